@@ -283,17 +283,70 @@ fgRenderCtrls(uint simple)
     return ret;
 }
 
+// Which morphed vertices changed in the latest pose shape update, by mesh. Updates are numbered
+// so that consumers can tell whether they have missed one:
+struct  PoseShapeChanges
+{
+    uint64              generation;
+    vector<bool>        all;            // All vertices may have changed
+    vector<FgUints>     changed;        // Otherwise the changed vertices, sorted
+    // State for determining the next changes:
+    uint64              baseStamp;      // Of the base shape the last update was made from
+    FgFlts              poseVals;       // Last pose values applied
+
+    PoseShapeChanges() : generation(0), baseStamp(0) {}
+};
+
+// The last changes generation the normals were updated for, by mesh:
+struct  NormsState
+{
+    uint64              generation;
+
+    NormsState() : generation(0) {}
+};
+
+// Only rebuilt when the meshes change, not when they are morphed:
+static
+FGLINK(linkVertFacets)
+{
+    FGLINKARGS(1,1);
+    const vector<Fg3dMesh> &    meshes = inputs[0]->valueRef();
+    vector<Fg3dVertFacets> &    vfs = outputs[0]->valueRef();
+    vfs.resize(meshes.size());
+    for (size_t ii=0; ii<meshes.size(); ++ii)
+        vfs[ii] = fgVertFacets(meshes[ii].surfaces,meshes[ii].verts.size());
+}
+
+// When only pose values have changed since the last update, only the normals around the
+// vertices moved by those poses are recomputed:
 static
 FGLINK(linkNorms)
 {
-    FGLINKARGS(2,1);
+    FGLINKARGS(4,2);
     const vector<Fg3dMesh> &    meshes = inputs[0]->valueRef();
     const FgVertss &            vertss = inputs[1]->valueRef();
+    const PoseShapeChanges &    changes = inputs[2]->valueRef();
+    const vector<Fg3dVertFacets> & vfs = inputs[3]->valueRef();
     vector<Fg3dNormals> &       normss = outputs[0]->valueRef();
+    NormsState &                state = outputs[1]->valueRef();
     FGASSERT(meshes.size() == vertss.size());
+    FGASSERT(meshes.size() == vfs.size());
+    bool                        incremental =
+        (changes.generation == state.generation + 1) &&
+        (changes.all.size() == meshes.size()) &&
+        (normss.size() == meshes.size());
     normss.resize(meshes.size());
-    for (size_t ii=0; ii<normss.size(); ++ii)
-        fgCalcNormals(meshes[ii].surfaces,vertss[ii],normss[ii]);
+    for (size_t ii=0; ii<normss.size(); ++ii) {
+        const vector<Fg3dSurface> & surfs = meshes[ii].surfaces;
+        const FgVerts &             verts = vertss[ii];
+        Fg3dNormals &               norms = normss[ii];
+        if (!incremental || changes.all[ii] || (norms.vert.size() != verts.size()) ||
+            (vfs[ii].offsets.size() != verts.size()+1))
+            fgCalcNormals(surfs,verts,norms);
+        else if (!changes.changed[ii].empty())
+            fgUpdateNormals(surfs,vfs[ii],verts,changes.changed[ii],norms);
+    }
+    state.generation = changes.generation;
 }
 
 static
@@ -349,28 +402,112 @@ FGLINK(lnkPoses)
     poses = fgPoses(meshes);
 }
 
+// Base vertices moved by each pose, found from the non-zero delta morph vertices and the target
+// morph indices bound to it:
+static
+vector<FgUints>
+poseVerts(const Fg3dMesh & mesh,const FgPoseBinding & binding)
+{
+    vector<FgUints>     ret(binding.numPoses);
+    for (size_t mm=0; mm<mesh.deltaMorphs.size(); ++mm) {
+        uint                pose = binding.deltaPoses[mm];
+        if (pose == binding.numPoses)
+            continue;
+        const FgVerts &     deltas = mesh.deltaMorphs[mm].verts;
+        for (size_t vv=0; vv<deltas.size(); ++vv)
+            if (deltas[vv] != FgVect3F(0))
+                ret[pose].push_back(uint(vv));
+    }
+    for (size_t mm=0; mm<mesh.targetMorphs.size(); ++mm) {
+        uint                pose = binding.targPoses[mm];
+        if (pose == binding.numPoses)
+            continue;
+        fgAppend(ret[pose],mesh.targetMorphs[mm].baseInds);
+    }
+    for (size_t pp=0; pp<ret.size(); ++pp) {
+        std::sort(ret[pp].begin(),ret[pp].end());
+        ret[pp].erase(std::unique(ret[pp].begin(),ret[pp].end()),ret[pp].end());
+    }
+    return ret;
+}
+
+// Rebound only when the meshes or pose list change, not when pose values change:
+static
+FGLINK(lnkPoseBindings)
+{
+    FGLINKARGS(2,2);
+    const vector<Fg3dMesh> &    meshes = inputs[0]->valueRef();
+    const FgPoses &             poses = inputs[1]->valueRef();
+    vector<FgPoseBinding> &     bindings = outputs[0]->valueRef();
+    vector<vector<FgUints> > &  poseVertss = outputs[1]->valueRef();
+    bindings.resize(meshes.size());
+    poseVertss.resize(meshes.size());
+    for (size_t ii=0; ii<meshes.size(); ++ii) {
+        bindings[ii] = meshes[ii].poseBinding(poses);
+        poseVertss[ii] = poseVerts(meshes[ii],bindings[ii]);
+    }
+}
+
+// Changes whenever anything the pose shape is made from changes, other than the pose values:
+static
+FGLINK(lnkBaseStamp)
+{
+    FGLINKARGS(3,1);
+    uint64 &                    stamp = outputs[0]->valueRef();
+    ++stamp;
+}
+
 static
 FGLINK(lnkPoseShape)
 {
-    FGLINKARGS(4,1);
+    FGLINKARGS(6,2);
     const vector<Fg3dMesh> &    meshes = inputs[0]->valueRef();
     const FgVertss &            allVertss = inputs[1]->valueRef();
-    const FgPoses &             poses = inputs[2]->valueRef();
-    vector<double>              poseVals = inputs[3]->valueRef();
+    const vector<FgPoseBinding> & bindings = inputs[2]->valueRef();
+    const vector<double> &      poseVals = inputs[3]->valueRef();
+    const vector<vector<FgUints> > & poseVertss = inputs[4]->valueRef();
+    uint64                      baseStamp = inputs[5]->valueRef();
     FgVertss &                  vertss = outputs[0]->valueRef();
+    PoseShapeChanges &          changes = outputs[1]->valueRef();
     FGASSERT(meshes.size() == allVertss.size());
+    FGASSERT(meshes.size() == bindings.size());
     // If pose list has changed but poseVals not yet updated (by GUI), assume all zero.
     // TODO: Keep poses as a label:val dictionary.
-    if (poses.size() != poseVals.size()) {
-        poseVals.clear();
-        poseVals.resize(poses.size(),0.0);
-    }
-    map<FgString,float>     poseMap;
-    for (size_t ii=0; ii<poses.size(); ++ii)
-        poseMap[poses[ii].name] = poseVals[ii];
+    size_t                      numPoses = bindings.empty() ? 0 : bindings[0].numPoses;
+    FgFlts                      vals(numPoses,0.0f);
+    if (poseVals.size() == numPoses)
+        for (size_t ii=0; ii<numPoses; ++ii)
+            vals[ii] = float(poseVals[ii]);
     vertss.resize(meshes.size());
     for (size_t ii=0; ii<meshes.size(); ++ii)
-        vertss[ii] = meshes[ii].poseShape(allVertss[ii],poseMap);
+        meshes[ii].poseShape_(allVertss[ii],bindings[ii],vals,vertss[ii]);
+    // Only the vertices of poses whose values changed can have moved, unless the base changed:
+    bool                        sameBase = (changes.baseStamp == baseStamp) &&
+                                           (changes.poseVals.size() == vals.size()) &&
+                                           (poseVertss.size() == meshes.size());
+    changes.all.assign(meshes.size(),!sameBase);
+    changes.changed.resize(meshes.size());
+    for (size_t ii=0; ii<meshes.size(); ++ii) {
+        FgUints &               changed = changes.changed[ii];
+        changed.clear();
+        if (!sameBase)
+            continue;
+        for (size_t pp=0; pp<vals.size(); ++pp)
+            if (vals[pp] != changes.poseVals[pp])
+                fgAppend(changed,poseVertss[ii][pp]);
+        // Beyond a modest fraction of the mesh the full normals calculation is faster:
+        if (changed.size()*4 > vertss[ii].size()) {
+            changes.all[ii] = true;
+            changed.clear();
+        }
+        else {
+            std::sort(changed.begin(),changed.end());
+            changed.erase(std::unique(changed.begin(),changed.end()),changed.end());
+        }
+    }
+    changes.baseStamp = baseStamp;
+    changes.poseVals = vals;
+    ++changes.generation;
 }
 
 static
@@ -699,7 +836,14 @@ fgGui3dCtls(
     g_gg.addLink(lnkPoses,meshesN,posesN);
     FgDgn<vector<double> >      morphValsN = g_gg.addInput(vector<double>(),"morphVals");
     ret.morphedVertssN = g_gg.addNode(FgVertss(),"morphedVertss");
-    g_gg.addLink(lnkPoseShape,fgUints(meshesN,allVertssN,posesN,morphValsN),ret.morphedVertssN);
+    FgDgn<vector<FgPoseBinding> > poseBindingsN = g_gg.addNode(vector<FgPoseBinding>(),"poseBindings");
+    FgDgn<vector<vector<FgUints> > > poseVertssN = g_gg.addNode(vector<vector<FgUints> >(),"poseVertss");
+    g_gg.addLink(lnkPoseBindings,fgUints(meshesN,posesN),fgUints(poseBindingsN,poseVertssN));
+    FgDgn<uint64>               baseStampN = g_gg.addNode(uint64(0),"poseBaseStamp");
+    g_gg.addLink(lnkBaseStamp,fgUints(meshesN,allVertssN,poseBindingsN),baseStampN);
+    FgDgn<PoseShapeChanges>     poseChangesN = g_gg.addNode(PoseShapeChanges(),"poseChanges");
+    g_gg.addLink(lnkPoseShape,fgUints(meshesN,allVertssN,poseBindingsN,morphValsN,poseVertssN,baseStampN),
+        fgUints(ret.morphedVertssN,poseChangesN));
     ret.morphCtls = fgGuiSplitScroll(g_gg.addUpdateFlag(posesN),
         boost::bind(getPanes,posesN,morphValsN,textEditBoxes),3);
     vector<Fg3dMesh>            meshes = g_gg.getVal(meshesN);
@@ -731,7 +875,11 @@ fgGui3dCtls(
     api.viewportDims = g_gg.addNode(FgVect2UI(1),"viewportDims");
     api.bgImg = renderCtrls.bgImgApi;
     api.bothButtonsDragAction = bothButtonsDrag;
-    g_gg.addLink(linkNorms,fgUints(meshesN,ret.morphedVertssN),api.normssN);
+    FgDgn<vector<Fg3dVertFacets> > vertFacetssN = g_gg.addNode(vector<Fg3dVertFacets>(),"vertFacetss");
+    g_gg.addLink(linkVertFacets,meshesN,vertFacetssN);
+    FgDgn<NormsState>   normsStateN = g_gg.addNode(NormsState(),"normsState");
+    g_gg.addLink(linkNorms,fgUints(meshesN,ret.morphedVertssN,poseChangesN,vertFacetssN),
+        fgUints(api.normssN,normsStateN));
     Fg3dCameraParams    defaultCps;     // Use default for lensFovDeg:
     FgDgn<double>       lensFovDeg = g_gg.addInput(defaultCps.fovMaxDeg,uid+"LensFovDeg");
     FgVectD2            logScaleRange(log(1.0/5.0),log(5.0));
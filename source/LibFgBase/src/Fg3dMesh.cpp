@@ -250,11 +250,11 @@ Fg3dMesh::morph(
 {
     FGASSERT(morphCoord.size() == numMorphs());
     outVerts = verts;
-    size_t      cnt = 0;
-    for (size_t ii=0; ii<deltaMorphs.size(); ++ii)
-        deltaMorphs[ii].applyAsDelta(outVerts,morphCoord[cnt++]);
+    size_t      cnt = deltaMorphs.size();
+    fgAccDeltaMorphs(deltaMorphs,fgHead(morphCoord,cnt),outVerts);
     for (size_t ii=0; ii<targetMorphs.size(); ++ii)
-        targetMorphs[ii].applyAsTarget_(verts,morphCoord[cnt++],outVerts);
+        if (morphCoord[cnt+ii] != 0.0f)
+            targetMorphs[ii].applyAsTarget_(verts,morphCoord[cnt+ii],outVerts);
 }
 
 void
@@ -277,9 +277,7 @@ Fg3dMesh::morph(
     FgVerts     ret = verts;
     FGASSERT(deltaMorphCoord.size() == deltaMorphs.size());
     FGASSERT(targMorphCoord.size() == targetMorphs.size());
-    for (size_t ii=0; ii<deltaMorphs.size(); ++ii)
-        if (deltaMorphCoord[ii] != 0.0f)
-            deltaMorphs[ii].applyAsDelta(ret,deltaMorphCoord[ii]);
+    fgAccDeltaMorphs(deltaMorphs,deltaMorphCoord,ret);
     for (size_t ii=0; ii<targetMorphs.size(); ++ii)
         if (targMorphCoord[ii] != 0.0f)
             targetMorphs[ii].applyAsTarget_(verts,targMorphCoord[ii],ret);
@@ -394,6 +392,18 @@ Fg3dMesh::poseShape(const FgVerts & allVerts,const std::map<FgString,float> & po
     return ret;
 }
 
+void
+Fg3dMesh::poseShape_(
+    const FgVerts &         allVerts,
+    const FgPoseBinding &   binding,
+    const FgFlts &          poseVals,
+    FgVerts &               ret) const
+{
+    FGASSERT(allVerts.size() >= verts.size());
+    ret.assign(allVerts.begin(),allVerts.begin()+verts.size());
+    binding.accDeltas(poseVals,deltaMorphs,targetMorphs,allVerts,ret);
+}
+
 void
 Fg3dMesh::addSurfaces(
     const std::vector<Fg3dSurface> & surfs)
@@ -662,7 +672,7 @@ fgSubdivide(const Fg3dMesh & in,bool loop)
         // Add the edge-split "odd" verts:
         for (uint ii=0; ii<topo.m_edges.size(); ++ii) {
             FgVect2UI       vertInds0 = topo.m_edges[ii].vertInds;
-            if (topo.m_edges[ii].triInds.size() == 1) {     // Boundary
+            if (topo.edgeTris(ii).size() == 1) {            // Boundary
                 ret.verts.push_back((
                     in.verts[vertInds0[0]] + 
                     in.verts[vertInds0[1]])*0.5f);
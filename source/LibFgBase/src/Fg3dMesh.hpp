@@ -252,6 +252,19 @@ struct  Fg3dMesh
     FgVerts
     poseShape(const FgVerts & allVerts,const std::map<FgString,float> & poseVals) const;
 
+    // Bind pose names to this mesh's morphs once for repeated evaluation below:
+    FgPoseBinding
+    poseBinding(const FgPoses & poses) const
+    {return FgPoseBinding(poses,verts.size(),deltaMorphs,targetMorphs); }
+
+    // 'poseVals' corresponds to the poses bound. Result is returned in 'ret', reusing its storage:
+    void
+    poseShape_(
+        const FgVerts &         allVerts,
+        const FgPoseBinding &   binding,
+        const FgFlts &          poseVals,
+        FgVerts &               ret) const;
+
     // EDITING:
 
     void
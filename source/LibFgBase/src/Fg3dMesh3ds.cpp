@@ -18,6 +18,7 @@
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
 #include "FgImageIo.hpp"
+#include "FgBinaryWriter.hpp"
 
 using namespace std;
 
@@ -74,59 +75,44 @@ static string fffMdlNameTo3dsName(const string & mdlName,vector<string> & nameLi
     return name;
 }
 
-static bool fffUpdateChunkSizeInfo_local(FILE *fptr,int newChunkSize,int chunkStartPos)
+static bool fffUpdateChunkSizeInfo_local(FgBinaryWriter &out,int newChunkSize,int chunkStartPos)
 {
-    int currPos = ftell(fptr);
-    if (fseek(fptr,chunkStartPos+2,SEEK_SET))
-        return false;
-    if (fwrite(&newChunkSize,sizeof(int),1,fptr) != 1)
-        return false;
-    if (fseek(fptr,currPos,SEEK_SET))
-        return false;
+    out.patch(size_t(chunkStartPos+2),newChunkSize);
     return true;
 }
 
-static bool fffWriteChunkHeader_local(FILE *fptr,unsigned short id,int ln)
+static bool fffWriteChunkHeader_local(FgBinaryWriter &out,unsigned short id,int ln)
 {
-    if (fwrite(&id,sizeof(unsigned short),1,fptr) != 1)
-        return false;
-    if (fwrite(&ln,sizeof(int),1,fptr) != 1)
-        return false;
+    out.val(id);
+    out.val(ln);
     return true;
 }
 
-static bool fffWrite3dsString_local(FILE *fptr, const string &str)
+static bool fffWrite3dsString_local(FgBinaryWriter &out, const string &str)
 {
-    if (fwrite(str.c_str(),sizeof(char),str.length()+1,fptr) !=
-            str.length()+1)
-        return false;
-    else
-        return true;
+    out.write(str.c_str(),str.length()+1);
+    return true;
 }
 
-static bool fffWriteTriObjectChunk_local(FILE *fptr,int &chunkSize,const map<string,string> &textureInfo,unsigned int objId,const FffMultiObjectC &model)
+static bool fffWriteTriObjectChunk_local(FgBinaryWriter &out,int &chunkSize,const map<string,string> &textureInfo,unsigned int objId,const FffMultiObjectC &model)
 {
-    int chunkStartPos = ftell(fptr);
+    int chunkStartPos = int(out.pos());
     unsigned short id = TRI_OBJECT;
     chunkSize = 6;
-    if (!fffWriteChunkHeader_local(fptr,id,chunkSize))
+    if (!fffWriteChunkHeader_local(out,id,chunkSize))
         return false;
     unsigned short numVtx = (unsigned short) model.numPoints(objId);
     if (numVtx != 0) {
         id = TRI_POINT_ARRAY;
         int ptChunkSize = 6+sizeof(unsigned short)+numVtx*sizeof(float)*3;
-        if (!fffWriteChunkHeader_local(fptr,id,ptChunkSize))
-            return false;
-        if (fwrite(&numVtx,sizeof(unsigned short),1,fptr) != 1)
+        if (!fffWriteChunkHeader_local(out,id,ptChunkSize))
             return false;
+        out.val(numVtx);
         const vector<FgVect3F> &ptList = model.getPtList(objId);
         for (unsigned short ii=0; ii<numVtx; ++ii) {
-            if (fwrite(&ptList[ii][0],sizeof(float),1,fptr) != 1)
-                return false;
-            if (fwrite(&ptList[ii][1],sizeof(float),1,fptr) != 1)
-                return false;
-            if (fwrite(&ptList[ii][2],sizeof(float),1,fptr) != 1)
-                return false;
+            out.val(ptList[ii][0]);
+            out.val(ptList[ii][1]);
+            out.val(ptList[ii][2]);
         }
         chunkSize += ptChunkSize;
     }
@@ -165,16 +151,13 @@ static bool fffWriteTriObjectChunk_local(FILE *fptr,int &chunkSize,const map<str
     if (perVertexTexture && model.numTxtCoord(objId) != 0) {
         id = TRI_TEX_COORD;
         int ptChunkSize = 6+sizeof(unsigned short)+numVtx*sizeof(float)*2;
-        if (!fffWriteChunkHeader_local(fptr,id,ptChunkSize))
-            return false;
-        if (fwrite(&numVtx,sizeof(unsigned short),1,fptr) != 1)
+        if (!fffWriteChunkHeader_local(out,id,ptChunkSize))
             return false;
+        out.val(numVtx);
         const vector<FgVect2F> &ptList = model.getTextCoord(objId);
         for (unsigned short ii=0; ii<numVtx; ++ii) {
-            if (fwrite(&ptList[ii][0],sizeof(float),1,fptr) != 1)
-                return false;
-            if (fwrite(&ptList[ii][1],sizeof(float),1,fptr) != 1)
-                return false;
+            out.val(ptList[ii][0]);
+            out.val(ptList[ii][1]);
         }
         chunkSize += ptChunkSize;
     }
@@ -183,7 +166,7 @@ static bool fffWriteTriObjectChunk_local(FILE *fptr,int &chunkSize,const map<str
     unsigned short numQuads = (unsigned short) model.numQuads(objId);
     unsigned short totalTris = numTris + numQuads*2;
     if (totalTris != 0) {
-        int triChunkStartPos = ftell(fptr);
+        int triChunkStartPos = int(out.pos());
         // Facet (tris) info.
         unsigned short fourthNum = 7;   // The first 3 bits turned on.
         id = TRI_FACE_ARRAY;
@@ -191,23 +174,18 @@ static bool fffWriteTriObjectChunk_local(FILE *fptr,int &chunkSize,const map<str
         int triChunkSize = 6 + sizeof(unsigned short)
                           + totalTris*sizeof(unsigned short)*4
                           + smoothGrpChunkSize;
-        if (!fffWriteChunkHeader_local(fptr,id,triChunkSize))
-            return false;
-        if (fwrite(&totalTris,sizeof(unsigned short),1,fptr) != 1)
+        if (!fffWriteChunkHeader_local(out,id,triChunkSize))
             return false;
+        out.val(totalTris);
         const vector<FgVect3UI> &triList = model.getTriList(objId);
         for (unsigned short ii=0; ii<numTris; ++ii) {
             unsigned short idx1 = (unsigned short) triList[ii][0];
             unsigned short idx2 = (unsigned short) triList[ii][1];
             unsigned short idx3 = (unsigned short) triList[ii][2];
-            if (fwrite(&idx1,sizeof(unsigned short),1,fptr) != 1)
-                return false;
-            if (fwrite(&idx2,sizeof(unsigned short),1,fptr) != 1)
-                return false;
-            if (fwrite(&idx3,sizeof(unsigned short),1,fptr) != 1)
-                return false;
-            if (fwrite(&fourthNum,sizeof(unsigned short),1,fptr) != 1)
-                return false;
+            out.val(idx1);
+            out.val(idx2);
+            out.val(idx3);
+            out.val(fourthNum);
         }
         const vector<FgVect4UI> &quadList = model.getQuadList(objId);
         ushort ii;
@@ -216,24 +194,19 @@ static bool fffWriteTriObjectChunk_local(FILE *fptr,int &chunkSize,const map<str
                 unsigned short idx1 = (unsigned short) quadList[ii][0];
                 unsigned short idx2 = (unsigned short) quadList[ii][xx+1];
                 unsigned short idx3 = (unsigned short) quadList[ii][xx+2];
-                if (fwrite(&idx1,sizeof(unsigned short),1,fptr) != 1)
-                    return false;
-                if (fwrite(&idx2,sizeof(unsigned short),1,fptr) != 1)
-                    return false;
-                if (fwrite(&idx3,sizeof(unsigned short),1,fptr) != 1)
-                    return false;
-                if (fwrite(&fourthNum,sizeof(unsigned short),1,fptr) != 1)
-                    return false;
+                out.val(idx1);
+                out.val(idx2);
+                out.val(idx3);
+                out.val(fourthNum);
             }
         }
         // Define smooth group (this whole surface is one smooth group)
         id = TRI_SMOOTH;
-        if (!fffWriteChunkHeader_local(fptr,id,smoothGrpChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,smoothGrpChunkSize))
             return false;
         unsigned int smoothGrp = objId+1;
         for (ii=0; ii<totalTris; ++ii) {
-            if (fwrite(&smoothGrp,sizeof(unsigned int),1,fptr) != 1)
-                return false;
+            out.val(smoothGrp);
         }
         // Texture mapping info.
         string textureFile = model.getTextureFilename(objId);
@@ -243,38 +216,35 @@ static bool fffWriteTriObjectChunk_local(FILE *fptr,int &chunkSize,const map<str
             id = TRI_MAT_GROUP;
             int triMatChunkSize = 6 + int(mapItr->second.length()) + 1
                                  + sizeof(unsigned short)*(totalTris+1);
-            if (!fffWriteChunkHeader_local(fptr,id,triMatChunkSize))
-                return false;
-            if (!fffWrite3dsString_local(fptr,mapItr->second))
+            if (!fffWriteChunkHeader_local(out,id,triMatChunkSize))
                 return false;
-            if (fwrite(&totalTris,sizeof(unsigned short),1,fptr) != 1)
+            if (!fffWrite3dsString_local(out,mapItr->second))
                 return false;
+            out.val(totalTris);
             vector<unsigned short> fList;
             fList.resize(totalTris);
             for (ii=0; ii<totalTris; ++ii)
                 fList[ii] = ii;
-            if (fwrite(&fList[0],sizeof(unsigned short),totalTris,fptr)
-                    != totalTris)
-                return false;
+            out.vals(&fList[0],totalTris);
             triChunkSize += triMatChunkSize;
-            if (!fffUpdateChunkSizeInfo_local(fptr,triChunkSize,
+            if (!fffUpdateChunkSizeInfo_local(out,triChunkSize,
                     triChunkStartPos))
                 return false;
         }
         chunkSize += triChunkSize;
     }
     // Correct the chunk size info for TRI_OBJECT chunk
-    if (!fffUpdateChunkSizeInfo_local(fptr,chunkSize,chunkStartPos))
+    if (!fffUpdateChunkSizeInfo_local(out,chunkSize,chunkStartPos))
         return false;
     return true;
 }
 
-static bool fffWriteMdataChunk_local(FILE *fptr,int &chunkSize,const FffMultiObjectC &model)
+static bool fffWriteMdataChunk_local(FgBinaryWriter &out,int &chunkSize,const FffMultiObjectC &model)
 {
-    int chunkStartPos = ftell(fptr);
+    int chunkStartPos = int(out.pos());
     unsigned short id = MDATA;
     chunkSize = 6;
-    if (!fffWriteChunkHeader_local(fptr,id,chunkSize))
+    if (!fffWriteChunkHeader_local(out,id,chunkSize))
         return false;
     // Build Texture info
     map<string,string> textureInfoMap;  // Key = fname, map = mapName
@@ -299,18 +269,18 @@ static bool fffWriteMdataChunk_local(FILE *fptr,int &chunkSize,const FffMultiObj
     for (map<string,string>::const_iterator itr = textureInfoMap.begin();
          itr != textureInfoMap.end(); ++itr)
     {
-        int matEntryChunkStartPos = ftell(fptr);
+        int matEntryChunkStartPos = int(out.pos());
         id = MAT_ENTRY;
         int matEntryChunkSize=6;
-        if (!fffWriteChunkHeader_local(fptr,id,matEntryChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,matEntryChunkSize))
             return false;
 
         id = MAT_NAME;
 
         int mapNameChunkSize = 6 + int(itr->second.length()) + 1;
-        if (!fffWriteChunkHeader_local(fptr,id,mapNameChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,mapNameChunkSize))
             return false;
-        if (!fffWrite3dsString_local(fptr,itr->second))
+        if (!fffWrite3dsString_local(out,itr->second))
             return false;
 
         matEntryChunkSize += mapNameChunkSize;
@@ -319,75 +289,66 @@ static bool fffWriteMdataChunk_local(FILE *fptr,int &chunkSize,const FffMultiObj
 
         id = MAT_AMBIENT;
         int mapAmbientColourChunkSize = 6 + colourChunkSize;
-        if (!fffWriteChunkHeader_local(fptr,id,mapAmbientColourChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,mapAmbientColourChunkSize))
             return false;
         id = COLOUR_RGB_BYTE;
-        if (!fffWriteChunkHeader_local(fptr,id,colourChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,colourChunkSize))
             return false;
         char red=(char)0;
         char green=(char)0;
         char blue=(char)0;
-        if (fwrite(&red,1,1,fptr) != 1)
-            return false;
-        if (fwrite(&green,1,1,fptr) != 1)
-            return false;
-        if (fwrite(&blue,1,1,fptr) != 1)
-            return false;
+        out.val(red);
+        out.val(green);
+        out.val(blue);
 
         matEntryChunkSize += mapAmbientColourChunkSize;
 
         id = MAT_DIFFUSE;
         int mapDiffuseColourChunkSize = 6 + colourChunkSize;
-        if (!fffWriteChunkHeader_local(fptr,id,mapDiffuseColourChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,mapDiffuseColourChunkSize))
             return false;
         id = COLOUR_RGB_BYTE;
-        if (!fffWriteChunkHeader_local(fptr,id,colourChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,colourChunkSize))
             return false;
         red=(char)255;
         green=(char)255;
         blue=(char)255;
-        if (fwrite(&red,1,1,fptr) != 1)
-            return false;
-        if (fwrite(&green,1,1,fptr) != 1)
-            return false;
-        if (fwrite(&blue,1,1,fptr) != 1)
-            return false;
+        out.val(red);
+        out.val(green);
+        out.val(blue);
 
         matEntryChunkSize += mapDiffuseColourChunkSize;
 
         id = MAT_SPECULAR;
         int mapSpecularColourChunkSize = 6 + colourChunkSize;
-        if (!fffWriteChunkHeader_local(fptr,id,mapSpecularColourChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,mapSpecularColourChunkSize))
             return false;
         id = COLOUR_RGB_BYTE;
-        if (!fffWriteChunkHeader_local(fptr,id,colourChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,colourChunkSize))
             return false;
         red=(char)0;
         green=(char)0;
         blue=(char)0;
-        if (fwrite(&red,1,1,fptr) != 1)
-            return false;
-        if (fwrite(&green,1,1,fptr) != 1)
-            return false;
-        if (fwrite(&blue,1,1,fptr) != 1)
-            return false;
+        out.val(red);
+        out.val(green);
+        out.val(blue);
 
         matEntryChunkSize += mapSpecularColourChunkSize;
 
         id = MAT_TEXMAP;
         int mapFilenameChunkSize = 6 + int(itr->first.length()) + 1;
         int textMapChunkSize = 6 + mapFilenameChunkSize;
-        if (!fffWriteChunkHeader_local(fptr,id,textMapChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,textMapChunkSize))
             return false;
         id = MAT_MAP_FNAME;
-        if (!fffWriteChunkHeader_local(fptr,id,mapFilenameChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,mapFilenameChunkSize))
             return false;
-        if (!fffWrite3dsString_local(fptr,itr->first))
+        if (!fffWrite3dsString_local(out,itr->first))
             return false;
 
         matEntryChunkSize += textMapChunkSize;
 
-        if (!fffUpdateChunkSizeInfo_local(fptr,matEntryChunkSize,
+        if (!fffUpdateChunkSizeInfo_local(out,matEntryChunkSize,
                 matEntryChunkStartPos))
             return false;
 
@@ -398,31 +359,31 @@ static bool fffWriteMdataChunk_local(FILE *fptr,int &chunkSize,const FffMultiObj
     ulong objId;
     for (objId=0; objId<model.numObjs(); ++objId)
     {
-        int objChunkStartPos = ftell(fptr);
+        int objChunkStartPos = int(out.pos());
         id = OBJECT;
         int    objChunkSize = 6;
-        if (!fffWriteChunkHeader_local(fptr,id,objChunkSize))
+        if (!fffWriteChunkHeader_local(out,id,objChunkSize))
             return false;
 
         string objName = fffMdlNameTo3dsName(model.getModelName(objId),
                                              objNameList);
-        if (!fffWrite3dsString_local(fptr,objName))
+        if (!fffWrite3dsString_local(out,objName))
             return false;
         objChunkSize += int(objName.length())+1;
 
         int triObjChunkSize;
-        if (!fffWriteTriObjectChunk_local(fptr,triObjChunkSize,
+        if (!fffWriteTriObjectChunk_local(out,triObjChunkSize,
                 textureInfoMap,objId,model))
             return false;
         objChunkSize += triObjChunkSize;
 
-        if (!fffUpdateChunkSizeInfo_local(fptr,objChunkSize,objChunkStartPos))
+        if (!fffUpdateChunkSizeInfo_local(out,objChunkSize,objChunkStartPos))
             return false;
 
         chunkSize += objChunkSize;
     }
 
-    if (!fffUpdateChunkSizeInfo_local(fptr,chunkSize,chunkStartPos))
+    if (!fffUpdateChunkSizeInfo_local(out,chunkSize,chunkStartPos))
         return false;
 
     return true;
@@ -435,19 +396,11 @@ fffSave3dsFile(const FgString &name, const FffMultiObjectC &model)
     FgPath      path(name);
     path.ext = "3ds";
     FgString    fname = path.str();
-#ifdef _WIN32
-    FILE *fptr = _wfopen(fname.as_wstring().c_str(),L"wb,ccs=UNICODE");
-#else
-    FILE *fptr = fopen(fname.m_str.c_str(),"wb");
-#endif
-    if (!fptr) {
-        return false;
-    }
+    FgBinaryWriter out(false);      // 3DS is little-endian
     unsigned short id = 0x4D4D;     // 3DS magic number
     int chunkSize = sizeof(unsigned short) + sizeof(int);
-    int chunkStartPos = ftell(fptr);
-    if (!fffWriteChunkHeader_local(fptr,id,chunkSize)) {
-        fclose(fptr);
+    int chunkStartPos = int(out.pos());
+    if (!fffWriteChunkHeader_local(out,id,chunkSize)) {
         return false;
     }
     {
@@ -455,29 +408,22 @@ fffSave3dsFile(const FgString &name, const FffMultiObjectC &model)
         int version = 3;
         int verChunkSize = sizeof(unsigned short) + sizeof(int)
                           + sizeof(int);
-        if (!fffWriteChunkHeader_local(fptr,id,verChunkSize))
-        {
-            fclose(fptr);
-            return false;
-        }
-        if (fwrite(&version,sizeof(int),1,fptr) != 1)
+        if (!fffWriteChunkHeader_local(out,id,verChunkSize))
         {
-            fclose(fptr);
             return false;
         }
+        out.val(version);
         chunkSize += verChunkSize;
     }
     int mdataChunkSize=0;
-    if (!fffWriteMdataChunk_local(fptr,mdataChunkSize,model)) {
-        fclose(fptr);
+    if (!fffWriteMdataChunk_local(out,mdataChunkSize,model)) {
         return false;
     }
     chunkSize += mdataChunkSize;
-    if (!fffUpdateChunkSizeInfo_local(fptr,chunkSize,chunkStartPos)) {
-        fclose(fptr);
+    if (!fffUpdateChunkSizeInfo_local(out,chunkSize,chunkStartPos)) {
         return false;
     }
-    fclose(fptr);
+    out.save(fname);
     return true;
 }
 
@@ -21,28 +21,538 @@
 
 using namespace std;
 
-Fg3dMesh
-fgLoadFgmesh(const FgString & fname)
+// VERSION 2 LAYOUT:
+//
+// Little-endian throughout. The file begins with 'FgmeshHeader', whose tag is stored as a
+// version 1 string so that version 1 readers reject it cleanly. Every array is located by an
+// 'FgmeshArr' (byte offset from the start of the file and number of elements) and starts on a
+// 16-byte boundary. Strings are UTF-8 arrays of char without terminator. Arrays of records are
+// written after the arrays they refer to.
+
+struct  FgmeshArr
 {
-    Fg3dMesh        ret;
-    FgIfstream      ifs(fname);
-    if (fgReadpT<string>(ifs) != "FgMesh01")
-        fgThrow("Not a valid FGMESH file",fname);
-    fgReadp(ifs,ret);
-    return ret;
+    uint64      offset;
+    uint64      num;
+};
+
+struct  FgmeshHeader
+{
+    uint32      tagLen;             // 8
+    char        tag[8];             // "FgMesh02"
+    uint32      reserved;
+    FgmeshArr   verts;              // FgVect3F
+    FgmeshArr   uvs;                // FgVect2F
+    FgmeshArr   surfs;              // FgmeshSurf
+    FgmeshArr   deltaMorphs;        // FgmeshMorph
+    FgmeshArr   targMorphs;         // FgmeshMorph
+    FgmeshArr   markedVerts;        // FgmeshMarked
+};
+
+struct  FgmeshSurf
+{
+    FgmeshArr   name;               // char
+    FgmeshArr   triVerts;           // FgVect3UI
+    FgmeshArr   triUvs;             // FgVect3UI
+    FgmeshArr   quadVerts;          // FgVect4UI
+    FgmeshArr   quadUvs;            // FgVect4UI
+    FgmeshArr   surfPoints;         // FgmeshSurfPoint
+};
+
+struct  FgmeshSurfPoint
+{
+    uint32      triEquivIdx;
+    FgVect3F    weights;
+    FgmeshArr   label;              // char
+};
+
+struct  FgmeshMorph
+{
+    FgmeshArr   name;               // char
+    FgmeshArr   baseInds;           // uint32. Empty for delta morphs.
+    FgmeshArr   verts;              // FgVect3F
+};
+
+struct  FgmeshMarked
+{
+    uint32      idx;
+    uint32      reserved[3];
+    FgmeshArr   label;              // char
+};
+
+FG_STATIC_ASSERT(sizeof(FgmeshHeader) == 112);
+FG_STATIC_ASSERT(sizeof(FgmeshSurf) == 96);
+FG_STATIC_ASSERT(sizeof(FgmeshSurfPoint) == 32);
+FG_STATIC_ASSERT(sizeof(FgmeshMorph) == 48);
+FG_STATIC_ASSERT(sizeof(FgmeshMarked) == 32);
+FG_STATIC_ASSERT(sizeof(FgVect3F) == 12);
+FG_STATIC_ASSERT(sizeof(FgVect2F) == 8);
+FG_STATIC_ASSERT(sizeof(FgVect3UI) == 12);
+FG_STATIC_ASSERT(sizeof(FgVect4UI) == 16);
+
+static const char   fgmeshTag1[] = "FgMesh01";
+static const char   fgmeshTag2[] = "FgMesh02";
+
+// Version 2 data is written and mapped in place, so is only supported on little-endian platforms:
+#if defined(BOOST_LITTLE_ENDIAN)
+static const bool   fgmesh2Supported = true;
+#else
+static const bool   fgmesh2Supported = false;
+#endif
+
+// Read-only stream over memory, so that version 1 files can be parsed from the mapping:
+struct  FgmeshMemBuf : public std::streambuf
+{
+    FgmeshMemBuf(const char * data,size_t size)
+    {
+        char *      ptr = const_cast<char*>(data);
+        setg(ptr,ptr,ptr+size);
+    }
+};
+
+// Writes each array at the next 16-byte boundary and returns its location:
+struct  FgmeshWriter
+{
+    FgOfstream &    ofs;
+    uint64          pos;
+
+    explicit
+    FgmeshWriter(FgOfstream & o) : ofs(o), pos(0) {}
+
+    void
+    writeRaw(const void * ptr,size_t bytes)
+    {
+        ofs.write(static_cast<const char*>(ptr),bytes);
+        pos += bytes;
+    }
+
+    FgmeshArr
+    write(const void * ptr,size_t num,size_t elemSz)
+    {
+        static const char   zeros[16] = {0};
+        if (pos % 16 != 0)
+            writeRaw(zeros,16 - pos % 16);
+        FgmeshArr       ret = {pos,num};
+        if (num > 0)
+            writeRaw(ptr,num*elemSz);
+        return ret;
+    }
+
+    template<class T>
+    FgmeshArr
+    write(const vector<T> & vec)
+    {return write(vec.empty() ? NULL : &vec[0],vec.size(),sizeof(T)); }
+
+    FgmeshArr
+    write(const string & str)
+    {return write(str.data(),str.size(),1); }
+
+    FgmeshArr
+    write(const FgString & str)
+    {return write(str.m_str); }
+};
+
+static
+void
+saveFgmesh2(const FgString & fname,const Fg3dMesh & mesh)
+{
+    if (!fgmesh2Supported)
+        fgThrow("FGMESH version 2 is not supported on big-endian platforms",fname);
+    FgOfstream          ofs(fname);
+    FgmeshWriter        wr(ofs);
+    FgmeshHeader        hdr;
+    memset(&hdr,0,sizeof(hdr));
+    hdr.tagLen = 8;
+    memcpy(hdr.tag,fgmeshTag2,8);
+    wr.writeRaw(&hdr,sizeof(hdr));          // Placeholder, rewritten below
+    hdr.verts = wr.write(mesh.verts);
+    hdr.uvs = wr.write(mesh.uvs);
+    vector<FgmeshSurf>      surfs(mesh.surfaces.size());
+    for (size_t ss=0; ss<surfs.size(); ++ss) {
+        const Fg3dSurface &     surf = mesh.surfaces[ss];
+        FgmeshSurf &            rec = surfs[ss];
+        rec.name = wr.write(surf.name);
+        rec.triVerts = wr.write(surf.tris.vertInds);
+        rec.triUvs = wr.write(surf.tris.uvInds);
+        rec.quadVerts = wr.write(surf.quads.vertInds);
+        rec.quadUvs = wr.write(surf.quads.uvInds);
+        vector<FgmeshSurfPoint>     sps(surf.surfPoints.size());
+        for (size_t ii=0; ii<sps.size(); ++ii) {
+            const FgSurfPoint &     sp = surf.surfPoints[ii];
+            sps[ii].triEquivIdx = sp.triEquivIdx;
+            sps[ii].weights = sp.weights;
+            sps[ii].label = wr.write(sp.label);
+        }
+        rec.surfPoints = wr.write(sps);
+    }
+    hdr.surfs = wr.write(surfs);
+    vector<FgmeshMorph>     morphs(mesh.deltaMorphs.size());
+    for (size_t ii=0; ii<morphs.size(); ++ii) {
+        const FgMorph &         morph = mesh.deltaMorphs[ii];
+        morphs[ii].name = wr.write(morph.name);
+        morphs[ii].baseInds = wr.write(FgUints());
+        morphs[ii].verts = wr.write(morph.verts);
+    }
+    hdr.deltaMorphs = wr.write(morphs);
+    morphs.resize(mesh.targetMorphs.size());
+    for (size_t ii=0; ii<morphs.size(); ++ii) {
+        const FgIndexedMorph &  morph = mesh.targetMorphs[ii];
+        FGASSERT(morph.baseInds.size() == morph.verts.size());
+        morphs[ii].name = wr.write(morph.name);
+        morphs[ii].baseInds = wr.write(morph.baseInds);
+        morphs[ii].verts = wr.write(morph.verts);
+    }
+    hdr.targMorphs = wr.write(morphs);
+    vector<FgmeshMarked>    marked(mesh.markedVerts.size());
+    for (size_t ii=0; ii<marked.size(); ++ii) {
+        memset(&marked[ii],0,sizeof(FgmeshMarked));
+        marked[ii].idx = mesh.markedVerts[ii].idx;
+        marked[ii].label = wr.write(mesh.markedVerts[ii].label);
+    }
+    hdr.markedVerts = wr.write(marked);
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(&hdr),sizeof(hdr));
+    if (!ofs)
+        fgThrow("Error writing FGMESH file",fname);
 }
 
+static
 void
-fgSaveFgmesh(const FgString & fname,const Fg3dMesh & mesh)
+saveFgmesh1(const FgString & fname,const Fg3dMesh & mesh)
 {
     FgOfstream          ofs(fname);
-    fgWritep(ofs,string("FgMesh01"));
+    fgWritep(ofs,string(fgmeshTag1));
     fgWritep(ofs,mesh);
 }
 
+Fg3dMesh
+fgLoadFgmesh(const FgString & fname)
+{
+    boost::shared_ptr<FgFileMap>    file(new FgFileMap(fname));
+    // The version 1 tag is a serialized string, ie. a little-endian uint32 length then the chars:
+    const uchar *   data = reinterpret_cast<const uchar*>(file->data());
+    if ((file->size() >= 12) &&
+        (data[0] == 8) && (data[1] == 0) && (data[2] == 0) && (data[3] == 0) &&
+        (memcmp(data+4,fgmeshTag1,8) == 0)) {
+        FgmeshMemBuf    buf(file->data()+12,file->size()-12);
+        std::istream    is(&buf);
+        Fg3dMesh        ret;
+        fgReadp(is,ret);
+        if (!is)
+            fgThrow("Corrupt FGMESH file",fname);
+        return ret;
+    }
+    // Throws if not valid version 2 either:
+    return FgFgmeshView(file,fname).mesh();
+}
+
 void
-fgSaveFgmesh(const FgString & fname,const Fg3dMeshes & meshes)
-{fgSaveFgmesh(fname,fgMergeMeshes(meshes)); }
+fgSaveFgmesh(const FgString & fname,const Fg3dMesh & mesh,uint version)
+{
+    if (version == 1)
+        saveFgmesh1(fname,mesh);
+    else if (version == 2)
+        saveFgmesh2(fname,mesh);
+    else
+        fgThrow("Unsupported FGMESH version",fgToString(version));
+}
+
+void
+fgSaveFgmesh(const FgString & fname,const Fg3dMeshes & meshes,uint version)
+{fgSaveFgmesh(fname,fgMergeMeshes(meshes),version); }
+
+uint
+fgFgmeshVersion(const FgString & fname)
+{
+    // Both versions begin with their tag serialized as a version 1 string:
+    FgIfstream          ifs(fname);
+    uint32              len = 0;
+    char                tag[8];
+    fgReadb(ifs,len);
+    ifs.read(tag,8);
+    if (!ifs || (len != 8))
+        return 0;
+    if (memcmp(tag,fgmeshTag1,8) == 0)
+        return 1;
+    if (memcmp(tag,fgmeshTag2,8) == 0)
+        return 2;
+    return 0;
+}
+
+template<class T>
+static
+FgMappedArr<T>
+fgmeshArr(const FgFileMap & file,const FgmeshArr & arr)
+{return FgMappedArr<T>(reinterpret_cast<const T*>(file.data()+arr.offset),size_t(arr.num)); }
+
+static
+FgString
+fgmeshStr(const FgFileMap & file,const FgmeshArr & arr)
+{
+    FgMappedArr<char>   chars = fgmeshArr<char>(file,arr);
+    return FgString(string(chars.begin(),chars.end()));
+}
+
+static
+const FgmeshHeader &
+fgmeshHeader(const FgFileMap & file)
+{return *reinterpret_cast<const FgmeshHeader*>(file.data()); }
+
+static
+void
+fgmeshCheck(const FgFileMap & file,const FgmeshArr & arr,size_t elemSz,const FgString & fname)
+{
+    uint64      sz = file.size();
+    if ((arr.offset % 16 != 0) || (arr.offset > sz) || (arr.num > (sz - arr.offset) / elemSz))
+        fgThrow("Corrupt FGMESH file",fname);
+}
+
+template<uint dim>
+static
+void
+fgmeshCheckInds(const FgFileMap & file,const FgmeshArr & arr,uint64 num,const FgString & fname)
+{
+    FgMappedArr<FgMatrixC<uint,dim,1> >     inds = fgmeshArr<FgMatrixC<uint,dim,1> >(file,arr);
+    for (size_t ii=0; ii<inds.size(); ++ii)
+        for (uint jj=0; jj<dim; ++jj)
+            if (inds[ii][jj] >= num)
+                fgThrow("Corrupt FGMESH file index",fname);
+}
+
+FgFgmeshView::FgFgmeshView(const FgString & fname) : m_file(new FgFileMap(fname))
+{validate(fname); }
+
+FgFgmeshView::FgFgmeshView(boost::shared_ptr<FgFileMap> file,const FgString & fname) : m_file(file)
+{validate(fname); }
+
+void
+FgFgmeshView::validate(const FgString & fname) const
+{
+    if (!fgmesh2Supported)
+        fgThrow("FGMESH version 2 is not supported on big-endian platforms",fname);
+    const FgFileMap &   file = *m_file;
+    if ((file.size() < sizeof(FgmeshHeader)) ||
+        (fgmeshHeader(file).tagLen != 8) ||
+        (memcmp(fgmeshHeader(file).tag,fgmeshTag2,8) != 0))
+        fgThrow("Not a valid version 2 FGMESH file",fname);
+    const FgmeshHeader &    hdr = fgmeshHeader(file);
+    fgmeshCheck(file,hdr.verts,sizeof(FgVect3F),fname);
+    fgmeshCheck(file,hdr.uvs,sizeof(FgVect2F),fname);
+    fgmeshCheck(file,hdr.surfs,sizeof(FgmeshSurf),fname);
+    FgMappedArr<FgmeshSurf>     surfs = fgmeshArr<FgmeshSurf>(file,hdr.surfs);
+    for (size_t ss=0; ss<surfs.size(); ++ss) {
+        const FgmeshSurf &      surf = surfs[ss];
+        fgmeshCheck(file,surf.name,1,fname);
+        fgmeshCheck(file,surf.triVerts,sizeof(FgVect3UI),fname);
+        fgmeshCheck(file,surf.triUvs,sizeof(FgVect3UI),fname);
+        fgmeshCheck(file,surf.quadVerts,sizeof(FgVect4UI),fname);
+        fgmeshCheck(file,surf.quadUvs,sizeof(FgVect4UI),fname);
+        fgmeshCheck(file,surf.surfPoints,sizeof(FgmeshSurfPoint),fname);
+        // UV indices are either absent or 1-1 with the vertex indices:
+        if (((surf.triUvs.num != 0) && (surf.triUvs.num != surf.triVerts.num)) ||
+            ((surf.quadUvs.num != 0) && (surf.quadUvs.num != surf.quadVerts.num)))
+            fgThrow("Corrupt FGMESH file UV indices",fname);
+        fgmeshCheckInds<3>(file,surf.triVerts,hdr.verts.num,fname);
+        fgmeshCheckInds<3>(file,surf.triUvs,hdr.uvs.num,fname);
+        fgmeshCheckInds<4>(file,surf.quadVerts,hdr.verts.num,fname);
+        fgmeshCheckInds<4>(file,surf.quadUvs,hdr.uvs.num,fname);
+        uint64                  numTriEquivs = surf.triVerts.num + 2 * surf.quadVerts.num;
+        FgMappedArr<FgmeshSurfPoint>    sps = fgmeshArr<FgmeshSurfPoint>(file,surf.surfPoints);
+        for (size_t ii=0; ii<sps.size(); ++ii) {
+            fgmeshCheck(file,sps[ii].label,1,fname);
+            if (sps[ii].triEquivIdx >= numTriEquivs)
+                fgThrow("Corrupt FGMESH file surface point",fname);
+        }
+    }
+    fgmeshCheck(file,hdr.deltaMorphs,sizeof(FgmeshMorph),fname);
+    FgMappedArr<FgmeshMorph>    morphs = fgmeshArr<FgmeshMorph>(file,hdr.deltaMorphs);
+    for (size_t ii=0; ii<morphs.size(); ++ii) {
+        fgmeshCheck(file,morphs[ii].name,1,fname);
+        fgmeshCheck(file,morphs[ii].verts,sizeof(FgVect3F),fname);
+        if ((morphs[ii].baseInds.num != 0) || (morphs[ii].verts.num != hdr.verts.num))
+            fgThrow("Corrupt FGMESH file delta morph",fname);
+    }
+    fgmeshCheck(file,hdr.targMorphs,sizeof(FgmeshMorph),fname);
+    morphs = fgmeshArr<FgmeshMorph>(file,hdr.targMorphs);
+    for (size_t ii=0; ii<morphs.size(); ++ii) {
+        fgmeshCheck(file,morphs[ii].name,1,fname);
+        fgmeshCheck(file,morphs[ii].baseInds,sizeof(uint),fname);
+        fgmeshCheck(file,morphs[ii].verts,sizeof(FgVect3F),fname);
+        if (morphs[ii].baseInds.num != morphs[ii].verts.num)
+            fgThrow("Corrupt FGMESH file target morph",fname);
+        FgMappedArr<uint>       baseInds = fgmeshArr<uint>(file,morphs[ii].baseInds);
+        for (size_t jj=0; jj<baseInds.size(); ++jj)
+            if (baseInds[jj] >= hdr.verts.num)
+                fgThrow("Corrupt FGMESH file target morph index",fname);
+    }
+    fgmeshCheck(file,hdr.markedVerts,sizeof(FgmeshMarked),fname);
+    FgMappedArr<FgmeshMarked>   marked = fgmeshArr<FgmeshMarked>(file,hdr.markedVerts);
+    for (size_t ii=0; ii<marked.size(); ++ii) {
+        fgmeshCheck(file,marked[ii].label,1,fname);
+        if (marked[ii].idx >= hdr.verts.num)
+            fgThrow("Corrupt FGMESH file marked vertex",fname);
+    }
+}
+
+FgMappedArr<FgVect3F>
+FgFgmeshView::verts() const
+{return fgmeshArr<FgVect3F>(*m_file,fgmeshHeader(*m_file).verts); }
+
+FgMappedArr<FgVect2F>
+FgFgmeshView::uvs() const
+{return fgmeshArr<FgVect2F>(*m_file,fgmeshHeader(*m_file).uvs); }
+
+static
+const FgmeshSurf &
+fgmeshSurf(const FgFileMap & file,size_t surfIdx)
+{return fgmeshArr<FgmeshSurf>(file,fgmeshHeader(file).surfs)[surfIdx]; }
+
+size_t
+FgFgmeshView::numSurfaces() const
+{return size_t(fgmeshHeader(*m_file).surfs.num); }
+
+FgString
+FgFgmeshView::surfaceName(size_t surfIdx) const
+{return fgmeshStr(*m_file,fgmeshSurf(*m_file,surfIdx).name); }
+
+FgMappedArr<FgVect3UI>
+FgFgmeshView::triVertInds(size_t surfIdx) const
+{return fgmeshArr<FgVect3UI>(*m_file,fgmeshSurf(*m_file,surfIdx).triVerts); }
+
+FgMappedArr<FgVect3UI>
+FgFgmeshView::triUvInds(size_t surfIdx) const
+{return fgmeshArr<FgVect3UI>(*m_file,fgmeshSurf(*m_file,surfIdx).triUvs); }
+
+FgMappedArr<FgVect4UI>
+FgFgmeshView::quadVertInds(size_t surfIdx) const
+{return fgmeshArr<FgVect4UI>(*m_file,fgmeshSurf(*m_file,surfIdx).quadVerts); }
+
+FgMappedArr<FgVect4UI>
+FgFgmeshView::quadUvInds(size_t surfIdx) const
+{return fgmeshArr<FgVect4UI>(*m_file,fgmeshSurf(*m_file,surfIdx).quadUvs); }
+
+Fg3dSurface
+FgFgmeshView::surface(size_t surfIdx) const
+{
+    Fg3dSurface         ret;
+    ret.name = surfaceName(surfIdx);
+    ret.tris.vertInds = triVertInds(surfIdx).vec();
+    ret.tris.uvInds = triUvInds(surfIdx).vec();
+    ret.quads.vertInds = quadVertInds(surfIdx).vec();
+    ret.quads.uvInds = quadUvInds(surfIdx).vec();
+    FgMappedArr<FgmeshSurfPoint>    sps =
+        fgmeshArr<FgmeshSurfPoint>(*m_file,fgmeshSurf(*m_file,surfIdx).surfPoints);
+    ret.surfPoints.resize(sps.size());
+    for (size_t ii=0; ii<sps.size(); ++ii) {
+        FgSurfPoint &       sp = ret.surfPoints[ii];
+        sp.triEquivIdx = sps[ii].triEquivIdx;
+        sp.weights = sps[ii].weights;
+        sp.label = fgmeshStr(*m_file,sps[ii].label).m_str;
+    }
+    return ret;
+}
+
+static
+const FgmeshMorph &
+fgmeshMorph(const FgFileMap & file,const FgmeshArr & morphs,size_t morphIdx)
+{return fgmeshArr<FgmeshMorph>(file,morphs)[morphIdx]; }
+
+// Compares names in place to avoid creating a string for each morph:
+static
+size_t
+fgmeshMorphIdx(const FgFileMap & file,const FgmeshArr & morphs,const FgString & name)
+{
+    const string &              str = name.m_str;
+    FgMappedArr<FgmeshMorph>    recs = fgmeshArr<FgmeshMorph>(file,morphs);
+    for (size_t ii=0; ii<recs.size(); ++ii) {
+        FgMappedArr<char>       chars = fgmeshArr<char>(file,recs[ii].name);
+        if ((chars.size() == str.size()) && std::equal(chars.begin(),chars.end(),str.begin()))
+            return ii;
+    }
+    return recs.size();
+}
+
+size_t
+FgFgmeshView::numDeltaMorphs() const
+{return size_t(fgmeshHeader(*m_file).deltaMorphs.num); }
+
+FgString
+FgFgmeshView::deltaMorphName(size_t morphIdx) const
+{return fgmeshStr(*m_file,fgmeshMorph(*m_file,fgmeshHeader(*m_file).deltaMorphs,morphIdx).name); }
+
+size_t
+FgFgmeshView::deltaMorphIdx(const FgString & name) const
+{return fgmeshMorphIdx(*m_file,fgmeshHeader(*m_file).deltaMorphs,name); }
+
+FgMappedArr<FgVect3F>
+FgFgmeshView::deltaMorphVerts(size_t morphIdx) const
+{return fgmeshArr<FgVect3F>(*m_file,fgmeshMorph(*m_file,fgmeshHeader(*m_file).deltaMorphs,morphIdx).verts); }
+
+FgMorph
+FgFgmeshView::deltaMorph(size_t morphIdx) const
+{return FgMorph(deltaMorphName(morphIdx),deltaMorphVerts(morphIdx).vec()); }
+
+size_t
+FgFgmeshView::numTargetMorphs() const
+{return size_t(fgmeshHeader(*m_file).targMorphs.num); }
+
+FgString
+FgFgmeshView::targetMorphName(size_t morphIdx) const
+{return fgmeshStr(*m_file,fgmeshMorph(*m_file,fgmeshHeader(*m_file).targMorphs,morphIdx).name); }
+
+size_t
+FgFgmeshView::targetMorphIdx(const FgString & name) const
+{return fgmeshMorphIdx(*m_file,fgmeshHeader(*m_file).targMorphs,name); }
+
+FgMappedArr<uint>
+FgFgmeshView::targetMorphBaseInds(size_t morphIdx) const
+{return fgmeshArr<uint>(*m_file,fgmeshMorph(*m_file,fgmeshHeader(*m_file).targMorphs,morphIdx).baseInds); }
+
+FgMappedArr<FgVect3F>
+FgFgmeshView::targetMorphVerts(size_t morphIdx) const
+{return fgmeshArr<FgVect3F>(*m_file,fgmeshMorph(*m_file,fgmeshHeader(*m_file).targMorphs,morphIdx).verts); }
+
+FgIndexedMorph
+FgFgmeshView::targetMorph(size_t morphIdx) const
+{
+    FgIndexedMorph      ret;
+    ret.name = targetMorphName(morphIdx);
+    ret.baseInds = targetMorphBaseInds(morphIdx).vec();
+    ret.verts = targetMorphVerts(morphIdx).vec();
+    return ret;
+}
+
+FgMarkedVerts
+FgFgmeshView::markedVerts() const
+{
+    FgMappedArr<FgmeshMarked>   recs = fgmeshArr<FgmeshMarked>(*m_file,fgmeshHeader(*m_file).markedVerts);
+    FgMarkedVerts               ret(recs.size());
+    for (size_t ii=0; ii<recs.size(); ++ii) {
+        ret[ii].idx = recs[ii].idx;
+        ret[ii].label = fgmeshStr(*m_file,recs[ii].label).m_str;
+    }
+    return ret;
+}
+
+Fg3dMesh
+FgFgmeshView::mesh(bool withMorphs) const
+{
+    Fg3dMesh        ret;
+    ret.verts = verts().vec();
+    ret.uvs = uvs().vec();
+    ret.surfaces.resize(numSurfaces());
+    for (size_t ss=0; ss<ret.surfaces.size(); ++ss)
+        ret.surfaces[ss] = surface(ss);
+    if (withMorphs) {
+        ret.deltaMorphs.resize(numDeltaMorphs());
+        for (size_t ii=0; ii<ret.deltaMorphs.size(); ++ii)
+            ret.deltaMorphs[ii] = deltaMorph(ii);
+        ret.targetMorphs.resize(numTargetMorphs());
+        for (size_t ii=0; ii<ret.targetMorphs.size(); ++ii)
+            ret.targetMorphs[ii] = targetMorph(ii);
+    }
+    ret.markedVerts = markedVerts();
+    return ret;
+}
 
 void
 fgSaveFgmeshTest(const FgArgs & args)
@@ -51,3 +561,101 @@ fgSaveFgmeshTest(const FgArgs & args)
     fgSaveFgmesh("Mouth.tri",fgLoadTri(fgDataDir()+"base/Mouth.tri"));
     fgViewMesh(fgLoadFgmesh("Mouth.tri"));
 }
+
+static
+void
+checkSameMesh(const Fg3dMesh & lhs,const Fg3dMesh & rhs)
+{
+    FGASSERT(lhs.verts == rhs.verts);
+    FGASSERT(lhs.uvs == rhs.uvs);
+    FGASSERT(lhs.surfaces.size() == rhs.surfaces.size());
+    for (size_t ss=0; ss<lhs.surfaces.size(); ++ss) {
+        const Fg3dSurface   &l = lhs.surfaces[ss],
+                            &r = rhs.surfaces[ss];
+        FGASSERT(l.name == r.name);
+        FGASSERT(l.tris.vertInds == r.tris.vertInds);
+        FGASSERT(l.tris.uvInds == r.tris.uvInds);
+        FGASSERT(l.quads.vertInds == r.quads.vertInds);
+        FGASSERT(l.quads.uvInds == r.quads.uvInds);
+        FGASSERT(l.surfPoints.size() == r.surfPoints.size());
+        for (size_t ii=0; ii<l.surfPoints.size(); ++ii) {
+            FGASSERT(l.surfPoints[ii].triEquivIdx == r.surfPoints[ii].triEquivIdx);
+            FGASSERT(l.surfPoints[ii].weights == r.surfPoints[ii].weights);
+            FGASSERT(l.surfPoints[ii].label == r.surfPoints[ii].label);
+        }
+    }
+    FGASSERT(lhs.deltaMorphs.size() == rhs.deltaMorphs.size());
+    for (size_t ii=0; ii<lhs.deltaMorphs.size(); ++ii) {
+        FGASSERT(lhs.deltaMorphs[ii].name == rhs.deltaMorphs[ii].name);
+        FGASSERT(lhs.deltaMorphs[ii].verts == rhs.deltaMorphs[ii].verts);
+    }
+    FGASSERT(lhs.targetMorphs.size() == rhs.targetMorphs.size());
+    for (size_t ii=0; ii<lhs.targetMorphs.size(); ++ii) {
+        FGASSERT(lhs.targetMorphs[ii].name == rhs.targetMorphs[ii].name);
+        FGASSERT(lhs.targetMorphs[ii] == rhs.targetMorphs[ii]);
+    }
+    FGASSERT(lhs.markedVerts.size() == rhs.markedVerts.size());
+    for (size_t ii=0; ii<lhs.markedVerts.size(); ++ii) {
+        FGASSERT(lhs.markedVerts[ii].idx == rhs.markedVerts[ii].idx);
+        FGASSERT(lhs.markedVerts[ii].label == rhs.markedVerts[ii].label);
+    }
+}
+
+void
+fgLoadFgmeshTest(const FgArgs & args)
+{
+    FGTESTDIR;
+    Fg3dMesh            mesh = fgLoadTri(fgDataDir()+"base/Mouth.tri");
+    FGASSERT(!mesh.deltaMorphs.empty() && !mesh.targetMorphs.empty());
+    mesh.surfaces[0].surfPoints.push_back(FgSurfPoint(3,FgVect3F(0.2f,0.3f,0.5f)));
+    mesh.surfaces[0].surfPoints.back().label = "point";
+    mesh.markedVerts.push_back(FgMarkedVert(7,"marked"));
+    // Version 1 is the default:
+    fgSaveFgmesh("mesh1.fgmesh",mesh);
+    {
+        FgIfstream          ifs("mesh1.fgmesh");
+        FGASSERT(fgReadpT<string>(ifs) == fgmeshTag1);
+    }
+    checkSameMesh(fgLoadFgmesh("mesh1.fgmesh"),mesh);
+    FGASSERT(fgFgmeshVersion("mesh1.fgmesh") == 1);
+    // Version 2:
+    fgSaveFgmesh("mesh2.fgmesh",mesh,2);
+    FGASSERT(fgFgmeshVersion("mesh2.fgmesh") == 2);
+    checkSameMesh(fgLoadFgmesh("mesh2.fgmesh"),mesh);
+    FgFgmeshView        view("mesh2.fgmesh");
+    FGASSERT(view.verts().vec() == mesh.verts);
+    FGASSERT(view.mesh(false).deltaMorphs.empty());
+    // Names can be repeated in which case the first is found:
+    for (size_t ii=0; ii<mesh.deltaMorphs.size(); ++ii) {
+        size_t              idx = view.deltaMorphIdx(mesh.deltaMorphs[ii].name);
+        FGASSERT(idx <= ii);
+        FGASSERT(view.deltaMorphName(idx) == mesh.deltaMorphs[ii].name);
+        FGASSERT(view.deltaMorphVerts(ii).vec() == mesh.deltaMorphs[ii].verts);
+    }
+    for (size_t ii=0; ii<mesh.targetMorphs.size(); ++ii) {
+        size_t              idx = view.targetMorphIdx(mesh.targetMorphs[ii].name);
+        FGASSERT(idx <= ii);
+        FGASSERT(view.targetMorphName(idx) == mesh.targetMorphs[ii].name);
+        FGASSERT(view.targetMorph(ii) == mesh.targetMorphs[ii]);
+    }
+    FGASSERT(view.deltaMorphIdx("no such morph") == view.numDeltaMorphs());
+    // Version 1 files are not valid as views:
+    bool                threw = false;
+    try {FgFgmeshView("mesh1.fgmesh"); }
+    catch (const FgException &) {threw = true; }
+    FGASSERT(threw);
+    // Out of range indices are rejected on open:
+    Fg3dMesh            bad = mesh;
+    bad.surfaces[0].tris.vertInds.push_back(FgVect3UI(0,1,uint(mesh.verts.size())));
+    if (!bad.surfaces[0].tris.uvInds.empty())
+        bad.surfaces[0].tris.uvInds.push_back(FgVect3UI(0));
+    fgSaveFgmesh("bad.fgmesh",bad,2);
+    fgSaveTri("mesh.tri",mesh);
+    FGASSERT(fgFgmeshVersion("mesh.tri") == 0);
+    threw = false;
+    try {FgFgmeshView("bad.fgmesh"); }
+    catch (const FgException &) {threw = true; }
+    FGASSERT(threw);
+}
+
+// */
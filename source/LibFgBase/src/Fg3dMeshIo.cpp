@@ -114,7 +114,7 @@ fgMeshExportFormatsDescriptions()
 
 std::string
 fgMeshSaveFormatsString()
-{return string("(tri | [w]obj | wrl | fbx | stl | lwo | ma | xsi | 3ds | ply)"); }
+{return string("(tri | [w]obj | wrl | fbx | stl | lwo | ma | xsi | 3ds | ply | fgmesh)"); }
 
 const vector<string> &
 fgMeshExportFormatsWithMorphs()
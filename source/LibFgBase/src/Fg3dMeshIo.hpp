@@ -55,14 +55,149 @@ fgMeshExportFormatsWithMorphs();
 std::string
 fgMeshSaveFormatsString();
 
-// FaceGen mesh format load / save:
+// FaceGen mesh format load / save. Both version 1 (stream serialized) and version 2 (memory
+// mappable, see FgFgmeshView) files can be loaded. Files are saved in version 1 format unless
+// 'version' is 2, since version 2 files cannot be read by earlier software:
 
 Fg3dMesh
 fgLoadFgmesh(const FgString & fname);
 void
-fgSaveFgmesh(const FgString & fname,const Fg3dMesh & mesh);
+fgSaveFgmesh(const FgString & fname,const Fg3dMesh & mesh,uint version=1);
 void
-fgSaveFgmesh(const FgString & fname,const Fg3dMeshes & meshes);
+fgSaveFgmesh(const FgString & fname,const Fg3dMeshes & meshes,uint version=1);
+// Returns the version of an existing FGMESH file, or 0 if it is not one:
+uint
+fgFgmeshVersion(const FgString & fname);
+
+class   FgFileMap;
+
+// Read-only view of an array stored within a memory mapped file:
+template<class T>
+struct  FgMappedArr
+{
+    const T *       ptr;
+    size_t          num;
+
+    FgMappedArr() : ptr(NULL), num(0) {}
+    FgMappedArr(const T * p,size_t n) : ptr(p), num(n) {}
+
+    size_t
+    size() const
+    {return num; }
+
+    bool
+    empty() const
+    {return (num == 0); }
+
+    const T &
+    operator[](size_t idx) const
+    {FGASSERT_FAST(idx < num); return ptr[idx]; }
+
+    const T *
+    begin() const
+    {return ptr; }
+
+    const T *
+    end() const
+    {return ptr + num; }
+
+    vector<T>
+    vec() const
+    {return vector<T>(ptr,ptr+num); }
+};
+
+// FGMESH version 2 file memory mapped and accessed in place. All array data is stored
+// little-endian, 16-byte aligned and located by offset, so the array accessors below return
+// views directly into the mapping without any parsing or allocation. These are valid only for
+// the lifetime of the FgFgmeshView object. Morphs are only read when accessed, so eg. a mesh
+// with hundreds of morphs can be opened instantly and just the required morphs extracted.
+// All offsets, sizes and indices are validated on construction. Little-endian platforms only:
+class   FgFgmeshView
+{
+public:
+    // Throws if 'fname' is not a valid version 2 FGMESH file:
+    explicit
+    FgFgmeshView(const FgString & fname);
+
+    // As above for a file which has already been mapped. 'fname' is used for error messages:
+    FgFgmeshView(boost::shared_ptr<FgFileMap> file,const FgString & fname);
+
+    FgMappedArr<FgVect3F>
+    verts() const;
+
+    FgMappedArr<FgVect2F>
+    uvs() const;
+
+    size_t
+    numSurfaces() const;
+
+    FgString
+    surfaceName(size_t surfIdx) const;
+
+    FgMappedArr<FgVect3UI>
+    triVertInds(size_t surfIdx) const;
+
+    FgMappedArr<FgVect3UI>
+    triUvInds(size_t surfIdx) const;
+
+    FgMappedArr<FgVect4UI>
+    quadVertInds(size_t surfIdx) const;
+
+    FgMappedArr<FgVect4UI>
+    quadUvInds(size_t surfIdx) const;
+
+    // Copy of the full surface including surface points:
+    Fg3dSurface
+    surface(size_t surfIdx) const;
+
+    size_t
+    numDeltaMorphs() const;
+
+    FgString
+    deltaMorphName(size_t morphIdx) const;
+
+    // Returns the first match, or numDeltaMorphs() if not found:
+    size_t
+    deltaMorphIdx(const FgString & name) const;
+
+    FgMappedArr<FgVect3F>
+    deltaMorphVerts(size_t morphIdx) const;     // 1-1 with base verts
+
+    FgMorph
+    deltaMorph(size_t morphIdx) const;
+
+    size_t
+    numTargetMorphs() const;
+
+    FgString
+    targetMorphName(size_t morphIdx) const;
+
+    // Returns the first match, or numTargetMorphs() if not found:
+    size_t
+    targetMorphIdx(const FgString & name) const;
+
+    FgMappedArr<uint>
+    targetMorphBaseInds(size_t morphIdx) const;
+
+    FgMappedArr<FgVect3F>
+    targetMorphVerts(size_t morphIdx) const;    // 1-1 with above
+
+    FgIndexedMorph
+    targetMorph(size_t morphIdx) const;
+
+    FgMarkedVerts
+    markedVerts() const;
+
+    // Copy of the whole mesh, optionally without morphs:
+    Fg3dMesh
+    mesh(bool withMorphs=true) const;
+
+private:
+    boost::shared_ptr<FgFileMap>    m_file;
+
+    void
+    validate(const FgString & fname) const;
+};
 
 // FaceGen legacy mesh format load / save:
 
@@ -72,6 +207,9 @@ Fg3dMesh
 fgLoadTri(const FgString & fname);
 Fg3dMesh
 fgLoadTri(const FgString & meshFile,const FgString & texFile);
+// Loads the files in parallel:
+vector<Fg3dMesh>
+fgLoadTris(const FgStrings & fnames);
 // Merges all surfaces:
 void
 fgSaveTri(const FgString & fname,const Fg3dMesh & mesh);
@@ -18,6 +18,7 @@
 #include "Fg3dNormals.hpp"
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
+#include "FgBinaryWriter.hpp"
 
 using namespace std;
 
@@ -90,7 +91,7 @@ struct LwoTextureInfoS
 //****************************************************************************
 // Local functions
 //****************************************************************************
-static bool saveLwoLwsFile(const FgString &fname,
+static void saveLwoLwsFile(const FgString &fname,
                 const FffMultiObjectC &model,
                 const vector<FffMultiObjectC> *targets,
                 const vector<string>          *names);
@@ -98,80 +99,80 @@ static bool saveLwoLwsFile(const FgString &fname,
 static bool searchVtxTexMap(unsigned long vtxId, FgVect2F tex,
                 const vector<unsigned long> &vtxList,
                 const vector<FgVect2F> &texCoord);
-static bool errorFcloseExit(FILE *fptr, const FgString &fname);
-static FgVect3F toLwoCoord(FgVect3F vec) { vec[2]=-vec[2]; return vec; }
-static bool swap4BytesWrite(FILE *fptr, const void *ptr);
-static bool swap2BytesWrite(FILE *fptr, const void *ptr);
-static int  writeVx(FILE *fptr, unsigned long idx);
-static bool writeVec12(FILE *fptr, const FgVect3F &vect);
-static bool writeVec8(FILE *fptr, const FgVect2F &vect);
-static bool padByte(FILE *fptr)
-            { char byte=0; return (fwrite(&byte,1,1,fptr) == 1); }
-static bool writeId(FILE *fptr, unsigned long id)
-            { return swap4BytesWrite(fptr,&id); }
-static bool writeChunkHdr(FILE *, unsigned long id, unsigned long sz);
-static bool writeSubChunkHdr(FILE *,unsigned long id,unsigned short sz);
-static bool updateChunkSize(FILE *fptr, unsigned long sz, long pos);
-static bool updateSubChunkSize(FILE *fptr, unsigned short sz, long pos);
-
-static bool writeTagsChunk(FILE *fptr, unsigned long &chunkSize,
+static void swap4BytesWrite(FgBinaryWriter &out, const void *ptr);
+static void swap2BytesWrite(FgBinaryWriter &out, const void *ptr);
+static int  writeVx(FgBinaryWriter &out, unsigned long idx);
+static void writeVec12(FgBinaryWriter &out, const FgVect3F &vect);
+static void writeLwoCoord(FgBinaryWriter &out, const FgVect3F &vect);
+static void writeVec8(FgBinaryWriter &out, const FgVect2F &vect);
+static void padByte(FgBinaryWriter &out)
+            { out.val(char(0)); }
+static void writeStr(FgBinaryWriter &out, const string &str, size_t ln);
+static void writeId(FgBinaryWriter &out, unsigned long id)
+            { swap4BytesWrite(out,&id); }
+static void writeChunkHdr(FgBinaryWriter &, unsigned long id, unsigned long sz);
+static void writeSubChunkHdr(FgBinaryWriter &,unsigned long id,unsigned short sz);
+static void updateChunkSize(FgBinaryWriter &out, unsigned long sz, long pos);
+static void updateSubChunkSize(FgBinaryWriter &out, unsigned short sz, long pos);
+
+static void writeTagsChunk(FgBinaryWriter &out, unsigned long &chunkSize,
                 const FffMultiObjectC &model,
                 vector<string> &tagNameList);
-static bool writeLayrChunk(FILE *fptr, unsigned long &chunkSize,
+static void writeLayrChunk(FgBinaryWriter &out, unsigned long &chunkSize,
                 unsigned short num, string name,
                 FgVect3F pivot);
-static bool writePntsChunks(FILE *fptr, unsigned long &chunkSize,
+static void writePntsChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 const FffMultiObjectC &model, int objIdx);
-static bool writeBboxChunks(FILE *fptr, unsigned long &chunkSize,
+static void writeBboxChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 const FffMultiObjectC &model, 
                 FgVect3F &minVec, FgVect3F &maxVec, int objIdx);
-static bool writeVmapTxuvChunks(FILE *fptr, unsigned long &chunkSize,
+static void writeVmapTxuvChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 vector<unsigned long> &tmpVtxList,
                 vector<FgVect2F> &tmpTexCoord,
                 const string &uvTexName,
                 const FffMultiObjectC &model, int objIdx, bool singleLayer);
-static bool writeVmapMorfChunks(FILE *fptr, unsigned long &chunkSize,
+static void writeVmapMorfChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 const FffMultiObjectC &target, const string &targetName,
                 const FffMultiObjectC &model, int objIndex);
-static bool writePolsChunks(FILE *fptr, unsigned long &chunkSize,
+static void writePolsChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 const FffMultiObjectC &model, int objIndex);
-static bool writePtagChunks(FILE *fptr, unsigned long &chunkSize,
+static void writePtagChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 const FffMultiObjectC &model, int objIndex);
-static bool writeVmadChunks(FILE *fptr, unsigned long &chunkSize,
+static void writeVmadChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 const vector<unsigned long> &tmpVtxList,
                 const vector<FgVect2F> &tmpTexCoord,
                 const string &uvTexName,
                 const FffMultiObjectC &model, int objIdx, bool singleLayer);
-static bool writeClipChunks(FILE *fptr, unsigned long &chunkSize,
+static void writeClipChunks(FgBinaryWriter &out, unsigned long &chunkSize,
                 vector<unsigned long> &clipIdList, 
                 const FffMultiObjectC &model);
-static bool writeSurfChunk(FILE *fptr, unsigned long &chunkSize,
+static void writeSurfChunk(FgBinaryWriter &out, unsigned long &chunkSize,
                 const string &tagName, const string &sourceName,
                 const string &uvTexName, unsigned long clipIdx);
-static bool writeSurfColrSubChunk(FILE *fptr, unsigned short &chunkSize,
+static void writeSurfColrSubChunk(FgBinaryWriter &out, unsigned short &chunkSize,
                 float red, float green, float blue,
                 unsigned long envelope);
-static bool writeSurfSideSubChunk(FILE *fptr, unsigned short &chunkSize,
+static void writeSurfSideSubChunk(FgBinaryWriter &out, unsigned short &chunkSize,
                 unsigned short val);
-static bool writeSurfSmanSubChunk(FILE *fptr, unsigned short &chunkSize,
+static void writeSurfSmanSubChunk(FgBinaryWriter &out, unsigned short &chunkSize,
                 float angle);
-static bool writeSurfBlokSubChunk(FILE *fptr, unsigned short &chunkSize,
+static void writeSurfBlokSubChunk(FgBinaryWriter &out, unsigned short &chunkSize,
                 const string &uvTexName, unsigned long clipIdx);
-static bool writeSurfBlokImapSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokTmapSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokProjSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokAxisSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokImagSubChunk(FILE *fptr, unsigned short &chunkSize,
+static void writeSurfBlokImapSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokTmapSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokProjSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokAxisSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokImagSubChunk(FgBinaryWriter &out, unsigned short &chunkSize,
                 unsigned long clipIdx);
-static bool writeSurfBlokWrapSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokWrpwSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokWrphSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokVmapSubChunk(FILE *fptr, unsigned short &chunkSize,
+static void writeSurfBlokWrapSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokWrpwSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokWrphSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokVmapSubChunk(FgBinaryWriter &out, unsigned short &chunkSize,
                 const string &uvTexName);
-static bool writeSurfBlokAastSubChunk(FILE *fptr, unsigned short &chunkSize);
-static bool writeSurfBlokPixbSubChunk(FILE *fptr, unsigned short &chunkSize);
+static void writeSurfBlokAastSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
+static void writeSurfBlokPixbSubChunk(FgBinaryWriter &out, unsigned short &chunkSize);
 
-static bool writeLwsFile(const FgString &lwsName, const FgString &lwoName,
+static void writeLwsFile(const FgString &lwsName, const FgString &lwoName,
                 FgVect3F minVect, FgVect3F maxVect,
                 unsigned long numLayers, unsigned long numMorphs, 
                 const vector<string> *morphNames);
@@ -180,7 +181,7 @@ static bool writeLwsFile(const FgString &lwsName, const FgString &lwoName,
 //****************************************************************************
 //                              fffSaveLwoLwsFile
 //****************************************************************************
-static bool    fffSaveLwoLwsFile(
+static void    fffSaveLwoLwsFile(
     const FgString            &fname,
     const FffMultiObjectC   &model)
 {
@@ -197,7 +198,7 @@ static string translateName(string input)
 	return out;
 }
 
-static bool    fffSaveLwoLwsFile(
+static void    fffSaveLwoLwsFile(
 
     const FgString                    &fname,
     const FffMultiObjectC           &model,
@@ -216,7 +217,7 @@ static bool    fffSaveLwoLwsFile(
 //****************************************************************************
 //                              saveLwoLwsFile
 //****************************************************************************
-static bool saveLwoLwsFile(
+static void saveLwoLwsFile(
     const FgString                  &fname,
     const FffMultiObjectC           &model,
     const vector<FffMultiObjectC>   *targets,       // Only use the vertices.
@@ -226,25 +227,15 @@ static bool saveLwoLwsFile(
     FgString        lwsName = path.dirBase() + ".lws";
     FgString        lwoName = path.base + ".lwo";
     FgString        fullLwoName = path.dirBase() + ".lwo";
-#ifdef _WIN32
-    FILE *fptr = _wfopen(fullLwoName.as_wstring().c_str(),L"wb,ccs=UNICODE");
-#else
-    FILE *fptr = fopen(fullLwoName.m_str.c_str(),"wb");
-#endif
-    if (!fptr) {
-        fgThrow("Unable to write to LWO file",fullLwoName);
-        return false;
-    }
+    FgBinaryWriter out(true);       // LWO is big-endian
 
     // Write the FORM file chunk header
-    long fileChunkStartPos = ftell(fptr);
+    long fileChunkStartPos = long(out.pos());
     unsigned long fileChunkSize = 0;
-    if (!writeChunkHdr(fptr,ID_FORM,fileChunkSize))
-        return errorFcloseExit(fptr,fname);
+    writeChunkHdr(out,ID_FORM,fileChunkSize);
 
     // Write the LWO2 file chunk header
-    if (!writeId(fptr,ID_LWO2))
-        return errorFcloseExit(fptr,fname);
+    writeId(out,ID_LWO2);
     fileChunkSize += 4;
 
     //
@@ -254,30 +245,26 @@ static bool saveLwoLwsFile(
     // TAGS chunk
     unsigned long tagChunkSize = 0;
     vector<string> tagNameList;
-    if (!writeTagsChunk(fptr,tagChunkSize,model,tagNameList))
-        return errorFcloseExit(fptr,fname);
+    writeTagsChunk(out,tagChunkSize,model,tagNameList);
     fileChunkSize += tagChunkSize;
 
     // LAYR chunk
     string layerName = string("Layer");
     FgVect3F pivot(0.0f,0.0f,0.0f);
     unsigned long layrChunkSize = 0;
-    if (!writeLayrChunk(fptr,layrChunkSize,0,layerName,pivot))
-        return errorFcloseExit(fptr,fname);
+    writeLayrChunk(out,layrChunkSize,0,layerName,pivot);
     fileChunkSize += layrChunkSize;
 
     // PNTS chunk
     unsigned long pntsChunkSize = 0;
-    if (!writePntsChunks(fptr,pntsChunkSize,model,-1))
-        return errorFcloseExit(fptr,fname);
+    writePntsChunks(out,pntsChunkSize,model,-1);
     fileChunkSize += pntsChunkSize;
 
     // BBOX chunk
     FgVect3F minVect(0.0f,0.0f,0.0f);
     FgVect3F maxVect(0.0f,0.0f,0.0f);
     unsigned long bboxChunkSize = 0;
-    if (!writeBboxChunks(fptr,bboxChunkSize,model,minVect,maxVect,-1))
-        return errorFcloseExit(fptr,fname);
+    writeBboxChunks(out,bboxChunkSize,model,minVect,maxVect,-1);
     fileChunkSize += bboxChunkSize;
 
     // VMAP (MORF) chunk
@@ -288,9 +275,8 @@ static bool saveLwoLwsFile(
             for (unsigned long ii=0; ii<targets->size(); ++ii)
             {
                 unsigned long morfChunkSize = 0;
-                if (!writeVmapMorfChunks(fptr,morfChunkSize,
-                        (*targets)[ii],(*names)[ii],model,-1))
-                    return errorFcloseExit(fptr,fname);
+                writeVmapMorfChunks(out,morfChunkSize,
+                        (*targets)[ii],(*names)[ii],model,-1);
                 fileChunkSize += morfChunkSize;
             }
         }
@@ -310,12 +296,11 @@ static bool saveLwoLwsFile(
         texInfo.push_back(LwoTextureInfoS());
 
         unsigned long txuvChunkSize = 0;
-        if (!writeVmapTxuvChunks(fptr,txuvChunkSize,
+        writeVmapTxuvChunks(out,txuvChunkSize,
                 texInfo[obj].texVtxList,
                 texInfo[obj].texTxtCoord,
                 uvTexName,model,obj,
-                true))
-            return errorFcloseExit(fptr,fname);
+                true);
         fileChunkSize += txuvChunkSize;
         if (texInfo[obj].texVtxList.size() == 0)
             uvTexName = string("");
@@ -325,60 +310,53 @@ static bool saveLwoLwsFile(
 
     // POLS chunk
     unsigned long polsChunkSize = 0;
-    if (!writePolsChunks(fptr,polsChunkSize,model,-1))
-        return errorFcloseExit(fptr,fname);
+    writePolsChunks(out,polsChunkSize,model,-1);
     fileChunkSize += polsChunkSize;
 
     // PTAG chunk (specify which facet belongs to which surface)
     unsigned long ptagChunkSize = 0;
-    if (!writePtagChunks(fptr,ptagChunkSize,model,-1))
-        return errorFcloseExit(fptr,fname);
+    writePtagChunks(out,ptagChunkSize,model,-1);
     fileChunkSize += ptagChunkSize;
 
     // VMAD chunks (for per-facet textures)
     for (obj=0; obj<model.numObjs(); ++obj)
     {
         unsigned long vmadChunkSize = 0;
-        if (!writeVmadChunks(fptr,vmadChunkSize,
+        writeVmadChunks(out,vmadChunkSize,
                 texInfo[obj].texVtxList,
                 texInfo[obj].texTxtCoord,
                 texInfo[obj].uvTexName,
                 model,obj,
-                true))
-            return errorFcloseExit(fptr,fname);
+                true);
         fileChunkSize += vmadChunkSize;
     }
 
     // CLIP chunk and STIL sub-chunk (Texture names)
     vector<unsigned long> clipIdList;
     unsigned long clipChunkSize = 0;
-    if (!writeClipChunks(fptr,clipChunkSize,clipIdList,model))
-        return errorFcloseExit(fptr,fname);
+    writeClipChunks(out,clipChunkSize,clipIdList,model);
     fileChunkSize += clipChunkSize;
 
     // SURF chunks
     for (unsigned long ii=0; ii<model.numObjs(); ++ii)
     {
         unsigned long surfChunkSize = 0;
-        if (!writeSurfChunk(fptr, surfChunkSize, 
+        writeSurfChunk(out, surfChunkSize, 
                 tagNameList[ii], "",
                 texInfo[ii].uvTexName, 
-                clipIdList[ii]))
-            return errorFcloseExit(fptr,fname);
+                clipIdList[ii]);
         fileChunkSize += surfChunkSize;
     }
 
     // Now update the file chunk size info
-    if (!updateChunkSize(fptr,fileChunkSize,fileChunkStartPos+4))
-        return errorFcloseExit(fptr,fname);
+    updateChunkSize(out,fileChunkSize,fileChunkStartPos+4);
 
     if (fileChunkSize % 2 != 0)
     {
-        if (!padByte(fptr))
-            return errorFcloseExit(fptr,fname);
+        padByte(out);
     }
 
-    fclose(fptr);
+    out.save(fullLwoName);
 
     // If morph data exists, save a LWS file as well.
     if (names)
@@ -391,8 +369,6 @@ static bool saveLwoLwsFile(
                      1,
                      0,0);
     }
-
-    return true;
 }
 
 
@@ -426,180 +402,152 @@ static bool searchVtxTexMap(
 
 
 //****************************************************************************
-//                              errorFcloseExit
+//                              swap4BytesWrite
 //****************************************************************************
-static bool errorFcloseExit(FILE *fptr, const FgString &)
+static void swap4BytesWrite(FgBinaryWriter &out, const void *ptr)
 {
-    fclose(fptr);
-    return false;
+    uint32 val;
+    memcpy(&val,ptr,4);
+    out.val(val);
 }
 
 
 //****************************************************************************
-//                              swap4BytesWrite
+//                              swap2BytesWrite
 //****************************************************************************
-static bool swap4BytesWrite(FILE *fptr, const void *ptr)
+static void swap2BytesWrite(FgBinaryWriter &out, const void *ptr)
 {
-    char *pp = (char*)ptr;
-
-    if (fwrite(&pp[3],1,1,fptr) != 1)
-        return false;
-    if (fwrite(&pp[2],1,1,fptr) != 1)
-        return false;
-    if (fwrite(&pp[1],1,1,fptr) != 1)
-        return false;
-    if (fwrite(&pp[0],1,1,fptr) != 1)
-        return false;
-
-    return true;
+    uint16 val;
+    memcpy(&val,ptr,2);
+    out.val(val);
 }
 
 
 //****************************************************************************
-//                              swap2BytesWrite
+//                              writeStr
 //****************************************************************************
-static bool swap2BytesWrite(FILE *fptr, const void *ptr)
+// Writes 'ln' bytes of 'str' including its null terminator, zero padded if 'ln' is longer
+static void writeStr(FgBinaryWriter &out, const string &str, size_t ln)
 {
-    char *pp = (char*)ptr;
-
-    if (fwrite(&pp[1],1,1,fptr) != 1)
-        return false;
-    if (fwrite(&pp[0],1,1,fptr) != 1)
-        return false;
-
-    return true;
+    size_t num = std::min(ln,str.length()+1);
+    out.write(str.c_str(),num);
+    for (; num<ln; ++num)
+        out.val(char(0));
 }
 
 
 //****************************************************************************
 //                                  writeVx
 //****************************************************************************
-static int  writeVx(FILE *fptr, unsigned long idx)
+static int  writeVx(FgBinaryWriter &out, unsigned long idx)
 {
     if (idx < 0xFF00)
     {
         unsigned short idx2 = (unsigned short) idx;
-        if (!swap2BytesWrite(fptr,&idx2))
-            return 0;
-        else
-            return 2;
+        swap2BytesWrite(out,&idx2);
+        return 2;
     }
     else
     {
         unsigned long idx2 = idx | 0xFF000000;
-        if (!swap4BytesWrite(fptr,&idx2))
-            return 0;
-        else
-            return 4;
+        swap4BytesWrite(out,&idx2);
+        return 4;
     }
-
-    return 0;
 }
 
 
 //****************************************************************************
 //                              writeVec12
 //****************************************************************************
-static bool writeVec12(FILE *fptr, const FgVect3F &vect)
+static void writeVec12(FgBinaryWriter &out, const FgVect3F &vect)
+{
+    swap4BytesWrite(out,&vect[0]);
+    swap4BytesWrite(out,&vect[1]);
+    swap4BytesWrite(out,&vect[2]);
+}
+
+
+//****************************************************************************
+//                              writeLwoCoord
+//****************************************************************************
+// Lightwave uses a left-handed coordinate system so Z is negated. This is done by flipping
+// the sign bit of the written value, so zero is always written as -0.0 as with IEEE negation.
+// Negating the float instead leaves it to the compiler whether constant zeros become -0.0
+// or +0.0 (eg. -ffast-math), so the output would not be deterministic:
+static void writeLwoCoord(FgBinaryWriter &out, const FgVect3F &vect)
 {
-    if (!swap4BytesWrite(fptr,&vect[0]))
-        return false;
-    if (!swap4BytesWrite(fptr,&vect[1]))
-        return false;
-    return swap4BytesWrite(fptr,&vect[2]);
+    uint32 zz;
+    memcpy(&zz,&vect[2],4);
+    swap4BytesWrite(out,&vect[0]);
+    swap4BytesWrite(out,&vect[1]);
+    out.val(uint32(zz ^ 0x80000000U));
 }
 
 
 //****************************************************************************
 //                              writeVec8
 //****************************************************************************
-static bool writeVec8(FILE *fptr, const FgVect2F &vect)
+static void writeVec8(FgBinaryWriter &out, const FgVect2F &vect)
 {
-    if (!swap4BytesWrite(fptr,&vect[0]))
-        return false;
-    return swap4BytesWrite(fptr,&vect[1]);
+    swap4BytesWrite(out,&vect[0]);
+    swap4BytesWrite(out,&vect[1]);
 }
 
 
 //****************************************************************************
 //                              writeChunkHdr
 //****************************************************************************
-static bool writeChunkHdr(FILE *fptr, unsigned long id, unsigned long sz)
+static void writeChunkHdr(FgBinaryWriter &out, unsigned long id, unsigned long sz)
 {
-    if (!writeId(fptr,id))
-        return false;
+    writeId(out,id);
 
-    return swap4BytesWrite(fptr,&sz);
+    swap4BytesWrite(out,&sz);
 }
 
 
 //****************************************************************************
 //                              writeSubChunkHdr
 //****************************************************************************
-static bool writeSubChunkHdr(FILE *fptr, unsigned long id, unsigned short sz)
+static void writeSubChunkHdr(FgBinaryWriter &out, unsigned long id, unsigned short sz)
 {
-    if (!writeId(fptr,id))
-        return false;
+    writeId(out,id);
 
-    return swap2BytesWrite(fptr,&sz);
+    swap2BytesWrite(out,&sz);
 }
 
 
 //****************************************************************************
 //                              updateChunkSize
 //****************************************************************************
-static bool updateChunkSize(FILE *fptr, unsigned long sz, long pos)
+static void updateChunkSize(FgBinaryWriter &out, unsigned long sz, long pos)
 {
-    long currPos = ftell(fptr);
-
-    if (fseek(fptr,pos,SEEK_SET))
-        return false;
-
-    if (!swap4BytesWrite(fptr,&sz))
-        return false;
-
-    if (fseek(fptr,currPos,SEEK_SET))
-        return false;
-
-    return true;
+    out.patch(size_t(pos),uint32(sz));
 }
 
 
 //****************************************************************************
 //                              updateSubChunkSize
 //****************************************************************************
-static bool updateSubChunkSize(FILE *fptr, unsigned short sz, long pos)
+static void updateSubChunkSize(FgBinaryWriter &out, unsigned short sz, long pos)
 {
-    long currPos = ftell(fptr);
-
-    if (fseek(fptr,pos,SEEK_SET))
-        return false;
-
-    if (!swap2BytesWrite(fptr,&sz))
-        return false;
-
-    if (fseek(fptr,currPos,SEEK_SET))
-        return false;
-
-    return true;
+    out.patch(size_t(pos),uint16(sz));
 }
 
 
 //****************************************************************************
 //                              writeTagsChunk
 //****************************************************************************
-static bool writeTagsChunk(
+static void writeTagsChunk(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     const FffMultiObjectC   &model,
     vector<string>          &tagNameList)
 {
     unsigned long localChunkSize=0;
-    long localChunkStart = ftell(fptr);
+    long localChunkStart = long(out.pos());
 
-    if (!writeChunkHdr(fptr,ID_TAGS,localChunkSize))
-        return false;
+    writeChunkHdr(out,ID_TAGS,localChunkSize);
      chunkSize += 8;
 
     unsigned long numObjs = model.numObjs();
@@ -614,26 +562,22 @@ static bool writeTagsChunk(
         unsigned long tagNameLn = uint(strlen(tagName.c_str()))+1;
         tagNameLn = (tagNameLn + 1) & ~0x00000001;      // even byte pad
 
-        if (fwrite(tagName.c_str(),1,tagNameLn,fptr) != tagNameLn)
-            return false;
+        writeStr(out,tagName,tagNameLn);
 
         localChunkSize += tagNameLn;
         chunkSize += tagNameLn;
     }
 
-    if (!updateChunkSize(fptr,localChunkSize,localChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,localChunkSize,localChunkStart+4);
 }
 
 
 //****************************************************************************
 //                              writeLayrChunk
 //****************************************************************************
-static bool writeLayrChunk(
+static void writeLayrChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned long   &chunkSize,
     unsigned short  num,
     string          name,
@@ -646,47 +590,38 @@ static bool writeLayrChunk(
     unsigned short flags = 0;
 
     // LAYR chunk
-    if (!writeChunkHdr(fptr,ID_LAYR,layrSize))
-        return false;
+    writeChunkHdr(out,ID_LAYR,layrSize);
     chunkSize += 8;
 
     // Layer number
-    if (!swap2BytesWrite(fptr,&num))
-        return false;
+    swap2BytesWrite(out,&num);
     chunkSize += 2;
 
     // flags
-    if (!swap2BytesWrite(fptr,&flags))
-        return false;
+    swap2BytesWrite(out,&flags);
     chunkSize += 2;
 
     // pivot
-    pivot = toLwoCoord(pivot);
-    if (!writeVec12(fptr,pivot))
-        return false;
+    writeLwoCoord(out,pivot);
     chunkSize += 12;
 
     // name
-    if (fwrite(name.c_str(),1,nameLn,fptr) != nameLn)
-        return false;
+    writeStr(out,name,nameLn);
     chunkSize += nameLn;
     if (nameLn % 2 != 0)
     {
-        if (!padByte(fptr))
-            return false;
+        padByte(out);
         chunkSize++;
     }
-
-    return true;
 }
 
 
 //****************************************************************************
 //                              writePntsChunk
 //****************************************************************************
-static bool writePntsChunks(
+static void writePntsChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     const FffMultiObjectC   &model,
     int                     objIdx)
@@ -708,8 +643,7 @@ static bool writePntsChunks(
     }
 
     // PNTS chunk
-    if (!writeChunkHdr(fptr,ID_PNTS,pntsSize))
-        return false;
+    writeChunkHdr(out,ID_PNTS,pntsSize);
     chunkSize += 8;
 
     // Now write the points
@@ -719,23 +653,19 @@ static bool writePntsChunks(
         for (unsigned long ii=0; ii<pts.size(); ++ii)
         {
             // Lightwave uses left-handed coordinate system!
-            FgVect3F pt = toLwoCoord(pts[ii]);
-            if (!writeVec12(fptr,pt))
-                return false;
+            writeLwoCoord(out,pts[ii]);
             chunkSize += 12;
         }
     }
-
-    return true;
 }
 
 
 //****************************************************************************
 //                              writeBboxChunks
 //****************************************************************************
-static bool writeBboxChunks(
+static void writeBboxChunks(
 
-    FILE                    *fptr, 
+    FgBinaryWriter          &out, 
     unsigned long           &chunkSize,
     const FffMultiObjectC   &model, 
     FgVect3F              &minPnt,
@@ -772,34 +702,27 @@ static bool writeBboxChunks(
         }
     }
 
-    if (!maxMinInitialized) return true;
+    if (!maxMinInitialized) return;
 
     // BBOX chunk
     unsigned long bboxSize = 24;
-    if (!writeChunkHdr(fptr,ID_BBOX,bboxSize))
-        return false;
+    writeChunkHdr(out,ID_BBOX,bboxSize);
     chunkSize += 8;
 
     // Write out the bounding box values
-    FgVect3F minVal = toLwoCoord(minPnt);
-    FgVect3F maxVal = toLwoCoord(maxPnt);
-    if (!writeVec12(fptr,minVal))
-        return false;
+    writeLwoCoord(out,minPnt);
     chunkSize += 12;
-    if (!writeVec12(fptr,maxVal))
-        return false;
+    writeLwoCoord(out,maxPnt);
     chunkSize += 12;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                              writeVmapTxuvChunk
 //****************************************************************************
-static bool writeVmapTxuvChunks(
+static void writeVmapTxuvChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     vector<unsigned long>   &tmpVtxList,
     vector<FgVect2F>      &tmpTxtCoord,
@@ -889,38 +812,33 @@ static bool writeVmapTxuvChunks(
 
     if (tmpTxtCoord.size() == 0)
     {
-        return true;
+        return;
     }
 
     // VMAP chunk
     unsigned long vmapSize = 0;
-    long vmapChunkStart = ftell(fptr);
+    long vmapChunkStart = long(out.pos());
     unsigned short dimension = 2;
 
-    if (!writeChunkHdr(fptr,ID_VMAP,vmapSize))
-        return false;
+    writeChunkHdr(out,ID_VMAP,vmapSize);
     chunkSize += 8;
 
     // TXUV type
-    if (!writeId(fptr,ID_TXUV))
-        return false;
+    writeId(out,ID_TXUV);
     chunkSize += 4;
     vmapSize += 4;
 
     // dimension
-    if (!swap2BytesWrite(fptr,&dimension))
-        return false;
+    swap2BytesWrite(out,&dimension);
     chunkSize += 2;
     vmapSize += 2;
 
     // name
     size_t  ln = strlen(uvTexName.c_str()) + 1;
-    if (fwrite(uvTexName.c_str(),1,ln,fptr) != ln)
-        return false;
+    writeStr(out,uvTexName,ln);
     if (ln % 2 != 0)
     {
-        if (!padByte(fptr))
-            return false;
+        padByte(out);
         ln++;
     }
     chunkSize += ulong(ln);
@@ -929,31 +847,26 @@ static bool writeVmapTxuvChunks(
     // texture coordinate data
     for (unsigned long ii=0; ii<tmpTxtCoord.size(); ++ii)
     {
-        int bytes = writeVx(fptr,tmpVtxList[ii]);
-        if (bytes == 0) return false;
+        int bytes = writeVx(out,tmpVtxList[ii]);
         chunkSize += bytes;
         vmapSize += bytes;
 
-        if (!writeVec8(fptr,tmpTxtCoord[ii]))
-            return false;
+        writeVec8(out,tmpTxtCoord[ii]);
         chunkSize += 8;
         vmapSize += 8;
     }
 
     // Update the local chunk size
-    if (!updateChunkSize(fptr,vmapSize,vmapChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,vmapSize,vmapChunkStart+4);
 }
 
 
 //****************************************************************************
 //                              writeVmapMorfChunk
 //****************************************************************************
-static bool writeVmapMorfChunks(
+static void writeVmapMorfChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     const FffMultiObjectC   &target,
     const string            &targetName,
@@ -962,7 +875,7 @@ static bool writeVmapMorfChunks(
 {
     chunkSize = 0;
 
-    if (target.numObjs() != model.numObjs()) return true;
+    if (target.numObjs() != model.numObjs()) return;
 
     unsigned long startObj = 0;
     unsigned long endObj = model.numObjs();
@@ -995,37 +908,32 @@ static bool writeVmapMorfChunks(
     }
 
     if (tmpMorfDelta.size() == 0)
-        return true;
+        return;
 
     // VMAP chunk
     unsigned long vmapSize = 0;
-    long vmapChunkStart = ftell(fptr);
+    long vmapChunkStart = long(out.pos());
     unsigned short dimension = 3;
 
-    if (!writeChunkHdr(fptr,ID_VMAP,vmapSize))
-        return false;
+    writeChunkHdr(out,ID_VMAP,vmapSize);
     chunkSize += 8;
 
     // MORF type
-    if (!writeId(fptr,ID_MORF))
-        return false;
+    writeId(out,ID_MORF);
     chunkSize += 4;
     vmapSize += 4;
 
     // dimension
-    if (!swap2BytesWrite(fptr,&dimension))
-        return false;
+    swap2BytesWrite(out,&dimension);
     chunkSize += 2;
     vmapSize += 2;
 
     // name
     size_t ln = strlen(targetName.c_str()) + 1;
-    if (fwrite(targetName.c_str(),1,ln,fptr) != ln)
-        return false;
+    writeStr(out,targetName,ln);
     if (ln % 2 != 0)
     {
-        if (!padByte(fptr))
-            return false;
+        padByte(out);
         ln++;
     }
     chunkSize += ulong(ln);
@@ -1034,33 +942,27 @@ static bool writeVmapMorfChunks(
     // texture coordinate data
     for (unsigned long ii=0; ii<tmpMorfDelta.size(); ++ii)
     {
-        int bytes = writeVx(fptr,tmpVtxList[ii]);
-        if (bytes == 0) return false;
+        int bytes = writeVx(out,tmpVtxList[ii]);
         chunkSize += bytes;
         vmapSize += bytes;
 
         // Lightwave uses left-handed coordinate system!
-        tmpMorfDelta[ii] = toLwoCoord(tmpMorfDelta[ii]);
-        if (!writeVec12(fptr,tmpMorfDelta[ii]))
-            return false;
+        writeLwoCoord(out,tmpMorfDelta[ii]);
         chunkSize += 12;
         vmapSize += 12;
     }
 
     // Update the local chunk size
-    if (!updateChunkSize(fptr,vmapSize,vmapChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,vmapSize,vmapChunkStart+4);
 }
 
 
 //****************************************************************************
 //                              writePolsChunk
 //****************************************************************************
-static bool writePolsChunks(
+static void writePolsChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     const FffMultiObjectC   &model,
     int                     objIdx)
@@ -1076,16 +978,14 @@ static bool writePolsChunks(
     }
 
     unsigned long polsSize = 0;
-    long polsChunkStart = ftell(fptr);
+    long polsChunkStart = long(out.pos());
 
     // POLS chunk
-    if (!writeChunkHdr(fptr,ID_POLS,polsSize))
-        return false;
+    writeChunkHdr(out,ID_POLS,polsSize);
     chunkSize += 8;
 
     // FACE type
-    if (!writeId(fptr,ID_FACE))
-        return false;
+    writeId(out,ID_FACE);
     chunkSize += 4;
     polsSize += 4;
 
@@ -1105,26 +1005,22 @@ static bool writePolsChunks(
         const vector<FgVect3UI> &triList = model.getTriList(obj);
         for (unsigned long tri=0; tri<triList.size(); ++tri)
         {
-            if (!swap2BytesWrite(fptr,&polySize))
-                return false;
+            swap2BytesWrite(out,&polySize);
             chunkSize += 2;
             polsSize += 2;
 
             vtx = triList[tri][2] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
 
             vtx = triList[tri][1] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
 
             vtx = triList[tri][0] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
         }
@@ -1133,32 +1029,27 @@ static bool writePolsChunks(
         const vector<FgVect4UI> &quadList = model.getQuadList(obj);
         for (unsigned long quad=0; quad<quadList.size(); ++quad)
         {
-            if (!swap2BytesWrite(fptr,&polySize))
-                return false;
+            swap2BytesWrite(out,&polySize);
             chunkSize += 2;
             polsSize += 2;
 
             vtx = quadList[quad][3] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
 
             vtx = quadList[quad][2] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
 
             vtx = quadList[quad][1] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
 
             vtx = quadList[quad][0] + vtxOffset;
-            bytes = writeVx(fptr,vtx);
-            if (bytes == 0) return false;
+            bytes = writeVx(out,vtx);
             chunkSize += bytes;
             polsSize += bytes;
         }
@@ -1167,19 +1058,16 @@ static bool writePolsChunks(
     }
 
     // Update the local chunk size
-    if (!updateChunkSize(fptr,polsSize,polsChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,polsSize,polsChunkStart+4);
 }
 
 
 //****************************************************************************
 //                              writePtagChunk
 //****************************************************************************
-static bool writePtagChunks(
+static void writePtagChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     const FffMultiObjectC   &model,
     int                     objIdx)
@@ -1195,16 +1083,14 @@ static bool writePtagChunks(
     }
 
     unsigned long ptagSize = 0;
-    long ptagChunkStart = ftell(fptr);
+    long ptagChunkStart = long(out.pos());
 
     // PTAG chunk
-    if (!writeChunkHdr(fptr,ID_PTAG,ptagSize))
-        return false;
+    writeChunkHdr(out,ID_PTAG,ptagSize);
     chunkSize += 8;
 
     // SURF type
-    if (!writeId(fptr,ID_SURF))
-        return false;
+    writeId(out,ID_SURF);
     chunkSize += 4;
     ptagSize += 4;
 
@@ -1217,13 +1103,11 @@ static bool writePtagChunks(
         {
             unsigned long poly = tri + polyOffset;
 
-            int bytes = writeVx(fptr,poly);
-            if (bytes == 0) return false;
+            int bytes = writeVx(out,poly);
             chunkSize += bytes;
             ptagSize += bytes;
 
-            if (!swap2BytesWrite(fptr,&tagId))
-                return false;
+            swap2BytesWrite(out,&tagId);
             chunkSize += 2;
             ptagSize += 2;
         }
@@ -1233,13 +1117,11 @@ static bool writePtagChunks(
         {
             unsigned long poly = quad + polyOffset;
 
-            int bytes = writeVx(fptr,poly);
-            if (bytes == 0) return false;
+            int bytes = writeVx(out,poly);
             chunkSize += bytes;
             ptagSize += bytes;
 
-            if (!swap2BytesWrite(fptr,&tagId))
-                return false;
+            swap2BytesWrite(out,&tagId);
             chunkSize += 2;
             ptagSize += 2;
         }
@@ -1247,10 +1129,7 @@ static bool writePtagChunks(
     }
 
     // Update the local chunk size
-    if (!updateChunkSize(fptr,ptagSize,ptagChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,ptagSize,ptagChunkStart+4);
 }
 
 
@@ -1260,9 +1139,9 @@ static bool writePtagChunks(
 //
 // Update the per-facet texture with proper values.
 //
-static bool writeVmadChunks(
+static void writeVmadChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     const vector<unsigned long> &tmpVtxList,
     const vector<FgVect2F> &tmpTexCoord,
@@ -1272,8 +1151,8 @@ static bool writeVmadChunks(
     bool                    singleLayer)
 {
     chunkSize = 0;
-    if (tmpTexCoord.size() == 0 || tmpVtxList.size() == 0) return true;
-    if (tmpTexCoord.size() != tmpVtxList.size()) return true;
+    if (tmpTexCoord.size() == 0 || tmpVtxList.size() == 0) return;
+    if (tmpTexCoord.size() != tmpVtxList.size()) return;
 
     unsigned long vtxOffset=0;
     unsigned long polyOffset=0;
@@ -1392,39 +1271,34 @@ static bool writeVmadChunks(
     // Check if there are any per-facet texture data that needs to be
     // corrected.
     if (vtxList.size() == 0)
-        return true;
+        return;
 
     unsigned long vmadSize = 0;
-    long vmadChunkStart = ftell(fptr);
+    long vmadChunkStart = long(out.pos());
     unsigned short dimension = 2;
 
     // VMAD chunk
-    if (!writeChunkHdr(fptr,ID_VMAD,vmadSize))
-        return false;
+    writeChunkHdr(out,ID_VMAD,vmadSize);
     chunkSize += 8;
 
     // TXUV type
-    if (!writeId(fptr,ID_TXUV))
-        return false;
+    writeId(out,ID_TXUV);
     chunkSize += 4;
     vmadSize += 4;
 
     // dimension
-    if (!swap2BytesWrite(fptr,&dimension))
-        return false;
+    swap2BytesWrite(out,&dimension);
     chunkSize += 2;
     vmadSize += 2;
 
     // name
     size_t  ln = strlen(uvTexName.c_str()) + 1;
-    if (fwrite(uvTexName.c_str(),1,ln,fptr) != ln)
-        return false;
+    writeStr(out,uvTexName,ln);
     chunkSize += ulong(ln);
     vmadSize += ulong(ln);
     if (ln % 2 != 0)
     {
-        if (!padByte(fptr))
-            return false;
+        padByte(out);
         chunkSize ++;
         vmadSize ++;
     }
@@ -1432,36 +1306,30 @@ static bool writeVmadChunks(
     // Now save the new per-facet mapping info
     for (unsigned long ii=0; ii<vtxList.size(); ++ii)
     {
-        int bytes = writeVx(fptr,vtxList[ii]);
-        if (bytes == 0) return false;
+        int bytes = writeVx(out,vtxList[ii]);
         chunkSize += bytes;
         vmadSize += bytes;
 
-        bytes = writeVx(fptr,polyList[ii]);
-        if (bytes == 0) return false;
+        bytes = writeVx(out,polyList[ii]);
         chunkSize += bytes;
         vmadSize += bytes;
 
-        if (!writeVec8(fptr,texList[ii]))
-            return false;
+        writeVec8(out,texList[ii]);
         chunkSize += 8;
         vmadSize += 8;
     }
 
     // Update the local chunk size
-    if (!updateChunkSize(fptr,vmadSize,vmadChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,vmadSize,vmadChunkStart+4);
 }
 
 
 //****************************************************************************
 //                              writeClipChunks
 //****************************************************************************
-static bool writeClipChunks(
+static void writeClipChunks(
 
-    FILE                    *fptr,
+    FgBinaryWriter          &out,
     unsigned long           &chunkSize,
     vector<unsigned long>   &clipIdList,
     const FffMultiObjectC   &model)
@@ -1478,14 +1346,12 @@ static bool writeClipChunks(
 
             // CLIP chunk
             unsigned long clipChunkSize=0;
-            long clipChunkPos = ftell(fptr);
-            if (!writeChunkHdr(fptr,ID_CLIP,clipChunkSize))
-                return false;
+            long clipChunkPos = long(out.pos());
+            writeChunkHdr(out,ID_CLIP,clipChunkSize);
             chunkSize += 8;
 
             // clip index
-            if (!swap4BytesWrite(fptr,&clipIdx))
-                return false;
+            swap4BytesWrite(out,&clipIdx);
             clipChunkSize += 4;
             chunkSize += 4;
 
@@ -1495,18 +1361,15 @@ static bool writeClipChunks(
 
             unsigned short ln = ushort(strlen(texFname.c_str())) + 1;
             unsigned short stilSubSize = (ln + 1) & ~0x0001;
-            if (!writeSubChunkHdr(fptr,ID_STIL,stilSubSize))
-                return false;
+            writeSubChunkHdr(out,ID_STIL,stilSubSize);
             clipChunkSize += 6;
             chunkSize += 6;
 
             // Image filename
-            if (fwrite(texFname.c_str(),1,ln,fptr) != ln)
-                return false;
+            writeStr(out,texFname,ln);
             if (ln != stilSubSize)
             {
-                if (!padByte(fptr))
-                    return false;
+                padByte(out);
             }
             clipChunkSize += stilSubSize;
             chunkSize += stilSubSize;
@@ -1516,23 +1379,20 @@ static bool writeClipChunks(
             ////////////////////////
 
             // Update CLIP chunk's size info
-            if (!updateChunkSize(fptr,clipChunkSize,clipChunkPos+4))
-                return false;
+            updateChunkSize(out,clipChunkSize,clipChunkPos+4);
         }
         else
             clipIdList.push_back(0);
     }
-
-    return true;
 }
 
 
 //****************************************************************************
 //                              writeSurfChunk
 //****************************************************************************
-static bool writeSurfChunk(
+static void writeSurfChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned long   &chunkSize,
     const string    &tagName,
     const string    &sourceName,
@@ -1542,37 +1402,32 @@ static bool writeSurfChunk(
     chunkSize = 0;
 
     unsigned long surfChunkSize = 0;
-    long surfChunkStart = ftell(fptr);
+    long surfChunkStart = long(out.pos());
 
     // SURF tag
-    if (!writeChunkHdr(fptr,ID_SURF,surfChunkSize))
-        return false;
+    writeChunkHdr(out,ID_SURF,surfChunkSize);
     chunkSize += 8;
 
     // tag name
     size_t  ln = strlen(tagName.c_str()) + 1;
-    if (fwrite(tagName.c_str(),1,ln,fptr) != ln)
-        return false;
+    writeStr(out,tagName,ln);
     chunkSize += ulong(ln);
     surfChunkSize += ulong(ln);
     if (ln % 2 != 0)
     {
-        if (!padByte(fptr))
-            return false;
+        padByte(out);
         chunkSize ++;
         surfChunkSize ++;
     }
 
     // source
     ln = strlen(sourceName.c_str()) + 1;
-    if (fwrite(sourceName.c_str(),1,ln,fptr) != ln)
-        return false;
+    writeStr(out,sourceName,ln);
     chunkSize += ulong(ln);
     surfChunkSize += ulong(ln);
     if (ln % 2 != 0)
     {
-        if (!padByte(fptr))
-            return false;
+        padByte(out);
         chunkSize ++;
         surfChunkSize ++;
     }
@@ -1583,22 +1438,19 @@ static bool writeSurfChunk(
 
     // COLR sub-chunk
     unsigned short colrSubChunkSize=0;
-    if (!writeSurfColrSubChunk(fptr,colrSubChunkSize,1.0f,1.0f,1.0f,0))
-        return false;
+    writeSurfColrSubChunk(out,colrSubChunkSize,1.0f,1.0f,1.0f,0);
     chunkSize += colrSubChunkSize;
     surfChunkSize += colrSubChunkSize;
 
     // SMAN sub-chunk   -- max smoothing angle in radian
     unsigned short smanSubChunkSize=0;
-    if (!writeSurfSmanSubChunk(fptr,smanSubChunkSize,1.5))
-        return false;
+    writeSurfSmanSubChunk(out,smanSubChunkSize,1.5);
     chunkSize += smanSubChunkSize;
     surfChunkSize += smanSubChunkSize;
 
     // SIDE sub-chunk
     unsigned short sideSubChunkSize=0;
-    if (!writeSurfSideSubChunk(fptr,sideSubChunkSize,1))
-        return false;
+    writeSurfSideSubChunk(out,sideSubChunkSize,1);
     chunkSize += sideSubChunkSize;
     surfChunkSize += sideSubChunkSize;
 
@@ -1606,32 +1458,27 @@ static bool writeSurfChunk(
     if (clipIdx == 0 && uvTexName == "")    // No texture image or tex coord
     {
         // Update the current SURF chunk size
-        if (!updateChunkSize(fptr,surfChunkSize,surfChunkStart+4))
-            return false;
-        return true;
+        updateChunkSize(out,surfChunkSize,surfChunkStart+4);
+        return;
     }
 
     // BLOK sub-chunk
     unsigned short blokSubChunkSize=0;
-    if (!writeSurfBlokSubChunk(fptr,blokSubChunkSize,uvTexName,clipIdx))
-        return false;
+    writeSurfBlokSubChunk(out,blokSubChunkSize,uvTexName,clipIdx);
     chunkSize += blokSubChunkSize;
     surfChunkSize += blokSubChunkSize;
 
     // Update the current SURF chunk size
-    if (!updateChunkSize(fptr,surfChunkSize,surfChunkStart+4))
-        return false;
-
-    return true;
+    updateChunkSize(out,surfChunkSize,surfChunkStart+4);
 }
 
 
 //****************************************************************************
 //                          writeSurfColrSubChunk
 //****************************************************************************
-static bool writeSurfColrSubChunk(
+static void writeSurfColrSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize,
     float           red,
     float           green,
@@ -1640,76 +1487,61 @@ static bool writeSurfColrSubChunk(
 {
     chunkSize = 0;
 
-    if (!writeSubChunkHdr(fptr,ID_COLR,14))
-        return false;
+    writeSubChunkHdr(out,ID_COLR,14);
     chunkSize += 6;
 
-    if (!swap4BytesWrite(fptr,&red))
-        return false;
-    if (!swap4BytesWrite(fptr,&green))
-        return false;
-    if (!swap4BytesWrite(fptr,&blue))
-        return false;
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    swap4BytesWrite(out,&red);
+    swap4BytesWrite(out,&green);
+    swap4BytesWrite(out,&blue);
+    swap2BytesWrite(out,&envelope);
     chunkSize += 14;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfSideSubChunk
 //****************************************************************************
-static bool writeSurfSideSubChunk(
+static void writeSurfSideSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize,
     unsigned short  val)
 {
     chunkSize = 0;
 
-    if (!writeSubChunkHdr(fptr,ID_SIDE,2))
-        return false;
+    writeSubChunkHdr(out,ID_SIDE,2);
     chunkSize += 6;
 
-    if (!swap2BytesWrite(fptr,&val))
-        return false;
+    swap2BytesWrite(out,&val);
     chunkSize += 2;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfSmanSubChunk
 //****************************************************************************
-static bool writeSurfSmanSubChunk(
+static void writeSurfSmanSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize,
     float           angle)
 {
     chunkSize = 0;
 
-    if (!writeSubChunkHdr(fptr,ID_SMAN,4))
-        return false;
+    writeSubChunkHdr(out,ID_SMAN,4);
     chunkSize += 6;
 
-    if (!swap4BytesWrite(fptr,&angle))
-        return false;
+    swap4BytesWrite(out,&angle);
     chunkSize += 4;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokSubChunk
 //****************************************************************************
-static bool writeSurfBlokSubChunk(
+static void writeSurfBlokSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize,
     const string    &uvTexName,
     unsigned long   clipIdx)
@@ -1717,24 +1549,21 @@ static bool writeSurfBlokSubChunk(
     chunkSize = 0;
 
     unsigned short blokSubChunkSize = 0;
-    long blokSubChunkStart = ftell(fptr);
+    long blokSubChunkStart = long(out.pos());
 
     // BLOK sub-chunk
-    if (!writeSubChunkHdr(fptr,ID_BLOK,blokSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_BLOK,blokSubChunkSize);
     chunkSize += 6;
 
     // BLOK's IMAP sub-chunk
     unsigned short imapSubChunkSize=0;
-    if (!writeSurfBlokImapSubChunk(fptr,imapSubChunkSize))
-        return false;
+    writeSurfBlokImapSubChunk(out,imapSubChunkSize);
     chunkSize += imapSubChunkSize;
     blokSubChunkSize += imapSubChunkSize;
 
     // BLOK's TMAP sub-chunk
     unsigned short tmapSubChunkSize=0;
-    if (!writeSurfBlokTmapSubChunk(fptr,tmapSubChunkSize))
-        return false;
+    writeSurfBlokTmapSubChunk(out,tmapSubChunkSize);
     chunkSize += tmapSubChunkSize;
     blokSubChunkSize += tmapSubChunkSize;
 
@@ -1742,120 +1571,103 @@ static bool writeSurfBlokSubChunk(
     if (uvTexName != "")
     {
         unsigned short projSubChunkSize=0;
-        if (!writeSurfBlokProjSubChunk(fptr,projSubChunkSize))
-            return false;
+        writeSurfBlokProjSubChunk(out,projSubChunkSize);
         chunkSize += projSubChunkSize;
         blokSubChunkSize += projSubChunkSize;
     }
 
     // BLOK's AXIS sub-chunk
     unsigned short axisSubChunkSize=0;
-    if (!writeSurfBlokAxisSubChunk(fptr,axisSubChunkSize))
-        return false;
+    writeSurfBlokAxisSubChunk(out,axisSubChunkSize);
     chunkSize += axisSubChunkSize;
     blokSubChunkSize += axisSubChunkSize;
 
     // BLOK's IMAG sub-chunk
     unsigned short imagSubChunkSize=0;
-    if (!writeSurfBlokImagSubChunk(fptr,imagSubChunkSize,clipIdx))
-        return false;
+    writeSurfBlokImagSubChunk(out,imagSubChunkSize,clipIdx);
     chunkSize += imagSubChunkSize;
     blokSubChunkSize += imagSubChunkSize;
 
     // BLOK's WRAP sub-chunk
     unsigned short wrapSubChunkSize=0;
-    if (!writeSurfBlokWrapSubChunk(fptr,wrapSubChunkSize))
-        return false;
+    writeSurfBlokWrapSubChunk(out,wrapSubChunkSize);
     chunkSize += wrapSubChunkSize;
     blokSubChunkSize += wrapSubChunkSize;
 
     // BLOK's WRPW sub-chunk
     unsigned short wrpwSubChunkSize=0;
-    if (!writeSurfBlokWrpwSubChunk(fptr,wrpwSubChunkSize))
-        return false;
+    writeSurfBlokWrpwSubChunk(out,wrpwSubChunkSize);
     chunkSize += wrpwSubChunkSize;
     blokSubChunkSize += wrpwSubChunkSize;
 
     // BLOK's WRPH sub-chunk
     unsigned short wrphSubChunkSize=0;
-    if (!writeSurfBlokWrphSubChunk(fptr,wrphSubChunkSize))
-        return false;
+    writeSurfBlokWrphSubChunk(out,wrphSubChunkSize);
     chunkSize += wrphSubChunkSize;
     blokSubChunkSize += wrphSubChunkSize;
 
     // BLOK's VMAP sub-chunk
     unsigned short vmapSubChunkSize=0;
-    if (!writeSurfBlokVmapSubChunk(fptr,vmapSubChunkSize,uvTexName))
-        return false;
+    writeSurfBlokVmapSubChunk(out,vmapSubChunkSize,uvTexName);
     chunkSize += vmapSubChunkSize;
     blokSubChunkSize += vmapSubChunkSize;
 
     // BLOK's AAST sub-chunk
     unsigned short aastSubChunkSize=0;
-    if (!writeSurfBlokAastSubChunk(fptr,aastSubChunkSize))
-        return false;
+    writeSurfBlokAastSubChunk(out,aastSubChunkSize);
     chunkSize += aastSubChunkSize;
     blokSubChunkSize += aastSubChunkSize;
 
     // BLOK's PIXB sub-chunk
     unsigned short pixbSubChunkSize=0;
-    if (!writeSurfBlokPixbSubChunk(fptr,pixbSubChunkSize))
-        return false;
+    writeSurfBlokPixbSubChunk(out,pixbSubChunkSize);
     chunkSize += pixbSubChunkSize;
     blokSubChunkSize += pixbSubChunkSize;
 
     //
     // Update BLOK sub-chunk's size info
     //
-    if (!updateSubChunkSize(fptr,blokSubChunkSize,blokSubChunkStart+4))
-        return false;
-
-    return true;
+    updateSubChunkSize(out,blokSubChunkSize,blokSubChunkStart+4);
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokImapSubChunk
 //****************************************************************************
-static bool writeSurfBlokImapSubChunk(
+static void writeSurfBlokImapSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize)
 {
     chunkSize = 0;
 
     unsigned short imapSubChunkSize = 0;
-    long imapSubChunkStart = ftell(fptr);
+    long imapSubChunkStart = long(out.pos());
 
     // IMAP sub-chunk
-    if (!writeSubChunkHdr(fptr,ID_IMAP,imapSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_IMAP,imapSubChunkSize);
     chunkSize += 6;
 
     // IMAP's ordinal string (since we only have one block, use 0x80)
     unsigned char ordStr[2] = { (unsigned char)0x80, 0 };
-    if (fwrite(ordStr,1,2,fptr) != 2)
-        return false;
+    out.write(ordStr,2);
     chunkSize += 2;
     imapSubChunkSize += 2;
 
     // IMAP's CHAN sub-chunk
     unsigned short chanSubChunkSize = 4;
-    if (!writeSubChunkHdr(fptr,ID_CHAN,chanSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_CHAN,chanSubChunkSize);
     chunkSize += 6;
     imapSubChunkSize += 6;
 
     // IMAP's CHAN sub-chunk's data
-    if (!writeId(fptr,ID_COLR))
-        return false;
+    writeId(out,ID_COLR);
     chunkSize += chanSubChunkSize;
     imapSubChunkSize += chanSubChunkSize;
 
     // IMAP's OPAC sub-chunk
     unsigned short opacSubChunkSize = 8;
-    if (!writeSubChunkHdr(fptr,ID_OPAC,opacSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_OPAC,opacSubChunkSize);
     chunkSize += 6;
     imapSubChunkSize += 6;
 
@@ -1864,398 +1676,323 @@ static bool writeSurfBlokImapSubChunk(
     float opac = 1.0f;
     unsigned short envelope = 0;
 
-    if (!swap2BytesWrite(fptr,&opacType))
-        return false;
-    if (!swap4BytesWrite(fptr,&opac))
-        return false;
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    swap2BytesWrite(out,&opacType);
+    swap4BytesWrite(out,&opac);
+    swap2BytesWrite(out,&envelope);
     chunkSize += opacSubChunkSize;
     imapSubChunkSize += opacSubChunkSize;
 
     // IMAP's ENAB sub-chunk
     unsigned short enabSubChunkSize = 2;
-    if (!writeSubChunkHdr(fptr,ID_ENAB,enabSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_ENAB,enabSubChunkSize);
     chunkSize += 6;
     imapSubChunkSize += 6;
 
     // IMAP's ENAB sub-chunk's data
     unsigned short enable=1;
-    if (!swap2BytesWrite(fptr,&enable))
-        return false;
+    swap2BytesWrite(out,&enable);
     chunkSize += enabSubChunkSize;
     imapSubChunkSize += enabSubChunkSize;
 
     // IMAP's NEGA sub-chunk
     unsigned short negaSubChunkSize = 2;
-    if (!writeSubChunkHdr(fptr,ID_NEGA,negaSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_NEGA,negaSubChunkSize);
     chunkSize += 6;
     imapSubChunkSize += 6;
 
     // IMAP's NEGA sub-chunk's data
     unsigned short nega=0;
-    if (!swap2BytesWrite(fptr,&nega))
-        return false;
+    swap2BytesWrite(out,&nega);
     chunkSize += negaSubChunkSize;
     imapSubChunkSize += negaSubChunkSize;
 
     // Update IMAP sub-chunk's size info
-    if (!updateSubChunkSize(fptr,imapSubChunkSize,imapSubChunkStart+4))
-        return false;
-
-    return true;
+    updateSubChunkSize(out,imapSubChunkSize,imapSubChunkStart+4);
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokTmapSubChunk
 //****************************************************************************
-static bool writeSurfBlokTmapSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokTmapSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     unsigned short tmapSubChunkSize = 0;
-    long tmapSubChunkStart = ftell(fptr);
+    long tmapSubChunkStart = long(out.pos());
 
     // TMAP sub-chunk
-    if (!writeSubChunkHdr(fptr,ID_TMAP,tmapSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_TMAP,tmapSubChunkSize);
     chunkSize += 6;
 
     unsigned short envelope = 0;
 
     // TMAP's CNTR sub-chunk
     unsigned short cntrSubChunkSize = 14;
-    if (!writeSubChunkHdr(fptr,ID_CNTR,cntrSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_CNTR,cntrSubChunkSize);
     chunkSize += 6;
     tmapSubChunkSize += 6;
 
     // TMAP's CNTR sub-chunk's data
     FgVect3F cntr(0.0f,0.0f,0.0f);
-    if (!writeVec12(fptr,cntr))
-        return false;
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    writeVec12(out,cntr);
+    swap2BytesWrite(out,&envelope);
     chunkSize += cntrSubChunkSize;
     tmapSubChunkSize += cntrSubChunkSize;
 
     // TMAP's SIZE sub-chunk
     unsigned short sizeSubChunkSize = 14;
-    if (!writeSubChunkHdr(fptr,ID_SIZE,sizeSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_SIZE,sizeSubChunkSize);
     chunkSize += 6;
     tmapSubChunkSize += 6;
 
     // TMAP's SIZE sub-chunk's data
     FgVect3F size(1.0f,1.0f,1.0f);
-    if (!writeVec12(fptr,size))
-        return false;
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    writeVec12(out,size);
+    swap2BytesWrite(out,&envelope);
     chunkSize += sizeSubChunkSize;
     tmapSubChunkSize += sizeSubChunkSize;
 
     // TMAP's ROTA sub-chunk
     unsigned short rotaSubChunkSize = 14;
-    if (!writeSubChunkHdr(fptr,ID_ROTA,rotaSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_ROTA,rotaSubChunkSize);
     chunkSize += 6;
     tmapSubChunkSize += 6;
 
     // TMAP's ROTA sub-chunk's data
     FgVect3F rota(0.0f,0.0f,0.0f);
-    if (!writeVec12(fptr,rota))
-        return false;
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    writeVec12(out,rota);
+    swap2BytesWrite(out,&envelope);
     chunkSize += rotaSubChunkSize;
     tmapSubChunkSize += rotaSubChunkSize;
 
     // TMAP's FALL sub-chunk
     unsigned short fallSubChunkSize = 16;
-    if (!writeSubChunkHdr(fptr,ID_FALL,fallSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_FALL,fallSubChunkSize);
     chunkSize += 6;
     tmapSubChunkSize += 6;
 
     // TMAP's FALL sub-chunk's data
     unsigned short type = 0;
     FgVect3F fall(0.0f,0.0f,0.0f);
-    if (!swap2BytesWrite(fptr,&type))
-        return false;
-    if (!writeVec12(fptr,fall))
-        return false;
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    swap2BytesWrite(out,&type);
+    writeVec12(out,fall);
+    swap2BytesWrite(out,&envelope);
     chunkSize += fallSubChunkSize;
     tmapSubChunkSize += fallSubChunkSize;
 
     // TMAP's OREF sub-chunk
     unsigned short orefSubChunkSize = 8;
-    if (!writeSubChunkHdr(fptr,ID_OREF,orefSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_OREF,orefSubChunkSize);
     chunkSize += 6;
     tmapSubChunkSize += 6;
 
     // TMAP's OREF sub-chunk's data
     char oref[8] = { '(', 'n', 'o', 'n', 'e', ')', 0, 0 };
-    if (fwrite(oref,1,8,fptr) != 8)
-        return false;
+    out.write(oref,8);
     chunkSize += orefSubChunkSize;
     tmapSubChunkSize += orefSubChunkSize;
 
     // TMAP's CSYS sub-chunk
     unsigned short csysSubChunkSize = 2;
-    if (!writeSubChunkHdr(fptr,ID_CSYS,csysSubChunkSize))
-        return false;
+    writeSubChunkHdr(out,ID_CSYS,csysSubChunkSize);
     chunkSize += 6;
     tmapSubChunkSize += 6;
 
     // TMAP's CSYS sub-chunk's data
     unsigned short csysType = 0;
-    if (!swap2BytesWrite(fptr,&csysType))
-        return false;
+    swap2BytesWrite(out,&csysType);
     chunkSize += csysSubChunkSize;
     tmapSubChunkSize += csysSubChunkSize;
 
     // Update TMAP sub-chunk's size info
-    if (!updateSubChunkSize(fptr,tmapSubChunkSize,tmapSubChunkStart+4))
-        return false;
-
-    return true;
+    updateSubChunkSize(out,tmapSubChunkSize,tmapSubChunkStart+4);
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokProjSubChunk
 //****************************************************************************
-static bool writeSurfBlokProjSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokProjSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     unsigned short val = 5;
 
-    if (!writeSubChunkHdr(fptr,ID_PROJ,2))
-        return false;
+    writeSubChunkHdr(out,ID_PROJ,2);
     chunkSize += 6;
 
-    if (!swap2BytesWrite(fptr,&val))
-        return false;
+    swap2BytesWrite(out,&val);
     chunkSize += 2;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokAxisSubChunk
 //****************************************************************************
-static bool writeSurfBlokAxisSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokAxisSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     unsigned short val = 2;
 
-    if (!writeSubChunkHdr(fptr,ID_AXIS,2))
-        return false;
+    writeSubChunkHdr(out,ID_AXIS,2);
     chunkSize += 6;
 
-    if (!swap2BytesWrite(fptr,&val))
-        return false;
+    swap2BytesWrite(out,&val);
     chunkSize += 2;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokImagSubChunk
 //****************************************************************************
-static bool writeSurfBlokImagSubChunk(
+static void writeSurfBlokImagSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize,
     unsigned long   clipIdx)
 {
     chunkSize = 0;
 
-    if (clipIdx == 0) return true;
+    if (clipIdx == 0) return;
 
     unsigned short sz = 2;
     if (clipIdx >= 0xFF00) sz += 2;
 
-    if (!writeSubChunkHdr(fptr,ID_IMAG,sz))
-        return false;
+    writeSubChunkHdr(out,ID_IMAG,sz);
     chunkSize += 6;
 
-    int bytes = writeVx(fptr,clipIdx);
-    if (bytes != sz) return false;
-    chunkSize += bytes;
-
-    return true;
+    chunkSize += writeVx(out,clipIdx);
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokWrapSubChunk
 //****************************************************************************
-static bool writeSurfBlokWrapSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokWrapSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     unsigned short val = 1;
 
-    if (!writeSubChunkHdr(fptr,ID_WRAP,4))
-        return false;
+    writeSubChunkHdr(out,ID_WRAP,4);
     chunkSize += 6;
 
-    if (!swap2BytesWrite(fptr,&val))
-        return false;
+    swap2BytesWrite(out,&val);
     chunkSize += 2;
 
-    if (!swap2BytesWrite(fptr,&val))
-        return false;
+    swap2BytesWrite(out,&val);
     chunkSize += 2;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokWrpwSubChunk
 //****************************************************************************
-static bool writeSurfBlokWrpwSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokWrpwSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     float cycles = 1.0f;
     unsigned short envelope = 0;
 
-    if (!writeSubChunkHdr(fptr,ID_WRPW,6))
-        return false;
+    writeSubChunkHdr(out,ID_WRPW,6);
     chunkSize += 6;
 
-    if (!swap4BytesWrite(fptr,&cycles))
-        return false;
+    swap4BytesWrite(out,&cycles);
     chunkSize += 4;
 
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    swap2BytesWrite(out,&envelope);
     chunkSize += 2;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokWrphSubChunk
 //****************************************************************************
-static bool writeSurfBlokWrphSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokWrphSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     float cycles = 1.0f;
     unsigned short envelope = 0;
 
-    if (!writeSubChunkHdr(fptr,ID_WRPH,6))
-        return false;
+    writeSubChunkHdr(out,ID_WRPH,6);
     chunkSize += 6;
 
-    if (!swap4BytesWrite(fptr,&cycles))
-        return false;
+    swap4BytesWrite(out,&cycles);
     chunkSize += 4;
 
-    if (!swap2BytesWrite(fptr,&envelope))
-        return false;
+    swap2BytesWrite(out,&envelope);
     chunkSize += 2;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokVmapSubChunk
 //****************************************************************************
-static bool writeSurfBlokVmapSubChunk(
+static void writeSurfBlokVmapSubChunk(
 
-    FILE            *fptr,
+    FgBinaryWriter  &out,
     unsigned short  &chunkSize,
     const string    &uvTexName)
 {
     chunkSize = 0;
 
-    if (uvTexName == "") return true;
+    if (uvTexName == "") return;
 
     unsigned short ln = ushort(strlen(uvTexName.c_str())) + 1;
     unsigned short sz = (ln+1) & ~((unsigned short)1);
 
-    if (!writeSubChunkHdr(fptr,ID_VMAP,sz))
-        return false;
+    writeSubChunkHdr(out,ID_VMAP,sz);
     chunkSize += 6;
 
-    if (fwrite(uvTexName.c_str(),1,ln,fptr) != ln)
-        return false;
+    writeStr(out,uvTexName,ln);
     chunkSize += ln;
     if (ln != sz)
     {
-        if (!padByte(fptr))
-            return false;
-        ln++;
-        if (ln != sz) return false;
+        padByte(out);
         chunkSize++;
     }
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokAastSubChunk
 //****************************************************************************
-static bool writeSurfBlokAastSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokAastSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     float aast = 1.0f;
     unsigned short flags = 1;
 
-    if (!writeSubChunkHdr(fptr,ID_AAST,6))
-        return false;
+    writeSubChunkHdr(out,ID_AAST,6);
     chunkSize += 6;
 
-    if (!swap2BytesWrite(fptr,&flags))
-        return false;
+    swap2BytesWrite(out,&flags);
     chunkSize += 2;
 
-    if (!swap4BytesWrite(fptr,&aast))
-        return false;
+    swap4BytesWrite(out,&aast);
     chunkSize += 4;
-
-    return true;
 }
 
 
 //****************************************************************************
 //                          writeSurfBlokPixbSubChunk
 //****************************************************************************
-static bool writeSurfBlokPixbSubChunk(FILE *fptr, unsigned short &chunkSize)
+static void writeSurfBlokPixbSubChunk(FgBinaryWriter &out, unsigned short &chunkSize)
 {
     chunkSize = 0;
 
     unsigned short flags = 1;
 
-    if (!writeSubChunkHdr(fptr,ID_PIXB,2))
-        return false;
+    writeSubChunkHdr(out,ID_PIXB,2);
     chunkSize += 6;
 
-    if (!swap2BytesWrite(fptr,&flags))
-        return false;
+    swap2BytesWrite(out,&flags);
     chunkSize += 2;
-
-    return true;
 }
 
 
@@ -2266,7 +2003,7 @@ static bool writeSurfBlokPixbSubChunk(FILE *fptr, unsigned short &chunkSize)
 // Helper function to translate our morph naming scheme to one compatible with
 // programs using LWO2 format (ie replacing the ": " with ".").
 //
-static bool writeLwsFile(
+static void writeLwsFile(
     const FgString            &lwsName, 
     const FgString            &lwoName,
     FgVect3F              minVect,
@@ -2275,11 +2012,7 @@ static bool writeLwsFile(
     unsigned long           numMorphs, 
     const vector<string>    *morphNames)
 {
-    FgOfstream file(lwsName);
-    if (!file)
-    {
-        return false;
-    }
+    FgOfstream file(lwsName);       // Throws on failure
 
     // Start the file write
     file << "LWSC\n";
@@ -2365,8 +2098,8 @@ static bool writeLwsFile(
     else                    gridSize = power10;
 
     file << "GridSize " << gridSize << endl << flush;
-
-    return (!file.fail());
+    if (file.fail())
+        fgThrow("Error writing LWS file",lwsName);
 }
 
 void
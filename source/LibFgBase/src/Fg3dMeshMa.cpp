@@ -17,6 +17,7 @@
 #include "Fg3dNormals.hpp"
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
+#include "FgTextWriter.hpp"
 
 using namespace std;
 
@@ -129,11 +130,11 @@ static string getObjectTexFileName(
 static string getObjectTexPlaceName(
         const FffMultiObjectC &model, unsigned long mm);
 
-static void writeTexCoord(ofstream &ofs, const vector<FgVect2F> &texCoord);
-static void writeVertices(ofstream &ofs, const vector<FgVect3F> &vtxList);
-static void writeEdges(ofstream &ofs, const vector<FgVect2UI> &edgeList);
+static void writeTexCoord(FgTextWriter &ofs, const vector<FgVect2F> &texCoord);
+static void writeVertices(FgTextWriter &ofs, const vector<FgVect3F> &vtxList);
+static void writeEdges(FgTextWriter &ofs, const vector<FgVect2UI> &edgeList);
 static void writeFacets(
-        ofstream                    &ofs,
+        FgTextWriter                &ofs,
         const vector<FgVect3F>    &vtxList,
         const vector<FgVect3UI>    &triList,
         const vector<FgVect4UI>    &quadList,
@@ -142,26 +143,26 @@ static void writeFacets(
         const vector<FgVect3UI>    &texTriList,
         const vector<FgVect4UI>    &texQuadList);
 static void writeObjects(
-        ofstream                        &ofs,
+        FgTextWriter                    &ofs,
         const FffMultiObjectC           &model,
         const vector<FffMultiObjectC>   *morphTargets,
         const vector<string>            *morphNames,
         vector<int>                     &edgeSizeList);
 static int writeShadingMaterialPhong(
-        ofstream                        &ofs,
+        FgTextWriter                    &ofs,
         const FffMultiObjectC           &model,
         const vector<string>            *morphNames);
 static void writeBlendShapes(
-        ofstream                        &ofs, 
+        FgTextWriter                    &ofs, 
         const FffMultiObjectC           &model,
         const vector<string>            *morphNames);
 static void writePolySoftEdge(
-        ofstream                        &ofs, 
+        FgTextWriter                    &ofs, 
         const FffMultiObjectC           &model,
         const vector<string>            *morphNames,
         const vector<int>               &edgeSizeList);
 static void connectAttributes(
-        ofstream                        &ofs,
+        FgTextWriter                    &ofs,
         const FffMultiObjectC           &model,
         const vector<string>            *morphNames);
 
@@ -222,11 +223,7 @@ static bool saveMayaAsciiFile(
 
     FgPath      path(fname);
     path.ext = "ma";
-    FgOfstream ofs(path.str());
-    if (!ofs)
-    {
-        return false;
-    }
+    FgTextWriter ofs(path.str());
 
     //
     // Write header
@@ -341,16 +338,8 @@ static bool saveMayaAsciiFile(
     //
     // Done.
     //
-    if (ofs.fail())
-    {
-        ofs.close();
-        return false;
-    }
-    else
-    {
-        ofs.close();
-        return true;
-    }
+    ofs.close();
+    return true;
 }
 
 
@@ -842,27 +831,33 @@ static string getObjectTexPlaceName(
 //****************************************************************************
 //                              writeTexCoord
 //****************************************************************************
-static void writeTexCoord(ofstream &ofs, const vector<FgVect2F> &texCoord)
+static void writeTexCoordItem(
+
+    const vector<FgVect2F>  *texCoord,
+    FgTextWriter            &ofs,
+    size_t                  pp)
+{
+    // 4 per line
+    if (pp % 4 == 0)
+        ofs << "\t\t";
+    ofs << (*texCoord)[pp][0] << " " << (*texCoord)[pp][1];
+    if (pp == texCoord->size()-1)
+        ofs << ";\n";
+    else if (pp % 4 == 3)
+        ofs << " \n";
+    else
+        ofs << " ";
+}
+
+static void writeTexCoord(FgTextWriter &ofs, const vector<FgVect2F> &texCoord)
 {
     if (texCoord.size())
     {
         ofs << "\tsetAttr -s " << texCoord.size()
                     << " \".uvst[0].uvsp[0:" << texCoord.size()-1 << "]\" "
                     << "-type \"float2\"\n";
-
-        for (unsigned long pp=0; pp<texCoord.size(); )
-        {
-            ofs << "\t\t";
-            for (int ii=0; ii<4 && pp<texCoord.size(); ++ii, ++pp)
-            {
-                ofs << texCoord[pp][0] << " " << texCoord[pp][1];
-                if (pp == texCoord.size()-1)
-                    ofs << ";";
-                else
-                    ofs << " ";
-            }
-            ofs << "\n";
-        }
+        fgWriteItems(ofs,texCoord.size(),
+                     boost::bind(writeTexCoordItem,&texCoord,_1,_2));
     }
 }
 
@@ -870,49 +865,63 @@ static void writeTexCoord(ofstream &ofs, const vector<FgVect2F> &texCoord)
 //****************************************************************************
 //                              writeVertices
 //****************************************************************************
-static void writeVertices(ofstream &ofs, const vector<FgVect3F> &vtxList)
+static void writeVertexItem(
+
+    const vector<FgVect3F>  *vtxList,
+    FgTextWriter            &ofs,
+    size_t                  vv)
+{
+    // 3 per line
+    if (vv % 3 == 0)
+        ofs << "\t\t";
+    ofs << (*vtxList)[vv][0] << " " 
+        << (*vtxList)[vv][1] << " " 
+        << (*vtxList)[vv][2];
+    if (vv == vtxList->size()-1)
+        ofs << ";\n";
+    else if (vv % 3 == 2)
+        ofs << " \n";
+    else
+        ofs << " ";
+}
+
+static void writeVertices(FgTextWriter &ofs, const vector<FgVect3F> &vtxList)
 {
     ofs << "\tsetAttr -s " << vtxList.size() 
                 << " \".vt[0:" << vtxList.size()-1 << "]\"\n";
-    for (unsigned long vv=0; vv<vtxList.size(); )
-    {
-        ofs << "\t\t";
-        for (int ii=0; ii<3 && vv<vtxList.size(); ++ii, ++vv)
-        {
-            ofs << vtxList[vv][0] << " " 
-                << vtxList[vv][1] << " " 
-                << vtxList[vv][2];
-            if (vv == vtxList.size()-1)
-                ofs << ";";
-            else
-                ofs << " ";
-        }
-        ofs << "\n";
-    }
+    fgWriteItems(ofs,vtxList.size(),
+                 boost::bind(writeVertexItem,&vtxList,_1,_2));
 }
 
 
 //****************************************************************************
 //                              writeEdges
 //****************************************************************************
-static void writeEdges(ofstream &ofs, const vector<FgVect2UI> &edgeList)
+static void writeEdgeItem(
+
+    const vector<FgVect2UI> *edgeList,
+    FgTextWriter            &ofs,
+    size_t                  ee)
+{
+    // 7 per line
+    if (ee % 7 == 0)
+        ofs << "\t\t";
+    ofs << (*edgeList)[ee][0] << " " 
+        << (*edgeList)[ee][1] << " 0";
+    if (ee == edgeList->size()-1)
+        ofs << ";\n";
+    else if (ee % 7 == 6)
+        ofs << " \n";
+    else
+        ofs << " ";
+}
+
+static void writeEdges(FgTextWriter &ofs, const vector<FgVect2UI> &edgeList)
 {
     ofs << "\tsetAttr -s " << edgeList.size() 
                 << " \".ed[0:" << edgeList.size()-1 << "]\"\n";
-    for (unsigned long ee=0; ee<edgeList.size(); )
-    {
-        ofs << "\t\t";
-        for (int ii=0; ii<7 && ee<edgeList.size(); ++ii, ++ee)
-        {
-            ofs << edgeList[ee][0] << " " 
-                << edgeList[ee][1] << " 0";
-            if (ee == edgeList.size()-1)
-                ofs << ";";
-            else
-                ofs << " ";
-        }
-        ofs << "\n";
-    }
+    fgWriteItems(ofs,edgeList.size(),
+                 boost::bind(writeEdgeItem,&edgeList,_1,_2));
 }
 
 
@@ -921,7 +930,7 @@ static void writeEdges(ofstream &ofs, const vector<FgVect2UI> &edgeList)
 //****************************************************************************
 static void writeFacets(
 
-    ofstream                    &ofs,
+    FgTextWriter                &ofs,
     const vector<FgVect3F>    &vtxList,
     const vector<FgVect3UI>    &triList,
     const vector<FgVect4UI>    &quadList,
@@ -1019,7 +1028,7 @@ static void writeFacets(
 //****************************************************************************
 static void writeObjects(
 
-    ofstream                        &ofs,
+    FgTextWriter                    &ofs,
     const FffMultiObjectC           &model,
     const vector<FffMultiObjectC>   *morphTargets,
     const vector<string>            *morphNames,
@@ -1042,6 +1051,8 @@ static void writeObjects(
     vector< vector<FgVect2UI> > edgeList;
     edgeMap.resize(model.numObjs());
     edgeList.resize(model.numObjs());
+    // Edges and facets are the same for all morph targets so are only formatted once:
+    vector<FgTextWriter> topology(model.numObjs());
     edgeSizeList.clear();
     for (unsigned long objId=0; objId<model.numObjs(); ++objId)
     {
@@ -1124,11 +1135,12 @@ static void writeObjects(
         writeVertices(ofs,vtxList);
 
         // Edges
-        writeEdges(ofs,edgeList[objId]);
+        writeEdges(topology[objId],edgeList[objId]);
 
         // Faces
-        writeFacets(ofs,vtxList,triList,quadList,edgeMap[objId],
+        writeFacets(topology[objId],vtxList,triList,quadList,edgeMap[objId],
                     texCoord,texTriList,texQuadList);
+        ofs.append(topology[objId]);
     }
 
     // Now the morph targets
@@ -1146,12 +1158,8 @@ static void writeObjects(
 
             const vector<FgVect3F> &mVtxList = 
                 (*morphTargets)[mm].getPtList(objId);
-            const vector<FgVect3F> &vtxList = model.getPtList(objId);
             const vector<FgVect3UI> &triList = model.getTriList(objId);
             const vector<FgVect4UI> &quadList = model.getQuadList(objId);
-            const vector<FgVect2F> &texCoord = model.getTextCoord(objId);
-            const vector<FgVect3UI> &texTriList = model.getTexTriList(objId);
-            const vector<FgVect4UI> &texQuadList=model.getTexQuadList(objId);
 
             size_t  numFacets = triList.size() + quadList.size();
 
@@ -1184,9 +1192,7 @@ static void writeObjects(
             writeVertices(ofs,mVtxList);
 
             // Other info.
-            writeEdges(ofs,edgeList[objId]);
-            writeFacets(ofs,vtxList,triList,quadList,edgeMap[objId],
-                        texCoord,texTriList,texQuadList);
+            ofs.append(topology[objId]);
         }
     }
 }
@@ -1197,7 +1203,7 @@ static void writeObjects(
 //****************************************************************************
 static int writeShadingMaterialPhong(
 
-    ofstream                    &ofs,
+    FgTextWriter                &ofs,
     const FffMultiObjectC       &model,
     const vector<string>        *morphNames)
 {
@@ -1264,7 +1270,7 @@ static int writeShadingMaterialPhong(
 //****************************************************************************
 static void writeBlendShapes(
 
-    ofstream                    &ofs, 
+    FgTextWriter                &ofs, 
     const FffMultiObjectC       &model,
     const vector<string>        *morphNames)
 {
@@ -1371,7 +1377,7 @@ static void writeBlendShapes(
 //****************************************************************************
 static void writePolySoftEdge(
 
-    ofstream                    &ofs, 
+    FgTextWriter                &ofs, 
     const FffMultiObjectC       &model,
     const vector<string>        *morphNames,
     const vector<int>           &edgeSizeList)
@@ -1415,7 +1421,7 @@ static void writePolySoftEdge(
 //****************************************************************************
 static void connectAttributes(
 
-    ofstream                        &ofs,
+    FgTextWriter                    &ofs,
     const FffMultiObjectC           &model,
     const vector<string>            *morphNames)
 {
@@ -11,9 +11,14 @@
 #include "FgImage.hpp"
 #include "FgFileSystem.hpp"
 #include "Fg3dMeshOps.hpp"
+#include "Fg3dMeshIo.hpp"
 #include "FgTokenizer.hpp"
 #include "FgParse.hpp"
 #include "Fg3dNormals.hpp"
+#include "FgThread.hpp"
+#include "FgRandom.hpp"
+#include "FgCommand.hpp"
+#include "FgTextWriter.hpp"
 
 #include <boost/algorithm/string.hpp>
 
@@ -146,17 +151,614 @@ parseFacet(
     return ret;
 }
 
+// The loader below memory maps the file and parses it in chunks on the thread pool. Each chunk
+// parses its lines without reference to the rest of the file, with facet indices left as in the
+// file. The chunks are then merged in order, resolving indices (which may be relative to the
+// current vertex count) and surface separators. Lines that don't fit the simple common forms
+// are deferred to the merge and parsed with the functions above, so the results, including
+// warnings, are those of a line-by-line parse.
+
+static inline
+bool
+isCrOrLf(char ch)
+{return ((ch == '\r') || (ch == '\n')); }
+
+static inline
+bool
+isDigit(char ch)
+{return ((ch >= '0') && (ch <= '9')); }
+
+// Parses the leading float in [pos,end) as 'istream >> float' does (skipping leading whitespace,
+// and zero if there is no valid number) but without streams, locales or allocation. Up to 19
+// significant digits with modest exponents are converted exactly via double, falling back to
+// 'strtof' for other values and for the rare case where rounding via double is ambiguous:
+static
+float
+parseObjFloat(const char * pos,const char * end)
+{
+    static const double     pow10[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+                                       1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+    while ((pos != end) && ((*pos == ' ') || ((*pos >= '\t') && (*pos <= '\r'))))
+        ++pos;
+    const char *    numBeg = pos;
+    bool            neg = false;
+    if ((pos != end) && ((*pos == '+') || (*pos == '-'))) {
+        neg = (*pos == '-');
+        ++pos;
+    }
+    uint64          mant = 0;
+    int             exp10 = 0,
+                    numSig = 0;
+    bool            found = false,
+                    dropped = false;
+    for (; (pos != end) && isDigit(*pos); ++pos) {
+        found = true;
+        if (numSig < 19) {
+            mant = mant * 10 + uint64(*pos - '0');
+            if (mant > 0)
+                ++numSig;
+        }
+        else {
+            dropped = dropped || (*pos != '0');
+            ++exp10;
+        }
+    }
+    if ((pos != end) && (*pos == '.')) {
+        for (++pos; (pos != end) && isDigit(*pos); ++pos) {
+            found = true;
+            if (numSig < 19) {
+                mant = mant * 10 + uint64(*pos - '0');
+                if (mant > 0)
+                    ++numSig;
+                --exp10;
+            }
+            else
+                dropped = dropped || (*pos != '0');
+        }
+    }
+    if (!found)
+        return 0.0f;
+    if ((pos != end) && ((*pos == 'e') || (*pos == 'E'))) {
+        ++pos;
+        bool            expNeg = false;
+        if ((pos != end) && ((*pos == '+') || (*pos == '-'))) {
+            expNeg = (*pos == '-');
+            ++pos;
+        }
+        if ((pos == end) || !isDigit(*pos))     // Incomplete exponent makes the whole value invalid
+            return 0.0f;
+        int             ee = 0;
+        for (; (pos != end) && isDigit(*pos); ++pos)
+            if (ee < 100000)
+                ee = ee * 10 + (*pos - '0');
+        exp10 += expNeg ? -ee : ee;
+    }
+    if (mant == 0)
+        return (dropped ? 0.0f : (neg ? -0.0f : 0.0f));
+    if (!dropped && (mant < (uint64(1) << 53)) && (exp10 >= -22) && (exp10 <= 22)) {
+        double          dd = double(mant);
+        dd = (exp10 < 0) ? dd / pow10[-exp10] : dd * pow10[exp10];
+        if ((dd >= double(numeric_limits<float>::min())) && (dd <= double(numeric_limits<float>::max()))) {
+            uint64          bits;
+            memcpy(&bits,&dd,8);
+            // Exactly half way between two floats may be from either side of the true value:
+            if ((bits & 0x1FFFFFFF) != 0x10000000)
+                return (neg ? -float(dd) : float(dd));
+        }
+    }
+    string          str(numBeg,pos);
+    float           ret = strtof(str.c_str(),NULL);
+    uint32          bits;                       // Check bits since fast-math may assume finite
+    memcpy(&bits,&ret,4);
+    if ((bits & 0x7F800000) == 0x7F800000)      // As per 'istream' on overflow
+        ret = neg ? -numeric_limits<float>::max() : numeric_limits<float>::max();
+    return ret;
+}
+
+// Parses the index field [beg,end) as 'istream >> int', returning false if it isn't simply an
+// optionally signed integer of up to 9 digits:
+static inline
+bool
+parseObjInt(const char * beg,const char * end,int & ret)
+{
+    bool            neg = false;
+    if ((beg != end) && ((*beg == '+') || (*beg == '-'))) {
+        neg = (*beg == '-');
+        ++beg;
+    }
+    if ((beg == end) || (end - beg > 9))
+        return false;
+    int             val = 0;
+    for (; beg != end; ++beg) {
+        if (!isDigit(*beg))
+            return false;
+        val = val * 10 + (*beg - '0');
+    }
+    ret = neg ? -val : val;
+    return true;
+}
+
+// Splits [beg,end) at spaces, skipping empty tokens, as per 'fgSplitChar'. Returns the number of
+// tokens, of which up to 'maxToks' are stored:
+static inline
+uint
+splitObjSpaces(const char * beg,const char * end,const char ** toks,uint maxToks)
+{
+    uint            num = 0;
+    while (beg != end) {
+        while ((beg != end) && (*beg == ' '))
+            ++beg;
+        if (beg == end)
+            break;
+        const char *    tokEnd = beg;
+        while ((tokEnd != end) && (*tokEnd != ' '))
+            ++tokEnd;
+        if (num < maxToks) {
+            toks[2*num] = beg;
+            toks[2*num+1] = tokEnd;
+        }
+        ++num;
+        beg = tokEnd;
+    }
+    return num;
+}
+
+// Gets the next non-empty line from [pos,end) as split by 'fgSplitLines'. Lines continued with
+// a backslash are joined into 'joined', which the returned line then points into:
+static
+bool
+nextObjLine(const char * & pos,const char * end,string & joined,const char * & lineBeg,const char * & lineEnd)
+{
+    while ((pos != end) && isCrOrLf(*pos))
+        ++pos;
+    if (pos == end)
+        return false;
+    const char *    beg = pos;
+    while ((pos != end) && !isCrOrLf(*pos))
+        ++pos;
+    if ((pos == end) || (pos[-1] != '\\')) {
+        lineBeg = beg;
+        lineEnd = pos;
+        return true;
+    }
+    // Same logic as 'fgSplitLines':
+    joined.clear();
+    for (pos=beg; pos != end; ++pos) {
+        if ((*pos == '\\') && (pos+1 != end) && isCrOrLf(pos[1])) {
+            ++pos;
+            while ((pos+1 != end) && isCrOrLf(*pos))
+                ++pos;
+        }
+        if (isCrOrLf(*pos)) {
+            if (!joined.empty())
+                break;
+        }
+        else
+            joined += *pos;
+    }
+    if (joined.empty())
+        return false;
+    lineBeg = joined.data();
+    lineEnd = lineBeg + joined.size();
+    return true;
+}
+
+struct  ObjFacet
+{
+    const char *    text;           // Start of line in file, for reparsing if invalid
+    uint            line;           // Index of line within chunk
+    uint            numVerts;       // Number of verts and uvs in chunk preceding this facet
+    uint            numUvs;
+    ushort          numCorners;
+    bool            uvs;
+};
+
+// Line parsed during merge since it depends on preceding lines or is malformed:
+struct  ObjDeferred
+{
+    string          text;
+    uint            line;
+    uint            numVerts;       // As above
+    uint            numUvs;
+    size_t          numFacets;      // Number of (fast) facets in chunk preceding this line
+};
+
+struct  ObjChunk
+{
+    const char *            beg;
+    const char *            end;
+    FgVerts                 verts;
+    vector<FgVect2F>        uvs;
+    vector<int>             inds;       // Facet vert (and uv) indices as in file
+    vector<ObjFacet>        facets;
+    vector<ObjDeferred>     deferred;
+    uint                    numLines;
+    size_t                  homogenousAt;   // Index of first vert with homogenous coord, if any
+    size_t                  colorsAt;       // Index of first vert with color values, if any
+
+    ObjChunk() :
+        beg(NULL), end(NULL), numLines(0),
+        homogenousAt(std::numeric_limits<size_t>::max()),
+        colorsAt(std::numeric_limits<size_t>::max())
+    {}
+};
+
+// Larger facets are deferred:
+static const uint   objMaxCorners = 64;
+
+static
+bool
+parseObjFacet(const char * beg,const char * end,ObjChunk & chunk)
+{
+    static const uint   maxCorners = objMaxCorners;
+    const char *        toks[2*maxCorners];
+    uint                num = splitObjSpaces(beg,end,toks,maxCorners);
+    if ((num < 3) || (num > maxCorners))
+        return false;
+    bool                uvs = false;
+    for (uint ii=0; ii<num; ++ii) {
+        const char      *tb = toks[2*ii],
+                        *te = toks[2*ii+1],
+                        *s0 = std::find(tb,te,'/');
+        int             vi,ui = 0;
+        bool            hasUv = false;
+        if (!parseObjInt(tb,s0,vi))
+            return false;
+        if (s0 != te) {
+            const char *    s1 = std::find(s0+1,te,'/');
+            if (s1 != s0+1) {
+                if (!parseObjInt(s0+1,s1,ui))
+                    return false;
+                hasUv = true;
+            }
+        }
+        if (ii == 0)
+            uvs = hasUv;
+        else if (hasUv != uvs)
+            return false;
+        chunk.inds.push_back(vi);
+        if (uvs)
+            chunk.inds.push_back(ui);
+    }
+    ObjFacet            facet;
+    facet.text = NULL;
+    facet.line = chunk.numLines;
+    facet.numVerts = uint(chunk.verts.size());
+    facet.numUvs = uint(chunk.uvs.size());
+    facet.numCorners = ushort(num);
+    facet.uvs = uvs;
+    chunk.facets.push_back(facet);
+    return true;
+}
+
+static
+void
+parseObjChunk(const string & surfSeparator,ObjChunk * chunkPtr)
+{
+    ObjChunk &          chunk = *chunkPtr;
+    const char          *pos = chunk.beg,
+                        *lb,*le;
+    const char *        toks[12];
+    string              joined;
+    while (nextObjLine(pos,chunk.end,joined,lb,le)) {
+        size_t          len = le - lb;
+        bool            defer = false;
+        if (!surfSeparator.empty() && (len >= surfSeparator.size()) &&
+            std::equal(surfSeparator.begin(),surfSeparator.end(),lb))
+            defer = true;
+        else if ((len >= 2) && (lb[0] == 'v') && (lb[1] == ' ')) {
+            uint            num = splitObjSpaces(lb+2,le,toks,6);
+            if ((num == 3) || (num == 4) || (num == 6)) {
+                if ((num == 4) && (chunk.homogenousAt > chunk.verts.size()))
+                    chunk.homogenousAt = chunk.verts.size();
+                if ((num == 6) && (chunk.colorsAt > chunk.verts.size()))
+                    chunk.colorsAt = chunk.verts.size();
+                chunk.verts.push_back(FgVect3F(
+                    parseObjFloat(toks[0],toks[1]),
+                    parseObjFloat(toks[2],toks[3]),
+                    parseObjFloat(toks[4],toks[5])));
+            }
+            else
+                defer = true;
+        }
+        else if ((len >= 3) && (lb[0] == 'v') && (lb[1] == 't') && (lb[2] == ' ')) {
+            uint            num = splitObjSpaces(lb+3,le,toks,3);
+            if ((num == 2) || (num == 3))
+                chunk.uvs.push_back(FgVect2F(parseObjFloat(toks[0],toks[1]),parseObjFloat(toks[2],toks[3])));
+            else
+                defer = true;
+        }
+        else if ((len >= 2) && (lb[0] == 'f') && (lb[1] == ' ')) {
+            size_t          numInds = chunk.inds.size();
+            // Joined lines aren't in the file so can't be referred to later:
+            if ((lb == joined.data()) || !parseObjFacet(lb+2,le,chunk)) {
+                chunk.inds.resize(numInds);
+                defer = true;
+            }
+            else
+                chunk.facets.back().text = lb;
+        }
+        if (defer) {
+            ObjDeferred         def;
+            def.text.assign(lb,le);
+            def.line = chunk.numLines;
+            def.numVerts = uint(chunk.verts.size());
+            def.numUvs = uint(chunk.uvs.size());
+            def.numFacets = chunk.facets.size();
+            chunk.deferred.push_back(def);
+        }
+        ++chunk.numLines;
+    }
+}
+
+// Merge state, which is the state of the line-by-line parse:
+struct  ObjMerge
+{
+    const FgString &            fname;
+    const string &              surfSeparator;
+    Fg3dMesh &                  mesh;
+    map<string,Fg3dSurface>     surfs;
+    string                      currName;
+    Fg3dSurface                 surf;
+    size_t                      numNgons;
+    bool                        vertexColors;
+    bool                        vertexHomogenous;
+    bool                        stopped;
+
+    ObjMerge(const FgString & f,const string & s,Fg3dMesh & m) :
+        fname(f), surfSeparator(s), mesh(m), numNgons(0),
+        vertexColors(false), vertexHomogenous(false), stopped(false)
+    {}
+
+    void
+    warnLine(size_t ii,const FgException & e,const string & line)
+    {
+        fgout << fgnl << "WARNING: Error in line " << ii+1 << " of " << fname << ": " << e.tr_message() << fgpush
+            << fgnl << line << fgpop;
+    }
+
+    void
+    closeSurf()
+    {
+        if (!surf.empty()) {
+            if (surfs.find(currName) == surfs.end())
+                surfs[currName] = surf;
+            else
+                surfs[currName].merge(surf);
+        }
+    }
+
+    // The original line by line logic. 'numVerts' and 'numUvs' are the counts preceding the line:
+    void
+    parseLine(size_t ii,const string & line,size_t numVerts,size_t numUvs)
+    {
+        try {
+            // Vertex lines are only deferred when malformed, so these throw:
+            if (line[0] == 'v') {
+                if (line[1] == ' ')
+                    parseVert(line.substr(2),vertexHomogenous,vertexColors);
+                if (line[1] == 't')
+                    if (line[2] == ' ')
+                        parseUv(line.substr(3));
+            }
+            if (line[0] == 'f') {
+                if (line[1] == ' ') {
+                    if (parseFacet(line.substr(2),numVerts,numUvs,surf.tris,surf.quads))
+                        ++numNgons;
+                }
+            }
+            if (!surfSeparator.empty() && fgStartsWith(line,surfSeparator)) {
+                vector<string>  words = fgSplitAtSeparators(line,' ');
+                if (words.size() != 2) {
+                    fgout << "WARNING: Invalid " << surfSeparator << " name on line " << ii << " of " << fname;
+                    stopped = true;
+                    return;
+                }
+                string          name = words[1];
+                if (currName != name) {
+                    closeSurf();
+                    currName = name;
+                    surf = Fg3dSurface();
+                }
+            }
+        }
+        catch(const FgException & e) {
+            warnLine(ii,e,line);
+        }
+    }
+
+    // Resolves a facet's indices as 'parseFacet' does, returning false if any are out of range:
+    bool
+    resolve(const int * inds,uint num,bool uvs,size_t numVerts,size_t numUvs,uint * dst)
+    {
+        uint            stride = uvs ? 2 : 1;
+        for (uint ii=0; ii<num*stride; ++ii) {
+            size_t          numLim = ((ii % stride) == 0) ? numVerts : numUvs;
+            int             idx = inds[ii] - 1;         // WOBJ indexing starts at 1
+            if (idx >= int(numLim))
+                return false;
+            if (idx < 0) {
+                if (size_t(-idx) > numLim)
+                    return false;
+                idx = int(numLim) + idx;
+            }
+            dst[ii] = uint(idx);
+        }
+        return true;
+    }
+
+    void
+    addFacet(const ObjChunk & chunk,const ObjFacet & facet,const int * inds,size_t lineBase,size_t vertBase,size_t uvBase)
+    {
+        size_t          numVerts = vertBase + facet.numVerts,
+                        numUvs = uvBase + facet.numUvs;
+        uint            r[2*objMaxCorners];
+        if (!resolve(inds,facet.numCorners,facet.uvs,numVerts,numUvs,r)) {
+            // Reparse to report the error exactly as a line by line parse would:
+            const char *    end = facet.text;
+            while ((end != chunk.end) && !isCrOrLf(*end))
+                ++end;
+            parseLine(lineBase+facet.line,string(facet.text,end),numVerts,numUvs);
+            return;
+        }
+        uint            s = facet.uvs ? 2 : 1;
+        if (facet.numCorners == 3) {
+            surf.tris.vertInds.push_back(FgVect3UI(r[0],r[s],r[2*s]));
+            if (facet.uvs)
+                surf.tris.uvInds.push_back(FgVect3UI(r[1],r[3],r[5]));
+        }
+        else if (facet.numCorners == 4) {
+            surf.quads.vertInds.push_back(FgVect4UI(r[0],r[s],r[2*s],r[3*s]));
+            if (facet.uvs)
+                surf.quads.uvInds.push_back(FgVect4UI(r[1],r[3],r[5],r[7]));
+        }
+        else {                                          // N-gon
+            for (uint ii=0; ii<facet.numCorners-2u; ++ii) {
+                surf.tris.vertInds.push_back(FgVect3UI(r[0],r[(ii+1)*s],r[(ii+2)*s]));
+                if (facet.uvs)
+                    surf.tris.uvInds.push_back(FgVect3UI(r[1],r[(ii+1)*s+1],r[(ii+2)*s+1]));
+            }
+            ++numNgons;
+        }
+    }
+
+    void
+    addChunk(const ObjChunk & chunk,size_t lineBase)
+    {
+        size_t          vertBase = mesh.verts.size(),
+                        uvBase = mesh.uvs.size(),
+                        ff = 0;
+        const int *     inds = chunk.inds.empty() ? NULL : &chunk.inds[0];
+        for (size_t dd=0; dd<=chunk.deferred.size(); ++dd) {
+            size_t          numFacets = (dd < chunk.deferred.size()) ? chunk.deferred[dd].numFacets : chunk.facets.size();
+            for (; ff<numFacets; ++ff) {
+                const ObjFacet &    facet = chunk.facets[ff];
+                addFacet(chunk,facet,inds,lineBase,vertBase,uvBase);
+                inds += facet.numCorners * (facet.uvs ? 2 : 1);
+            }
+            if (dd < chunk.deferred.size()) {
+                const ObjDeferred & def = chunk.deferred[dd];
+                parseLine(lineBase+def.line,def.text,vertBase+def.numVerts,uvBase+def.numUvs);
+                if (stopped) {
+                    addVerts(chunk,def.numVerts,def.numUvs);
+                    return;
+                }
+            }
+        }
+        addVerts(chunk,chunk.verts.size(),chunk.uvs.size());
+    }
+
+    void
+    addVerts(const ObjChunk & chunk,size_t numVerts,size_t numUvs)
+    {
+        mesh.verts.insert(mesh.verts.end(),chunk.verts.begin(),chunk.verts.begin()+numVerts);
+        mesh.uvs.insert(mesh.uvs.end(),chunk.uvs.begin(),chunk.uvs.begin()+numUvs);
+        if (chunk.homogenousAt < numVerts)
+            vertexHomogenous = true;
+        if (chunk.colorsAt < numVerts)
+            vertexColors = true;
+    }
+};
+
+// Chunks start after a line break not preceded by a backslash (ie. not a continuation):
+static
+vector<ObjChunk>
+objChunks(const char * data,size_t size,size_t chunkSize)
+{
+    vector<ObjChunk>    ret;
+    const char          *pos = data,
+                        *end = data + size;
+    while (pos != end) {
+        ObjChunk            chunk;
+        chunk.beg = pos;
+        const char *        brk = (size_t(end - pos) > chunkSize) ? pos + chunkSize : end;
+        while ((brk != end) && !(isCrOrLf(*brk) && !isCrOrLf(brk[-1]) && (brk[-1] != '\\')))
+            ++brk;
+        chunk.end = brk;
+        ret.push_back(chunk);
+        pos = brk;
+    }
+    return ret;
+}
+
+static
+Fg3dMesh
+loadWobj(
+    const char *        data,
+    size_t              size,
+    const FgString &    fname,
+    const string &      surfSeparator,
+    size_t              chunkSize)
+{
+    Fg3dMesh                    mesh;
+    ObjMerge                    merge(fname,surfSeparator,mesh);
+    vector<ObjChunk>            chunks = objChunks(data,size,chunkSize);
+    vector<FgJob>               jobs(chunks.size());
+    for (size_t ii=0; ii<chunks.size(); ++ii)
+        jobs[ii] = boost::bind(parseObjChunk,boost::cref(surfSeparator),&chunks[ii]);
+    fgThreadPool().run(jobs);
+    size_t                      lineBase = 0;
+    for (size_t ii=0; (ii<chunks.size()) && !merge.stopped; ++ii) {
+        merge.addChunk(chunks[ii],lineBase);
+        lineBase += chunks[ii].numLines;
+        chunks[ii] = ObjChunk();            // Release memory as we go
+    }
+    if (merge.numNgons > 0)
+        fgout << fgnl << "WARNING: " << merge.numNgons << " N-gons broken into tris in " << fname;
+    if (merge.vertexHomogenous)
+        fgout << fgnl << "WARNING: Vertex homogenous coordinates ignored.";
+    if (merge.vertexColors)
+        fgout << fgnl << "WARNING: Vertex color values ignored.";
+    merge.closeSurf();
+    mesh.name = fgPathToBase(fname);
+    for (map<string,Fg3dSurface>::iterator it = merge.surfs.begin(); it != merge.surfs.end(); ++it) {
+        Fg3dSurface &   srf = it->second;
+        if (!srf.tris.valid() || !srf.quads.valid()) {
+            srf.tris.uvInds.clear();
+            srf.quads.uvInds.clear();
+            fgout << fgnl << "WARNING: Partial UV indices ignored in " << fname << " surface " << it->first;
+        }
+        srf.name = it->first;
+        mesh.surfaces.push_back(srf);
+    }
+    // Some OBJ meshes make use of wrap aliasing in their UVs (eg. Daz Gen 3):
+    bool        uvsWrapped = false;
+    for (size_t ii=0; ii<mesh.uvs.size(); ++ii) {
+        FgVect2F &  uv = mesh.uvs[ii];
+        for (uint xx=0; xx<2; ++xx) {
+            if ((uv[xx] < 0.0f) || (uv[xx] > 1.0f)) {
+                uvsWrapped = true;
+                uv[xx] = uv[xx] - floor(uv[xx]);
+            }
+        }
+    }
+    if (uvsWrapped)
+        fgout << fgnl << "WARNING: UV indices unwrapped.";
+    return mesh;
+}
+
 Fg3dMesh
 fgLoadWobj(
     const FgString &    fname,
     string              surfSeparator)
+{
+    // Vertex lines matching the separator would be deferred to the merge, which doesn't add verts:
+    FGASSERT(surfSeparator.empty() || (surfSeparator[0] != 'v'));
+    FgFileMap           file(fname);
+    return loadWobj(file.data(),file.size(),fname,surfSeparator,size_t(1) << 22);
+}
+
+// The previous line by line loader (with the text passed in and warnings omitted), kept as an
+// independent reference for the above:
+static
+Fg3dMesh
+loadWobjRef(const string & text,const string & surfSeparator)
 {
     Fg3dMesh                    mesh;
     string                      currName;
     map<string,Fg3dSurface>     surfs;
-    vector<string>              lines = fgSplitLines(fgSlurp(fname));
+    vector<string>              lines = fgSplitLines(text);
     Fg3dSurface                 surf;
-    size_t                      numNgons = 0;
     bool                        vertexColors = false,
                                 vertexHomogenous = false;
     for (size_t ii=0; ii<lines.size(); ++ii) {
@@ -170,17 +772,13 @@ fgLoadWobj(
                         mesh.uvs.push_back(parseUv(line.substr(3)));
             }
             if (line[0] == 'f') {
-                if (line[1] == ' ') {
-                    if (parseFacet(line.substr(2),mesh.verts.size(),mesh.uvs.size(),surf.tris,surf.quads))
-                        ++numNgons;
-                }
+                if (line[1] == ' ')
+                    parseFacet(line.substr(2),mesh.verts.size(),mesh.uvs.size(),surf.tris,surf.quads);
             }
             if (!surfSeparator.empty() && fgStartsWith(line,surfSeparator)) {
                 vector<string>  words = fgSplitAtSeparators(line,' ');
-                if (words.size() != 2) {
-                    fgout << "WARNING: Invalid " << surfSeparator << " name on line " << ii << " of " << fname;
+                if (words.size() != 2)
                     break;
-                }
                 string          name = words[1];
                 if (currName != name) {
                     if (!surf.empty()) {
@@ -193,53 +791,146 @@ fgLoadWobj(
                     surf = Fg3dSurface();
                 }
             }
-            if (line[0] == '#')
-                continue;
-        }
-        catch(const FgException & e) {
-            fgout << fgnl << "WARNING: Error in line " << ii+1 << " of " << fname << ": " << e.tr_message() << fgpush
-                << fgnl << lines[ii] << fgpop;
         }
+        catch(const FgException &) {}
     }
-    if (numNgons > 0)
-        fgout << fgnl << "WARNING: " << numNgons << " N-gons broken into tris in " << fname;
-    if (vertexHomogenous)
-        fgout << fgnl << "WARNING: Vertex homogenous coordinates ignored.";
-    if (vertexColors)
-        fgout << fgnl << "WARNING: Vertex color values ignored.";
     if (!surf.empty()) {
         if (surfs.find(currName) == surfs.end())
             surfs[currName] = surf;
         else
             surfs[currName].merge(surf);
     }
-    mesh.name = fgPathToBase(fname);
     for (map<string,Fg3dSurface>::iterator it = surfs.begin(); it != surfs.end(); ++it) {
         Fg3dSurface &   srf = it->second;
         if (!srf.tris.valid() || !srf.quads.valid()) {
             srf.tris.uvInds.clear();
             srf.quads.uvInds.clear();
-            fgout << fgnl << "WARNING: Partial UV indices ignored in " << fname << " surface " << it->first;
         }
         srf.name = it->first;
         mesh.surfaces.push_back(srf);
     }
-    // Some OBJ meshes make use of wrap aliasing in their UVs (eg. Daz Gen 3):
-    bool        uvsWrapped = false;
     for (size_t ii=0; ii<mesh.uvs.size(); ++ii) {
         FgVect2F &  uv = mesh.uvs[ii];
-        for (uint xx=0; xx<2; ++xx) {
-            if ((uv[xx] < 0.0f) || (uv[xx] > 1.0f)) {
-                uvsWrapped = true;
+        for (uint xx=0; xx<2; ++xx)
+            if ((uv[xx] < 0.0f) || (uv[xx] > 1.0f))
                 uv[xx] = uv[xx] - floor(uv[xx]);
-            }
-        }
     }
-    if (uvsWrapped)
-        fgout << fgnl << "WARNING: UV indices unwrapped.";
     return mesh;
 }
 
+static
+void
+checkSameObj(const Fg3dMesh & mesh,const Fg3dMesh & ref)
+{
+    FGASSERT(mesh.verts == ref.verts);
+    FGASSERT(mesh.uvs == ref.uvs);
+    FGASSERT(mesh.surfaces.size() == ref.surfaces.size());
+    for (size_t ss=0; ss<ref.surfaces.size(); ++ss) {
+        const Fg3dSurface   &s0 = mesh.surfaces[ss],
+                            &s1 = ref.surfaces[ss];
+        FGASSERT(s0.name == s1.name);
+        FGASSERT(s0.tris.vertInds == s1.tris.vertInds);
+        FGASSERT(s0.tris.uvInds == s1.tris.uvInds);
+        FGASSERT(s0.quads.vertInds == s1.quads.vertInds);
+        FGASSERT(s0.quads.uvInds == s1.quads.uvInds);
+    }
+}
+
+void
+fgLoadWobjTest(const FgArgs &)
+{
+    // Float parsing must match 'istream >> float':
+    const char *    strs[] = {"0","-0.0","1","-1.5","+2.25",".5","5.","1e3","1E-3","1e","1e+",
+        "-","+",".","e5","1.2.3","1e5.3","12abc","\t3.5","0.1","0.3","123.456789","-987654.321",
+        "3.4028235e38","1e39","-1e39","1.17549435e-38","1e-40","1e-50","16777217","0.000000000000000000000123456789",
+        "1234567890123456789012345","9007199254740993","0.30000001192092896","nan","inf"};
+    for (size_t ii=0; ii<sizeof(strs)/sizeof(strs[0]); ++ii) {
+        string          str = strs[ii];
+        float           ref = parseFloat(str),
+                        val = parseObjFloat(str.data(),str.data()+str.size());
+        if (!(val == ref))
+            fgThrow("OBJ float parse mismatch",str);
+    }
+    fgRandSeedRepeatable();
+    for (uint ii=0; ii<100000; ++ii) {
+        ostringstream   oss;
+        oss.precision(1 + fgRandUint(12));
+        if (ii % 3 == 0)
+            oss << scientific;
+        oss << fgRandNormal() * std::pow(10.0,fgRandNormal() * 6.0);
+        string          str = oss.str();
+        float           ref = parseFloat(str),
+                        val = parseObjFloat(str.data(),str.data()+str.size());
+        if (!(val == ref))
+            fgThrow("OBJ float parse mismatch",str);
+    }
+    // Whole files must match the line by line parse, however they are broken into chunks:
+    string          text =
+        "# comment\n"
+        "v 0 0 0\n"
+        "v 1.5 0 0 1\n"
+        "v 1 1 0\n"
+        "v 0 1e-3 0\n"
+        "v  2 2 2\n"
+        "v 1 2\n"
+        "vt 0.5 0.5\n"
+        "vt 1.25 -0.5\n"
+        "vt 0 1 0\n"
+        "\n\n"
+        "usemtl matA\n"
+        "f 1 2 3\n"
+        "f 1/1 2/2 3/3 4/1\n"
+        "f -1 -2 -3\n"
+        "f 1 2 3 4 5\n"
+        "f 1/1 2 3\n"
+        "f 1 2 99\n"
+        "usemtl matB\r\n"
+        "f 1//1 2//2 3//3 \\\n"
+        "4//1\n"
+        "vn 0 0 1\n"
+        "f 2/3/1 3/2/1 4/1/1\n"
+        "usemtl matA\n"
+        "f 5 4 3\n"
+        "v 3 3 3\n"
+        "f -1 1 2\n"
+        "f 1/1/1 2/2/2 3/-1/3 4/-2/4 5/1/5";
+    string          stop = text + "\nusemtl bad name\nv 4 4 4\nf 1 2 3\n";
+    FgOutMute       mute;           // The text has deliberate errors
+    for (size_t cs=1; cs<64; cs+=5) {
+        checkSameObj(loadWobj(text.data(),text.size(),"test",string(),cs),loadWobjRef(text,string()));
+        checkSameObj(loadWobj(text.data(),text.size(),"test","usemtl",cs),loadWobjRef(text,"usemtl"));
+        checkSameObj(loadWobj(stop.data(),stop.size(),"test","usemtl",cs),loadWobjRef(stop,"usemtl"));
+    }
+    // Fixed expected values. Note that the line by line parse has relative index -N refer to
+    // the (N+1)th last vertex:
+    Fg3dMesh        mesh = loadWobj(text.data(),text.size(),"test","usemtl",1 << 20);
+    FGASSERT(mesh.verts.size() == 6);
+    FGASSERT(mesh.verts[1] == FgVect3F(1.5f,0,0));
+    FGASSERT(mesh.verts[3] == FgVect3F(0,1e-3f,0));
+    FGASSERT(mesh.verts[4] == FgVect3F(2,2,2));
+    FGASSERT(mesh.verts[5] == FgVect3F(3,3,3));
+    FGASSERT(mesh.uvs.size() == 3);
+    FGASSERT(mesh.uvs[1] == FgVect2F(0.25f,0.5f));      // Unwrapped
+    FGASSERT(mesh.surfaces.size() == 2);
+    const Fg3dSurface & matA = mesh.surfaces[0];
+    FGASSERT(matA.name == "matA");
+    FGASSERT(matA.tris.vertInds.size() == 10);
+    FGASSERT(matA.tris.vertInds[1] == FgVect3UI(3,2,1));
+    FGASSERT(matA.tris.vertInds[4] == FgVect3UI(0,3,4));
+    FGASSERT(matA.tris.vertInds[6] == FgVect3UI(4,0,1));
+    FGASSERT(matA.quads.vertInds == fgSvec(FgVect4UI(0,1,2,3)));
+    FGASSERT(matA.tris.uvInds.empty() && matA.quads.uvInds.empty());  // Partial UVs dropped
+    const Fg3dSurface & matB = mesh.surfaces[1];
+    FGASSERT(matB.name == "matB");
+    FGASSERT(matB.tris.vertInds == fgSvec(FgVect3UI(1,2,3)));
+    FGASSERT(matB.quads.vertInds == fgSvec(FgVect4UI(0,1,2,3)));      // Continued line
+    // Parsing stops at the invalid separator:
+    mesh = loadWobj(stop.data(),stop.size(),"test","usemtl",1 << 20);
+    FGASSERT(mesh.verts.size() == 6);
+    FGASSERT(mesh.surfaces.size() == 2);
+    FGASSERT(mesh.surfaces[0].tris.vertInds.size() == 10);
+}
+
 struct  Offsets
 {
     uint    vert;
@@ -254,7 +945,7 @@ struct  Offsets
 template<uint dim>
 void
 writeFacets(
-    FgOfstream &    ofs,
+    FgTextWriter &  ofs,
     const vector<FgMatrixC<uint,dim,1> > &  vertInds,
     const vector<FgMatrixC<uint,dim,1> > &  uvInds,
     Offsets         offsets)
@@ -297,10 +988,25 @@ writeMtlBase(
         << "    Ka 0 0 0\n";
 }
 
+template<uint dim>
+void
+writeVec(
+    const char *                            prefix,
+    const vector<FgMatrixC<float,dim,1> > * vecs,
+    FgTextWriter &                          ofs,
+    size_t                                  idx)
+{
+    const FgMatrixC<float,dim,1> &  vec = (*vecs)[idx];
+    ofs << prefix;
+    for (uint kk=0; kk<dim; ++kk)
+        ofs << " " << vec[kk];
+    ofs << "\n";
+}
+
 static
 Offsets
 writeMesh(
-    FgOfstream &        ofs,
+    FgTextWriter &      ofs,
     FgOfstream &        ofsMtl,
     const Fg3dMesh &    mesh,
     const FgPath &      fpath,
@@ -310,19 +1016,10 @@ writeMesh(
     if (!mesh.deltaMorphs.empty())
         fgout << endl << "WARNING: OBJ format does not support morphs";
 
-    for (uint ii=0; ii<mesh.verts.size(); ++ii) {
-        FgVect3F    vert = mesh.verts[ii];
-        ofs << "v " << vert[0] << " " << vert[1] << " " << vert[2] << endl;
-    }
-    for (size_t ii=0; ii<mesh.uvs.size(); ++ii) {
-        FgVect2F    uv = mesh.uvs[ii];
-        ofs << "vt " << uv[0] << " " << uv[1] << endl;
-    }
+    fgWriteItems(ofs,mesh.verts.size(),boost::bind(writeVec<3>,"v",&mesh.verts,_1,_2));
+    fgWriteItems(ofs,mesh.uvs.size(),boost::bind(writeVec<2>,"vt",&mesh.uvs,_1,_2));
     Fg3dNormals         norms = fgNormals(mesh.surfaces,mesh.verts);
-    for (size_t ii=0; ii<norms.vert.size(); ++ii) {
-        FgVect3F    n = norms.vert[ii];
-        ofs << "vn " << n[0] << " " << n[1] << " " << n[2] << endl;
-    }
+    fgWriteItems(ofs,norms.vert.size(),boost::bind(writeVec<3>,"vn",&norms.vert,_1,_2));
     for (uint tt=0; tt<mesh.surfaces.size(); ++tt) {
         if (mesh.surfaces[tt].albedoMap) {
             string  idxString = fgToString(offsets.mat+tt);
@@ -360,9 +1057,8 @@ fgSaveObj(
     for (size_t ii=0; ii<meshes.size(); ++ii)
         if (meshes[ii].numValidAlbedoMaps() > 0)
             texImage = true;
-    FgOfstream  ofs(fpath.dirBase()+".obj");
-    FgOfstream  ofsMtl;
-    ofs.precision(7);
+    FgTextWriter    ofs(fpath.dirBase()+".obj");
+    FgOfstream      ofsMtl;
     ofs <<
         "# Wavefront OBJ format.\n"
         "# Generated by FaceGen, for more information visit https://facegen.com\n";
@@ -383,6 +1079,53 @@ fgSaveObj(
             << "s 1" << endl;    // Enable smooth shading
         offsets = writeMesh(ofs,ofsMtl,meshes[ii],fpath,offsets,imgFormat);
     }
+    ofs.close();
+}
+
+void
+fgSaveObjTest(const FgArgs & args)
+{
+    FGTESTDIR
+    FgString            dd = fgDataDir();
+    string              rd = "base/";
+    vector<Fg3dMesh>    meshes;
+    meshes.push_back(fgLoadTri(dd+rd+"Mouth.tri"));
+    meshes.push_back(fgLoadTri(dd+rd+"Glasses.tri"));
+    // Enough values over a wide range of exponents to be formatted in parallel chunks:
+    fgRandSeedRepeatable();
+    Fg3dMesh            rnd;
+    for (uint ii=0; ii<10000; ++ii) {
+        FgVect3F        vert;
+        for (uint kk=0; kk<3; ++kk)
+            vert[kk] = float(fgRandNormal() * std::pow(10.0,fgRandNormal() * 6.0));
+        rnd.verts.push_back(vert);
+        rnd.uvs.push_back(FgVect2F(float(fgRandUniform(0,1)),float(fgRandUniform(0,1))));
+    }
+    rnd.verts[0] = FgVect3F(0.0f,-0.0f,1.0f);
+    rnd.verts[1] = FgVect3F(3.4028235e38f,-1.17549435e-38f,1e-5f);
+    rnd.verts[2] = FgVect3F(123456792.0f,0.1f,-1e9f);
+    rnd.surfaces.push_back(Fg3dSurface(fgSvec(FgVect3UI(0,1,2))));
+    rnd.surfaces[0].tris.uvInds = fgSvec(FgVect3UI(0,1,2));
+    meshes.push_back(rnd);
+    fgSaveObj("meshExportObj",meshes);
+    // Every value written must read back exactly:
+    Fg3dMesh            mesh = fgLoadWobj("meshExportObj.obj");
+    size_t              vv = 0,
+                        uu = 0;
+    for (size_t mm=0; mm<meshes.size(); ++mm) {
+        const Fg3dMesh &    ref = meshes[mm];
+        FGASSERT(mesh.verts.size() >= vv + ref.verts.size());
+        for (size_t ii=0; ii<ref.verts.size(); ++ii)
+            FGASSERT(mesh.verts[vv++] == ref.verts[ii]);
+        FGASSERT(mesh.uvs.size() >= uu + ref.uvs.size());
+        for (size_t ii=0; ii<ref.uvs.size(); ++ii,++uu)
+            for (uint xx=0; xx<2; ++xx)     // UVs are unwrapped by the loader
+                FGASSERT(mesh.uvs[uu][xx] == ref.uvs[ii][xx] - floor(ref.uvs[ii][xx]) ||
+                         mesh.uvs[uu][xx] == ref.uvs[ii][xx]);
+    }
+    FGASSERT(mesh.verts.size() == vv);
+    FGASSERT(mesh.uvs.size() == uu);
+    FGASSERT(fgMergeMeshes(meshes).numFacets() == mesh.numFacets());
 }
 
 // */
@@ -367,31 +367,125 @@ fgMergeSameNameSurfaces(const Fg3dMesh & in)
     return ret;
 }
 
+template<uint dim>
+struct  HashBits
+{
+    size_t
+    operator()(const FgMatrixC<float,dim,1> & v) const
+    {
+        // FNV-1a over the bit patterns:
+        size_t          ret = 2166136261U;
+        for (uint ii=0; ii<dim; ++ii) {
+            uint32      bits;
+            std::memcpy(&bits,&v[ii],4);
+            // -0 and +0 compare equal so must hash equal. This is done on the bits since
+            // fast-math assumes no signed zeros and removes floating point canonicalization:
+            if (bits == 0x80000000U)
+                bits = 0;
+            ret = (ret ^ bits) * 16777619U;
+        }
+        return ret;
+    }
+};
+
+template<uint dim>
+struct  HashCell
+{
+    size_t
+    operator()(const FgMatrixC<int,dim,1> & c) const
+    {
+        size_t          ret = 2166136261U;
+        for (uint ii=0; ii<dim; ++ii)
+            ret = (ret ^ size_t(c[ii])) * 16777619U;
+        return ret;
+    }
+};
+
+// Cell coordinates are clamped so that they and their neighbours fit in an int for any weld
+// distance or value. Clamped values share the outermost cells, which only costs speed since
+// distances are always checked:
+static inline
+int
+toCell(float val,double invCell)
+{
+    const double        lim = 1.0e9;
+    double              cc = std::floor(double(val) * invCell);
+    return int(std::max(-lim,std::min(lim,cc)));
+}
+
+// Returns the index of the representative value for each of 'vals', being the first value
+// it's unified with, in O(n). With 'weldDist' zero only equal values are unified, using a hash
+// of their bit patterns. Otherwise values are unified with the first representative within
+// 'weldDist', found by searching the neighbouring cells of a uniform grid of that size:
+template<uint dim>
+static
+vector<uint>
+unifyMap(const vector<FgMatrixC<float,dim,1> > & vals,float weldDist)
+{
+    typedef FgMatrixC<float,dim,1>  Val;
+    typedef FgMatrixC<int,dim,1>    Cell;
+    vector<uint>        ret(vals.size());
+    if (weldDist == 0.0f) {
+        std::unordered_map<Val,uint,HashBits<dim> >   reps;
+        reps.reserve(vals.size());
+        for (size_t ii=0; ii<vals.size(); ++ii)
+            ret[ii] = reps.insert(std::make_pair(vals[ii],uint(ii))).first->second;
+        return ret;
+    }
+    FGASSERT(weldDist > 0.0f);
+    double              invCell = 1.0 / double(weldDist);
+    float               distSqr = weldDist * weldDist;
+    // Each cell holds a linked list of the representatives within it:
+    std::unordered_map<Cell,uint,HashCell<dim> >      heads;
+    vector<uint>        next(vals.size());
+    const uint          none = numeric_limits<uint>::max();
+    uint                numNeighbours = 1;
+    for (uint dd=0; dd<dim; ++dd)
+        numNeighbours *= 3;
+    for (size_t ii=0; ii<vals.size(); ++ii) {
+        Cell            cell;
+        for (uint dd=0; dd<dim; ++dd)
+            cell[dd] = toCell(vals[ii][dd],invCell);
+        uint            best = none;
+        for (uint nn=0; nn<numNeighbours; ++nn) {
+            Cell        nc = cell;
+            for (uint dd=0, rem=nn; dd<dim; ++dd, rem/=3)
+                nc[dd] += int(rem % 3) - 1;
+            typename std::unordered_map<Cell,uint,HashCell<dim> >::const_iterator it = heads.find(nc);
+            if (it == heads.end())
+                continue;
+            for (uint rr=it->second; rr!=none; rr=next[rr])
+                if ((rr < best) && ((vals[rr]-vals[ii]).mag() <= distSqr))
+                    best = rr;
+        }
+        if (best == none) {
+            ret[ii] = uint(ii);
+            std::pair<typename std::unordered_map<Cell,uint,HashCell<dim> >::iterator,bool>
+                        ins = heads.insert(std::make_pair(cell,uint(ii)));
+            next[ii] = ins.second ? none : ins.first->second;
+            ins.first->second = uint(ii);
+        }
+        else
+            ret[ii] = best;
+    }
+    return ret;
+}
+
 Fg3dMesh
-fgUnifyIdenticalVerts(const Fg3dMesh & mesh)
+fgUnifyIdenticalVerts(const Fg3dMesh & mesh,float weldDist)
 {
     Fg3dMesh            ret(mesh);
-    FgVerts             verts;
-    vector<uint>        map;
-    map.reserve(mesh.verts.size());
-    uint                cnt = 0;
-    for (uint vv=0; vv<mesh.verts.size(); ++vv) {
-        bool            dup = false;
-        FgVect3F        v = mesh.verts[vv];
-        for (uint ww=0; ww<verts.size(); ++ww) {
-            if (verts[ww] == v) {
-                dup = true;
-                map.push_back(ww);
-                break;
-            }
-        }
-        if (!dup) {
-            verts.push_back(mesh.verts[vv]);
-            map.push_back(cnt);
-            ++cnt;
+    vector<uint>        reps = unifyMap(mesh.verts,weldDist),
+                        map(reps.size()),
+                        kept;               // Original index of each unified vert
+    for (uint vv=0; vv<reps.size(); ++vv) {
+        if (reps[vv] == vv) {
+            map[vv] = uint(kept.size());
+            kept.push_back(vv);
         }
+        else
+            map[vv] = map[reps[vv]];
     }
-    FGASSERT(mesh.verts.size() == map.size());
     for (size_t ss=0; ss<ret.surfaces.size(); ++ss) {
         Fg3dSurface &           surf = ret.surfaces[ss];
         for (size_t ii=0; ii<surf.tris.vertInds.size(); ++ii)
@@ -404,9 +498,10 @@ fgUnifyIdenticalVerts(const Fg3dMesh & mesh)
     for (size_t ii=0; ii<ret.deltaMorphs.size(); ++ii) {
         const FgMorph &     src = mesh.deltaMorphs[ii];
         FgMorph &           dst = ret.deltaMorphs[ii];
-        FGASSERT(dst.verts.size() == map.size());
-        for (size_t jj=0; jj<dst.verts.size(); ++jj)
-            dst.verts[jj] = src.verts[map[jj]];
+        FGASSERT(src.verts.size() == map.size());
+        dst.verts.resize(kept.size());
+        for (size_t jj=0; jj<kept.size(); ++jj)
+            dst.verts[jj] = src.verts[kept[jj]];
     }
     for (size_t ii=0; ii<ret.targetMorphs.size(); ++ii) {
         FgIndexedMorph &    im = ret.targetMorphs[ii];
@@ -415,29 +510,30 @@ fgUnifyIdenticalVerts(const Fg3dMesh & mesh)
     }
     for (size_t ii=0; ii<ret.markedVerts.size(); ++ii)
         ret.markedVerts[ii].idx = map[ret.markedVerts[ii].idx];
-    ret.verts = verts;
+    ret.verts.resize(kept.size());
+    for (size_t ii=0; ii<kept.size(); ++ii)
+        ret.verts[ii] = mesh.verts[kept[ii]];
     return ret;
 }
 
 Fg3dMesh
-fgUnifyIdenticalUvs(const Fg3dMesh & in)
+fgUnifyIdenticalUvs(const Fg3dMesh & in,float weldDist)
 {
     Fg3dMesh                    ret(in);
-    const vector<FgVect2F> &    uvs = ret.uvs;
-    vector<FgValid<uint> >      merge(uvs.size());
+    vector<uint>                reps = unifyMap(ret.uvs,weldDist);
     size_t                      cnt0 = 0,
                                 cnt1 = 0;
-    for (size_t ii=1; ii<uvs.size(); ++ii)
-        for (size_t jj=0; jj<ii-1; ++jj)
-            if (uvs[ii] == uvs[jj])
-                merge[ii] = uint(jj), ++cnt0;
+    for (size_t ii=0; ii<reps.size(); ++ii)
+        if (reps[ii] != ii)
+            ++cnt0;
     for (size_t ss=0; ss<ret.surfaces.size(); ++ss) {
         Fg3dSurface &           surf = ret.surfaces[ss];
         vector<FgVect3UI> &     triUvInds = surf.tris.uvInds;
         for (size_t ii=0; ii<triUvInds.size(); ++ii) {
             for (uint jj=0; jj<3; ++jj) {
-                if (merge[triUvInds[ii][jj]].valid()) {
-                    triUvInds[ii][jj] = merge[triUvInds[ii][jj]].val();
+                uint            rep = reps[triUvInds[ii][jj]];
+                if (rep != triUvInds[ii][jj]) {
+                    triUvInds[ii][jj] = rep;
                     ++cnt1;
                 }
             }
@@ -445,8 +541,9 @@ fgUnifyIdenticalUvs(const Fg3dMesh & in)
         vector<FgVect4UI> &     quadUvInds = surf.quads.uvInds;
         for (size_t ii=0; ii<quadUvInds.size(); ++ii) {
             for (uint jj=0; jj<4; ++jj) {
-                if (merge[quadUvInds[ii][jj]].valid()) {
-                    quadUvInds[ii][jj] = merge[quadUvInds[ii][jj]].val();
+                uint            rep = reps[quadUvInds[ii][jj]];
+                if (rep != quadUvInds[ii][jj]) {
+                    quadUvInds[ii][jj] = rep;
                     ++cnt1;
                 }
             }
@@ -65,11 +65,16 @@ fgNTent(uint nn);
 Fg3dMesh
 fgMergeSameNameSurfaces(const Fg3dMesh &);
 
+// Unify verts with identical positions, or within 'weldDist' of an earlier kept vert if non-zero.
+// Surfaces, target morph base indices and marked verts are remapped. Delta morphs keep the
+// delta of the first of each set of unified verts:
 Fg3dMesh
-fgUnifyIdenticalVerts(const Fg3dMesh &);
+fgUnifyIdenticalVerts(const Fg3dMesh &,float weldDist=0.0f);
 
+// Redirect UV indices to the first identical UV, or the first within 'weldDist' if non-zero.
+// The UV list itself is unchanged:
 Fg3dMesh
-fgUnifyIdenticalUvs(const Fg3dMesh &);
+fgUnifyIdenticalUvs(const Fg3dMesh &,float weldDist=0.0f);
 
 Fg3dMesh
 fgSplitSurfsByUvs(const Fg3dMesh &);
@@ -16,9 +16,23 @@
 #include "FgFileSystem.hpp"
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
+#include "FgTextWriter.hpp"
 
 using namespace std;
 
+static
+void
+writeVert(
+    const vector<FgVect3F> *    verts,
+    const vector<FgVect3F> *    norms,
+    FgTextWriter &              ofs,
+    size_t                      idx)
+{
+    FgVect3F    pos = (*verts)[idx],
+                nrm = (*norms)[idx];
+    ofs << pos[0] << " " << pos[1] << " " << pos[2] << " " << nrm[0] << " " << nrm[1] << " " << nrm[2] << "\n";
+}
+
 void
 fgSavePly(
     const FgString &        fname,
@@ -28,7 +42,7 @@ fgSavePly(
     Fg3dMesh    mesh = fgMergeMeshes(meshes);
     FgPath      path(fname);
     path.ext = "ply";
-    FgOfstream  ofs(path.str());
+    FgTextWriter    ofs(path.str());
     ofs <<
         "ply\n"
         "format ascii 1.0\n"
@@ -54,11 +68,7 @@ fgSavePly(
         << "property int texnumber" << endl
         << "end_header" << endl;
     Fg3dNormals         norms = fgNormals(mesh);
-    for (size_t vv=0; vv<mesh.verts.size(); ++vv) {
-        FgVect3F    pos = mesh.verts[vv],
-                    nrm = norms.vert[vv];
-        ofs << pos[0] << " " << pos[1] << " " << pos[2] << " " << nrm[0] << " " << nrm[1] << " " << nrm[2] << endl;
-    }
+    fgWriteItems(ofs,mesh.verts.size(),boost::bind(writeVert,&mesh.verts,&norms.vert,_1,_2));
     imgCnt = 0;
     for (size_t ss=0; ss<mesh.surfaces.size(); ++ss) {
         const Fg3dSurface &     surf = mesh.surfaces[ss];
@@ -80,6 +90,7 @@ fgSavePly(
         if (mesh.surfaces[ss].albedoMap)
             ++imgCnt;
     }
+    ofs.close();
 }
 
 void
@@ -10,49 +10,88 @@
 #include "stdafx.h"
 
 #include "Fg3dMesh.hpp"
+#include "Fg3dMeshIo.hpp"
 #include "FgException.hpp"
 #include "FgStdStream.hpp"
 #include "FgBounds.hpp"
 #include "FgFileSystem.hpp"
+#include "FgThread.hpp"
+#include "FgCommand.hpp"
 
 using namespace std;
 
 static string triIdent = "FRTRI003";
 
-static
-string
-readString(istream & istr,bool wchar)
+// Bounds-checked sequential reads from a TRI file in memory. Arrays are copied directly into
+// their destination since the data may not be aligned:
+struct  TriReader
 {
-    uint        size;
-    fgReadb(istr,size);
-    string      str;
-    if (size == 0)
-        return str;
-    str.resize(size);
-    for (uint ii=0; ii<size; ++ii) {
+    const char *        pos;
+    const char *        end;
+
+    TriReader(const char * data,size_t size) : pos(data), end(data+size) {}
+
+    const char *
+    skip(size_t bytes)
+    {
+        if (size_t(end-pos) < bytes)
+            fgThrow("TRI file is truncated");
+        const char *    ret = pos;
+        pos += bytes;
+        return ret;
+    }
+
+    template<class T>
+    void
+    read(T & val)
+    {memcpy(&val,skip(sizeof(T)),sizeof(T)); }
+
+    template<class T>
+    void
+    read(vector<T> & vec,size_t num)
+    {
+        vec.resize(num);
+        if (num > 0)
+            memcpy(&vec[0],skip(num*sizeof(T)),num*sizeof(T));
+    }
+
+    // Labels are stored with a null terminator required by spec. Unicode labels are stored as
+    // the platform 'wchar_t' and are converted to ASCII:
+    string
+    readLabel(bool wchar)
+    {
+        uint32          size;
+        read(size);
+        if (size == 0)
+            return string();
+        string          ret(size-1,0);
         if (wchar) {
-            wchar_t     wch;
-            fgReadb(istr,wch);
-            str[ii] = char(wch);
+            const char *    ptr = skip(size_t(size)*sizeof(wchar_t));
+            for (uint ii=0; ii<size-1; ++ii) {
+                wchar_t         wch;
+                memcpy(&wch,ptr+ii*sizeof(wchar_t),sizeof(wchar_t));
+                ret[ii] = char(wch);
+            }
         }
         else
-            istr.read(&str[ii],1);
+            ret.assign(skip(size),size-1);
+        return ret;
     }
-    // Get rid of NULL terminating character required by spec:
-    str.resize(size-1);
-    return str;
-}
+};
 
+static
 Fg3dMesh
-fgLoadTri(istream & istr)
+loadTri(const char * data,size_t size)
 {
     Fg3dMesh            mesh;
+    TriReader           rdr(data,size);
     // Check for file type identifier
-    char                cdata[9];
-    istr.read(cdata,8);
-    if (strncmp(cdata,"FRTRI103",8) == 0)
+    if (size < 8)
+        fgThrow("File not in TRI format");
+    const char *        ident = rdr.skip(8);
+    if (strncmp(ident,"FRTRI103",8) == 0)
         fgThrow("File is encrypted, use 'fileconvert' utility to decrypt");
-    if (strncmp(cdata,triIdent.data(),8) != 0)           // 0 indicates no difference
+    if (strncmp(ident,triIdent.data(),8) != 0)          // 0 indicates no difference
         fgThrow("File not in TRI format");
         // Read in the header
     uint32      numVerts,
@@ -65,116 +104,109 @@ fgLoadTri(istream & istr)
                 numDiffMorph,
                 numStatMorph,
                 numStatMorphVerts;
-    char        buff[16];
-    fgReadb(istr,numVerts);
-    fgReadb(istr,numTris);
-    fgReadb(istr,numQuads);
-    fgReadb(istr,numLabVerts);
-    fgReadb(istr,numSurfPts);
-    fgReadb(istr,numUvs);
-    fgReadb(istr,texExt);
-    fgReadb(istr,numDiffMorph);
-    fgReadb(istr,numStatMorph);
-    fgReadb(istr,numStatMorphVerts);
-    istr.read(buff,16);
+    rdr.read(numVerts);
+    rdr.read(numTris);
+    rdr.read(numQuads);
+    rdr.read(numLabVerts);
+    rdr.read(numSurfPts);
+    rdr.read(numUvs);
+    rdr.read(texExt);
+    rdr.read(numDiffMorph);
+    rdr.read(numStatMorph);
+    rdr.read(numStatMorphVerts);
+    rdr.skip(16);
     bool    texs = ((texExt & 0x01) != 0),
             wchar = ((texExt & 0x02) != 0);
     if (wchar)
         fgout << fgnl << "WARNING: Unicode labels being converted to ASCII.";
 
-    // Read in the verts:
+    // Read in the verts. Target morph verts are copied directly from the file into each morph below:
     FGASSERT(numVerts > 0);     // Valid TRI must have to have verts
-    mesh.verts.resize(numVerts);
-    vector<FgVect3F>    targVerts(numStatMorphVerts);
-    istr.read(reinterpret_cast<char*>(&mesh.verts[0]),int(12*numVerts));
-    if (numStatMorphVerts > 0)
-        istr.read(reinterpret_cast<char*>(&targVerts[0]),int(12*numStatMorphVerts));
+    rdr.read(mesh.verts,numVerts);
+    const char *        targVerts = rdr.skip(12*size_t(numStatMorphVerts));
 
     // Read in the surface (a TRI has only one):
     mesh.surfaces.resize(1);
     Fg3dSurface &           surf = mesh.surfaces[0];
-    surf.tris.vertInds.resize(numTris);
-    if (numTris > 0)
-        istr.read(reinterpret_cast<char*>(&surf.tris.vertInds[0]),int(12*numTris));
-    surf.quads.vertInds.resize(numQuads);
-    if (numQuads > 0)
-        istr.read(reinterpret_cast<char*>(&surf.quads.vertInds[0]),int(16*numQuads));
+    rdr.read(surf.tris.vertInds,numTris);
+    rdr.read(surf.quads.vertInds,numQuads);
     // Marked verts:
     mesh.markedVerts.resize(numLabVerts);
     for (uint jj=0; jj<numLabVerts; jj++) {
-        istr.read(reinterpret_cast<char*>(&mesh.markedVerts[jj].idx),4);
-        mesh.markedVerts[jj].label = readString(istr,wchar);
+        rdr.read(mesh.markedVerts[jj].idx);
+        mesh.markedVerts[jj].label = rdr.readLabel(wchar);
     }
     // Surface points:
+    surf.surfPoints.resize(numSurfPts);
     for (uint ii=0; ii<numSurfPts; ii++) {
-        FgSurfPoint     sp;
-        fgReadb(istr,sp.triEquivIdx);
-        fgReadb(istr,sp.weights);
-        sp.label = readString(istr,wchar);
-        surf.surfPoints.push_back(sp);
+        FgSurfPoint &   sp = surf.surfPoints[ii];
+        rdr.read(sp.triEquivIdx);
+        rdr.read(sp.weights);
+        sp.label = rdr.readLabel(wchar);
     }
     // Texture coordinates:
     if (numUvs > 0) {
-        surf.tris.uvInds.resize(surf.tris.vertInds.size());
-        surf.quads.uvInds.resize(surf.quads.vertInds.size());
-        mesh.uvs.resize(numUvs);
-        istr.read(reinterpret_cast<char*>(&mesh.uvs[0]),int(8*numUvs));
-        if (surf.tris.vertInds.size() > 0)
-            istr.read(reinterpret_cast<char*>(&surf.tris.uvInds[0]),int(12*numTris));
-        if (surf.quads.vertInds.size() > 0)
-            istr.read(reinterpret_cast<char*>(&surf.quads.uvInds[0]),int(16*numQuads));
+        rdr.read(mesh.uvs,numUvs);
+        rdr.read(surf.tris.uvInds,numTris);
+        rdr.read(surf.quads.uvInds,numQuads);
     }
     else if (texs) { // In the case of per vertex UVs we have to convert to indexed UVs
-        surf.tris.uvInds.resize(surf.tris.vertInds.size());
-        surf.quads.uvInds.resize(surf.quads.vertInds.size());
-        mesh.uvs.resize(mesh.verts.size());
-        istr.read(reinterpret_cast<char*>(&mesh.uvs[0]),int(8*numVerts));
-        for (uint ii=0; ii<surf.tris.vertInds.size(); ii++)
-            for (uint jj=0; jj<3; jj++)
-                surf.tris.uvInds[ii][jj] = surf.tris.vertInds[ii][jj];
-        for (uint ii=0; ii<surf.quads.vertInds.size(); ii++)
-            for (uint jj=0; jj<4; jj++)
-                surf.quads.uvInds[ii][jj] = surf.quads.vertInds[ii][jj];
+        rdr.read(mesh.uvs,numVerts);
+        surf.tris.uvInds = surf.tris.vertInds;
+        surf.quads.uvInds = surf.quads.vertInds;
     }
     // Delta morphs:
     mesh.deltaMorphs.resize(numDiffMorph);
     for (uint mm=0; mm<numDiffMorph; mm++) {
-        mesh.deltaMorphs[mm].name = readString(istr,wchar);
-        mesh.deltaMorphs[mm].verts.resize(numVerts);
-        float       scale;
-        fgReadb(istr,scale);
+        FgMorph &       morph = mesh.deltaMorphs[mm];
+        morph.name = rdr.readLabel(wchar);
+        morph.verts.resize(numVerts);
+        float           scale;
+        rdr.read(scale);
+        const char *    ptr = rdr.skip(6*size_t(numVerts));
         for (uint vv=0; vv<numVerts; vv++) {
-            FgVect3S    sval;
-            fgReadb(istr,sval);
-            mesh.deltaMorphs[mm].verts[vv] = FgVect3F(sval) * scale;
+            FgVect3S        sval;
+            memcpy(&sval,ptr+6*size_t(vv),6);
+            morph.verts[vv] = FgVect3F(sval) * scale;
         }
     }
     // Target morphs:
     size_t                      targVertsStart = 0;
     mesh.targetMorphs.reserve(numStatMorph);
     for (uint ii=0; ii<numStatMorph; ++ii) {
-        FgIndexedMorph       tm;
-        tm.name = readString(istr,wchar);
+        string                      name = rdr.readLabel(wchar);
         uint32                      numTargVerts;
-        fgReadb(istr,numTargVerts);
+        rdr.read(numTargVerts);
         if (numTargVerts > 0) {         // For some reason this is not the case in v2.0 eyes
-            tm.baseInds.resize(numTargVerts);
-            istr.read((char*)&tm.baseInds[0],4*numTargVerts);
-            tm.verts = fgSubvec(targVerts,targVertsStart,numTargVerts);
+            if (targVertsStart + numTargVerts > numStatMorphVerts)
+                fgThrow("TRI file target morph vertex count mismatch");
+            mesh.targetMorphs.push_back(FgIndexedMorph());
+            FgIndexedMorph &            tm = mesh.targetMorphs.back();
+            tm.name = name;
+            rdr.read(tm.baseInds,numTargVerts);
+            tm.verts.resize(numTargVerts);
+            memcpy(&tm.verts[0],targVerts+12*targVertsStart,12*size_t(numTargVerts));
             targVertsStart += numTargVerts;
-            mesh.targetMorphs.push_back(tm);
         }
     }
     return mesh;
 }
 
+// Reads the remainder of the stream:
+Fg3dMesh
+fgLoadTri(istream & istr)
+{
+    string          data((std::istreambuf_iterator<char>(istr)),std::istreambuf_iterator<char>());
+    return loadTri(data.data(),data.size());
+}
+
 Fg3dMesh
 fgLoadTri(const FgString & fname)
 {
     Fg3dMesh        ret;
     try {
-        FgIfstream      ff(fname);
-        ret = fgLoadTri(ff);
+        FgFileMap       file(fname);
+        ret = loadTri(file.data(),file.size());
     }
     catch (FgException & e) {
         e.m_ct.back().data = fname;
@@ -184,6 +216,22 @@ fgLoadTri(const FgString & fname)
     return ret;
 }
 
+static
+void
+loadTriJob(const FgString & fname,Fg3dMesh * mesh)
+{*mesh = fgLoadTri(fname); }
+
+vector<Fg3dMesh>
+fgLoadTris(const FgStrings & fnames)
+{
+    vector<Fg3dMesh>        ret(fnames.size());
+    vector<FgJob>           jobs(fnames.size());
+    for (size_t ii=0; ii<jobs.size(); ++ii)
+        jobs[ii] = boost::bind(loadTriJob,boost::cref(fnames[ii]),&ret[ii]);
+    fgThreadPool().run(jobs);
+    return ret;
+}
+
 Fg3dMesh
 fgLoadTri(
     const FgString &    meshFile,
@@ -300,3 +348,195 @@ fgSaveTri(
             fgWriteb(ff,uint32(morph.baseInds[jj]));
     }
 }
+
+// The original stream parser is kept as an independent reference for the mapped loader:
+static
+string
+readStringRef(istream & istr,bool wchar)
+{
+    uint        size;
+    fgReadb(istr,size);
+    string      str;
+    if (size == 0)
+        return str;
+    str.resize(size);
+    for (uint ii=0; ii<size; ++ii) {
+        if (wchar) {
+            wchar_t     wch;
+            fgReadb(istr,wch);
+            str[ii] = char(wch);
+        }
+        else
+            istr.read(&str[ii],1);
+    }
+    str.resize(size-1);
+    return str;
+}
+
+static
+Fg3dMesh
+loadTriRef(istream & istr)
+{
+    Fg3dMesh            mesh;
+    char                cdata[9];
+    istr.read(cdata,8);
+    FGASSERT(strncmp(cdata,triIdent.data(),8) == 0);
+    uint32      numVerts,
+                numTris,
+                numQuads,
+                numLabVerts,
+                numSurfPts,
+                numUvs,
+                texExt,
+                numDiffMorph,
+                numStatMorph,
+                numStatMorphVerts;
+    char        buff[16];
+    fgReadb(istr,numVerts);
+    fgReadb(istr,numTris);
+    fgReadb(istr,numQuads);
+    fgReadb(istr,numLabVerts);
+    fgReadb(istr,numSurfPts);
+    fgReadb(istr,numUvs);
+    fgReadb(istr,texExt);
+    fgReadb(istr,numDiffMorph);
+    fgReadb(istr,numStatMorph);
+    fgReadb(istr,numStatMorphVerts);
+    istr.read(buff,16);
+    bool    texs = ((texExt & 0x01) != 0),
+            wchar = ((texExt & 0x02) != 0);
+    mesh.verts.resize(numVerts);
+    vector<FgVect3F>    targVerts(numStatMorphVerts);
+    istr.read(reinterpret_cast<char*>(&mesh.verts[0]),int(12*numVerts));
+    if (numStatMorphVerts > 0)
+        istr.read(reinterpret_cast<char*>(&targVerts[0]),int(12*numStatMorphVerts));
+    mesh.surfaces.resize(1);
+    Fg3dSurface &           surf = mesh.surfaces[0];
+    surf.tris.vertInds.resize(numTris);
+    if (numTris > 0)
+        istr.read(reinterpret_cast<char*>(&surf.tris.vertInds[0]),int(12*numTris));
+    surf.quads.vertInds.resize(numQuads);
+    if (numQuads > 0)
+        istr.read(reinterpret_cast<char*>(&surf.quads.vertInds[0]),int(16*numQuads));
+    mesh.markedVerts.resize(numLabVerts);
+    for (uint jj=0; jj<numLabVerts; jj++) {
+        istr.read(reinterpret_cast<char*>(&mesh.markedVerts[jj].idx),4);
+        mesh.markedVerts[jj].label = readStringRef(istr,wchar);
+    }
+    for (uint ii=0; ii<numSurfPts; ii++) {
+        FgSurfPoint     sp;
+        fgReadb(istr,sp.triEquivIdx);
+        fgReadb(istr,sp.weights);
+        sp.label = readStringRef(istr,wchar);
+        surf.surfPoints.push_back(sp);
+    }
+    if (numUvs > 0) {
+        surf.tris.uvInds.resize(surf.tris.vertInds.size());
+        surf.quads.uvInds.resize(surf.quads.vertInds.size());
+        mesh.uvs.resize(numUvs);
+        istr.read(reinterpret_cast<char*>(&mesh.uvs[0]),int(8*numUvs));
+        if (surf.tris.vertInds.size() > 0)
+            istr.read(reinterpret_cast<char*>(&surf.tris.uvInds[0]),int(12*numTris));
+        if (surf.quads.vertInds.size() > 0)
+            istr.read(reinterpret_cast<char*>(&surf.quads.uvInds[0]),int(16*numQuads));
+    }
+    else if (texs) {
+        surf.tris.uvInds = surf.tris.vertInds;
+        surf.quads.uvInds = surf.quads.vertInds;
+        mesh.uvs.resize(mesh.verts.size());
+        istr.read(reinterpret_cast<char*>(&mesh.uvs[0]),int(8*numVerts));
+    }
+    mesh.deltaMorphs.resize(numDiffMorph);
+    for (uint mm=0; mm<numDiffMorph; mm++) {
+        mesh.deltaMorphs[mm].name = readStringRef(istr,wchar);
+        mesh.deltaMorphs[mm].verts.resize(numVerts);
+        float       scale;
+        fgReadb(istr,scale);
+        for (uint vv=0; vv<numVerts; vv++) {
+            FgVect3S    sval;
+            fgReadb(istr,sval);
+            mesh.deltaMorphs[mm].verts[vv] = FgVect3F(sval) * scale;
+        }
+    }
+    size_t                      targVertsStart = 0;
+    for (uint ii=0; ii<numStatMorph; ++ii) {
+        FgIndexedMorph       tm;
+        tm.name = readStringRef(istr,wchar);
+        uint32                      numTargVerts;
+        fgReadb(istr,numTargVerts);
+        if (numTargVerts > 0) {
+            tm.baseInds.resize(numTargVerts);
+            istr.read((char*)&tm.baseInds[0],4*numTargVerts);
+            tm.verts = fgSubvec(targVerts,targVertsStart,numTargVerts);
+            targVertsStart += numTargVerts;
+            mesh.targetMorphs.push_back(tm);
+        }
+    }
+    FGASSERT(istr);
+    return mesh;
+}
+
+static
+void
+checkTriEqual(const Fg3dMesh & mesh,const Fg3dMesh & ref)
+{
+    FGASSERT(mesh.verts == ref.verts);
+    FGASSERT(mesh.uvs == ref.uvs);
+    FGASSERT(mesh.surfaces.size() == 1);
+    const Fg3dSurface &     surf = mesh.surfaces[0],
+                            surfRef = ref.surfaces[0];
+    FGASSERT(surf.tris.vertInds == surfRef.tris.vertInds);
+    FGASSERT(surf.tris.uvInds == surfRef.tris.uvInds);
+    FGASSERT(surf.quads.vertInds == surfRef.quads.vertInds);
+    FGASSERT(surf.quads.uvInds == surfRef.quads.uvInds);
+    FGASSERT(surf.surfPoints.size() == surfRef.surfPoints.size());
+    for (size_t ii=0; ii<surf.surfPoints.size(); ++ii) {
+        FGASSERT(surf.surfPoints[ii].triEquivIdx == surfRef.surfPoints[ii].triEquivIdx);
+        FGASSERT(surf.surfPoints[ii].weights == surfRef.surfPoints[ii].weights);
+        FGASSERT(surf.surfPoints[ii].label == surfRef.surfPoints[ii].label);
+    }
+    FGASSERT(mesh.markedVerts.size() == ref.markedVerts.size());
+    for (size_t ii=0; ii<mesh.markedVerts.size(); ++ii) {
+        FGASSERT(mesh.markedVerts[ii].idx == ref.markedVerts[ii].idx);
+        FGASSERT(mesh.markedVerts[ii].label == ref.markedVerts[ii].label);
+    }
+    FGASSERT(mesh.deltaMorphs.size() == ref.deltaMorphs.size());
+    for (size_t ii=0; ii<mesh.deltaMorphs.size(); ++ii) {
+        FGASSERT(mesh.deltaMorphs[ii].name == ref.deltaMorphs[ii].name);
+        FGASSERT(mesh.deltaMorphs[ii].verts == ref.deltaMorphs[ii].verts);
+    }
+    FGASSERT(mesh.targetMorphs == ref.targetMorphs);
+}
+
+void
+fgLoadTriTest(const FgArgs & args)
+{
+    FGTESTDIR;
+    FgStrings           fnames;
+    fnames.push_back(fgDataDir()+"base/Jane.tri");
+    fnames.push_back(fgDataDir()+"base/Mouth.tri");
+    fnames.push_back(fgDataDir()+"base/Glasses.tri");
+    vector<Fg3dMesh>    meshes = fgLoadTris(fnames);
+    for (size_t ii=0; ii<fnames.size(); ++ii) {
+        const Fg3dMesh &    mesh = meshes[ii];
+        FGASSERT(mesh.name == fgPathToBase(fnames[ii]));
+        FgIfstream          ifs(fnames[ii]);
+        checkTriEqual(mesh,loadTriRef(ifs));
+        // Stream overload:
+        FgIfstream          ifs2(fnames[ii]);
+        checkTriEqual(fgLoadTri(ifs2),mesh);
+        // Round trip:
+        fgSaveTri("test.tri",mesh);
+        FgIfstream          ifs3("test.tri");
+        checkTriEqual(fgLoadTri("test.tri"),loadTriRef(ifs3));
+    }
+    // Truncated files throw rather than returning partial data:
+    string              data = fgSlurp("test.tri");
+    istringstream       iss(data.substr(0,data.size()-1));
+    bool                threw = false;
+    try {fgLoadTri(iss); }
+    catch (const FgException &) {threw = true; }
+    FGASSERT(threw);
+}
+
+// */
@@ -13,13 +13,16 @@
 #include "FgStdStream.hpp"
 #include "FgFileSystem.hpp"
 #include "FgTokenizer.hpp"
+#include "FgTextWriter.hpp"
+#include "FgCommand.hpp"
+#include "FgTestUtils.hpp"
 
 using namespace std;
 
 template<uint dim>
 void
 writePoint(
-    FgOfstream &            ofs,
+    FgTextWriter &          ofs,
     FgMatrixC<float,dim,1>  pnt)
 {
     ofs << "               ";
@@ -27,21 +30,28 @@ writePoint(
         ofs << " " << pnt[kk];
 }
 
+template<uint dim>
+void
+writePointItem(
+    const vector<FgMatrixC<float,dim,1> > * pts,
+    FgTextWriter &                          ofs,
+    size_t                                  idx)
+{
+    if (idx > 0)
+        ofs << ",\n";
+    writePoint(ofs,(*pts)[idx]);
+}
+
 template<uint dim>
 void
 writePoints(
-    FgOfstream &                            ofs,
+    FgTextWriter &                          ofs,
     const vector<FgMatrixC<float,dim,1> > & pts)
 {
     ofs <<
         "            point\n"
         "            [\n";
-    writePoint(ofs,pts[0]);
-    for (size_t jj=1; jj<pts.size(); ++jj)
-    {
-        ofs << ",\n";
-        writePoint(ofs,pts[jj]);
-    }
+    fgWriteItems(ofs,pts.size(),boost::bind(writePointItem<dim>,&pts,_1,_2));
     ofs << 
         "\n            ]\n";
 }
@@ -49,7 +59,7 @@ writePoints(
 template<uint dim>
 void
 writeIdx(
-    FgOfstream &          ofs,
+    FgTextWriter &        ofs,
     FgMatrixC<uint,dim,1> idx)
 {
     ofs << "            ";
@@ -61,7 +71,7 @@ writeIdx(
 template<uint dim>
 void
 writeIndices(
-    FgOfstream &                            ofs,
+    FgTextWriter &                          ofs,
     const vector<FgMatrixC<uint,dim,1> > &  inds)
 {
     if (inds.size() == 0) return;
@@ -80,8 +90,7 @@ fgSaveVrml(
     string                      imgFormat)
 {
     FGASSERT(meshes.size() > 0);
-    FgOfstream  ofs(filename);
-    ofs.precision(7);
+    FgTextWriter    ofs(filename);
     ofs <<
         "#VRML V2.0 utf8\n"
         "# Copyright 2015 Singular Inversions Inc. (facegen.com)\n"
@@ -180,6 +189,21 @@ fgSaveVrml(
             "    }\n"
             "}\n";
     }
+    ofs.close();
+}
+
+void
+fgSaveVrmlTest(const FgArgs & args)
+{
+    FGTESTDIR
+    FgString            dd = fgDataDir();
+    string              rd = "base/";
+    vector<Fg3dMesh>    meshes;
+    meshes.push_back(fgLoadTri(dd+rd+"Mouth.tri"));
+    meshes.back().surfaces[0].setAlbedoMap(fgLoadImgAnyFormat(dd+rd+"Mouth.tga"));
+    fgSaveVrml("meshExportVrml.wrl",meshes);
+    fgRegressFile("meshExportVrml.wrl","base/test/");
+    fgRegressFile("meshExportVrml0.png","base/test/");
 }
 
 // */
@@ -18,6 +18,7 @@
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
 #include "FgImageIo.hpp"
+#include "FgTextWriter.hpp"
 
 using namespace std;
 
@@ -37,7 +38,11 @@ static FgVect3F calQuadNormals(
         const vector<FgVect3F>        &vtxList,
         const vector<FgVect4UI>        &quadList,
         unsigned long                   quad);
-static string floatToString(float val);
+static FgFixed xsiFloat(float val);
+static void writeIndexedVec3(
+        const vector<FgVect3F>        *vecs,
+        FgTextWriter                    &ofs,
+        size_t                          pt);
 
 
 //****************************************************************************
@@ -81,11 +86,7 @@ static bool saveXsiFile(
 
     FgPath      path(fname);
     path.ext = "xsi";
-    FgOfstream ofs(path.str());
-    if (!ofs)
-    {
-        return false;
-    }
+    FgTextWriter ofs(path.str());
 
     //
     // Get object's bounding box (for camera and lighting info)
@@ -171,21 +172,21 @@ static bool saveXsiFile(
     ofs << "SI_Camera camera1\n";
     ofs << "{\n";
                 // Position
-    ofs << "   " << floatToString(camPos[0]) << "; " 
-                 << floatToString(camPos[1]) << "; " 
-                 << floatToString(camPos[2]) << ";;\n";
+    ofs << "   " << xsiFloat(camPos[0]) << "; " 
+                 << xsiFloat(camPos[1]) << "; " 
+                 << xsiFloat(camPos[2]) << ";;\n";
                 // Point of interest (camera direction)
-    ofs << "   " << floatToString(centroid[0]) << "; "
-                 << floatToString(centroid[1]) << "; "
-                 << floatToString(centroid[2]) << ";;\n";
+    ofs << "   " << xsiFloat(centroid[0]) << "; "
+                 << xsiFloat(centroid[1]) << "; "
+                 << xsiFloat(centroid[2]) << ";;\n";
                 // Roll
     ofs << "   0.0;\n";
                 // Field of view
     ofs << "   55.0;\n";
                 // Near plane units
-    ofs << "   " << floatToString(camNearPlane) << ";\n";
+    ofs << "   " << xsiFloat(camNearPlane) << ";\n";
                 // Far plane units
-    ofs << "   " << floatToString(camFarPlane) << ";\n";
+    ofs << "   " << xsiFloat(camFarPlane) << ";\n";
     ofs << "}\n";
     ofs << "\n" << flush;
     ofs << "SI_Ambience\n";
@@ -200,9 +201,9 @@ static bool saveXsiFile(
                 // Colour of light
     ofs << "   1.0; 1.0; 1.0;;\n";
                 // Position of light (above the camera)
-    ofs << "   " << floatToString(camPos[0]) << "; "
-                 << floatToString(hiBound[1]) << "; "
-                 << floatToString(camPos[2]) << ";;\n";
+    ofs << "   " << xsiFloat(camPos[0]) << "; "
+                 << xsiFloat(hiBound[1]) << "; "
+                 << xsiFloat(camPos[2]) << ";;\n";
     ofs << "}\n";
     ofs << "\n" << flush;
 
@@ -345,9 +346,9 @@ static bool saveXsiFile(
         for (pt=0; pt<vtxList.size(); ++pt)
         {
             ofs << "         "
-                << floatToString(vtxList[pt][0]) << ", "
-                << floatToString(vtxList[pt][1]) << ", "
-                << floatToString(vtxList[pt][2]) << ",\n";
+                << xsiFloat(vtxList[pt][0]) << ", "
+                << xsiFloat(vtxList[pt][1]) << ", "
+                << xsiFloat(vtxList[pt][2]) << ",\n";
 
             // Initialize the normal list to zero.
             normList[pt] = FgVect3F(0);
@@ -376,9 +377,9 @@ static bool saveXsiFile(
             float ln = normList[pt].length();
             if (ln > 0.0f) normList[pt] /= ln;
             ofs << "         "
-                << floatToString(normList[pt][0]) << ", "
-                << floatToString(normList[pt][1]) << ", "
-                << floatToString(normList[pt][2]) << ",\n";
+                << xsiFloat(normList[pt][0]) << ", "
+                << xsiFloat(normList[pt][1]) << ", "
+                << xsiFloat(normList[pt][2]) << ",\n";
         }
         if (perVertex || perFacet)
         {
@@ -388,8 +389,8 @@ static bool saveXsiFile(
             for (pt=0; pt<txtList.size(); ++pt)
             {
                 ofs << "         "
-                    << floatToString(txtList[pt][0]) << ", "
-                    << floatToString(txtList[pt][1]) << ", \n";
+                    << xsiFloat(txtList[pt][0]) << ", "
+                    << xsiFloat(txtList[pt][1]) << ", \n";
             }
         }
         ofs << "      }\n" << flush;
@@ -541,7 +542,7 @@ static bool saveXsiFile(
                     if (mm > 0)
                         mvtxList = &((*morphTargets)[mm-1].getPtList(xx));
 
-                    normList.resize( mvtxList->size() );
+                    normList.assign( mvtxList->size(), FgVect3F(0.0f) );
 
                     ofs << "\n";
                     ofs << "         SI_Shape SHP-" << objName 
@@ -557,16 +558,8 @@ static bool saveXsiFile(
                     ofs << "\n";
                     ofs << "            " << mvtxList->size() << ",\n";
                     ofs << "            \"POSITION\",\n";
-                    for (pt=0; pt<mvtxList->size(); ++pt)
-                    {
-                        ofs << "            " << pt << ", "
-                            << floatToString((*mvtxList)[pt][0]) << ", "
-                            << floatToString((*mvtxList)[pt][1]) << ", "
-                            << floatToString((*mvtxList)[pt][2]) << ",\n";
-
-                        // Initialize the normal list to zero.
-                        normList[pt] = FgVect3F(0.0f);
-                    }
+                    fgWriteItems(ofs,mvtxList->size(),
+                        boost::bind(writeIndexedVec3,mvtxList,_1,_2));
 
                     // New normal list.
                     size_t  tt;
@@ -593,11 +586,9 @@ static bool saveXsiFile(
                     {
                         float ln = normList[pt].length();
                         if (ln > 0.0f) normList[pt] /= ln;
-                        ofs << "            " << pt << ", "
-                            << floatToString(normList[pt][0]) << ", "
-                            << floatToString(normList[pt][1]) << ", "
-                            << floatToString(normList[pt][2]) << ",\n";
                     }
+                    fgWriteItems(ofs,normList.size(),
+                        boost::bind(writeIndexedVec3,&normList,_1,_2));
 
                     // Texture UV
                     if (perVertex || perFacet)
@@ -608,8 +599,8 @@ static bool saveXsiFile(
                         for (pt=0; pt<txtList.size(); ++pt)
                         {
                             ofs << "            " << pt << ", "
-                                << floatToString(txtList[pt][0]) << ", "
-                                << floatToString(txtList[pt][1]) << ", \n";
+                                << xsiFloat(txtList[pt][0]) << ", "
+                                << xsiFloat(txtList[pt][1]) << ", \n";
                         }
                     }
 
@@ -646,16 +637,8 @@ static bool saveXsiFile(
     //
     // Done.
     //
-    if (ofs.fail())
-    {
-        ofs.close();
-        return false;
-    }
-    else
-    {
-        ofs.close();
-        return true;
-    }
+    ofs.close();
+    return true;
 }
 
 
@@ -728,28 +711,30 @@ static FgVect3F calQuadNormals(
 
 
 //****************************************************************************
-//                              floatToString
+//                              xsiFloat
 //****************************************************************************
 //
 // Softimage|3D has a very old parser and requires all floating point output
 // to be printed as x.xxx even if the number doesn't have any decimal values.
 //
-static string floatToString(float val)
+static FgFixed xsiFloat(float val)
 {
-    char str[48];
+    return FgFixed(val,6);
+}
 
-    sprintf(str,"%#f",val);
-    size_t len=strlen(str);
-    if (len)
-    {
-        if (str[len-1] == '.')
-        {
-            str[len] = '0';
-            str[len+1] = 0;
-        }
-    }
 
-    return string(str);
+//****************************************************************************
+//                              writeIndexedVec3
+//****************************************************************************
+static void writeIndexedVec3(
+    const vector<FgVect3F>  *vecs,
+    FgTextWriter            &ofs,
+    size_t                  pt)
+{
+    ofs << "            " << pt << ", "
+        << xsiFloat((*vecs)[pt][0]) << ", "
+        << xsiFloat((*vecs)[pt][1]) << ", "
+        << xsiFloat((*vecs)[pt][2]) << ",\n";
 }
 
 void
@@ -13,6 +13,57 @@
 
 using namespace std;
 
+static
+FgVect3F
+triNorm(const FgVerts & verts,FgVect3UI tri)
+{
+    FgVect3F    v0 = verts[tri[0]],
+                v1 = verts[tri[1]],
+                v2 = verts[tri[2]];
+    FgVect3F    cross = fgCrossProduct((v1-v0),(v2-v0));    // CC winding
+    float       crossMag = cross.length();
+    if (crossMag == 0.0f)
+        return FgVect3F(0.0f);
+    return cross * (1.0f / crossMag);
+}
+
+// This least squares surface normal is taken from [Mantyla 87]:
+static
+FgVect3F
+quadNorm(const FgVerts & verts,FgVect4UI quad)
+{
+    FgVect3F    v0 = verts[quad[0]],
+                v1 = verts[quad[1]],
+                v2 = verts[quad[2]],
+                v3 = verts[quad[3]];
+    FgVect3F    cross;
+    cross[0] =  (v0[1]-v1[1]) * (v0[2]+v1[2]) +
+                (v1[1]-v2[1]) * (v1[2]+v2[2]) +
+                (v2[1]-v3[1]) * (v2[2]+v3[2]) +
+                (v3[1]-v0[1]) * (v3[2]+v0[2]);
+    cross[1] =  (v0[2]-v1[2]) * (v0[0]+v1[0]) +
+                (v1[2]-v2[2]) * (v1[0]+v2[0]) +
+                (v2[2]-v3[2]) * (v2[0]+v3[0]) +
+                (v3[2]-v0[2]) * (v3[0]+v0[0]);
+    cross[2] =  (v0[0]-v1[0]) * (v0[1]+v1[1]) +
+                (v1[0]-v2[0]) * (v1[1]+v2[1]) +
+                (v2[0]-v3[0]) * (v2[1]+v3[1]) +
+                (v3[0]-v0[0]) * (v3[1]+v0[1]);
+    float       crossMag = cross.length();
+    if (crossMag == 0.0f)
+        return FgVect3F(0.0f);
+    return cross * (1.0f / crossMag);
+}
+
+static
+void
+normalize(FgVect3F & norm)
+{
+    float       val = norm.length();
+    if(val > 0.0f)
+        norm *= (1.0f / val);
+}
+
 // Vertex normals are just approximated by a simple average of the facet normals of all
 // facets containing the vertex:
 void
@@ -32,52 +83,17 @@ fgCalcNormals(
         Fg3dFacetNormals &      fnorms(norms.facet[ss]);
         fnorms.tri.resize(surf.numTris());
         fnorms.quad.resize(surf.numQuads());
-
-        // TRIs
         for (uint ii=0; ii<surf.numTris(); ii++) {
             FgVect3UI   tri = surf.getTri(ii);
-            FgVect3F    v0 = verts[tri[0]],
-                        v1 = verts[tri[1]],
-                        v2 = verts[tri[2]];
-            FgVect3F    cross = fgCrossProduct((v1-v0),(v2-v0)),    // CC winding
-                        norm;
-            float       crossMag = cross.length();
-            if (crossMag == 0.0f)
-                norm = zero;
-            else
-                norm = cross * (1.0f / crossMag);
+            FgVect3F    norm = triNorm(verts,tri);
             fnorms.tri[ii] = norm;
             norms.vert[tri[0]] += norm;
             norms.vert[tri[1]] += norm;
             norms.vert[tri[2]] += norm;
         }
-
-        // QUADs
-        // This least squares surface normal is taken from [Mantyla 87]:
         for (uint ii=0; ii<surf.numQuads(); ii++) {
             FgVect4UI   quad = surf.getQuad(ii);
-            FgVect3F    v0 = verts[quad[0]],
-                        v1 = verts[quad[1]],
-                        v2 = verts[quad[2]],
-                        v3 = verts[quad[3]];
-            FgVect3F   cross,norm;
-            cross[0] =  (v0[1]-v1[1]) * (v0[2]+v1[2]) +
-                        (v1[1]-v2[1]) * (v1[2]+v2[2]) +
-                        (v2[1]-v3[1]) * (v2[2]+v3[2]) +
-                        (v3[1]-v0[1]) * (v3[2]+v0[2]);
-            cross[1] =  (v0[2]-v1[2]) * (v0[0]+v1[0]) +
-                        (v1[2]-v2[2]) * (v1[0]+v2[0]) +
-                        (v2[2]-v3[2]) * (v2[0]+v3[0]) +
-                        (v3[2]-v0[2]) * (v3[0]+v0[0]);
-            cross[2] =  (v0[0]-v1[0]) * (v0[1]+v1[1]) +
-                        (v1[0]-v2[0]) * (v1[1]+v2[1]) +
-                        (v2[0]-v3[0]) * (v2[1]+v3[1]) +
-                        (v3[0]-v0[0]) * (v3[1]+v0[1]);
-            float       crossMag = cross.length();
-            if (crossMag == 0.0f)
-                norm = zero;
-            else
-                norm = cross * (1.0f / crossMag);
+            FgVect3F    norm = quadNorm(verts,quad);
             fnorms.quad[ii] = norm;
             norms.vert[quad[0]] += norm;
             norms.vert[quad[1]] += norm;
@@ -87,11 +103,105 @@ fgCalcNormals(
     }
 
     // Normalize vertex normals:
-    for (size_t ii=0; ii<norms.vert.size(); ++ii) {
-        float       val = norms.vert[ii].length();
-        if(val > 0.0f)
-            norms.vert[ii] *= (1.0f / val);
-    }
+    for (size_t ii=0; ii<norms.vert.size(); ++ii)
+        normalize(norms.vert[ii]);
 
     return;
 }
+
+Fg3dVertFacets
+fgVertFacets(const vector<Fg3dSurface> & surfs,size_t numVerts)
+{
+    Fg3dVertFacets          ret;
+    ret.offsets.resize(numVerts+1,0);
+    // Count facets per vertex, then prefix sum to offsets:
+    for (size_t ss=0; ss<surfs.size(); ++ss) {
+        const Fg3dSurface &     surf = surfs[ss];
+        for (uint ii=0; ii<surf.numTris(); ++ii) {
+            FgVect3UI           tri = surf.getTri(ii);
+            for (uint jj=0; jj<3; ++jj)
+                ++ret.offsets[tri[jj]+1];
+        }
+        for (uint ii=0; ii<surf.numQuads(); ++ii) {
+            FgVect4UI           quad = surf.getQuad(ii);
+            for (uint jj=0; jj<4; ++jj)
+                ++ret.offsets[quad[jj]+1];
+        }
+    }
+    for (size_t ii=0; ii<numVerts; ++ii)
+        ret.offsets[ii+1] += ret.offsets[ii];
+    ret.facets.resize(ret.offsets.back());
+    // Fill in accumulation order so each vertex's list is in that order:
+    vector<uint>            pos(ret.offsets.begin(),ret.offsets.end()-1);
+    for (size_t ss=0; ss<surfs.size(); ++ss) {
+        const Fg3dSurface &     surf = surfs[ss];
+        for (uint ii=0; ii<surf.numTris(); ++ii) {
+            FgVect3UI           tri = surf.getTri(ii);
+            Fg3dVertFacets::Facet   facet(uint(ss),ii,false);
+            for (uint jj=0; jj<3; ++jj)
+                ret.facets[pos[tri[jj]]++] = facet;
+        }
+        for (uint ii=0; ii<surf.numQuads(); ++ii) {
+            FgVect4UI           quad = surf.getQuad(ii);
+            Fg3dVertFacets::Facet   facet(uint(ss),ii,true);
+            for (uint jj=0; jj<4; ++jj)
+                ret.facets[pos[quad[jj]]++] = facet;
+        }
+    }
+    return ret;
+}
+
+void
+fgUpdateNormals(
+    const vector<Fg3dSurface> & surfs,
+    const Fg3dVertFacets &      vertFacets,
+    const FgVerts &             verts,
+    const vector<uint> &        changedVerts,
+    Fg3dNormals &               norms)
+{
+    FGASSERT(vertFacets.offsets.size() == verts.size()+1);
+    FGASSERT(norms.vert.size() == verts.size());
+    FGASSERT(norms.facet.size() == surfs.size());
+    // Recompute the normals of all facets containing a changed vertex:
+    typedef Fg3dVertFacets::Facet   Facet;
+    vector<Facet>           facets;
+    for (size_t ii=0; ii<changedVerts.size(); ++ii) {
+        uint                vv = changedVerts[ii];
+        FGASSERT(vv < verts.size());
+        facets.insert(facets.end(),
+            vertFacets.facets.begin()+vertFacets.offsets[vv],
+            vertFacets.facets.begin()+vertFacets.offsets[vv+1]);
+    }
+    std::sort(facets.begin(),facets.end());
+    facets.erase(std::unique(facets.begin(),facets.end()),facets.end());
+    vector<uint>            dirtyVerts;
+    for (size_t ii=0; ii<facets.size(); ++ii) {
+        const Facet &       facet = facets[ii];
+        const Fg3dSurface & surf = surfs[facet.surf];
+        Fg3dFacetNormals &  fnorms = norms.facet[facet.surf];
+        if (facet.quad) {
+            FgVect4UI       quad = surf.getQuad(facet.idx);
+            fnorms.quad[facet.idx] = quadNorm(verts,quad);
+            dirtyVerts.insert(dirtyVerts.end(),quad.m,quad.m+4);
+        }
+        else {
+            FgVect3UI       tri = surf.getTri(facet.idx);
+            fnorms.tri[facet.idx] = triNorm(verts,tri);
+            dirtyVerts.insert(dirtyVerts.end(),tri.m,tri.m+3);
+        }
+    }
+    // Re-accumulate the vertex normals of those facets, in the same order as 'fgCalcNormals':
+    std::sort(dirtyVerts.begin(),dirtyVerts.end());
+    dirtyVerts.erase(std::unique(dirtyVerts.begin(),dirtyVerts.end()),dirtyVerts.end());
+    for (size_t ii=0; ii<dirtyVerts.size(); ++ii) {
+        uint                vv = dirtyVerts[ii];
+        FgVect3F            acc(0.0f);
+        for (uint jj=vertFacets.offsets[vv]; jj<vertFacets.offsets[vv+1]; ++jj) {
+            const Facet &   facet = vertFacets.facets[jj];
+            const Fg3dFacetNormals & fnorms = norms.facet[facet.surf];
+            acc += facet.quad ? fnorms.quad[facet.idx] : fnorms.tri[facet.idx];
+        }
+        normalize(acc);
+        norms.vert[vv] = acc;
+    }
+}
@@ -34,6 +34,51 @@ fgCalcNormals(
     const FgVerts &             verts,
     Fg3dNormals &               norms);     // RETURNED
 
+// Vertex to facet incidence, for updating normals when only some vertices have moved.
+// Each vertex's facets are listed in the order 'fgCalcNormals' accumulates them, so updated
+// normals match recalculated ones to within rounding:
+struct  Fg3dVertFacets
+{
+    struct  Facet
+    {
+        uint        surf;
+        uint        idx;        // Index into the tris or quads of 'surf'
+        bool        quad;
+
+        Facet() {}
+        Facet(uint s,uint i,bool q) : surf(s), idx(i), quad(q) {}
+
+        bool
+        operator<(const Facet & rhs) const
+        {
+            if (surf != rhs.surf) return (surf < rhs.surf);
+            if (quad != rhs.quad) return (rhs.quad);
+            return (idx < rhs.idx);
+        }
+
+        bool
+        operator==(const Facet & rhs) const
+        {return ((surf == rhs.surf) && (idx == rhs.idx) && (quad == rhs.quad)); }
+    };
+
+    vector<uint>    offsets;    // Facets of vertex 'vv' are [offsets[vv],offsets[vv+1]) in 'facets'
+    vector<Facet>   facets;
+};
+
+Fg3dVertFacets
+fgVertFacets(const vector<Fg3dSurface> & surfs,size_t numVerts);
+
+// Updates 'norms' previously calculated for 'surfs' after the vertices in 'changedVerts' have
+// moved to 'verts'. Only the facets containing those vertices, and the vertex normals of those
+// facets, are recomputed:
+void
+fgUpdateNormals(
+    const vector<Fg3dSurface> & surfs,
+    const Fg3dVertFacets &      vertFacets,     // fgVertFacets(surfs,verts.size())
+    const FgVerts &             verts,
+    const vector<uint> &        changedVerts,
+    Fg3dNormals &               norms);         // MODIFIED
+
 inline
 Fg3dNormals
 fgNormals(
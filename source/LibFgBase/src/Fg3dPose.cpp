@@ -49,6 +49,29 @@ fgWritep(std::ostream & os,const FgIndexedMorph & m)
     fgWritep(os,m.verts);
 }
 
+// Number of floats of the accumulator updated by all morphs before moving on, so it stays
+// in L1 cache rather than being streamed from memory once per morph:
+static const size_t     morphBlockSize = 4096;
+
+static
+void
+accBlocked(
+    const vector<const float *> &   deltas,     // Each of size 'num'
+    const FgFlts &                  coeffs,     // Same size as 'deltas'
+    size_t                          num,
+    float *                         acc)
+{
+    for (size_t beg=0; beg<num; beg+=morphBlockSize) {
+        size_t          end = std::min(beg+morphBlockSize,num);
+        for (size_t mm=0; mm<deltas.size(); ++mm) {
+            const float *   delta = deltas[mm];
+            float           coeff = coeffs[mm];
+            for (size_t ii=beg; ii<end; ++ii)
+                acc[ii] += delta[ii] * coeff;
+        }
+    }
+}
+
 void
 fgAccDeltaMorphs(
     const vector<FgMorph> &     deltaMorphs,
@@ -56,14 +79,160 @@ fgAccDeltaMorphs(
     FgVerts &                   accVerts)
 {
     FGASSERT(deltaMorphs.size() == coord.size());
+    vector<const float *>   deltas;
+    FgFlts                  coeffs;
     for (size_t ii=0; ii<deltaMorphs.size(); ++ii) {
         const FgMorph &     morph = deltaMorphs[ii];
         FGASSERT(morph.verts.size() == accVerts.size());
-        for (size_t jj=0; jj<accVerts.size(); ++jj)
-            accVerts[jj] += morph.verts[jj] * coord[ii];
+        if ((coord[ii] != 0.0f) && !accVerts.empty()) {
+            deltas.push_back(&morph.verts[0][0]);
+            coeffs.push_back(coord[ii]);
+        }
+    }
+    if (!deltas.empty())
+        accBlocked(deltas,coeffs,accVerts.size()*3,&accVerts[0][0]);
+}
+
+FgMorphBasis::FgMorphBasis(
+    const FgVerts &             base_,
+    const FgMorphs &            deltaMorphs,
+    const FgIndexedMorphs &     targMorphs)
+    : base(base_), deltas(deltaMorphs.size(),base_.size()*3),
+      targInds(targMorphs.size()), targDels(targMorphs.size())
+{
+    size_t              numVerts = base.size();
+    for (size_t ii=0; ii<deltaMorphs.size(); ++ii) {
+        const FgVerts &     verts = deltaMorphs[ii].verts;
+        FGASSERT(verts.size() == numVerts);
+        float *             dst = deltas.m_data.data() + ii * deltas.ncols;
+        for (size_t jj=0; jj<numVerts; ++jj)
+            for (uint dd=0; dd<3; ++dd)
+                dst[dd*numVerts+jj] = verts[jj][dd];
+    }
+    for (size_t ii=0; ii<targMorphs.size(); ++ii) {
+        const FgIndexedMorph &  morph = targMorphs[ii];
+        size_t              num = morph.baseInds.size();
+        FGASSERT(morph.verts.size() == num);
+        FgFlts &            dels = targDels[ii];
+        dels.resize(num*3);
+        for (size_t jj=0; jj<num; ++jj) {
+            uint                idx = morph.baseInds[jj];
+            FGASSERT(idx < numVerts);
+            FgVect3F            del = morph.verts[jj] - base[idx];
+            for (uint dd=0; dd<3; ++dd)
+                dels[dd*num+jj] = del[dd];
+        }
+        targInds[ii] = morph.baseInds;
+    }
+}
+
+// Accumulates the non-zero weighted sparse target morph deltas onto 'acc':
+static
+void
+accTargs(
+    const vector<FgUints> &     targInds,
+    const vector<FgFlts> &      targDels,
+    const float *               coeffs,     // targInds.size()
+    FgVect3F *                  acc)
+{
+    for (size_t ii=0; ii<targInds.size(); ++ii) {
+        float               val = coeffs[ii];
+        if (val == 0.0f)
+            continue;
+        const FgUints &     inds = targInds[ii];
+        size_t              num = inds.size();
+        const float         *xs = targDels[ii].data(),
+                            *ys = xs + num,
+                            *zs = ys + num;
+        for (size_t jj=0; jj<num; ++jj)
+            acc[inds[jj]] += FgVect3F(xs[jj],ys[jj],zs[jj]) * val;
     }
 }
 
+void
+FgMorphBasis::accDeltas(const FgFlts & coord,FgVerts & accVerts) const
+{
+    FGASSERT(coord.size() == numMorphs());
+    FGASSERT(accVerts.size() == base.size());
+    if (accVerts.empty())
+        return;
+    size_t                  numVerts = base.size();
+    vector<const float *>   rows;
+    FgFlts                  coeffs;
+    for (size_t ii=0; ii<deltas.nrows; ++ii) {
+        if (coord[ii] != 0.0f) {
+            rows.push_back(deltas.m_data.data() + ii*deltas.ncols);
+            coeffs.push_back(coord[ii]);
+        }
+    }
+    if (!rows.empty()) {
+        // Blocks of 'accVerts' are transposed into a buffer that stays in L1 cache while all
+        // active morphs are applied:
+        size_t              blockVerts = morphBlockSize / 3;
+        FgFlts              buf(morphBlockSize);
+        for (size_t beg=0; beg<numVerts; beg+=blockVerts) {
+            size_t              num = std::min(blockVerts,numVerts-beg);
+            float               *xs = &buf[0],
+                                *ys = xs + num,
+                                *zs = ys + num;
+            for (size_t jj=0; jj<num; ++jj) {
+                const FgVect3F &    v = accVerts[beg+jj];
+                xs[jj] = v[0];
+                ys[jj] = v[1];
+                zs[jj] = v[2];
+            }
+            for (size_t mm=0; mm<rows.size(); ++mm) {
+                float               coeff = coeffs[mm];
+                for (uint dd=0; dd<3; ++dd) {
+                    const float *       src = rows[mm] + dd*numVerts + beg;
+                    float *             dst = xs + dd*num;
+                    for (size_t jj=0; jj<num; ++jj)
+                        dst[jj] += src[jj] * coeff;
+                }
+            }
+            for (size_t jj=0; jj<num; ++jj)
+                accVerts[beg+jj] = FgVect3F(xs[jj],ys[jj],zs[jj]);
+        }
+    }
+    accTargs(targInds,targDels,coord.data()+deltas.nrows,&accVerts[0]);
+}
+
+FgVerts
+FgMorphBasis::morph(const FgFlts & coord) const
+{
+    FgVerts         ret = base;
+    accDeltas(coord,ret);
+    return ret;
+}
+
+vector<FgVerts>
+FgMorphBasis::morph(const vector<FgFlts> & coords) const
+{
+    size_t              numDeltas = deltas.nrows,
+                        numVerts = base.size();
+    vector<FgVerts>     ret(coords.size(),base);
+    if (numVerts == 0)
+        return ret;
+    FgMatrixF           coordMat(coords.size(),numDeltas);
+    for (size_t ii=0; ii<coords.size(); ++ii) {
+        FGASSERT(coords[ii].size() == numMorphs());
+        std::copy(coords[ii].begin(),coords[ii].begin()+numDeltas,coordMat.m_data.begin()+ii*numDeltas);
+    }
+    if (numDeltas > 0) {
+        FgMatrixF           delMat = coordMat * deltas;
+        for (size_t ii=0; ii<ret.size(); ++ii) {
+            const float         *xs = delMat.m_data.data() + ii*delMat.ncols,
+                                *ys = xs + numVerts,
+                                *zs = ys + numVerts;
+            for (size_t jj=0; jj<numVerts; ++jj)
+                ret[ii][jj] += FgVect3F(xs[jj],ys[jj],zs[jj]);
+        }
+    }
+    for (size_t ii=0; ii<ret.size(); ++ii)
+        accTargs(targInds,targDels,coords[ii].data()+numDeltas,&ret[ii][0]);
+    return ret;
+}
+
 void
 fgAccTargetMorphs(
     const FgVerts &             allVerts,
@@ -87,6 +256,71 @@ fgAccTargetMorphs(
     }
 }
 
+FgPoseBinding::FgPoseBinding(
+    const FgPoses &             poses,
+    size_t                      numBaseVerts,
+    const FgMorphs &            deltaMorphs,
+    const FgIndexedMorphs &     targMorphs)
+    : numPoses(poses.size())
+{
+    map<FgString,uint>      poseInds;
+    for (size_t ii=0; ii<poses.size(); ++ii)
+        poseInds[poses[ii].name] = uint(ii);
+    deltaPoses.resize(deltaMorphs.size(),uint(numPoses));
+    for (size_t ii=0; ii<deltaMorphs.size(); ++ii) {
+        map<FgString,uint>::const_iterator  it = poseInds.find(deltaMorphs[ii].name);
+        if (it != poseInds.end())
+            deltaPoses[ii] = it->second;
+    }
+    targPoses.resize(targMorphs.size(),uint(numPoses));
+    targOffsets.resize(targMorphs.size());
+    size_t                  offset = numBaseVerts;
+    for (size_t ii=0; ii<targMorphs.size(); ++ii) {
+        map<FgString,uint>::const_iterator  it = poseInds.find(targMorphs[ii].name);
+        if (it != poseInds.end())
+            targPoses[ii] = it->second;
+        targOffsets[ii] = offset;
+        offset += targMorphs[ii].baseInds.size();
+    }
+}
+
+void
+FgPoseBinding::accDeltas(
+    const FgFlts &              poseVals,
+    const FgMorphs &            deltaMorphs,
+    const FgIndexedMorphs &     targMorphs,
+    const FgVerts &             allVerts,
+    FgVerts &                   acc) const
+{
+    FGASSERT(poseVals.size() == numPoses);
+    FGASSERT((deltaMorphs.size() == deltaPoses.size()) && (targMorphs.size() == targPoses.size()));
+    vector<const float *>   deltas;
+    FgFlts                  coeffs;
+    for (size_t ii=0; ii<deltaMorphs.size(); ++ii) {
+        uint                pp = deltaPoses[ii];
+        if ((pp < numPoses) && (poseVals[pp] != 0.0f)) {
+            FGASSERT(deltaMorphs[ii].verts.size() == acc.size());
+            deltas.push_back(&deltaMorphs[ii].verts[0][0]);
+            coeffs.push_back(poseVals[pp]);
+        }
+    }
+    if (!deltas.empty())
+        accBlocked(deltas,coeffs,acc.size()*3,&acc[0][0]);
+    for (size_t ii=0; ii<targMorphs.size(); ++ii) {
+        uint                pp = targPoses[ii];
+        if ((pp < numPoses) && (poseVals[pp] != 0.0f)) {
+            const FgUints &     inds = targMorphs[ii].baseInds;
+            FGASSERT(targOffsets[ii] + inds.size() <= allVerts.size());
+            const FgVect3F *    targ = &allVerts[targOffsets[ii]];
+            float               val = poseVals[pp];
+            for (size_t jj=0; jj<inds.size(); ++jj) {
+                uint                idx = inds[jj];
+                acc[idx] += (targ[jj] - allVerts[idx]) * val;
+            }
+        }
+    }
+}
+
 void
 fgPoseDeltas(const std::map<FgString,float> & poseVals,const FgMorphs & deltaMorphs,FgVerts & acc)
 {
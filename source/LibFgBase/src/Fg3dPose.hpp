@@ -15,6 +15,7 @@
 #include "FgStdVector.hpp"
 #include "FgStdString.hpp"
 #include "FgMatrix.hpp"
+#include "FgMatrixV.hpp"
 #include "Fg3dSurface.hpp"
 #include "FgImage.hpp"
 #include "FgStdStream.hpp"
@@ -108,6 +109,45 @@ fgAccTargetMorphs(
     const FgFlts &              coord,      // morph coefficient for each target morph
     FgVerts &                   accVerts);  // MODIFIED: target morphing delta accumulated here
 
+// Delta and target morphs compiled for fast repeated evaluation. Delta morphs are stored as the
+// rows of a single matrix, each in structure of arrays order (all x, then all y, then all z).
+// Target morphs are kept sparse, as deltas from 'base' for only the verts they move, also in
+// structure of arrays order. Repeated base indices within a target morph accumulate as they
+// do in 'FgIndexedMorph::applyAsTarget_'. Building a basis copies every morph, so this is only
+// worthwhile when many coefficient vectors are evaluated against the same mesh. 'Fg3dMesh::morph'
+// evaluates a single coordinate in place and does not use it:
+struct  FgMorphBasis
+{
+    FgVerts             base;
+    FgMatrixF           deltas;     // deltaMorphs.size() x 3*base.size()
+    vector<FgUints>     targInds;   // Base vertex indices moved by each target morph
+    vector<FgFlts>      targDels;   // 3*targInds[ii].size() for each target morph
+
+    FgMorphBasis() {}
+
+    FgMorphBasis(
+        const FgVerts &             base,
+        const FgMorphs &            deltaMorphs,
+        const FgIndexedMorphs &     targMorphs=FgIndexedMorphs());
+
+    size_t
+    numMorphs() const
+    {return deltas.nrows + targInds.size(); }
+
+    // Accumulate the morph deltas weighted by 'coord' onto 'accVerts'. The delta morphs are
+    // applied in a single pass over 'accVerts'. Zero coefficients are skipped:
+    void
+    accDeltas(const FgFlts & coord,FgVerts & accVerts) const;
+
+    FgVerts
+    morph(const FgFlts & coord) const;
+
+    // Evaluate many coefficient vectors at once, with the delta morphs as a matrix product
+    // (uses fgThreadPool()):
+    vector<FgVerts>
+    morph(const vector<FgFlts> & coords) const;
+};
+
 // Current implementation supports at most 3 skin weights per vertex.
 struct  FgSkinWgt
 {
@@ -172,6 +212,35 @@ fgPoses(const FgIndexedMorphs & morphs)
     return ret;
 }
 
+// Pose names resolved once to the morphs of a mesh, so that repeated evaluation (eg. animation,
+// fitting, GUI sliders) works from a dense vector of pose values without name lookups:
+struct  FgPoseBinding
+{
+    size_t              numPoses;
+    FgUints             deltaPoses;     // Pose index of each delta morph. 'numPoses' if none.
+    FgUints             targPoses;      // Pose index of each target morph. 'numPoses' if none.
+    vector<size_t>      targOffsets;    // Start of each target morph's verts in 'allVerts' below
+
+    FgPoseBinding() : numPoses(0) {}
+
+    // If pose names are repeated the last one is bound, as with a name:value map:
+    FgPoseBinding(
+        const FgPoses &             poses,
+        size_t                      numBaseVerts,
+        const FgMorphs &            deltaMorphs,
+        const FgIndexedMorphs &     targMorphs);
+
+    // Accumulate the morph deltas for 'poseVals' (one per pose) onto 'acc'. Zero valued poses
+    // are skipped and delta morphs are accumulated together in a single blocked pass:
+    void
+    accDeltas(
+        const FgFlts &              poseVals,
+        const FgMorphs &            deltaMorphs,
+        const FgIndexedMorphs &     targMorphs,
+        const FgVerts &             allVerts,   // Base verts plus all target morph verts
+        FgVerts &                   acc) const;
+};
+
 // Accumulate deltas for delta morphs stored as a vertex array:
 void
 fgPoseDeltas(const std::map<FgString,float> & poseVals,const FgMorphs & deltaMorphs,FgVerts & acc);
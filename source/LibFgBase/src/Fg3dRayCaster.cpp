@@ -17,22 +17,24 @@ Fg3dRayCaster::Fg3dRayCaster(
     FgFuncShader                shader,
     FgAffine3F                  modelview,
     FgAffineCw2F                itcsToIucs,
-    FgRgbaF                     background)
+    FgRgbaF                     background,
+    FgVect2UI                   pixelSize)
     :
     m_shader(shader),
     m_background(background)
 {
     m_surfs.reserve(rs.size());
     for (size_t ii=0; ii<rs.size(); ++ii)
-        m_surfs.push_back(FgSurfRay(rs[ii],modelview,itcsToIucs));
+        m_surfs.push_back(FgSurfRay(rs[ii],modelview,itcsToIucs,FgVect2F(pixelSize)));
 }
 
 FgSurfRay::FgSurfRay(
     FgSurfPtr               rs,
     FgAffine3F              modelview,
-    FgAffineCw2F            itcsToIucs)
+    FgAffineCw2F            itcsToIucs,
+    FgVect2F                pixelsPerIucs_)
     :
-    surf(rs)
+    surf(rs), pixelsPerIucs(pixelsPerIucs_)
 {
     const FgVerts &         verts = *(surf.verts);
     depth.resize(verts.size());
@@ -54,40 +56,70 @@ FgSurfRay::FgSurfRay(
 FgRgbaF
 Fg3dRayCaster::operator()(FgVect2F posIucs) const
 {
-    // Find closest ray intersection:
-    FgBestN<float,Best,8>   bestAll;
-    for (size_t ii=0; ii<m_surfs.size(); ++ii) {
-        FgBestN<float,FgTriPoint,8>
-            best = m_surfs[ii].cast(posIucs);
-        for (uint jj=0; jj<best.num(); ++jj)
-            if (!bestAll.update(best[jj].key,Best(ii,best[jj].val)))
-                break;
+    FgRgbaF     ret;
+    castPacket(&posIucs,1,&ret);
+    return ret;
+}
+
+template<uint N>
+static
+void
+castLanes(
+    const Fg3dRayCaster &   rc,
+    const FgVect2F *        posIucs,
+    uint                    num,
+    FgRgbaF *               ret)
+{
+    // Find closest ray intersections:
+    FgBestN<float,Fg3dRayCaster::Best,8>    bestAll[N];
+    for (size_t ii=0; ii<rc.m_surfs.size(); ++ii) {
+        FgTriPointsByDepth  best[N];
+        rc.m_surfs[ii].castPacket(posIucs,num,best);
+        for (uint ll=0; ll<num; ++ll)
+            for (uint jj=0; jj<best[ll].num(); ++jj)
+                if (!bestAll[ll].update(best[ll][jj].key,Fg3dRayCaster::Best(ii,best[ll][jj].val)))
+                    break;
+    }
+    for (uint ll=0; ll<num; ++ll) {
+        const FgBestN<float,Fg3dRayCaster::Best,8> &    ba = bestAll[ll];
+        FgRgbaF     acc = rc.m_background;
+        for (uint ii=ba.num(); ii>0; --ii)
+            acc = fgCompositeFragment(
+                rc.m_surfs[ba[ii-1].val.surfIdx].shade(rc.m_shader,ba[ii-1].val.intersect),
+                acc);
+        ret[ll] = acc;
+    }
+}
+
+void
+Fg3dRayCaster::castPacket(const FgVect2F * posIucs,uint num,FgRgbaF * ret) const
+{
+    const uint          np = fgGridPacketSize;
+    for (uint base=0; base<num; base+=np) {
+        uint            nl = std::min(num-base,np);
+        if (nl == 1)
+            castLanes<1>(*this,posIucs+base,nl,ret+base);
+        else if (nl <= 4)
+            castLanes<4>(*this,posIucs+base,nl,ret+base);
+        else
+            castLanes<np>(*this,posIucs+base,nl,ret+base);
     }
-    FgRgbaF     acc = m_background;
-    for (uint ii=bestAll.num(); ii>0; --ii)
-        acc = fgCompositeFragment(
-            m_surfs[bestAll[ii-1].val.surfIdx].shade(m_shader,bestAll[ii-1].val.intersect),
-            acc);
-    return acc;
 }
 
-FgBestN<float,FgTriPoint,8>
+FgTriPointsByDepth
 FgSurfRay::cast(FgVect2F posIucs)
     const
 {
-    FgBestN<float,FgTriPoint,8> retval;
-    std::vector<FgTriPoint>  intersects = grid.intersects(*(surf.vertInds),vertsIucs,posIucs);
-    for (size_t ii=0; ii<intersects.size(); ++ii) {
-        FgTriPoint  isect = intersects[ii];
-        float   newDepth =
-            isect.baryCoord[0] * depth[isect.pointInds[0]] +
-            isect.baryCoord[1] * depth[isect.pointInds[1]] +
-            isect.baryCoord[2] * depth[isect.pointInds[2]];
-        retval.update(newDepth,isect);
-    }
-    return retval;
+    FgTriPointsByDepth  ret;
+    castPacket(&posIucs,1,&ret);
+    return ret;
 }
 
+void
+FgSurfRay::castPacket(const FgVect2F * posIucs,uint num,FgTriPointsByDepth * ret)
+    const
+{grid.intersectsPacket(*(surf.vertInds),vertsIucs,depth,posIucs,num,ret); }
+
 FgRgbaF
 FgSurfRay::shade(
     FgFuncShader        shader,
@@ -101,11 +133,15 @@ FgSurfRay::shade(
                        bCoord[2] * norms[tri[2]];
     norm /= norm.length();
     FgVect3UI   uvInds = (*surf.uvInds)[intersect.triInd];
-    FgVect2F    uv = bCoord[0] * (*surf.uvs)[uvInds[0]] +
-                     bCoord[1] * (*surf.uvs)[uvInds[1]] +
-                     bCoord[2] * (*surf.uvs)[uvInds[2]];
-    uv[1] = 1.0f - uv[1];   // OTCS to IUCS
-    return shader(norm,uv,surf.material,surf.texImg);
+    FgVect2F    uvs[3],
+                pos[3];
+    for (uint ii=0; ii<3; ++ii) {
+        uvs[ii] = (*surf.uvs)[uvInds[ii]];
+        uvs[ii][1] = 1.0f - uvs[ii][1];     // OTCS to IUCS
+        pos[ii] = fgMapMul(vertsIucs[tri[ii]],pixelsPerIucs);
+    }
+    FgVect2F    uv = bCoord[0] * uvs[0] + bCoord[1] * uvs[1] + bCoord[2] * uvs[2];
+    return shader(norm,uv,fgTriUvPerPos(pos,uvs),surf.material,surf.texImg);
 }
 
 // */
@@ -15,8 +15,12 @@
 #include "FgGridTriangles.hpp"
 #include "FgBestN.hpp"
 #include "FgAffineCwC.hpp"
+#include "FgImagePyramid.hpp"
 
-typedef boost::function<FgRgbaF(FgVect3F,FgVect2F,FgMaterial,const FgImgRgbaUb *)>   FgFuncShader;
+// Arguments are the OECS normal, the texture coordinate (IUCS), its derivatives with respect to
+// the output pixel X and Y (columns, zero if unknown), the material and the albedo map:
+typedef boost::function<FgRgbaF(FgVect3F,FgVect2F,FgMat22F,FgMaterial,const FgImgPyramidRgbaUb *)>
+    FgFuncShader;
 
 struct  FgSurfPtr
 {
@@ -26,9 +30,29 @@ struct  FgSurfPtr
     const Fg3dNormals *         norms;
     const vector<FgVect2F> *    uvs;        // Can be NULL
     const vector<FgVect3UI> *   uvInds;     // Can be NULL
-    const FgImgRgbaUb *         texImg;     // Can be NULL
+    const FgImgPyramidRgbaUb *  texImg;     // Can be NULL
 };
 
+// Derivatives of the texture coordinates with respect to screen position over a triangle,
+// treating the projection as affine across the triangle. Zero if the triangle is degenerate:
+inline
+FgMat22F
+fgTriUvPerPos(const FgVect2F pos[3],const FgVect2F uvs[3])
+{
+    FgVect2F    p1 = pos[1] - pos[0],
+                p2 = pos[2] - pos[0],
+                u1 = uvs[1] - uvs[0],
+                u2 = uvs[2] - uvs[0];
+    float       det = p1[0]*p2[1] - p2[0]*p1[1];
+    if (det == 0.0f)
+        return FgMat22F(0.0f);
+    float       id = 1.0f / det;
+    // [u1 u2] * inverse([p1 p2]):
+    return FgMat22F(
+        (u1[0]*p2[1] - u2[0]*p1[1])*id, (u2[0]*p1[0] - u1[0]*p2[0])*id,
+        (u1[1]*p2[1] - u2[1]*p1[1])*id, (u2[1]*p1[0] - u1[1]*p2[0])*id);
+}
+
 struct  FgSurfRay
 {
     FgSurfPtr                   surf;
@@ -36,16 +60,24 @@ struct  FgSurfRay
     vector<float>               depth;      // CCS Z
     vector<FgVect3F>            norms;
     FgVect2Fs                   vertsIucs;
+    FgVect2F                    pixelsPerIucs;  // For texture footprints. Zero if unknown
 
     FgSurfRay() {}
     FgSurfRay(
         FgSurfPtr               rs,
         FgAffine3F              modelview,
-        FgAffineCw2F            itcsToIucs);
+        FgAffineCw2F            itcsToIucs,
+        FgVect2F                pixelsPerIucs=FgVect2F(0.0f));
 
-    FgBestN<float,FgTriPoint,8>
+    FgTriPointsByDepth
     cast(FgVect2F posIucs) const;
 
+    void
+    castPacket(
+        const FgVect2F *        posIucs,
+        uint                    num,
+        FgTriPointsByDepth *    ret) const;     // RETURNED: 'num' results
+
     FgRgbaF
     shade(
         FgFuncShader            shader,
@@ -63,7 +95,8 @@ struct  Fg3dRayCaster
         FgFuncShader            shader,
         FgAffine3F              modelview,
         FgAffineCw2F            itcsToIucs,
-        FgRgbaF                 background);
+        FgRgbaF                 background,
+        FgVect2UI               pixelSize=FgVect2UI(0));    // For texture filtering. 0: unfiltered
 
     virtual FgRgbaF
     operator()(FgVect2F posIucs) const;
@@ -72,6 +105,13 @@ struct  Fg3dRayCaster
     cast(FgVect2F p) const
     {return this->operator()(p); }
 
+    // Casts neighbouring sample positions together for efficiency (see 'FgFuncSamples'):
+    void
+    castPacket(
+        const FgVect2F *        posIucs,
+        uint                    num,
+        FgRgbaF *               ret) const;     // RETURNED: 'num' results
+
     struct Best
     {
         size_t                  surfIdx;
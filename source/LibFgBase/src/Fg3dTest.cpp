@@ -18,6 +18,7 @@
 #include "FgCommand.hpp"
 #include "Fg3dTopology.hpp"
 #include "FgAffine1.hpp"
+#include "FgRandom.hpp"
 
 using namespace std;
 
@@ -153,13 +154,180 @@ edgeDist(const FgArgs &)
     fgViewMesh(mesh);
 }
 
+// Split each facet onto its own verts then check that unification recovers the original
+// topology, both for identical and slightly perturbed verts:
+static
+void
+unifyVerts(const FgArgs &)
+{
+    Fg3dMesh                    cube = fgCube();
+    const vector<FgVect3UI> &   tris = cube.surfaces[0].tris.vertInds;
+    FgVerts                     verts;
+    vector<FgVect3UI>           split;
+    for (size_t tt=0; tt<tris.size(); ++tt) {
+        uint        base = uint(verts.size());
+        split.push_back(FgVect3UI(base,base+1,base+2));
+        for (uint jj=0; jj<3; ++jj)
+            verts.push_back(cube.verts[tris[tt][jj]]);
+    }
+    Fg3dMesh                    mesh(verts,split);
+    mesh.deltaMorphs.push_back(FgMorph("identity",verts));
+    mesh.markedVerts.push_back(FgMarkedVert(uint(verts.size()-1),"last"));
+    Fg3dMesh                    uni = fgUnifyIdenticalVerts(mesh);
+    FGASSERT(uni.verts.size() == cube.verts.size());
+    FGASSERT(uni.deltaMorphs[0].verts == uni.verts);
+    FGASSERT(uni.verts[uni.markedVerts[0].idx] == verts.back());
+    for (size_t tt=0; tt<tris.size(); ++tt)
+        for (uint jj=0; jj<3; ++jj)
+            FGASSERT(uni.verts[uni.surfaces[0].tris.vertInds[tt][jj]] == cube.verts[tris[tt][jj]]);
+    for (size_t ii=0; ii<mesh.verts.size(); ++ii)
+        mesh.verts[ii] += FgVect3F(float(ii) * 0.00001f);
+    FGASSERT(fgUnifyIdenticalVerts(mesh).verts.size() == mesh.verts.size());
+    Fg3dMesh                    weld = fgUnifyIdenticalVerts(mesh,0.001f);
+    FGASSERT(weld.verts.size() == cube.verts.size());
+    for (size_t tt=0; tt<tris.size(); ++tt)
+        for (uint jj=0; jj<3; ++jj)
+            FGASSERT((weld.verts[weld.surfaces[0].tris.vertInds[tt][jj]]-cube.verts[tris[tt][jj]]).length() < 0.001f);
+    // Signed zeros compare equal so must be unified. The bits are set directly since fast-math
+    // may not preserve the sign of a negated zero:
+    float                       negZero;
+    uint32                      negZeroBits = 0x80000000U;
+    memcpy(&negZero,&negZeroBits,4);
+    FgVerts                     zeros;
+    zeros.push_back(FgVect3F(0.0f,1.0f,0.0f));
+    zeros.push_back(FgVect3F(negZero,1.0f,0.0f));
+    zeros.push_back(FgVect3F(0.0f,1.0f,negZero));
+    zeros.push_back(FgVect3F(negZero,1.0f,negZero));
+    zeros.push_back(FgVect3F(1.0f,negZero,0.0f));
+    zeros.push_back(FgVect3F(1.0f,0.0f,0.0f));
+    Fg3dMesh                    zmesh(zeros,fgSvec(FgVect3UI(0,1,4),FgVect3UI(2,3,5)));
+    FGASSERT(fgUnifyIdenticalVerts(zmesh).verts.size() == 2);
+    FGASSERT(fgUnifyIdenticalVerts(zmesh,0.001f).verts.size() == 2);
+    // Weld cells must not overflow for large values relative to the weld distance:
+    FgVerts                     far;
+    far.push_back(FgVect3F(3.0e38f,-3.0e38f,1.0f));
+    far.push_back(FgVect3F(3.0e38f,-3.0e38f,1.0f));
+    far.push_back(FgVect3F(-1.0e30f,2.0e30f,0.0f));
+    Fg3dMesh                    fmesh(far,fgSvec(FgVect3UI(0,1,2)));
+    FGASSERT(fgUnifyIdenticalVerts(fmesh,1.0e-30f).verts.size() == 2);
+}
+
+// Brute force edge distances by relaxation over all edges until nothing changes:
+static
+vector<float>
+edgeDistRef(const Fg3dMesh & mesh,const vector<uint> & seeds)
+{
+    const vector<FgVect3UI> &   tris = mesh.surfaces[0].tris.vertInds;
+    vector<float>               ret(mesh.verts.size(),numeric_limits<float>::max());
+    for (size_t ii=0; ii<seeds.size(); ++ii)
+        ret[seeds[ii]] = 0.0f;
+    for (bool done=false; !done;) {
+        done = true;
+        for (size_t tt=0; tt<tris.size(); ++tt) {
+            for (uint jj=0; jj<3; ++jj) {
+                uint        v0 = tris[tt][jj],
+                            v1 = tris[tt][(jj+1)%3];
+                float       len = (mesh.verts[v1]-mesh.verts[v0]).length();
+                if (ret[v0] + len < ret[v1]) { ret[v1] = ret[v0] + len; done = false; }
+                if (ret[v1] + len < ret[v0]) { ret[v0] = ret[v1] + len; done = false; }
+            }
+        }
+    }
+    return ret;
+}
+
+// Distances are sums along different paths of equal length so are only equal to within
+// rounding:
+static
+bool
+edgeDistsEqual(const vector<float> & dists,const vector<float> & ref)
+{
+    if (dists.size() != ref.size())
+        return false;
+    for (size_t ii=0; ii<ref.size(); ++ii)
+        if (!fgApproxEqualRel(dists[ii],ref[ii],0.00001))
+            return false;
+    return true;
+}
+
+// Check the edge distance maps against a brute force relaxation, for single and multiple
+// seeds and a bounded radius:
+static
+void
+edgeDistMap(const FgArgs &)
+{
+    Fg3dMesh                    mesh = fgSubdivide(fgSubdivide(fgOctahedron()));
+    Fg3dTopology                topo(mesh.verts,mesh.surfaces[0].tris.vertInds);
+    vector<uint>                seeds;
+    seeds.push_back(0);
+    seeds.push_back(uint(mesh.verts.size()/2));
+    vector<float>               ref = edgeDistRef(mesh,seeds);
+    Fg3dTopology::DistScratch   scratch;
+    vector<float>               dists;
+    topo.edgeDistanceMap(mesh.verts,seeds,numeric_limits<float>::max(),dists,scratch);
+    FGASSERT(edgeDistsEqual(dists,ref));
+    float                       maxDist = fgMax(ref) * 0.5f;
+    topo.edgeDistanceMap(mesh.verts,seeds,maxDist,dists,scratch);
+    for (size_t ii=0; ii<ref.size(); ++ii) {
+        if (dists[ii] == numeric_limits<float>::max())
+            FGASSERT(ref[ii] > maxDist * 0.99999f);
+        else {
+            FGASSERT(dists[ii] <= maxDist);
+            FGASSERT(fgApproxEqualRel(dists[ii],ref[ii],0.00001));
+        }
+    }
+    vector<float>               single = topo.edgeDistanceMap(mesh.verts,seeds[0]),
+                                singleRef = edgeDistRef(mesh,fgSvec(seeds[0]));
+    FGASSERT(single[seeds[0]] == 0.0f);
+    FGASSERT(edgeDistsEqual(single,singleRef));
+}
+
+// Incremental normal updates for a moved vertex subset must match a full recalculation (to
+// within rounding, since fast-math code generation may differ), for both tris and quads:
+static
+void
+normalsUpdate(const FgArgs &)
+{
+    Fg3dMesh                    mesh = fgLoadTri(fgDataDir()+"base/Jane.tri");
+    FGASSERT(mesh.surfaces[0].numQuads() > 0);
+    Fg3dNormals                 norms = fgNormals(mesh);
+    Fg3dVertFacets              vertFacets = fgVertFacets(mesh.surfaces,mesh.verts.size());
+    fgRandSeedRepeatable();
+    for (uint rr=0; rr<5; ++rr) {
+        vector<uint>            changed;
+        for (uint ii=0; ii<20; ++ii) {
+            uint                vv = fgRandUint(uint(mesh.verts.size()));
+            mesh.verts[vv] += FgVect3F(float(fgRandNormal()),float(fgRandNormal()),float(fgRandNormal())) * 0.1f;
+            changed.push_back(vv);
+        }
+        fgUpdateNormals(mesh.surfaces,vertFacets,mesh.verts,changed,norms);
+        Fg3dNormals             ref = fgNormals(mesh);
+        for (size_t ii=0; ii<ref.vert.size(); ++ii)
+            FGASSERT((norms.vert[ii]-ref.vert[ii]).mag() < 1e-10f);
+        for (size_t ss=0; ss<ref.facet.size(); ++ss) {
+            for (size_t ii=0; ii<ref.facet[ss].tri.size(); ++ii)
+                FGASSERT((norms.facet[ss].tri[ii]-ref.facet[ss].tri[ii]).mag() < 1e-10f);
+            for (size_t ii=0; ii<ref.facet[ss].quad.size(); ++ii)
+                FGASSERT((norms.facet[ss].quad[ii]-ref.facet[ss].quad[ii]).mag() < 1e-10f);
+        }
+    }
+}
+
 void
 fg3dTest(const FgArgs & args)
 {
     vector<FgCmd>   cmds;
+    cmds.push_back(FgCmd(edgeDistMap,"edgeDistMap"));
+    cmds.push_back(FgCmd(normalsUpdate,"normalsUpdate"));
+    cmds.push_back(FgCmd(unifyVerts,"unifyVerts"));
     FGADDCMD(fgSave3dsTest,"3ds",".3DS file format export");
     FGADDCMD(fgSaveLwoTest,"lwo","Lightwve object file format export");
     FGADDCMD(fgSaveMaTest,"ma","Maya ASCII file format export");
+    FGADDCMD(fgSaveObjTest,"obj","OBJ file format export");
+    FGADDCMD(fgSaveVrmlTest,"vrml","VRML file format export");
+    FGADDCMD(fgLoadWobjTest,"objLoad","OBJ file format import");
+    FGADDCMD(fgLoadFgmeshTest,"fgmeshLoad","FaceGen mesh file format versions");
+    FGADDCMD(fgLoadTriTest,"triLoad","FaceGen TRI file format import");
     fgMenu(args,cmds,true,false,true);
 }
 
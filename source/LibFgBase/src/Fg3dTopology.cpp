@@ -42,147 +42,164 @@ Fg3dTopology::Edge::otherVertIdx(uint vertIdx) const
     return 0;       // make compiler happy
 }
 
-struct  EdgeVerts
+// Stable LSD radix sort of 'keys' with their 'vals', 16 bits per pass. Passes are skipped for
+// digits which are the same for all keys, so small meshes need fewer passes:
+static
+void
+radixSort(
+    vector<uint64> &    keys,
+    vector<uint> &      vals)
 {
-    uint        loIdx;
-    uint        hiIdx;
-
-    EdgeVerts(uint i0,uint i1)
-    {
-        if (i0 < i1) {
-            loIdx = i0;
-            hiIdx = i1;
+    FGASSERT(keys.size() == vals.size());
+    const uint          numBuckets = 1 << 16;
+    vector<uint64>      keysTmp(keys.size());
+    vector<uint>        valsTmp(vals.size()),
+                        counts(numBuckets);
+    for (uint shift=0; shift<64; shift+=16) {
+        std::fill(counts.begin(),counts.end(),0);
+        for (size_t ii=0; ii<keys.size(); ++ii)
+            ++counts[(keys[ii] >> shift) & 0xFFFF];
+        if (keys.empty() || (counts[(keys[0] >> shift) & 0xFFFF] == keys.size()))
+            continue;
+        uint            acc = 0;
+        for (uint bb=0; bb<numBuckets; ++bb) {
+            uint        cnt = counts[bb];
+            counts[bb] = acc;
+            acc += cnt;
         }
-        else {
-            loIdx = i1;
-            hiIdx = i0;
+        for (size_t ii=0; ii<keys.size(); ++ii) {
+            uint        dst = counts[(keys[ii] >> shift) & 0xFFFF]++;
+            keysTmp[dst] = keys[ii];
+            valsTmp[dst] = vals[ii];
         }
-        FGASSERT(i0 != i1);
+        keys.swap(keysTmp);
+        vals.swap(valsTmp);
     }
+}
 
-    // Comparison operator to use as a key for std::map:
-    bool operator<(const EdgeVerts & rhs) const
-    {
-        if (loIdx < rhs.loIdx)
-            return true;
-        else if (loIdx == rhs.loIdx)
-            return (hiIdx < rhs.hiIdx);
-        else
-            return false;
-    }
-
-    bool
-    contains(uint idx) const
-    {return ((idx == loIdx) || (idx == hiIdx)); }
-};
-
-struct  TriVerts
+// Fill 'offsets' and 'inds' with the CSR form of the relation 'pairs' (from,to). Within each
+// 'from' the 'to' values are in the order of 'pairs':
+static
+void
+buildCsr(
+    uint                        numFrom,
+    const vector<FgVect2UI> &   pairs,
+    vector<uint> &              offsets,
+    vector<uint> &              inds)
 {
-    FgVect3UI   inds;
-
-    TriVerts(FgVect3UI i)
-    {
-        if (i[1] < i[0])
-            std::swap(i[0],i[1]);
-        if (i[2] < i[1])
-            std::swap(i[1],i[2]);
-        if (i[1] < i[0])
-            std::swap(i[0],i[1]);
-        inds = i;
-    }
-
-    bool operator<(const TriVerts & rhs) const
-    {
-        for (uint ii=0; ii<3; ++ii) {
-            if (inds[ii] < rhs.inds[ii])
-                return true;
-            else if (inds[ii] == rhs.inds[ii])
-                continue;
-            else
-                return false;
-        }
-        return false;
-    }
-};
+    offsets.assign(numFrom+1,0);
+    for (size_t ii=0; ii<pairs.size(); ++ii)
+        ++offsets[pairs[ii][0]+1];
+    for (uint ii=0; ii<numFrom; ++ii)
+        offsets[ii+1] += offsets[ii];
+    inds.resize(pairs.size());
+    vector<uint>        pos(offsets.begin(),offsets.end()-1);
+    for (size_t ii=0; ii<pairs.size(); ++ii)
+        inds[pos[pairs[ii][0]]++] = pairs[ii][1];
+}
 
 Fg3dTopology::Fg3dTopology(
     const FgVerts &             verts,
     const vector<FgVect3UI> &   tris)
 {
-    // Detect null or duplicate tris:
+    // Detect null or duplicate tris by sorting on their ordered vertex indices (lexicographically
+    // by 2 stable sorts); duplicates are then adjacent with the first occurrence first:
     uint                    duplicates = 0,
                             nulls = 0;
-    set<TriVerts>           vset;
+    vector<FgVect3UI>       ordered;
+    vector<uint64>          keys;
+    vector<uint>            triInds;
+    ordered.reserve(tris.size());
+    keys.reserve(tris.size());
+    triInds.reserve(tris.size());
     for (size_t ii=0; ii<tris.size(); ++ii) {
         FgVect3UI           vis = tris[ii];
         if ((vis[0] == vis[1]) || (vis[1] == vis[2]) || (vis[2] == vis[0]))
             ++nulls;
         else {
-            TriVerts            tv(vis);
-            if (vset.find(tv) == vset.end()) {
-                vset.insert(tv);
-                Tri             tri;
-                tri.vertInds = vis;
-                m_tris.push_back(tri);
-            }
-            else
-                ++duplicates;
+            if (vis[1] < vis[0])
+                std::swap(vis[0],vis[1]);
+            if (vis[2] < vis[1])
+                std::swap(vis[1],vis[2]);
+            if (vis[1] < vis[0])
+                std::swap(vis[0],vis[1]);
+            keys.push_back((uint64(vis[1]) << 32) | vis[2]);
+            triInds.push_back(uint(ii));
         }
+        ordered.push_back(vis);
+    }
+    radixSort(keys,triInds);
+    for (size_t ii=0; ii<triInds.size(); ++ii)
+        keys[ii] = ordered[triInds[ii]][0];
+    radixSort(keys,triInds);
+    vector<bool>            keep(tris.size(),false);
+    for (size_t ii=0; ii<triInds.size(); ++ii) {
+        if ((ii > 0) && (ordered[triInds[ii]] == ordered[triInds[ii-1]]))
+            ++duplicates;
+        else
+            keep[triInds[ii]] = true;
     }
     if (duplicates > 0)
         fgout << fgnl << "WARNING: Duplicate tris: " << duplicates;
     if (nulls > 0)
         fgout << fgnl << "WARNING: Null tris: " << nulls;
-    m_verts.resize(verts.size());
-    std::map<EdgeVerts,vector<uint> >    edgesToTris;
+    m_tris.reserve(tris.size()-duplicates-nulls);
+    for (size_t ii=0; ii<tris.size(); ++ii) {
+        if (keep[ii]) {
+            Tri             tri;
+            tri.vertInds = tris[ii];
+            m_tris.push_back(tri);
+        }
+    }
+    // Sort all tri edges by their ordered vertex indices to find the unique edges, with
+    // the tris of each edge in increasing order:
+    size_t                  numTriEdges = m_tris.size()*3;
+    vector<uint>            triEdges(numTriEdges);  // tri index * 3 + relative edge index
+    keys.resize(numTriEdges);
     for (size_t ii=0; ii<m_tris.size(); ++ii) {
-        FgVect3UI       vertInds = m_tris[ii].vertInds;
-        m_tris[ii].edgeInds = FgVect3UI(std::numeric_limits<uint>::max());
+        FgVect3UI           vis = m_tris[ii].vertInds;
         for (uint jj=0; jj<3; ++jj) {
-            m_verts[vertInds[jj]].triInds.push_back(uint(ii));
-            EdgeVerts        edge(vertInds[jj],vertInds[(jj+1)%3]);
-            edgesToTris[edge].push_back(uint(ii));
+            uint            v0 = vis[jj],
+                            v1 = vis[(jj+1)%3];
+            if (v1 < v0)
+                std::swap(v0,v1);
+            keys[ii*3+jj] = (uint64(v0) << 32) | v1;
+            triEdges[ii*3+jj] = uint(ii*3+jj);
         }
     }
-    for (map<EdgeVerts,vector<uint> >::const_iterator it=edgesToTris.begin(); it!=edgesToTris.end(); ++it) {
-        EdgeVerts       edgeVerts = it->first;
-        Edge            edge;
-        edge.vertInds = FgVect2UI(edgeVerts.loIdx,edgeVerts.hiIdx);
-        edge.triInds = it->second;
-        m_edges.push_back(edge);
-    }
-    for (size_t ii=0; ii<m_edges.size(); ++ii) {
-        FgVect2UI               vts = m_edges[ii].vertInds;
-        m_verts[vts[0]].edgeInds.push_back(uint(ii));
-        m_verts[vts[1]].edgeInds.push_back(uint(ii));
-        EdgeVerts               edge(vts[0],vts[1]);
-        const vector<uint> &    triInds = edgesToTris.find(edge)->second;
-        for (size_t jj=0; jj<triInds.size(); ++jj) {
-            uint                triIdx = triInds[jj];
-            FgVect3UI           tri = m_tris[triIdx].vertInds;
-            for (uint ee=0; ee<3; ++ee)
-                if ((edge.contains(tri[ee]) && edge.contains(tri[(ee+1)%3])))
-                    m_tris[triIdx].edgeInds[ee] = uint(ii);
+    radixSort(keys,triEdges);
+    vector<FgVect2UI>       edgeTris;
+    edgeTris.reserve(numTriEdges);
+    for (size_t ii=0; ii<numTriEdges; ++ii) {
+        if ((ii == 0) || (keys[ii] != keys[ii-1])) {
+            Edge            edge;
+            edge.vertInds = FgVect2UI(uint(keys[ii] >> 32),uint(keys[ii] & 0xFFFFFFFF));
+            m_edges.push_back(edge);
         }
+        uint                edgeIdx = uint(m_edges.size()-1),
+                            triIdx = triEdges[ii] / 3;
+        m_tris[triIdx].edgeInds[triEdges[ii] % 3] = edgeIdx;
+        edgeTris.push_back(FgVect2UI(edgeIdx,triIdx));
     }
-    // validate:
-    for (size_t ii=0; ii<m_verts.size(); ++ii) {
-        const vector<uint> &    edgeInds = m_verts[ii].edgeInds;
-        if (edgeInds.size() > 1)
-            for (size_t jj=0; jj<edgeInds.size(); ++jj)
-                m_edges[edgeInds[jj]].otherVertIdx(uint(ii));   // throws if index ii not found in edge verts
+    buildCsr(uint(m_edges.size()),edgeTris,m_edgeTriOffsets,m_edgeTris);
+    vector<FgVect2UI>       pairs;
+    pairs.reserve(m_edges.size()*2);
+    for (size_t ii=0; ii<m_edges.size(); ++ii) {
+        pairs.push_back(FgVect2UI(m_edges[ii].vertInds[0],uint(ii)));
+        pairs.push_back(FgVect2UI(m_edges[ii].vertInds[1],uint(ii)));
     }
+    buildCsr(uint(verts.size()),pairs,m_vertEdgeOffsets,m_vertEdges);
+    pairs.clear();
     for (size_t ii=0; ii<m_tris.size(); ++ii)
         for (uint jj=0; jj<3; ++jj)
-            FGASSERT(m_tris[ii].edgeInds[jj] != std::numeric_limits<uint>::max());
-    for (size_t ii=0; ii<m_edges.size(); ++ii)
-        FGASSERT(m_edges[ii].triInds.size() > 0);
+            pairs.push_back(FgVect2UI(m_tris[ii].vertInds[jj],uint(ii)));
+    buildCsr(uint(verts.size()),pairs,m_vertTriOffsets,m_vertTris);
 }
 
 FgVect2UI
 Fg3dTopology::edgeFacingVertInds(uint edgeIdx) const
 {
-    const vector<uint> &    triInds = m_edges[edgeIdx].triInds;
+    Inds                    triInds = edgeTris(edgeIdx);
     FGASSERT(triInds.size() == 2);
     uint        ov0 = oppositeVert(triInds[0],edgeIdx),
                 ov1 = oppositeVert(triInds[1],edgeIdx);
@@ -192,10 +209,10 @@ Fg3dTopology::edgeFacingVertInds(uint edgeIdx) const
 bool
 Fg3dTopology::vertOnBoundary(uint vertIdx) const
 {
-    const vector<uint> &    eis = m_verts[vertIdx].edgeInds;
+    Inds                    eis = vertEdges(vertIdx);
     // If this vert is unused it is not on a boundary:
     for (size_t ii=0; ii<eis.size(); ++ii)
-        if (m_edges[eis[ii]].triInds.size() == 1)
+        if (edgeTris(eis[ii]).size() == 1)
             return true;
     return false;
 }
@@ -204,11 +221,10 @@ vector<uint>
 Fg3dTopology::vertBoundaryNeighbours(uint vertIdx) const
 {
     vector<uint>            neighs;
-    const vector<uint> &    edgeInds = m_verts[vertIdx].edgeInds;
+    Inds                    edgeInds = vertEdges(vertIdx);
     for (size_t ee=0; ee<edgeInds.size(); ++ee) {
-        Edge                edge = m_edges[edgeInds[ee]];
-        if (edge.triInds.size() == 1)
-            neighs.push_back(edge.otherVertIdx(vertIdx));
+        if (edgeTris(edgeInds[ee]).size() == 1)
+            neighs.push_back(m_edges[edgeInds[ee]].otherVertIdx(vertIdx));
     }
     return neighs;
 }
@@ -216,8 +232,9 @@ Fg3dTopology::vertBoundaryNeighbours(uint vertIdx) const
 vector<uint>
 Fg3dTopology::vertNeighbours(uint vertIdx) const
 {
+    Inds                    edgeInds = vertEdges(vertIdx);
     vector<uint>            ret;
-    const vector<uint> &    edgeInds = m_verts[vertIdx].edgeInds;
+    ret.reserve(edgeInds.size());
     for (size_t ee=0; ee<edgeInds.size(); ++ee)
         ret.push_back(m_edges[edgeInds[ee]].otherVertIdx(vertIdx));
     return ret;
@@ -229,12 +246,12 @@ vector<set<uint> >
 Fg3dTopology::seams() const
 {
     vector<set<uint> >  ret;
-    vector<uint>        vertLabels(m_verts.size(),0);   // 0 is the label for non-edge vertices
+    vector<uint>        vertLabels(m_vertEdgeOffsets.size()-1,0);   // 0 is the label for non-edge vertices
     // Initialization sweep through edges:
     uint                currLabel = 1;
     for (size_t ee=0; ee<m_edges.size(); ++ee) {
         const Edge &    edge = m_edges[ee];
-        if (edge.triInds.size() == 1) {                 // Boundary edge
+        if (edgeTris(uint(ee)).size() == 1) {           // Boundary edge
             uint        v0 = edge.vertInds[0],
                         v1 = edge.vertInds[1];
             if (vertLabels[v0] == 0) {
@@ -256,9 +273,9 @@ Fg3dTopology::seams() const
         done = true;
         for (size_t ii=0; ii<vertLabels.size(); ++ii) {
             if (vertLabels[ii] != 0) {
-                const vector<uint> &    edgeInds = m_verts[ii].edgeInds;
+                Inds                    edgeInds = vertEdges(uint(ii));
                 for (size_t ee=0; ee<edgeInds.size(); ++ee) {
-                    if (m_edges[edgeInds[ee]].triInds.size() == 1) {    // Boundary edge
+                    if (edgeTris(edgeInds[ee]).size() == 1) {           // Boundary edge
                         uint    v = m_edges[edgeInds[ee]].otherVertIdx(uint(ii));
                         FGASSERT(vertLabels[v] != 0);
                         if (vertLabels[ii] != vertLabels[v]) {
@@ -309,12 +326,13 @@ Fg3dTopology::traceFold(
     if (done[vertIdx])
         return ret;
     done[vertIdx] = true;
-    const vector<uint> &    edgeInds = m_verts[vertIdx].edgeInds;
+    Inds                    edgeInds = vertEdges(vertIdx);
     for (size_t ii=0; ii<edgeInds.size(); ++ii) {
         const Edge &           edge = m_edges[edgeInds[ii]];
-        if (edge.triInds.size() == 2) {         // Can not be part of a fold otherwise
+        Inds                   triInds = edgeTris(edgeInds[ii]);
+        if (triInds.size() == 2) {              // Can not be part of a fold otherwise
             const Fg3dFacetNormals &    facetNorms = norms.facet[0];
-            float       dot = fgDot(facetNorms.tri[edge.triInds[0]],facetNorms.tri[edge.triInds[1]]);
+            float       dot = fgDot(facetNorms.tri[triInds[0]],facetNorms.tri[triInds[1]]);
             if (dot < 0.5f) {                   // > 60 degrees
                 ret.insert(vertIdx);
                 fgAppend(ret,traceFold(norms,done,edge.otherVertIdx(vertIdx)));
@@ -341,15 +359,15 @@ Fg3dTopology::isManifold() const
 {
     FgVect3UI   ret(0);
     for (size_t ee=0; ee<m_edges.size(); ++ee) {
-        const Edge &    edge = m_edges[ee];
-        if (edge.triInds.size() == 1)
+        Inds            triInds = edgeTris(uint(ee));
+        if (triInds.size() == 1)
             ++ret[0];
-        else if (edge.triInds.size() > 2)
+        else if (triInds.size() > 2)
             ++ret[1];
         else {
             // Check that winding directions of the two facets are opposite on this edge:
-            Tri         tri0 = m_tris[edge.triInds[0]],
-                        tri1 = m_tris[edge.triInds[1]];
+            Tri         tri0 = m_tris[triInds[0]],
+                        tri1 = m_tris[triInds[1]];
             uint        edgeIdx0 = fgFindFirstIdx(tri0.edgeInds,uint(ee)),
                         edgeIdx1 = fgFindFirstIdx(tri1.edgeInds,uint(ee));
             if (tri0.edge(edgeIdx0) == tri1.edge(edgeIdx1))
@@ -366,8 +384,8 @@ size_t
 Fg3dTopology::unusedVerts() const
 {
     size_t      ret = 0;
-    for (size_t ii=0; ii<m_verts.size(); ++ii)
-        if (m_verts[ii].triInds.empty())
+    for (size_t ii=0; ii+1<m_vertTriOffsets.size(); ++ii)
+        if (m_vertTriOffsets[ii] == m_vertTriOffsets[ii+1])
             ++ret;
     return ret;
 }
@@ -383,26 +401,72 @@ Fg3dTopology::edgeDistanceMap(const FgVerts & verts,size_t vertIdx) const
 }
 
 void
-Fg3dTopology::edgeDistanceMap(const FgVerts & verts,vector<float> & vertDists) const
+Fg3dTopology::edgeDistanceMap(
+    const FgVerts &     verts,
+    vector<float> &     vertDists,
+    float               maxDist) const
 {
-    FGASSERT(verts.size() == m_verts.size());
     FGASSERT(vertDists.size() == verts.size());
-    bool                done = false;
-    while (!done) {
-        done = true;
-        for (size_t vv=0; vv<vertDists.size(); ++vv) {
-            // Important: check each vertex each time since the topology will often result in 
-            // the first such assignment not being the optimal:
-            if (vertDists[vv] < std::numeric_limits<float>::max()) {
-                const vector<uint> &    edges = m_verts[vv].edgeInds;
-                for (size_t ee=0; ee<edges.size(); ++ee) {
-                    uint                neighVertIdx = m_edges[edges[ee]].otherVertIdx(uint(vv));
-                    float               neighDist = vertDists[vv] + (verts[neighVertIdx]-verts[vv]).length();
-                    if (neighDist < vertDists[neighVertIdx]) {
-                        vertDists[neighVertIdx] = neighDist;
-                        done = false;
-                    }
-                }
+    DistScratch         scratch;
+    for (size_t vv=0; vv<vertDists.size(); ++vv) {
+        // Only the defined distances are seeds, the rest are reached from them:
+        if ((vertDists[vv] < std::numeric_limits<float>::max()) && (vertDists[vv] <= maxDist))
+            scratch.heap.push_back(std::make_pair(vertDists[vv],uint(vv)));
+        else
+            vertDists[vv] = std::numeric_limits<float>::max();
+    }
+    edgeDistanceDijkstra(verts,maxDist,vertDists,scratch);
+}
+
+void
+Fg3dTopology::edgeDistanceMap(
+    const FgVerts &         verts,
+    const vector<uint> &    seeds,
+    float                   maxDist,
+    vector<float> &         dists,
+    DistScratch &           scratch) const
+{
+    dists.assign(verts.size(),std::numeric_limits<float>::max());
+    scratch.heap.clear();
+    for (size_t ii=0; ii<seeds.size(); ++ii) {
+        FGASSERT(seeds[ii] < verts.size());
+        dists[seeds[ii]] = 0.0f;
+        scratch.heap.push_back(std::make_pair(0.0f,seeds[ii]));
+    }
+    edgeDistanceDijkstra(verts,maxDist,dists,scratch);
+}
+
+// 'scratch.heap' holds the initial (distance,vertex) entries on entry. Stale heap entries
+// are skipped when popped rather than updated in place (lazy deletion), which is faster than
+// an indexed heap for mesh valences:
+void
+Fg3dTopology::edgeDistanceDijkstra(
+    const FgVerts &     verts,
+    float               maxDist,
+    vector<float> &     dists,
+    DistScratch &       scratch) const
+{
+    typedef std::pair<float,uint>   Entry;
+    FGASSERT(verts.size()+1 == m_vertEdgeOffsets.size());
+    FGASSERT(dists.size() == verts.size());
+    vector<Entry> &         heap = scratch.heap;
+    std::greater<Entry>     cmp;                    // Min-heap
+    std::make_heap(heap.begin(),heap.end(),cmp);
+    while (!heap.empty()) {
+        Entry               top = heap.front();
+        std::pop_heap(heap.begin(),heap.end(),cmp);
+        heap.pop_back();
+        uint                vv = top.second;
+        if (top.first > dists[vv])
+            continue;
+        Inds                edges = vertEdges(vv);
+        for (size_t ee=0; ee<edges.size(); ++ee) {
+            uint            neighVertIdx = m_edges[edges[ee]].otherVertIdx(vv);
+            float           neighDist = top.first + (verts[neighVertIdx]-verts[vv]).length();
+            if ((neighDist < dists[neighVertIdx]) && (neighDist <= maxDist)) {
+                dists[neighVertIdx] = neighDist;
+                heap.push_back(Entry(neighDist,neighVertIdx));
+                std::push_heap(heap.begin(),heap.end(),cmp);
             }
         }
     }
@@ -32,24 +32,52 @@ struct Fg3dTopology
     struct      Edge
     {
         FgVect2UI           vertInds;   // Lower index first
-        vector<uint>        triInds;
 
         uint
         otherVertIdx(uint vertIdx) const;
     };
-    struct      Vert
+    // Read-only view of the indices related to one element, from the arrays below:
+    struct      Inds
     {
-        vector<uint>        edgeInds;   // Can be zero if vert is unused
-        vector<uint>        triInds;    // "
+        const uint *        m_begin;
+        const uint *        m_end;
+
+        Inds(const uint * b,const uint * e) : m_begin(b), m_end(e) {}
+
+        size_t size() const {return size_t(m_end-m_begin); }
+        bool empty() const {return (m_begin == m_end); }
+        uint operator[](size_t idx) const {return m_begin[idx]; }
+        const uint * begin() const {return m_begin; }
+        const uint * end() const {return m_end; }
     };
     vector<Tri>             m_tris;
-    vector<Edge>            m_edges;
-    vector<Vert>            m_verts;
+    vector<Edge>            m_edges;        // Ordered by vert indices
+    // Compressed sparse row relations; the indices related to element 'ii' are at
+    // [offsets[ii],offsets[ii+1]) in the corresponding index array, in increasing order.
+    // Unused verts have no edges or tris:
+    vector<uint>            m_edgeTriOffsets;
+    vector<uint>            m_edgeTris;
+    vector<uint>            m_vertEdgeOffsets;
+    vector<uint>            m_vertEdges;
+    vector<uint>            m_vertTriOffsets;
+    vector<uint>            m_vertTris;
 
     Fg3dTopology(
         const FgVerts &            verts,
         const vector<FgVect3UI> &  tris);
 
+    Inds
+    edgeTris(uint edgeIdx) const
+    {return Inds(m_edgeTris.data()+m_edgeTriOffsets[edgeIdx],m_edgeTris.data()+m_edgeTriOffsets[edgeIdx+1]); }
+
+    Inds
+    vertEdges(uint vertIdx) const
+    {return Inds(m_vertEdges.data()+m_vertEdgeOffsets[vertIdx],m_vertEdges.data()+m_vertEdgeOffsets[vertIdx+1]); }
+
+    Inds
+    vertTris(uint vertIdx) const
+    {return Inds(m_vertTris.data()+m_vertTriOffsets[vertIdx],m_vertTris.data()+m_vertTriOffsets[vertIdx+1]); }
+
     FgVect2UI
     edgeFacingVertInds(uint edgeIdx) const;
 
@@ -94,9 +122,31 @@ struct Fg3dTopology
     vector<float>
     edgeDistanceMap(const FgVerts & verts,size_t vertIdx) const;
 
-    // As above where 'init' has at least 1 distance defined, the rest set to float_max:
+    // As above where 'init' has at least 1 distance defined, the rest set to float_max.
+    // Verts further than 'maxDist' are left at float_max:
     void
-    edgeDistanceMap(const FgVerts & verts,vector<float> & init) const;
+    edgeDistanceMap(
+        const FgVerts &     verts,
+        vector<float> &     init,
+        float               maxDist=std::numeric_limits<float>::max()) const;
+
+    // Priority queue storage for edgeDistanceMap. Keep one around when computing many maps
+    // on the same topology to avoid re-allocation:
+    struct      DistScratch
+    {
+        vector<std::pair<float,uint> >  heap;
+    };
+
+    // Minimum edge distance to the nearest of 'seeds' for each vertex, out to 'maxDist'.
+    // 'dists' is resized to the number of verts (re-using its storage) and is float_max
+    // for verts beyond 'maxDist' or unconnected:
+    void
+    edgeDistanceMap(
+        const FgVerts &         verts,
+        const vector<uint> &    seeds,
+        float                   maxDist,
+        vector<float> &         dists,
+        DistScratch &           scratch) const;
 
 private:
 
@@ -105,6 +155,13 @@ private:
 
     uint
     oppositeVert(uint triIdx,uint edgeIdx) const;
+
+    void
+    edgeDistanceDijkstra(
+        const FgVerts &     verts,
+        float               maxDist,
+        vector<float> &     dists,
+        DistScratch &       scratch) const;
 };
 
 #endif
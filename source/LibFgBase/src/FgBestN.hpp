@@ -58,6 +58,10 @@ public:
     num() const
     {return m_num; }
 
+    void
+    clear()
+    {m_num = 0; }
+
     FgKeyVal<Key,Val>
     operator[](uint idx) const
     {return m_best[idx]; }
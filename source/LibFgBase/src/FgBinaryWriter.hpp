@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2015 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Created:     Oct 16, 2026
+//
+// Buffered writer for binary file formats with explicit byte order and back-patching, for
+// chunk-based formats (eg. IFF/LWO, 3DS) whose chunk sizes are only known after the contents are
+// written. All output is accumulated in memory and written to the file with a single call.
+//
+
+#ifndef FGBINARYWRITER_HPP
+#define FGBINARYWRITER_HPP
+
+#include "FgStdLibs.hpp"
+#include "FgTypes.hpp"
+#include "FgStdStream.hpp"
+#include "FgException.hpp"
+
+class   FgBinaryWriter
+{
+public:
+    explicit
+    FgBinaryWriter(bool bigEndian) : m_swap(bigEndian != hostBigEndian()) {}
+
+    // Number of bytes written so far, ie. the position of the next write:
+    size_t
+    pos() const
+    {return m_buf.size(); }
+
+    const vector<char> &
+    data() const
+    {return m_buf; }
+
+    // Raw bytes, no byte order conversion:
+    void
+    write(const void * ptr,size_t num)
+    {
+        const char *    p = static_cast<const char*>(ptr);
+        m_buf.insert(m_buf.end(),p,p+num);
+    }
+
+    // Builtin numeric value in the file byte order:
+    template<class T>
+    void
+    val(T v)
+    {
+        size_t      pp = m_buf.size();
+        m_buf.resize(pp+sizeof(T));
+        put(&m_buf[pp],v);
+    }
+
+    template<class T>
+    void
+    vals(const T * ptr,size_t num)
+    {
+        if (num == 0)
+            return;
+        size_t      pp = m_buf.size();
+        m_buf.resize(pp+num*sizeof(T));
+        if (m_swap)
+            for (size_t ii=0; ii<num; ++ii)
+                put(&m_buf[pp+ii*sizeof(T)],ptr[ii]);
+        else
+            memcpy(&m_buf[pp],ptr,num*sizeof(T));
+    }
+
+    // Overwrite a previously written value (eg. a chunk size) at position 'at':
+    template<class T>
+    void
+    patch(size_t at,T v)
+    {
+        FGASSERT(at+sizeof(T) <= m_buf.size());
+        put(&m_buf[at],v);
+    }
+
+    void
+    save(const FgString & fname) const
+    {
+        FgOfstream      ofs(fname);
+        if (!m_buf.empty())
+            ofs.write(&m_buf[0],m_buf.size());
+        if (!ofs)
+            fgThrow("Error writing to file",fname);
+    }
+
+private:
+    vector<char>    m_buf;
+    bool            m_swap;     // File byte order differs from host
+
+    static
+    bool
+    hostBigEndian()
+    {
+        const uint16    one = 1;
+        return (*reinterpret_cast<const uchar*>(&one) == 0);
+    }
+
+    template<class T>
+    void
+    put(char * dst,T v) const
+    {
+        memcpy(dst,&v,sizeof(T));
+        if (m_swap)
+            std::reverse(dst,dst+sizeof(T));
+    }
+};
+
+#endif
+
+// */
@@ -68,6 +68,7 @@
 #include <boost/static_assert.hpp>
 // Only include the necessary parts of boost/thread.hpp to avoid warning C4913 (VS2010):
 #include <boost/thread/barrier.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/once.hpp>
 #include <boost/thread/thread.hpp>
@@ -37,9 +37,11 @@ fgCmdBaseTests()
     FGADDCMD1(fgGeometryTest,"geometry");
     FGADDCMD1(fgGridTrianglesTest,"gridTriangles");
     FGADDCMD1(fgImageTest,"image");
+    FGADDCMD1(fgImgopsTest,"imgops");
     FGADDCMD1(fgMatrixSolverTest,"matrixSolver");
     FGADDCMD1(fgMathTest,"math");
     FGADDCMD1(fgMatrixCTest,"matrixC");
+    FGADDCMD1(fgMatrixVTest,"matrixV");
     FGADDCMD1(fgMetaFormatTest,"metaFormat");
     FGADDCMD1(fgMorphTest,"morph");
     FGADDCMD1(fgPathTest,"path");
@@ -83,6 +85,7 @@ fgCmdBaseTestms()
     FGADDCMD1(fgClusterDeployTestm,"clusterDeploy");
     FGADDCMD(fgCmdTestmCpp,"cpp","C++ behaviour tests");
     FGADDCMD1(fg3dReadWobjTest,"readWobj");
+    FGADDCMD(fgMatrixVBench,"matMul","Benchmark matrix multiplication against the naive loop");
     FGADDCMD1(fgRandomTest,"random");
     FGADDCMD1(fgGeometryManTest,"geometry");
     FGADDCMD1(fgSubdivisionTest,"subdivision");
@@ -13,6 +13,13 @@
 #include "FgSyntax.hpp"
 #include "FgMetaFormat.hpp"
 #include "FgImage.hpp"
+#include "FgImageIo.hpp"
+#include "FgFileSystem.hpp"
+#include "FgParse.hpp"
+#include "FgThread.hpp"
+#include "FgTime.hpp"
+#include "FgStdStream.hpp"
+#include "FgTestUtils.hpp"
 
 using namespace std;
 
@@ -63,12 +70,158 @@ shrink2(const FgArgs & args)
     fgSaveImgAnyFormat(syntax.next(),img);
 }
 
+struct  BatchOp
+{
+    bool            shrink2;
+    FgVect2UI       dims;           // Resize to these dimensions if non-zero
+    string          ext;            // Output format
+};
+
+struct  BatchItem
+{
+    FgString        src;
+    FgString        dst;
+    size_t          bytesIn;
+    size_t          bytesOut;
+    FgString        error;          // Empty if successful
+
+    BatchItem() : bytesIn(0), bytesOut(0) {}
+};
+
+// Each job holds at most one decoded image, so the number of images in flight is bounded
+// by the number of threads working on the batch:
+static
+void
+batchItem(const BatchOp & op,BatchItem * item)
+{
+    try {
+        string          raw = fgSlurp(item->src);
+        item->bytesIn = raw.size();
+        FgImgRgbaUb     img;
+        fgDecodeImgAnyFormat(vector<uchar>(raw.begin(),raw.end()),img,fgPathToExt(item->src).m_str);
+        if (op.shrink2)
+            img = fgImgShrink2(img);
+        if (op.dims[0] > 0) {
+            FgImgRgbaUb     tmp(op.dims);
+            fgImgResize(img,tmp);
+            img = tmp;
+        }
+        vector<uchar>   data;
+        fgEncodeImgAnyFormat(img,op.ext,data);
+        FgOfstream      ofs(item->dst);
+        ofs.write(reinterpret_cast<const char*>(data.data()),data.size());
+        item->bytesOut = data.size();
+    }
+    catch (FgException & e) {
+        item->error = e.no_tr_message();
+    }
+    catch (std::exception & e) {
+        item->error = e.what();
+    }
+}
+
+static
+void
+batch(const FgArgs & args)
+{
+    FgSyntax    syntax(args,
+        "[-s | -r <wid> <hgt>] [-t <threads>] (<dir>/<glob> | @<list>.txt) <outDir> <ext>\n"
+        "    -s         - Shrink each image by a factor of 2\n"
+        "    -r         - Resize each image to the given pixel dimensions\n"
+        "    -t         - Maximum number of threads, and thus images in memory (default all cores)\n"
+        "    <glob>     - Simple glob on the file name, eg. *.tga or tex*.*\n"
+        "    <list>     - Text file listing one input image file per line\n"
+        "    <outDir>   - Created if necessary. Output files take the base name of the input file,\n"
+        "                 which must be unique (eg. not both a.png and a.tga)\n"
+        "    <ext>      - " + fgImgCommonFormatsDescription() + " or any other supported format"
+        );
+    BatchOp         op;
+    op.shrink2 = false;
+    op.dims = FgVect2UI(0);
+    uint            numThreads = 0;
+    while (syntax.peekNext()[0] == '-') {
+        if (syntax.next() == "-s")
+            op.shrink2 = true;
+        else if (syntax.curr() == "-r") {
+            op.dims[0] = syntax.nextAs<uint>();
+            op.dims[1] = syntax.nextAs<uint>();
+            if (op.dims.volume() == 0)
+                syntax.error("Resize dimensions must be non-zero");
+        }
+        else if (syntax.curr() == "-t")
+            numThreads = syntax.nextAs<uint>();
+        else
+            syntax.error("Unrecognized option: ",syntax.curr());
+    }
+    FgString        in = syntax.next();
+    FgStrings       srcs;
+    if (in.m_str[0] == '@') {
+        FgString        list(in.m_str.substr(1));
+        FgStrings       lines = fgSplitLinesUtf8(fgSlurp(list));
+        for (size_t ii=0; ii<lines.size(); ++ii)
+            if (!lines[ii].empty())
+                srcs.push_back(lines[ii]);
+    }
+    else {
+        FgPath          path(in);
+        FgStrings       names = fgGlobFiles(path);
+        for (size_t ii=0; ii<names.size(); ++ii)
+            srcs.push_back(path.dir()+names[ii]);
+    }
+    FgString        outDir = fgAsDirectory(syntax.next());
+    op.ext = fgToLower(syntax.next());
+    if (srcs.empty()) {
+        fgout << fgnl << "No input files found";
+        return;
+    }
+    vector<BatchItem>   items(srcs.size());
+    vector<FgJob>       jobs(srcs.size());
+    // Checked before any output is written since the jobs would otherwise overwrite each other's
+    // output. Names are compared without case since some file systems ignore it:
+    map<string,size_t>  dstIdx;
+    for (size_t ii=0; ii<srcs.size(); ++ii) {
+        items[ii].src = srcs[ii];
+        items[ii].dst = outDir + fgPathToBase(srcs[ii]) + "." + op.ext;
+        pair<map<string,size_t>::iterator,bool>     ins =
+            dstIdx.insert(make_pair(fgToLower(items[ii].dst).m_str,ii));
+        if (!ins.second)
+            fgThrow("Input files would be converted to the same output file",
+                srcs[ins.first->second] + " and " + srcs[ii]);
+        jobs[ii] = boost::bind(batchItem,boost::cref(op),&items[ii]);
+    }
+    fgCreatePath(outDir);
+    FgTimer         timer;
+    fgThreadPool().run(jobs,numThreads);
+    double          time = std::max(timer.read(),0.001);
+    size_t          bytesIn = 0,
+                    bytesOut = 0;
+    FgStrings       failed;
+    for (size_t ii=0; ii<items.size(); ++ii) {
+        if (items[ii].error.empty()) {
+            bytesIn += items[ii].bytesIn;
+            bytesOut += items[ii].bytesOut;
+        }
+        else {
+            fgout << fgnl << "ERROR " << items[ii].src << ": " << items[ii].error;
+            failed.push_back(items[ii].src);
+        }
+    }
+    size_t          numDone = items.size() - failed.size();
+    fgout << fgnl << numDone << " images converted in " << time << "s: "
+        << numDone / time << " images/s, "
+        << bytesIn / (time * 1.0e6) << " MB/s read, "
+        << bytesOut / (time * 1.0e6) << " MB/s written";
+    if (!failed.empty())
+        fgThrow("Images could not be converted",fgCat(failed,", "));
+}
+
 static
 void
 imgops(const FgArgs & args)
 {
     vector<FgCmd>   ops;
     ops.push_back(FgCmd(addalpha,"addalpha","Add/replace an alpha channel from an another image"));
+    ops.push_back(FgCmd(batch,"batch","Convert, and optionally shrink or resize, many images in parallel"));
     ops.push_back(FgCmd(convert,"convert","Convert images between different formats"));
     ops.push_back(FgCmd(shrink2,"shrink2","Shrink images by a factor of 2"));
     fgMenu(args,ops);
@@ -78,4 +231,72 @@ FgCmd
 fgCmdImgopsInfo()
 {return FgCmd(imgops,"imgops","Operations on images"); }
 
+static
+FgVect2UI
+imgDims(const FgString & fname)
+{return fgLoadImgAnyFormat(fname).dims(); }
+
+static
+void
+writeLines(const FgString & fname,const FgStrings & lines)
+{
+    FgOfstream      ofs(fname);
+    for (size_t ii=0; ii<lines.size(); ++ii)
+        ofs << lines[ii] << "\n";
+}
+
+// Runs 'batch' and returns the exception message, or an empty string if successful:
+static
+string
+batchErr(const string & argStr)
+{
+    try {fgRunCmd(batch,argStr); }
+    catch (const FgException & e) {
+        fgout << fgpop;
+        return e.tr_message().m_str;
+    }
+    return string();
+}
+
+void
+fgImgopsTest(const FgArgs & args)
+{
+    FGTESTDIR
+    fgCreateDirectory("in");
+    FgImgRgbaUb     img(20,10);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        img[ii] = FgRgbaUB(uchar(ii),uchar(ii*3),uchar(ii*7),255);
+    fgSaveImgAnyFormat("in/a.png",img);
+    fgSaveImgAnyFormat("in/b.jpg",fgImgShrink2(img));
+    fgSaveImgAnyFormat("in/c.bmp",img);
+    fgSaveImgAnyFormat("in/A.tga",img);
+    fgWriteFile("in/bad.png","\x89PNG\r\n\x1A\nnot really a PNG",false);
+    writeLines("good.txt",fgSvec<FgString>("in/a.png","in/b.jpg","in/c.bmp"));
+    // Conversion by list and by glob, with shrinking and resizing:
+    fgRunCmd(batch,"batch @good.txt out png");
+    FGASSERT(imgDims("out/a.png") == FgVect2UI(20,10));
+    FGASSERT(imgDims("out/b.png") == FgVect2UI(10,5));
+    FGASSERT(fgLoadImgAnyFormat("out/c.png").dataVec() == img.dataVec());
+    fgRunCmd(batch,"batch -s @good.txt half png");
+    FGASSERT(imgDims("half/a.png") == FgVect2UI(10,5));
+    FGASSERT(imgDims("half/c.png") == FgVect2UI(10,5));
+    fgRunCmd(batch,"batch -r 7 3 -t 2 in/*.jpg sized bmp");
+    FGASSERT(imgDims("sized/b.bmp") == FgVect2UI(7,3));
+    FGASSERT(!fgExists("sized/a.bmp"));
+    // Output names differing only in case are rejected before any output is written:
+    writeLines("collide.txt",fgSvec<FgString>("in/a.png","in/b.jpg","in/A.tga"));
+    string          msg = batchErr("batch @collide.txt collide png");
+    FGASSERT(msg.find("same output file") != string::npos);
+    FGASSERT(!fgExists("collide"));
+    // A bad file is reported and the others are still converted:
+    writeLines("bad.txt",fgSvec<FgString>("in/a.png","in/bad.png","in/c.bmp"));
+    msg = batchErr("batch @bad.txt bad png");
+    FGASSERT(msg.find("Images could not be converted") != string::npos);
+    FGASSERT(msg.find("bad.png") != string::npos);
+    FGASSERT(msg.find("in/a.png") == string::npos);
+    FGASSERT(imgDims("bad/a.png") == FgVect2UI(20,10));
+    FGASSERT(imgDims("bad/c.png") == FgVect2UI(20,10));
+    FGASSERT(!fgExists("bad/bad.png"));
+}
+
 // */
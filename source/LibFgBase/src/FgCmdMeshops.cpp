@@ -532,17 +532,38 @@ splitsurface(const FgArgs & args)
     }
 }
 
+// Parses the optional '-v <version>' argument for commands that save FGMESH files:
+static
+uint
+fgmeshVersionArg(FgSyntax & syn)
+{
+    if (syn.peekNext() != "-v")
+        return 1;
+    syn.next();
+    uint            version = syn.nextAs<uint>();
+    if ((version < 1) || (version > 2))
+        syn.error("Invalid FGMESH version",syn.curr());
+    return version;
+}
+
 static
 void
 convert(const FgArgs & args)
 {
     FgSyntax    syntax(args,
-        "<in>.<extIn> <out>.<extOut>\n"
+        "[-v <version>] <in>.<extIn> <out>.<extOut>\n"
         "    <extIn> = " + fgLoadMeshFormatsDescription() + "\n"
-        "    <extOut> = " + fgMeshSaveFormatsString()
+        "    <extOut> = " + fgMeshSaveFormatsString() + "\n"
+        "    -v         - FGMESH version to save (1 or 2). Default 1 since earlier software can't\n"
+        "                 read version 2"
         );
+    uint        version = fgmeshVersionArg(syntax);
     Fg3dMesh    mesh = fgLoadMeshAnyFormat(syntax.next());
-    fgSaveMeshAnyFormat(mesh,syntax.next());
+    FgString    out = syntax.next();
+    if (fgPathToExt(out).toLower() == "fgmesh")
+        fgSaveFgmesh(out,mesh,version);
+    else
+        fgSaveMeshAnyFormat(mesh,out);
 }
 
 static
@@ -550,15 +571,17 @@ void
 surfAdd(const FgArgs & args)
 {
     FgSyntax    syn(args,
-        "<in>.<ext> <name> <out>.fgmesh\n"
+        "[-v <version>] <in>.<ext> <name> <out>.fgmesh\n"
+        "    -v     - FGMESH version to save (1 or 2). Default 1\n"
         "    <ext>  - " + fgLoadMeshFormatsDescription() + "\n"
         "    <name> - Surface name"
         );
+    uint            version = fgmeshVersionArg(syn);
     Fg3dMesh        mesh = fgLoadMeshAnyFormat(syn.next());
     Fg3dSurface     surf;
     surf.name = syn.next();
     mesh.surfaces.push_back(surf);
-    fgSaveFgmesh(syn.next(),mesh);
+    fgSaveFgmesh(syn.next(),mesh,version);
 }
 
 static
@@ -566,13 +589,15 @@ void
 surfCopy(const FgArgs & args)
 {
     FgSyntax    syn(args,
-        "<from>.fgmesh <to>.<ext> <out>.fgmesh\n"
+        "[-v <version>] <from>.fgmesh <to>.<ext> <out>.fgmesh\n"
+        "    -v     - FGMESH version to save (1 or 2). Default 1\n"
         "    <ext>  - " + fgLoadMeshFormatsDescription() + "\n"
         " * tris only, uvs not preserved."
         );
+    uint            version = fgmeshVersionArg(syn);
     Fg3dMesh        from = fgLoadFgmesh(syn.next()),
                     to = fgLoadMeshAnyFormat(syn.next());
-    fgSaveFgmesh(syn.next(),fgCopySurfaceStructure(from,to));
+    fgSaveFgmesh(syn.next(),fgCopySurfaceStructure(from,to),version);
 }
 
 static
@@ -605,21 +630,25 @@ surfRen(const FgArgs & args)
     if (idx >= mesh.surfaces.size())
         fgThrow("Index value larger than available surfaces");
     mesh.surfaces[idx].name = syn.next();
-    fgSaveFgmesh(meshFname,mesh);
+    fgSaveFgmesh(meshFname,mesh,fgFgmeshVersion(meshFname));     // Keep the file's version
 }
 
 static
 void
 spCopy(const FgArgs & args)
 {
-    FgSyntax    syn(args,"<from>.fgmesh <to>.fgmesh <out>.fgmesh");
+    FgSyntax    syn(args,
+        "[-v <version>] <from>.fgmesh <to>.fgmesh <out>.fgmesh\n"
+        "    -v     - FGMESH version to save (1 or 2). Default 1"
+        );
+    uint        version = fgmeshVersionArg(syn);
     Fg3dMesh    from = fgLoadFgmesh(syn.next()),
                 to = fgLoadFgmesh(syn.next());
     if (from.surfaces.size() != to.surfaces.size())
         fgThrow("'from' and 'to' meshes have different surface counts");
     for (size_t ss=0; ss<to.surfaces.size(); ++ss)
         fgAppend(to.surfaces[ss].surfPoints,from.surfaces[ss].surfPoints);
-    fgSaveFgmesh(syn.next(),to);
+    fgSaveFgmesh(syn.next(),to,version);
 }
 
 static
@@ -675,7 +704,7 @@ spRen(const FgArgs & args)
     if (ii >= surf.surfPoints.size())
         fgThrow("Point index value larger than availables points");
     surf.surfPoints[ii].label = syn.next();
-    fgSaveFgmesh(meshFname,mesh);
+    fgSaveFgmesh(meshFname,mesh,fgFgmeshVersion(meshFname));     // Keep the file's version
 }
 
 static
@@ -716,13 +745,18 @@ void
 unifyuvs(const FgArgs & args)
 {
     FgSyntax    syntax(args,
-        "<in>.<extIn> <out>.<extOut>\n"
+        "<in>.<extIn> <out>.<extOut> [<weld>]\n"
         "    <extIn> = " + fgLoadMeshFormatsDescription() + "\n"
-        "    <extOut> = " + fgMeshSaveFormatsString()
+        "    <extOut> = " + fgMeshSaveFormatsString() + "\n"
+        "    <weld> = also unify UVs within this distance (default 0: identical only)"
         );
     Fg3dMesh    mesh = fgLoadMeshAnyFormat(syntax.next());
-    mesh = fgUnifyIdenticalUvs(mesh);
-    fgSaveMeshAnyFormat(mesh,syntax.next());
+    string      outName = syntax.next();
+    float       weld = 0.0f;
+    if (syntax.more())
+        weld = fgFromString<float>(syntax.next());
+    mesh = fgUnifyIdenticalUvs(mesh,weld);
+    fgSaveMeshAnyFormat(mesh,outName);
 }
 
 static
@@ -730,13 +764,18 @@ void
 unifyverts(const FgArgs & args)
 {
     FgSyntax    syntax(args,
-        "<in>.<extIn> <out>.<extOut>\n"
+        "<in>.<extIn> <out>.<extOut> [<weld>]\n"
         "    <extIn> = " + fgLoadMeshFormatsDescription() + "\n"
-        "    <extOut> = " + fgMeshSaveFormatsString()
+        "    <extOut> = " + fgMeshSaveFormatsString() + "\n"
+        "    <weld> = also unify verts within this distance (default 0: identical only)"
         );
     Fg3dMesh    mesh = fgLoadMeshAnyFormat(syntax.next());
-    mesh = fgUnifyIdenticalVerts(mesh);
-    fgSaveMeshAnyFormat(mesh,syntax.next());
+    string      outName = syntax.next();
+    float       weld = 0.0f;
+    if (syntax.more())
+        weld = fgFromString<float>(syntax.next());
+    mesh = fgUnifyIdenticalVerts(mesh,weld);
+    fgSaveMeshAnyFormat(mesh,outName);
 }
 
 static
@@ -14,6 +14,7 @@
 #include "FgSyntax.hpp"
 #include "Fg3dMeshIo.hpp"
 #include "FgTestUtils.hpp"
+#include "FgApproxEqual.hpp"
 
 using namespace std;
 
@@ -109,8 +110,9 @@ copymorphs(const FgArgs & args)
                 nameOut = syntax.next();
     if (nameIn == nameOut)
         syntax.error("Input and output meshes must be different");
-    Fg3dMesh    meshIn = fgLoadTri(nameIn);
-    Fg3dMesh    meshOut = fgLoadTri(nameOut);
+    vector<Fg3dMesh>    meshes = fgLoadTris(fgSvec<FgString>(nameIn,nameOut));
+    const Fg3dMesh &    meshIn = meshes[0];
+    Fg3dMesh &          meshOut = meshes[1];
     if (meshIn.verts.size() != meshOut.verts.size())
         syntax.error("Meshes have different vertex counts");
     if (!syntax.more()) {           // All morphs
@@ -389,4 +391,52 @@ fgMorphTest(const FgArgs & args)
             fgCopyFile("tmp.tri",baseline,true);
         fgThrow("Morph test failed");
     }
+    // The compiled basis must match per-morph application exactly for single evaluation:
+    Fg3dMesh        mesh = fgLoadTri("Jane.tri");
+    FgMorphBasis    basis(mesh.verts,mesh.deltaMorphs,mesh.targetMorphs);
+    fgRandSeedRepeatable();
+    vector<FgFlts>  coords(5,FgFlts(mesh.numMorphs(),0.0f));
+    for (size_t ii=0; ii<coords.size(); ++ii)
+        for (size_t jj=ii; jj<coords[ii].size(); jj+=3)
+            coords[ii][jj] = float(fgRandUniform(-1.0,1.0));
+    vector<FgVerts> batch = basis.morph(coords);
+    for (size_t ii=0; ii<coords.size(); ++ii) {
+        FgVerts         ref;
+        mesh.morph(coords[ii],ref);
+        FGASSERT(basis.morph(coords[ii]) == ref);
+        FGASSERT(fgApproxEqual(batch[ii],ref,0.00001f));
+    }
+    // Repeated base indices in a target morph accumulate:
+    FgIndexedMorph  dup;
+    dup.baseInds = fgSvec<uint>(2,7,2);
+    dup.verts = fgSvec(mesh.verts[2]+FgVect3F(1,0,0),mesh.verts[7],mesh.verts[2]+FgVect3F(0,1,0));
+    mesh.targetMorphs.push_back(dup);
+    FgMorphBasis    dupBasis(mesh.verts,mesh.deltaMorphs,mesh.targetMorphs);
+    FgFlts          dupCoord(mesh.numMorphs(),0.0f);
+    dupCoord.back() = 0.5f;
+    FgVerts         dupRef;
+    mesh.morph(dupCoord,dupRef);
+    FGASSERT(dupBasis.morph(dupCoord) == dupRef);
+    FGASSERT(dupBasis.morph(fgSvec(dupCoord))[0] == dupRef);
+    FGASSERT(fgApproxEqual(dupRef[2],mesh.verts[2]+FgVect3F(0.5f,0.5f,0),16));
+    mesh.targetMorphs.pop_back();
+    // The compiled pose binding must match name lookup, with poses in a different order than
+    // the morphs, an unbound pose and zero values:
+    FgPoses         poses = fgPoses(mesh);
+    std::reverse(poses.begin(),poses.end());
+    poses.push_back(FgPose());
+    poses.back().name = "notAMorph";
+    FgVerts         allVerts = mesh.allVerts(),
+                    posed;
+    FgPoseBinding   binding = mesh.poseBinding(poses);
+    for (size_t ii=0; ii<coords.size(); ++ii) {
+        map<FgString,float> poseMap;
+        FgFlts          vals(poses.size());
+        for (size_t jj=0; jj<poses.size(); ++jj) {
+            vals[jj] = (jj % 2 == ii % 2) ? float(fgRandUniform(-1.0,1.0)) : 0.0f;
+            poseMap[poses[jj].name] = vals[jj];
+        }
+        mesh.poseShape_(allVerts,binding,vals,posed);
+        FGASSERT(fgApproxEqual(posed,mesh.poseShape(allVerts,poseMap),0.00001f));
+    }
 }
@@ -85,13 +85,29 @@ void
 fgCmdRender(const FgArgs & args)
 {
     FgSyntax    syntax(args,
-        "<name> (<mesh>.tri [<image>.<ext1>])+\n"
+        "[-t <threads>] [-r] <name> (<mesh>.tri [<image>.<ext1>])+\n"
         "    Render specified meshes [with texture images] using default render arguments.\n"
         "    Saves render arguments to <name>.xml and rendered image to <name>.png\n"
         "    <ext1>     - " + fgImgCommonFormatsDescription() + "\n"
-        "render <name>\n"
-        "    Render using the arguments in <name>.xml (including the output image file name and type)");
+        "render [-t <threads>] [-r] <name>\n"
+        "    Render using the arguments in <name>.xml (including the output image file name and type)\n"
+        "    -t         - Number of render threads (default 0 uses all hardware threads)\n"
+        "    -r         - Use the z-buffer rasterizer (faster but ignores texture transparency)");
 
+    uint                numThreads = 0;
+    FgSoftRenderBackend backend = FgSoftRenderBackend::rayCast;
+    for (;;) {
+        if (syntax.peekNext() == "-t") {
+            syntax.next();
+            numThreads = syntax.nextAs<uint>();
+        }
+        else if (syntax.peekNext() == "-r") {
+            syntax.next();
+            backend = FgSoftRenderBackend::raster;
+        }
+        else
+            break;
+    }
     string          renderName = syntax.next();
     RenderArgs      renderArgs;
     if (syntax.more()) {
@@ -116,11 +132,13 @@ fgCmdRender(const FgArgs & args)
     }
 
     //! Load data from files:
-    vector<Fg3dMesh>    meshes(renderArgs.models.size());
+    FgStrings           triFiles;
+    for (size_t ii=0; ii<renderArgs.models.size(); ++ii)
+        triFiles.push_back(renderArgs.models[ii].triFilename);
+    vector<Fg3dMesh>    meshes = fgLoadTris(triFiles);
     FgMat33F            rotMatrix = FgMat33F(renderArgs.cam.rotateToHcs.asMatrix());
     for (size_t ii=0; ii<meshes.size(); ++ii) {
         const ModelFiles &  mf = renderArgs.models[ii];
-        meshes[ii] = fgLoadTri(mf.triFilename);
         if (!mf.imgFilename.empty())
             fgLoadImgAnyFormat(FgString(mf.imgFilename),meshes[ii].surfaces[0].albedoMapRef());
         meshes[ii].transform(rotMatrix);
@@ -150,7 +168,9 @@ fgCmdRender(const FgArgs & args)
             mvm,
             cam.itcsToIucs,
             renderArgs.backgroundColor,
-            renderArgs.antiAliasBitDepth);
+            renderArgs.antiAliasBitDepth,
+            numThreads,
+            backend);
     if (renderArgs.showSurfPoints) {
         FgMat44F     tt = FgMat44F(cam.toIpcsH(renderArgs.imagePixelSize));
         for (size_t mm=0; mm<meshes.size(); ++mm) {
@@ -240,4 +260,23 @@ fgRenderTest(const FgArgs & args)
         }
         fgThrow("Render test regression failure");
     }
+    // Tiled multi-threaded sampling must give exactly the same result as single-threaded:
+    FgImgRgbaUb     single;
+    fgCmdRender(fgSplitChar("render -t 1 render_test"));
+    fgLoadImgAnyFormat("render_test.png",single);
+    if (!(single.dataVec() == test.dataVec()))
+        fgThrow("Render test multi-threaded result differs from single-threaded");
+    // The rasterizer differs from the ray caster only in anti-aliasing and interpolation details:
+    FgImgRgbaUb     raster;
+    fgCmdRender(fgSplitChar("render -r render_test"));
+    fgLoadImgAnyFormat("render_test.png",raster);
+    double          rmsd = fgImgRmsd(raster,test);
+    fgout << fgnl << "Rasterizer RMSD from ray caster: " << rmsd;
+    if (rmsd > 8.0)
+        fgThrow("Render test rasterizer result differs from ray caster",fgToString(rmsd));
+    FgImgRgbaUb     rasterSingle;
+    fgCmdRender(fgSplitChar("render -r -t 1 render_test"));
+    fgLoadImgAnyFormat("render_test.png",rasterSingle);
+    if (!(rasterSingle.dataVec() == raster.dataVec()))
+        fgThrow("Render test multi-threaded rasterizer result differs from single-threaded");
 }
@@ -256,6 +256,7 @@ fgConsBase(bool win,bool nix)
     imgk.srcGroups.push_back(FgConsSrcGroup("tiff/libtiff/",imtf));
     sln.projects.push_back(imgk);
     incMain.push_back("../LibImageMagickCore/ImageMagick-6.6.2/");
+    incMain.push_back("../LibImageMagickCore/ImageMagick-6.6.2/zlib/");     // For direct use of libpng
     lnkMain.push_back("LibImageMagickCore");
     incMain.push_back("../LibUTF-8/");
     incMain.push_back("../LibTntJama/");
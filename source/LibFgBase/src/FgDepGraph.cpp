@@ -18,7 +18,9 @@
 
 using namespace std;
 
-FgDepGraph::FgDepGraph(uint num_threads)
+FgDepGraph::FgDepGraph(uint num_threads) :
+    m_inlineSeconds(0.001),
+    m_meanLinkSeconds(-1.0)
 {
     if (num_threads > 0)
         m_numThreads = num_threads;
@@ -110,23 +112,61 @@ FgDepGraph::dirtyLink(uint linkInd)
 void
 FgDepGraph::updateNode(uint nodeIdx) const
 {
-    Update          update;
+    if (!m_linkGraph.nodeData(nodeIdx).dirty)
+        return;
+    uint            numWorkers = std::max(numThreads(),1U);
+    bool            runInline = (numWorkers == 1);
+    if (!runInline && (m_inlineSeconds > 0.0) && (m_meanLinkSeconds >= 0.0)) {
+        vector<uint>    visited;
+        uint            num = countDirtyLinks(nodeIdx,inlineMaxLinks,visited);
+        runInline = (num < inlineMaxLinks) && (double(num) * m_meanLinkSeconds < m_inlineSeconds);
+    }
+    if (runInline) {
+        typedef std::chrono::steady_clock   Clock;
+        Clock::time_point                   start = Clock::now();
+        uint            linksRun = updateInline(nodeIdx);
+        if (linksRun > 0) {
+            ++m_stats.updates;
+            ++m_stats.inlineUpdates;
+            m_stats.linksRun += linksRun;
+            updateMeanLinkTime(std::chrono::duration<double>(Clock::now()-start).count(),linksRun);
+        }
+        return;
+    }
     vector<Sync>    linksSync(m_linkGraph.numLinks());
     // Traverse to find dirty leaves and set up scheduling on dirty non-leaves
-    update.queue = leafLinks(nodeIdx,linksSync);
-    if (update.queue.empty())
+    vector<uint>    leaves = leafLinks(nodeIdx,linksSync);
+    if (leaves.empty())
         return;
+    bool            serial = isChain(leaves,linksSync);
+    if (serial)
+        numWorkers = 1;
+    Update          update(numWorkers);
     update.lastLink = m_linkGraph.incomingLink(nodeIdx);
-    vector<FgSinglePtr<boost::thread> > threads(numThreads());
-    for (size_t tt=0; tt<threads.size(); ++tt)
-        threads[tt] = new boost::thread(
-            &FgDepGraph::executeLinkTask,this,&linksSync,&update,(tt == 0));
-    do {
-        boost::thread::yield();
+    // Spread the leaves so each worker starts with its own work:
+    for (size_t ii=0; ii<leaves.size(); ++ii)
+        update.queues[ii%numWorkers]->links.push_back(leaves[ii]);
+    update.queued = int(leaves.size());
+    if (numWorkers == 1)
+        executeLinkTask(&linksSync,&update,0);
+    else {
+        if (!m_pool)
+            m_pool.reset(new FgThreadPool(numWorkers));
+        vector<FgJob>   jobs(numWorkers);
+        for (uint ww=0; ww<numWorkers; ++ww)
+            jobs[ww] = boost::bind(&FgDepGraph::executeLinkTask,this,&linksSync,&update,ww);
+        // Exceptions from links are captured in 'update' so none are expected here:
+        m_pool->run(jobs);
     }
-    while (!update.done);
-    for (size_t tt=0; tt<threads.size(); ++tt)
-        threads[tt]->join();
+    ++m_stats.updates;
+    if (serial)
+        ++m_stats.serialUpdates;
+    else
+        ++m_stats.parallelUpdates;
+    m_stats.linksRun += update.linksRun;
+    m_stats.steals += update.steals;
+    m_stats.idleSeconds += update.idleSeconds;
+    updateMeanLinkTime(update.busySeconds,update.linksRun);
     if (update.flag) {
         if (update.userCancelled)
             throw FgExceptionUserCancel();
@@ -135,6 +175,104 @@ FgDepGraph::updateNode(uint nodeIdx) const
     }
 }
 
+uint
+FgDepGraph::countDirtyLinks(
+    uint            nodeIdx,
+    uint            maxLinks,
+    vector<uint> &  visited) const
+{
+    if ((visited.size() >= maxLinks) ||
+        (!m_linkGraph.nodeData(nodeIdx).dirty) ||
+        (!m_linkGraph.hasIncomingLink(nodeIdx)))
+        return uint(visited.size());
+    uint                    linkIdx = m_linkGraph.incomingLink(nodeIdx);
+    // Linear search is fine since 'maxLinks' is small:
+    if (fgContains(visited,linkIdx))
+        return uint(visited.size());
+    visited.push_back(linkIdx);
+    const vector<uint> &    srcNodes = m_linkGraph.linkSources(linkIdx);
+    for (size_t ii=0; ii<srcNodes.size(); ++ii)
+        countDirtyLinks(srcNodes[ii],maxLinks,visited);
+    return uint(visited.size());
+}
+
+uint
+FgDepGraph::updateInline(uint nodeIdx) const
+{
+    const FgDepNode &       nd = m_linkGraph.nodeData(nodeIdx);
+    if (!nd.dirty)
+        return 0;
+    if (!m_linkGraph.hasIncomingLink(nodeIdx)) {
+        nd.dirty = false;
+        return 0;
+    }
+    uint                    linkIdx = m_linkGraph.incomingLink(nodeIdx);
+    const vector<uint> &    srcNodes = m_linkGraph.linkSources(linkIdx);
+    uint                    ret = 0;
+    for (size_t ii=0; ii<srcNodes.size(); ++ii)
+        ret += updateInline(srcNodes[ii]);
+    if (m_cancelCheck)
+        if (m_cancelCheck() != 0)
+            throw FgExceptionUserCancel();
+    // Report exceptions the same way as scheduled updates:
+    FgException             err("");
+    try {
+        executeLink(linkIdx);
+        return ret + 1;
+    }
+    catch(FgException const & e) {
+        err = e;
+    }
+    catch(std::exception const & e) {
+        err = FgException("Standard library exception",e.what());
+    }
+    catch(...) {
+        err = FgException("Unknown exception type");
+    }
+    err.pushMsg(
+        "A computation within an FgDepGraph has generated an exception on link",
+        fgToString(linkIdx));
+    throw err;
+}
+
+bool
+FgDepGraph::isChain(
+    const vector<uint> &    leaves,
+    const vector<Sync> &    linksSync) const
+{
+    if (leaves.size() > 1)
+        return false;
+    // With a single leaf, any concurrency must come from a link enabling more than one other:
+    for (uint ll=0; ll<linksSync.size(); ++ll) {
+        if (!linksSync[ll].traversed)
+            continue;
+        uint                    numDeps = 0;
+        const vector<uint> &    sinks = m_linkGraph.linkSinks(ll);
+        for (size_t ii=0; ii<sinks.size(); ++ii) {
+            const vector<uint> &    deps = m_linkGraph.outgoingLinks(sinks[ii]);
+            for (size_t jj=0; jj<deps.size(); ++jj)
+                if (linksSync[deps[jj]].traversed)
+                    ++numDeps;
+        }
+        if (numDeps > 1)
+            return false;
+    }
+    return true;
+}
+
+void
+FgDepGraph::updateMeanLinkTime(double busySeconds,uint64 linksRun) const
+{
+    if (linksRun == 0)
+        return;
+    double          mean = busySeconds / double(linksRun);
+    // Exponential smoothing so a single slow update doesn't disable inlining for long:
+    if (m_meanLinkSeconds < 0.0)
+        m_meanLinkSeconds = mean;
+    else
+        m_meanLinkSeconds = 0.75 * m_meanLinkSeconds + 0.25 * mean;
+}
+
 vector<uint>
 FgDepGraph::leafLinks(
     uint            nodeIdx,
@@ -167,11 +305,8 @@ FgDepGraph::leafLinks(
     vector<uint>            ret;
     if (incomingRemaining == 0)     // This is a leaf link for the update calc:
         ret.push_back(linkIdx);
-    else {
-        // Set up scheduling for this link:
+    else
         sync.incomingRemaining = incomingRemaining;
-        sync.mtxPtr = new boost::mutex;
-    }
     // Continue the traverse (even for leaf nodes since we need to mark sources clean):
     for (size_t ii=0; ii<srcNodes.size(); ++ii)
         fgAppend(ret,leafLinks(srcNodes[ii],linksSync));
@@ -182,30 +317,37 @@ void
 FgDepGraph::executeLinkTask(
     vector<Sync> *  syncPtr,
     Update *        updPtr,
-    bool            doCancelCheck) const
+    uint            worker) const
 {
+    Update &    update = *updPtr;
+    // Only one thread polls for cancellation:
+    bool        doCancelCheck = ((worker == 0) && m_cancelCheck);
     uint        linkInd = 0;
+    typedef std::chrono::steady_clock   Clock;
+    // Accumulates this thread's time spent in links into 'update' on any exit:
+    struct      Busy
+    {
+        Update &    update;
+        double      seconds;
+        explicit Busy(Update & u) : update(u), seconds(0.0) {}
+        ~Busy()
+        {
+            boost::lock_guard<boost::mutex>     lock(update.mtx);
+            update.busySeconds += seconds;
+        }
+    };
+    Busy        busy(update);
     try {
-        while (!updPtr->done) {
-            // This check cannot depend on whether there are currently jobs
-            // in the queue, since only one thread is doing the checking:
+        vector<uint>    todo;
+        while (!update.done) {
             if (doCancelCheck) {
-                if (m_cancelCheck) {
-                    if (m_cancelCheck() != 0) {
-                        updPtr->cancel();
-                        return;
-                    }
+                if (m_cancelCheck() != 0) {
+                    update.cancel();
+                    return;
                 }
             }
-            updPtr->guardQueue->lock();
-            bool    empty = updPtr->queue.empty();
-            if (!empty) {
-                linkInd = updPtr->queue.back();
-                updPtr->queue.pop_back();
-            }
-            updPtr->guardQueue->unlock();
-            if (empty) {
-                boost::thread::yield();
+            if (!update.pop(worker,linkInd)) {
+                update.wait(doCancelCheck);
                 continue;
             }
             bool    followNext = false;
@@ -213,12 +355,15 @@ FgDepGraph::executeLinkTask(
             // rest. This optimization saves about a per-cent by reducing contention
             // on the queue:
             do {
+                Clock::time_point   start = Clock::now();
                 executeLink(linkInd);
-                if (linkInd == updPtr->lastLink) {
-                    updPtr->done = true;
+                busy.seconds += std::chrono::duration<double>(Clock::now()-start).count();
+                ++update.linksRun;
+                if (linkInd == update.lastLink) {
+                    update.finish();
                     return;
                 }
-                vector<uint>            todo;
+                todo.clear();
                 const vector<uint> &    sinkNodes = m_linkGraph.linkSinks(linkInd);
                 for (size_t ii=0; ii<sinkNodes.size(); ++ii) {
                     uint    nodeIdx = sinkNodes[ii];
@@ -226,9 +371,7 @@ FgDepGraph::executeLinkTask(
                     for (size_t jj=0; jj<depLinks.size(); ++jj) {
                         Sync &  sync = (*syncPtr)[depLinks[jj]];
                         if (sync.traversed) {
-                            sync.mtxPtr->lock();
                             int     ir = --sync.incomingRemaining;
-                            sync.mtxPtr->unlock();
                             FGASSERT(ir >= 0);
                             if (ir == 0)
                                 todo.push_back(depLinks[jj]);
@@ -236,24 +379,19 @@ FgDepGraph::executeLinkTask(
                     }
                 }
                 if (!todo.empty()) {
-                    if (updPtr->done)
+                    if (update.done)
                         return;
                     if (doCancelCheck) {
-                        if (m_cancelCheck) {
-                            if (m_cancelCheck() != 0) {
-                                updPtr->cancel();
-                                return;
-                            }
+                        if (m_cancelCheck() != 0) {
+                            update.cancel();
+                            return;
                         }
                     }
                     linkInd = todo.back();
                     followNext = true;
                     todo.pop_back();
-                    if (!todo.empty()) {
-                        updPtr->guardQueue->lock();
-                        fgAppend(updPtr->queue,todo);
-                        updPtr->guardQueue->unlock();
-                    }
+                    if (!todo.empty())
+                        update.push(worker,todo);
                 }
                 else
                     followNext = false;
@@ -261,14 +399,102 @@ FgDepGraph::executeLinkTask(
         }
     }
     catch(FgException const & e) {
-        updPtr->set(e,linkInd);
+        update.set(e,linkInd);
     }
     catch(std::exception const & e) {
-        updPtr->set(FgException("Standard library exception",e.what()),linkInd);
+        update.set(FgException("Standard library exception",e.what()),linkInd);
     }
     catch(...) {
-        updPtr->set(FgException("Unknown exception type"),linkInd);
+        update.set(FgException("Unknown exception type"),linkInd);
+    }
+}
+
+FgDepGraph::Update::Update(uint numWorkers) :
+    queued(0),
+    done(false),
+    sleepers(0),
+    linksRun(0),
+    steals(0),
+    lastLink(0),
+    idleSeconds(0.0),
+    busySeconds(0.0),
+    flag(false),
+    exception(""),
+    userCancelled(false)
+{
+    for (uint ii=0; ii<numWorkers; ++ii)
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue));
+}
+
+void
+FgDepGraph::Update::push(uint worker,const vector<uint> & links)
+{
+    WorkQueue &     wq = *queues[worker];
+    {
+        boost::lock_guard<boost::mutex>     lock(wq.mtx);
+        wq.links.insert(wq.links.end(),links.begin(),links.end());
+    }
+    queued += int(links.size());
+    // 'queued' is incremented before 'sleepers' is read, and a waiter increments 'sleepers'
+    // before reading 'queued', so at least one of us sees the other (both are seq_cst):
+    if (sleepers > 0) {
+        boost::lock_guard<boost::mutex>     lock(mtx);
+        cv.notify_all();
+    }
+}
+
+bool
+FgDepGraph::Update::pop(uint worker,uint & linkIdx)
+{
+    if (queued <= 0)
+        return false;
+    size_t          num = queues.size();
+    for (size_t ii=0; ii<num; ++ii) {
+        WorkQueue &     wq = *queues[(worker+ii)%num];
+        boost::lock_guard<boost::mutex>     lock(wq.mtx);
+        if (wq.links.empty())
+            continue;
+        // Own queue LIFO for locality, others FIFO to take the oldest (likely largest) work:
+        if (ii == 0) {
+            linkIdx = wq.links.back();
+            wq.links.pop_back();
+        }
+        else {
+            linkIdx = wq.links.front();
+            wq.links.pop_front();
+            ++steals;
+        }
+        --queued;
+        return true;
     }
+    return false;
+}
+
+void
+FgDepGraph::Update::wait(bool timeout)
+{
+    typedef std::chrono::steady_clock   Clock;
+    Clock::time_point                   start = Clock::now();
+    {
+        boost::unique_lock<boost::mutex>    lock(mtx);
+        ++sleepers;
+        if ((queued <= 0) && !done) {
+            if (timeout)
+                cv.timed_wait(lock,boost::posix_time::milliseconds(10));
+            else
+                cv.wait(lock);
+        }
+        --sleepers;
+        idleSeconds += std::chrono::duration<double>(Clock::now()-start).count();
+    }
+}
+
+void
+FgDepGraph::Update::finish()
+{
+    boost::lock_guard<boost::mutex>     lock(mtx);
+    done = true;
+    cv.notify_all();
 }
 
 void
@@ -276,17 +502,41 @@ FgDepGraph::Update::set(
     const FgException &     e,
     uint                    linkIdx)
 {
-    guardException->lock();
-    bool prior = flag;
-    flag = true;
-    guardException->unlock();
-    if (!prior) {   // If another thread hasn't already reported an exception:
-        done = true;
+    boost::lock_guard<boost::mutex>     lock(mtx);
+    if (!flag) {    // If another thread hasn't already reported an exception:
+        flag = true;
         exception = e;
         exception.pushMsg(
             "A computation within an FgDepGraph has generated an exception on link",
             fgToString(linkIdx));
+        done = true;
+        cv.notify_all();
+    }
+}
+
+void
+FgDepGraph::Update::cancel()
+{
+    boost::lock_guard<boost::mutex>     lock(mtx);
+    if (!flag) {
+        flag = true;
+        userCancelled = true;
+        done = true;
+        cv.notify_all();
     }
 }
 
+std::ostream &
+operator<<(std::ostream & os,const FgDepGraphStats & s)
+{
+    return os
+        << "updates: " << s.updates
+        << " (inline: " << s.inlineUpdates
+        << " serial: " << s.serialUpdates
+        << " parallel: " << s.parallelUpdates << ")"
+        << " links run: " << s.linksRun
+        << " steals: " << s.steals
+        << " idle: " << s.idleSeconds << "s";
+}
+
 // */
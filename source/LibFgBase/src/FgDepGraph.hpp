@@ -16,7 +16,8 @@
 // Link functions must be of type FgLink
 // Nodes are stored as FgVariants
 // Updating is done lazily when a desired output value is requested
-// Updates are fully multithreaded using the number of virtual cores by default
+// Updates are fully multithreaded using the number of virtual cores by default, on a pool of
+// threads owned by the graph which persists between updates
 //
 // INVARIANTS:
 //
@@ -37,6 +38,7 @@
 #include "FgVariant.hpp"
 #include "FgOpt.hpp"
 #include "FgSmartPtr.hpp"
+#include "FgThread.hpp"
 
 typedef boost::function<void(const vector<const FgVariant *> &,const vector<FgVariant*> &)> FgLink;
 
@@ -123,16 +125,63 @@ struct  FgDepNode
     }
 };
 
+// Cumulative scheduling statistics for an FgDepGraph:
+struct  FgDepGraphStats
+{
+    uint64      updates;        // Updates which had at least one link to run. Sum of the 3 below:
+    uint64      inlineUpdates;  // Run recursively on the calling thread (small estimated work)
+    uint64      serialUpdates;  // Run on the calling thread since the dirty links form a chain
+    uint64      parallelUpdates;
+    uint64      linksRun;
+    uint64      steals;         // Links run by a thread other than the one that scheduled them
+    double      idleSeconds;    // Summed over threads; time blocked waiting for a runnable link
+
+    FgDepGraphStats() :
+        updates(0), inlineUpdates(0), serialUpdates(0), parallelUpdates(0),
+        linksRun(0), steals(0), idleSeconds(0.0)
+    {}
+};
+
+std::ostream &
+operator<<(std::ostream &,const FgDepGraphStats &);
+
 class   FgDepGraph
 {
     FgLinkGraph<FgDepNode,FgLink>   m_linkGraph;
     boost::function<int()>          m_cancelCheck;  // If valid and returns non-zero, cancel calculations
     uint                            m_numThreads;   // Defaults to number of hardware supported threads
+    // Created on first parallel update. Not shared between copies since it's per-graph state:
+    mutable std::unique_ptr<FgThreadPool>   m_pool;
+    mutable FgDepGraphStats         m_stats;
+    double                          m_inlineSeconds;    // See 'setInlineThreshold'
+    mutable double                  m_meanLinkSeconds;  // Running estimate. Negative if unknown
 
 public:
     explicit
     FgDepGraph(uint num_threads=0);
 
+    FgDepGraph(const FgDepGraph & rhs) :
+        m_linkGraph(rhs.m_linkGraph),
+        m_cancelCheck(rhs.m_cancelCheck),
+        m_numThreads(rhs.m_numThreads),
+        m_inlineSeconds(rhs.m_inlineSeconds),
+        m_meanLinkSeconds(rhs.m_meanLinkSeconds)
+    {}
+
+    FgDepGraph &
+    operator=(const FgDepGraph & rhs)
+    {
+        m_linkGraph = rhs.m_linkGraph;
+        m_cancelCheck = rhs.m_cancelCheck;
+        if (m_numThreads != rhs.m_numThreads)
+            m_pool.reset();
+        m_numThreads = rhs.m_numThreads;
+        m_stats = FgDepGraphStats();
+        m_inlineSeconds = rhs.m_inlineSeconds;
+        m_meanLinkSeconds = rhs.m_meanLinkSeconds;
+        return *this;
+    }
+
     template<class T>
     FgDgn<T>
     addNode(
@@ -286,6 +335,28 @@ public:
     linkGraph() const
     {return m_linkGraph; }
 
+    const FgDepGraphStats &
+    stats() const
+    {return m_stats; }
+
+    void
+    resetStats()
+    {m_stats = FgDepGraphStats(); }
+
+    // Updates whose estimated work (number of dirty links times the measured mean link time)
+    // is less than this are run recursively on the calling thread, avoiding scheduling overhead.
+    // The estimate is only made for up to 'inlineMaxLinks' dirty links, and the first update
+    // (before any link has been timed) is always scheduled. 0 disables inline updates:
+    void
+    setInlineThreshold(double seconds)
+    {m_inlineSeconds = seconds; }
+
+    double
+    inlineThreshold() const
+    {return m_inlineSeconds; }
+
+    static const uint   inlineMaxLinks = 32;
+
 private:
     void
     dirtyNode(uint nodeInd);
@@ -298,60 +369,90 @@ private:
 
     struct  Sync
     {
-        Sync() : traversed(false) {}
-        bool        traversed;              // Initial scheduling traverse flag
-        FgSinglePtr<boost::mutex> mtxPtr;   // Guard following member:
-        int         incomingRemaining;      // How many input nodes need to be updated before this link runs ?
+        Sync() : traversed(false), incomingRemaining(0) {}
+        bool                traversed;          // Initial scheduling traverse flag
+        std::atomic<int>    incomingRemaining;  // How many input nodes need to be updated before this link runs ?
+    };
+    // Each thread runs links from the back of its own queue, and steals from the front of
+    // the others' when its own is empty:
+    struct  WorkQueue
+    {
+        boost::mutex                mtx;
+        std::deque<uint>            links;
     };
     struct  Update
     {
-        Update() :
-            guardException(new boost::mutex),
-            flag(false),
-            exception(""),
-            guardQueue(new boost::mutex),
-            done(false),
-            userCancelled(false)
-            {}
-        std::unique_ptr<boost::mutex> guardException; // Guard 2 members below:
+        explicit
+        Update(uint numWorkers);
+
+        vector<std::unique_ptr<WorkQueue> > queues;    // One per worker
+        std::atomic<int>            queued;         // Total links in 'queues'
+        std::atomic<bool>           done;
+        std::atomic<uint>           sleepers;       // Workers waiting on 'cv'
+        std::atomic<uint64>         linksRun;
+        std::atomic<uint64>         steals;
+        uint                        lastLink;
+        boost::mutex                mtx;            // For 'cv' and guards all members below:
+        boost::condition_variable   cv;
+        double                      idleSeconds;
+        double                      busySeconds;    // Summed over threads; time spent in links
         bool                        flag;           // Error or cancellation exception has occurred
         FgException                 exception;
-        std::unique_ptr<boost::mutex> guardQueue;
-        char                        cachePad0[64-sizeof(std::unique_ptr<boost::mutex>)];
-        vector<uint>                queue;
-        char                        cachePad1[64-sizeof(size_t)];
-        uint                        lastLink;
-        bool                        done;
         bool                        userCancelled;
 
+        void
+        push(uint worker,const vector<uint> & links);
+
+        // Returns false if there was nothing to run:
+        bool
+        pop(uint worker,uint & linkIdx);
+
+        // Block until there may be work or the update is done. With 'timeout' wake regularly
+        // so the caller can poll for cancellation:
+        void
+        wait(bool timeout);
+
+        void
+        finish();
+
         void
         set(const FgException &,uint);
 
         void
-        cancel()        // Not MT safe, only call from 1 thread.
-        {
-            guardException->lock();
-            bool prior = flag;
-            flag = true;
-            guardException->unlock();
-            if (!prior) {   // If another thread hasn't already reported an exception:
-                done = true;
-                userCancelled = true;
-            }
-        }
+        cancel();
     };
 
     void
     updateNode(uint nodeInd) const;
 
+    // Counts the dirty links 'nodeIdx' depends on, stopping when 'maxLinks' is reached:
+    uint
+    countDirtyLinks(
+        uint                nodeIdx,
+        uint                maxLinks,
+        vector<uint> &      visited) const;     // Links counted so far
+
+    // Depth-first update on the calling thread. Returns the number of links run:
+    uint
+    updateInline(uint nodeIdx) const;
+
     // Returns: true if links were scheduled that ultimately will update 'nodeIdx':
     vector<uint>
     leafLinks(
         uint                nodeIdx,
         vector<Sync> & linksTraversed) const;
 
+    // True if no link in the update can run concurrently with another:
+    bool
+    isChain(
+        const vector<uint> &    leaves,
+        const vector<Sync> &    linksSync) const;
+
+    void
+    executeLinkTask(vector<Sync> *,Update *,uint worker) const;
+
     void
-    executeLinkTask(vector<Sync> *,Update *,bool) const;
+    updateMeanLinkTime(double busySeconds,uint64 linksRun) const;
 };
 
 struct  FgLinkTime
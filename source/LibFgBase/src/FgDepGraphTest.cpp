@@ -222,6 +222,10 @@ testCalcMulti(uint threads)
     double secs = timer.read();
     fgout << fgnl << "Test took " << secs << " seconds ";
     FGASSERT(sum == N*s_fib(40));
+    const FgDepGraphStats & stats = m_graph.stats();
+    fgout << fgnl << stats;
+    FGASSERT(stats.updates == 1);
+    FGASSERT(stats.linksRun == N+1);
 }
 
 static void
@@ -273,6 +277,50 @@ testDepGraphExceptions()
     fgout.pop();
 }
 
+// Many small updates on the same graph re-use its thread pool:
+static void
+testDepGraphRepeated()
+{
+    FgDepGraph      dg(2);
+    uint            idxA = dg.addNode(0,"A"),
+                    idxB = dg.addNode(0,"B"),
+                    idxC = dg.addNode(0,"C"),
+                    idxD = dg.addNode(0,"D");
+    dg.addLink(calcAddInts,fgSvec(idxA),fgSvec(idxB));
+    dg.addLink(calcAddInts,fgSvec(idxA),fgSvec(idxC));
+    dg.addLink(calcAddInts,fgSvec(idxB,idxC),fgSvec(idxD));
+    // With a threshold no update can reach, the path taken doesn't depend on timing:
+    dg.setInlineThreshold(1.0e9);
+    for (int ii=0; ii<1000; ++ii) {
+        dg.setNodeVal(idxA,ii);
+        int     val = dg.valueCRef(idxD);
+        FGASSERT(val == 2*ii);
+    }
+    const FgDepGraphStats & stats = dg.stats();
+    fgout << fgnl << stats;
+    FGASSERT(stats.updates == 1000);
+    FGASSERT(stats.linksRun == 3000);
+    // The first update must be scheduled since link times are unknown, after which all run inline
+    // and each runs every link exactly once:
+    FGASSERT(stats.parallelUpdates == 1);
+    FGASSERT(stats.inlineUpdates == 999);
+    dg.resetStats();
+    dg.setInlineThreshold(0.0);
+    dg.setNodeVal(idxA,1);
+    dg.valueCRef(idxD);
+    FGASSERT(dg.stats().parallelUpdates == 1);
+    // A chain of dirty links is never run in parallel:
+    dg.setNodeVal(idxA,2);
+    dg.valueCRef(idxB);
+    FGASSERT(dg.stats().serialUpdates == 1);
+    // Copies don't share scheduling state:
+    FgDepGraph      dg2(dg);
+    FGASSERT(dg2.stats().updates == 0);
+    dg2.setNodeVal(idxA,7);
+    int             val = dg2.valueCRef(idxD);
+    FGASSERT(val == 14);
+}
+
 static void
 testDepGraphCopyable()
 {
@@ -325,6 +373,7 @@ fgDepGraphTest(const FgArgs &)
     testDepGraphExceptions();
     testDepGraphExceptionsMulti();
     testDepGraphCopyable();
+    testDepGraphRepeated();
     fg_debug_thread = false;
     testDepGraphMulti();
 }
@@ -173,6 +173,33 @@ fgDump(
     const std::string & data,
     const FgString &    filename);
 
+// Read-only memory map of an entire file, for parsing large files without copying them.
+// An empty file maps to a null 'data()'. Throws if the file cannot be opened or mapped:
+class   FgFileMap
+{
+public:
+    explicit
+    FgFileMap(const FgString & filename);
+
+    ~FgFileMap();
+
+    const char *
+    data() const
+    {return m_data; }
+
+    size_t
+    size() const
+    {return m_size; }
+
+private:
+    const char *        m_data;
+    size_t              m_size;
+    void *              m_handle;       // OS file mapping handle (Windows only)
+
+    FgFileMap(const FgFileMap &);       // Not copyable
+    void operator=(const FgFileMap &);
+};
+
 // Returns true if identical:
 bool
 fgBinaryFileCompare(
@@ -78,6 +78,101 @@ FgGridTriangles::intersects(const FgVect3UIs & tris,const FgVect2Fs & verts,FgVe
     }
 }
 
+// Intersect up to N positions with fixed-width lane arrays so the inner loop vectorizes:
+template<uint N>
+static
+void
+intersectLanes(
+    const FgGridTriangles & gt,
+    const FgVect3UIs &      tris,
+    const FgVect2Fs &       verts,
+    const FgFlts &          depths,
+    const FgVect2F *        pos,
+    uint                    num,
+    FgTriPointsByDepth *    ret)
+{
+    float               px[N] = {0},
+                        py[N] = {0};
+    const FgUints *     bins[N] = {NULL};
+    for (uint ll=0; ll<num; ++ll) {
+        FgVect2F        gridCoord = gt.clientToGridIpcs * pos[ll];
+        px[ll] = pos[ll][0];
+        py[ll] = pos[ll][1];
+        ret[ll].clear();
+        if (fgBoundsIncludes(gt.grid.dims(),gridCoord))
+            bins[ll] = &gt.grid[FgVect2UI(gridCoord)];
+    }
+    // Each pass handles all remaining lanes sharing the bin of the first remaining lane:
+    for (uint lead=0; lead<num; ++lead) {
+        const FgUints *     bin = bins[lead];
+        if (bin == NULL)
+            continue;
+        bool                inBin[N];
+        for (uint ll=0; ll<N; ++ll) {
+            inBin[ll] = (bins[ll] == bin);
+            if (inBin[ll])
+                bins[ll] = NULL;
+        }
+        for (size_t ii=0; ii<bin->size(); ++ii) {
+            uint            triIdx = (*bin)[ii];
+            FgVect3UI       tri = tris[triIdx];
+            FgVect2F        v0 = verts[tri[0]],
+                            v1 = verts[tri[1]],
+                            v2 = verts[tri[2]];
+            // Same formulation as 'fgBarycentricCoords' but evaluated across all lanes:
+            float           c0[N],c1[N],c2[N];
+            for (uint ll=0; ll<N; ++ll) {
+                float       u0x = v0[0]-px[ll], u0y = v0[1]-py[ll],
+                            u1x = v1[0]-px[ll], u1y = v1[1]-py[ll],
+                            u2x = v2[0]-px[ll], u2y = v2[1]-py[ll];
+                c0[ll] = u1x*u2y - u2x*u1y;
+                c1[ll] = u2x*u0y - u0x*u2y;
+                c2[ll] = u0x*u1y - u1x*u0y;
+            }
+            for (uint ll=0; ll<num; ++ll) {
+                float       d = c0[ll] + c1[ll] + c2[ll];
+                if (!inBin[ll] || (d == 0.0f))
+                    continue;
+                float       id = 1.0f / d;
+                FgVect3F    bc(c0[ll]*id,c1[ll]*id,c2[ll]*id);
+                if (fgMinElem(bc) >= 0.0f) {
+                    FgTriPoint  tp;
+                    tp.triInd = triIdx;
+                    tp.pointInds = tri;
+                    tp.baryCoord = bc;
+                    float       depth =
+                        bc[0] * depths[tri[0]] +
+                        bc[1] * depths[tri[1]] +
+                        bc[2] * depths[tri[2]];
+                    ret[ll].update(depth,tp);
+                }
+            }
+        }
+    }
+}
+
+void
+FgGridTriangles::intersectsPacket(
+    const FgVect3UIs &      tris,
+    const FgVect2Fs &       verts,
+    const FgFlts &          depths,
+    const FgVect2F *        pos,
+    uint                    num,
+    FgTriPointsByDepth *    ret) const
+{
+    const uint          np = fgGridPacketSize;
+    for (uint base=0; base<num; base+=np) {
+        uint            nl = std::min(num-base,np);
+        // Narrower lanes for the single and quad queries of adaptive subdivision:
+        if (nl == 1)
+            intersectLanes<1>(*this,tris,verts,depths,pos+base,nl,ret+base);
+        else if (nl <= 4)
+            intersectLanes<4>(*this,tris,verts,depths,pos+base,nl,ret+base);
+        else
+            intersectLanes<np>(*this,tris,verts,depths,pos+base,nl,ret+base);
+    }
+}
+
 FgGridTriangles
 fgGridTriangles(const FgVect2Fs & verts,const FgVect3UIs & tris,float binsPerTri)
 {
@@ -168,6 +263,22 @@ fgGridTrianglesTest(const FgArgs &)
         else
             FGASSERT(res.size() == 0);
     }
+    // Packet queries must agree with single queries, including positions outside the grid:
+    FgFlts                      depths(verts.size(),1.0f);
+    FgVect2Fs                   poss;
+    for (uint ii=0; ii<37; ++ii)
+        poss.push_back(FgVect2F(FgVect2D(fgRand(),fgRand()) * 10.2 - FgVect2D(0.1)));
+    vector<FgTriPointsByDepth>  pres(poss.size());
+    gts.intersectsPacket(tris,verts,depths,&poss[0],uint(poss.size()),&pres[0]);
+    for (size_t ii=0; ii<poss.size(); ++ii) {
+        vector<FgTriPoint>  sres = gts.intersects(tris,verts,poss[ii]);
+        FGASSERT(pres[ii].num() == sres.size());
+        if (!sres.empty()) {
+            FgTriPoint      isect = pres[ii][0].val;
+            FGASSERT(isect.triInd == sres[0].triInd);
+            FGASSERT(fgApproxEqual(isect.baryCoord,sres[0].baryCoord,1024));   // Single vs double precision
+        }
+    }
     // Query outside grid area:
     vector<FgTriPoint> res = gts.intersects(tris,verts,FgVect2F(-0.1f,0.0f));
     FGASSERT(res.size() == 0);
@@ -16,6 +16,7 @@
 
 #include "FgImage.hpp"
 #include "FgAffineCwC.hpp"
+#include "FgBestN.hpp"
 
 struct  FgTriPoint
 {
@@ -24,6 +25,13 @@ struct  FgTriPoint
     FgVect3F    baryCoord;
 };
 
+// Closest intersections by depth for one sample position:
+typedef FgBestN<float,FgTriPoint,8>     FgTriPointsByDepth;
+
+// Number of sample positions intersected together by 'FgGridTriangles::intersectsPacket'.
+// Positions are processed as fixed-width float lanes so the inner loops vectorize:
+const uint  fgGridPacketSize = 8;
+
 struct  FgGridTriangles
 {
     FgAffineCw2F            clientToGridIpcs;
@@ -54,6 +62,18 @@ struct  FgGridTriangles
         intersects(tris,verts,pos,ret);
         return ret;
     }
+
+    // Intersect 'num' sample positions at once, in packets of 'fgGridPacketSize'. Neighbouring
+    // positions usually share a bin, whose triangles are then tested against all those
+    // positions together in single precision. No heap allocation:
+    void
+    intersectsPacket(
+        const FgVect3UIs &  tris,       // Must be same list used to initialize index
+        const FgVect2Fs &   verts,      // "
+        const FgFlts &      depths,     // Must be 1-1 with 'verts'
+        const FgVect2F *    pos,
+        uint                num,
+        FgTriPointsByDepth * ret) const;    // RETURNED: 'num' results 1-1 with 'pos'
 };
 
 FgGridTriangles
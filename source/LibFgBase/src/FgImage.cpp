@@ -11,6 +11,7 @@
 
 #include "FgImage.hpp"
 #include "FgMath.hpp"
+#include "FgThread.hpp"
 
 using namespace std;
 
@@ -282,79 +283,274 @@ fgImgGetIrcsToBounds(
     return FgAffine2D(centre,linear);
 }
 
+// Filter taps along one axis. Each destination index uses 'numTaps' consecutive source
+// indices starting at 'beg[dd]', with weights 'wgts[dd*numTaps ...]' (zero-padded, summing
+// to 1). Edge samples are clamped so the window always lies within the source:
+struct  ResizeTaps
+{
+    uint                numTaps;
+    vector<uint>        beg;
+    vector<float>       wgts;
+};
+
+static
+double
+resizeKernel(FgResizeFilter filter,double xx)
+{
+    xx = std::abs(xx);
+    if (filter == FgResizeFilter::bilinear)
+        return (xx < 1.0) ? 1.0 - xx : 0.0;
+    if (filter == FgResizeFilter::lanczos3) {
+        if (xx < 1.0e-8)
+            return 1.0;
+        if (xx >= 3.0)
+            return 0.0;
+        double      px = fgPi() * xx;
+        return 3.0 * sin(px) * sin(px / 3.0) / (px * px);
+    }
+    // Mitchell-Netravali with B = C = 1/3:
+    if (xx < 1.0)
+        return (7.0 * xx*xx*xx - 12.0 * xx*xx + 16.0/3.0) / 6.0;
+    if (xx < 2.0)
+        return (-7.0/3.0 * xx*xx*xx + 12.0 * xx*xx - 20.0 * xx + 32.0/3.0) / 6.0;
+    return 0.0;
+}
+
+static
+double
+resizeSupport(FgResizeFilter filter)
+{
+    if (filter == FgResizeFilter::bilinear)
+        return 1.0;
+    if (filter == FgResizeFilter::lanczos3)
+        return 3.0;
+    return 2.0;
+}
+
+static
+ResizeTaps
+resizeTaps(uint srcSz,uint dstSz,FgResizeFilter filter)
+{
+    double              scale = double(srcSz) / double(dstSz);  // Source pixels per destination pixel
+    vector<uint>        los(dstSz);
+    vector<FgFlts>      ws(dstSz);
+    uint                numTaps = 0;
+    for (uint dd=0; dd<dstSz; ++dd) {
+        double          lo,hi;
+        if (filter == FgResizeFilter::box) {
+            // Exact proportion of each source pixel covered by the back-projected destination pixel:
+            lo = dd * scale;
+            hi = lo + scale;
+        }
+        else {
+            // Filters are stretched when shrinking to avoid aliasing:
+            double      support = resizeSupport(filter) * std::max(scale,1.0),
+                        centre = (dd + 0.5) * scale - 0.5;
+            lo = centre - support;
+            hi = centre + support;
+        }
+        int             ilo = std::max(int(floor(lo)),0),
+                        ihi = std::min(int(ceil(hi)),int(srcSz)-1);
+        if (ihi < ilo)                      // Can only happen due to rounding at the edges
+            ilo = ihi = std::min(std::max(ilo,0),int(srcSz)-1);
+        FgFlts &        wgts = ws[dd];
+        wgts.resize(ihi-ilo+1,0.0f);
+        double          sum = 0.0;
+        // Weights outside the source are clamped to the nearest edge pixel:
+        int             elo = int(floor(lo)),
+                        ehi = int(ceil(hi));
+        for (int ss=elo; ss<=ehi; ++ss) {
+            double      ww;
+            if (filter == FgResizeFilter::box)
+                ww = std::max(std::min(hi,ss+1.0) - std::max(lo,double(ss)),0.0);
+            else {
+                double  centre = (dd + 0.5) * scale - 0.5;
+                ww = resizeKernel(filter,(ss - centre) / std::max(scale,1.0));
+            }
+            wgts[std::min(std::max(ss,ilo),ihi)-ilo] += float(ww);
+            sum += ww;
+        }
+        if (sum != 0.0)
+            for (size_t ii=0; ii<wgts.size(); ++ii)
+                wgts[ii] = float(wgts[ii] / sum);
+        los[dd] = uint(ilo);
+        numTaps = std::max(numTaps,uint(wgts.size()));
+    }
+    ResizeTaps          ret;
+    ret.numTaps = numTaps;
+    ret.beg.resize(dstSz);
+    ret.wgts.resize(size_t(dstSz)*numTaps,0.0f);
+    for (uint dd=0; dd<dstSz; ++dd) {
+        uint            beg = std::min(los[dd],srcSz-numTaps),
+                        off = los[dd] - beg;
+        ret.beg[dd] = beg;
+        for (size_t ii=0; ii<ws[dd].size(); ++ii)
+            ret.wgts[dd*numTaps+off+ii] = ws[dd][ii];
+    }
+    return ret;
+}
+
+static inline
+float
+resizeToFloat(uchar val)
+{return float(val); }
+
+static inline
+float
+resizeToFloat(float val)
+{return val; }
+
+static inline
+void
+resizeFromFloat(float val,uchar & ret)
+{ret = uchar(std::min(std::max(val+0.5f,0.0f),255.0f)); }
+
+static inline
+void
+resizeFromFloat(float val,float & ret)
+{ret = val; }
+
+// Horizontal pass over source rows [rowBeg,rowEnd) into the float buffer 'tmp'.
+// 'C' is the number of channels of type 'T' per pixel:
+template<typename T,uint C>
+static
+void
+resizeRows(
+    const T *           src,
+    uint                srcWid,
+    const ResizeTaps &  taps,
+    uint                dstWid,
+    uint                rowBeg,
+    uint                rowEnd,
+    float *             tmp)
+{
+    vector<float>       row(size_t(srcWid)*C);
+    for (uint yy=rowBeg; yy<rowEnd; ++yy) {
+        const T *       srow = src + size_t(yy)*srcWid*C;
+        for (size_t ii=0; ii<row.size(); ++ii)
+            row[ii] = resizeToFloat(srow[ii]);
+        float *         drow = tmp + size_t(yy)*dstWid*C;
+        for (uint xx=0; xx<dstWid; ++xx) {
+            const float *   ww = &taps.wgts[size_t(xx)*taps.numTaps];
+            const float *   sp = &row[size_t(taps.beg[xx])*C];
+            float           acc[C] = {};
+            for (uint tt=0; tt<taps.numTaps; ++tt)
+                for (uint cc=0; cc<C; ++cc)
+                    acc[cc] += ww[tt] * sp[tt*C+cc];
+            for (uint cc=0; cc<C; ++cc)
+                drow[xx*C+cc] = acc[cc];
+        }
+    }
+}
+
+// Vertical pass from the float buffer 'tmp' into destination rows [rowBeg,rowEnd):
+template<typename T>
+static
+void
+resizeCols(
+    const float *       tmp,
+    size_t              rowSz,          // Channel values per row
+    const ResizeTaps &  taps,
+    uint                rowBeg,
+    uint                rowEnd,
+    T *                 dst)
+{
+    vector<float>       acc(rowSz);
+    for (uint yy=rowBeg; yy<rowEnd; ++yy) {
+        std::fill(acc.begin(),acc.end(),0.0f);
+        const float *   ww = &taps.wgts[size_t(yy)*taps.numTaps];
+        for (uint tt=0; tt<taps.numTaps; ++tt) {
+            float           wt = ww[tt];
+            if (wt == 0.0f)
+                continue;
+            const float *   sp = tmp + (taps.beg[yy]+tt)*rowSz;
+            for (size_t ii=0; ii<rowSz; ++ii)
+                acc[ii] += wt * sp[ii];
+        }
+        T *             drow = dst + yy*rowSz;
+        for (size_t ii=0; ii<rowSz; ++ii)
+            resizeFromFloat(acc[ii],drow[ii]);
+    }
+}
+
+template<typename T,uint C>
+static
+void
+resizeSeparable(
+    const T *           src,
+    FgVect2UI           srcDims,
+    T *                 dst,
+    FgVect2UI           dstDims,
+    FgResizeFilter      filter)
+{
+    ResizeTaps          tx = resizeTaps(srcDims[0],dstDims[0],filter),
+                        ty = resizeTaps(srcDims[1],dstDims[1],filter);
+    size_t              rowSz = size_t(dstDims[0])*C;
+    vector<float>       tmp(rowSz*srcDims[1]);
+    // Row bands are only worth distributing for larger images:
+    double              work = double(rowSz) * (double(srcDims[1])*tx.numTaps + double(dstDims[1])*ty.numTaps);
+    uint                numBands = (work < 1.0e6) ? 1 : fgThreadPool().numThreads() * 4;
+    vector<FgJob>       jobs;
+    for (uint bb=0; bb<numBands; ++bb) {
+        uint            beg = uint(uint64(srcDims[1])*bb/numBands),
+                        end = uint(uint64(srcDims[1])*(bb+1)/numBands);
+        if (end > beg)
+            jobs.push_back(boost::bind(resizeRows<T,C>,src,srcDims[0],boost::cref(tx),dstDims[0],beg,end,tmp.data()));
+    }
+    fgThreadPool().run(jobs);
+    jobs.clear();
+    for (uint bb=0; bb<numBands; ++bb) {
+        uint            beg = uint(uint64(dstDims[1])*bb/numBands),
+                        end = uint(uint64(dstDims[1])*(bb+1)/numBands);
+        if (end > beg)
+            jobs.push_back(boost::bind(resizeCols<T>,tmp.data(),rowSz,boost::cref(ty),beg,end,dst));
+    }
+    fgThreadPool().run(jobs);
+}
+
 void
 fgImgResize(
-	const FgImgRgbaUb & src,
-	FgImgRgbaUb       & dst)
+    const FgImgRgbaUb & src,
+    FgImgRgbaUb &       dst,
+    FgResizeFilter      filter)
 {
     FGASSERT(!src.empty());
     FGASSERT(!dst.empty());
-    typedef FgImgRgbaUb          ImageType;
-    typedef ImageType::PixelType PixelType;
-	uint        swid = src.width(),
-                shgt = src.height(),
-                wid = dst.width(),
-                hgt = dst.height();
-    if ((wid == swid) && (hgt == shgt)) {
+    if (src.dims() == dst.dims()) {
         dst = src;
-		return;
-	}
-	float   sx = (float)wid / (float)swid,
-            sy   = (float)hgt / (float)shgt;
-	const PixelType *srcPtr = src.dataPtr();
-	PixelType       *dstPtr	= dst.dataPtr();
-	uint        srcStep = src.width(),
-                dstStep  = dst.width();
-	float       ex    = 1.0f / sx,
-                ey      = 1.0f / sy,
-                invArea	= 1.0f / (ex * ey);
-	for	(uint yDstRcs=0; yDstRcs<hgt; yDstRcs++) {
-		// Calculate the y pixel bounds in the source image IRCS
-		// Note that we need to check the upper bound since
-		// this algorithm will want to add an out of bounds pixel
-		// with weight 0. This still works with the weighting
-		// algorithm in the inner loop since the float value
-		// will only ever just hit the out of bounds integer
-		// value and not exceed it.
-		float	yblo = (float)yDstRcs * ey,
-				ybhi = yblo + ey;
-		uint	yblob = (uint)yblo,
-				ybhib = (uint)ybhi;
-		if (ybhib >= shgt)
-            --ybhib;
-		for (uint xDstRcs=0; xDstRcs<wid; xDstRcs++) {
-            // Calculate the x pixel bounds in the source image IRCS
-			float	xblo = (float)xDstRcs * ex,
-					xbhi = xblo + ex;
-			uint	xblob = (uint)xblo,
-					xbhib = (uint)xbhi;
-			if (xbhib >= swid)
-                --xbhib;
-            // Now sum up the contributions of the source pixels
-            // that fall within this back-projected window.
-			FgRgba<float> acc, fpix;
-			for (uint yy=yblob; yy<=ybhib; yy++) {
-				float	yfac = 1.0f;
-				if (yy == yblob)
-					yfac -= yblo - (float)yblob;
-				if (yy == ybhib)
-					yfac -= (float)(ybhib+1) - ybhi;
-				for (uint xx=xblob; xx<=xbhib; xx++) {
-					float	xfac = 1.0f;
-					if (xx == xblob)
-						xfac -= xblo - (float)xblob;
-					if (xx == xbhib)
-						xfac -= (float)(xbhib+1) - xbhi;
-					fgCast_(srcPtr[yy*srcStep + xx],fpix);
-					acc += fpix * xfac * yfac;
-				}
-			}
-            // Divide by the area of the back-project and convert
-            // back to fixed point.
-            fgRound(acc * invArea,dstPtr[xDstRcs]);
-		}
-		dstPtr += dstStep;
-	}
+        return;
+    }
+    resizeSeparable<uchar,4>(&src.dataPtr()->m_c[0],src.dims(),&dst.dataPtr()->m_c[0],dst.dims(),filter);
+}
+
+void
+fgImgResize(
+    const FgImgRgbaF &  src,
+    FgImgRgbaF &        dst,
+    FgResizeFilter      filter)
+{
+    FGASSERT(!src.empty());
+    FGASSERT(!dst.empty());
+    if (src.dims() == dst.dims()) {
+        dst = src;
+        return;
+    }
+    resizeSeparable<float,4>(&src.dataPtr()->m_c[0],src.dims(),&dst.dataPtr()->m_c[0],dst.dims(),filter);
+}
+
+void
+fgImgResize(
+    const FgImgF &      src,
+    FgImgF &            dst,
+    FgResizeFilter      filter)
+{
+    FGASSERT(!src.empty());
+    FGASSERT(!dst.empty());
+    if (src.dims() == dst.dims()) {
+        dst = src;
+        return;
+    }
+    resizeSeparable<float,1>(src.dataPtr(),src.dims(),dst.dataPtr(),dst.dims(),filter);
 }
 
 FgImgRgbaUb
@@ -456,6 +652,20 @@ fgOglMipMap(const FgImgRgbaUb & img)
     return ret;
 }
 
+vector<uint>
+fgImgRowBands(uint hgt,size_t rowSz,FgThreadPool * pool)
+{
+    uint                numBands = 1;
+    // Not worth the thread overhead for small images. Bands of at least a few rows keep the
+    // halo overhead of separable filters small:
+    if ((pool != NULL) && (double(rowSz)*hgt >= double(1 << 18)))
+        numBands = std::max(std::min(pool->numThreads()*4,hgt/8),1U);
+    vector<uint>        ret(numBands+1);
+    for (uint bb=0; bb<=numBands; ++bb)
+        ret[bb] = uint(uint64(hgt)*bb/numBands);
+    return ret;
+}
+
 FgImg3F
 fgImgToF3(const FgImgRgbaUb & img)
 {
@@ -473,8 +683,8 @@ fgSsi(const FgImg3F & img,uchar borderPolicy)
     FgImg3Fs        ret(fgLog2Floor(fgMinElem(img.dims()))+1);
     ret[0] = img;
     for (size_t ii=0; ii<ret.size()-1; ++ii) {
-        fgSmoothFloat(ret[ii],ret[ii],borderPolicy);
-        fgSmoothFloat(ret[ii],ret[ii],borderPolicy);
+        fgSmoothFloat(ret[ii],ret[ii],borderPolicy,&fgThreadPool());
+        fgSmoothFloat(ret[ii],ret[ii],borderPolicy,&fgThreadPool());
         fgShrink2Float(ret[ii],ret[ii+1]);
     }
     return ret;
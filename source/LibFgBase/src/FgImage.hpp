@@ -17,6 +17,7 @@
 #include "FgAffineC.hpp"
 #include "FgAffineCwC.hpp"
 #include "FgArray.hpp"
+#include "FgThread.hpp"
 
 std::ostream &
 operator<<(std::ostream &,const FgImgRgbaUb &);
@@ -69,16 +70,16 @@ fgBlerpCoordsClip(FgVect2UI dims,FgVect2F coordIucs);
 FgRgbaF
 fgBlerpAlpha(const FgImgRgbaUb & img,FgVect2F coordIucs);
 
-// Bilinear interpolation on floating point channel images.
-// Clips sample point coordinates to image boundaries.
-template<class T>
-typename FgTraits<T>::Floating
-fgBlerpClipIpcs(
-    const FgImage<T> &  img,        // Must not be empty
+// Bilinear interpolation with coordinate clipping for any image type with the FgImage
+// pixel access API (eg. FgImageTiled):
+template<class Img>
+typename FgTraits<typename Img::PixelType>::Floating
+fgBlerpClipIpcsImg(
+    const Img &         img,        // Must not be empty
     FgVect2F            coordIpcs)
 {
     FGASSERT(!img.empty());         // Required for algorithm below
-    typedef typename FgTraits<T>::Floating    Acc;
+    typedef typename FgTraits<typename Img::PixelType>::Floating    Acc;
     Acc                 acc(0.0);
     float               xf = coordIpcs[0] - 0.5f,     // to IRCS
                         yf = coordIpcs[1] - 0.5f;
@@ -104,6 +105,14 @@ fgBlerpClipIpcs(
     acc += Acc(img.xy(xh,yh)) * wxh * wyh;
     return acc;
 }
+// Bilinear interpolation on floating point channel images.
+// Clips sample point coordinates to image boundaries.
+template<class T>
+typename FgTraits<T>::Floating
+fgBlerpClipIpcs(
+    const FgImage<T> &  img,        // Must not be empty
+    FgVect2F            coordIpcs)
+{return fgBlerpClipIpcsImg(img,coordIpcs); }
 template<class T>
 typename FgTraits<T>::Floating
 fgBlerpClipIucs(const FgImage<T> & img,FgVect2F coordIucs)
@@ -201,14 +210,32 @@ fgImgConvert(const FgImgRgbaUb & src,FgImgUC & dst);
 void
 fgImgConvert(const FgImgUC & src,FgImgRgbaUb & dst);
 
+// box:      Exact proportional area of the source image covered by each destination pixel.
+// bilinear: Tent filter, widened when shrinking.
+// lanczos3: Sharpest, with slight ringing at hard edges.
+// mitchell: Cubic with B = C = 1/3; a good compromise between blur and ringing.
+enum class FgResizeFilter { box, bilinear, lanczos3, mitchell };
+
 // Resize to the destination image dimensions, by shrinking or expanding in each dimension.
-// Samples the exact proportional amount of the source image covered by the destination image
-// pixel for shrinking dimensions, which effectively uses bilinear interpolation for dilating
-// dimensions:
+// Separable; filter weights are computed once per destination row and column, and large
+// images are processed as row bands on the thread pool:
 void
 fgImgResize(
     const FgImgRgbaUb & src,
-    FgImgRgbaUb &       dst);   // MODIFIED
+    FgImgRgbaUb &       dst,    // MODIFIED
+    FgResizeFilter      filter=FgResizeFilter::box);
+
+void
+fgImgResize(
+    const FgImgRgbaF &  src,
+    FgImgRgbaF &        dst,    // MODIFIED
+    FgResizeFilter      filter=FgResizeFilter::box);
+
+void
+fgImgResize(
+    const FgImgF &      src,
+    FgImgF &            dst,    // MODIFIED
+    FgResizeFilter      filter=FgResizeFilter::box);
 
 void
 fgImgPntRescaleConvert(const FgImgD & src,FgImgUC & dst);
@@ -283,128 +310,194 @@ fgCast_(const FgImage<T> & in,FgImage<U> & out)
         fgCast_(in[ii],out[ii]);
 }
 
+// Row bands for splitting image filtering work over 'pool'. Returns the band boundaries
+// (size number of bands + 1) over 'hgt' rows of 'rowSz' channel values each. A single band is
+// returned if 'pool' is NULL or the image is too small to be worth distributing:
+vector<uint>
+fgImgRowBands(
+    uint                hgt,
+    size_t              rowSz,
+    FgThreadPool *      pool);
+
 // Accumulators for convolution:
 template<class T> struct FgConvTraits;
 template<> struct FgConvTraits<uchar>       {typedef ushort     Acc; };
 template<> struct FgConvTraits<FgRgbaUB>    {typedef FgRgbaUS   Acc; };
-template<class T>
-// Applies a [1 2 1] outer product 2D kernel smoothing using border replication to an
-// UNISGNED INTEGER channel image in a preicsion-friendly, cache-friendly way.
-// The Source and desination images can be the same, for in-place convolution.
+
+// Horizontal [1 2 1] kernel over a row of 'wid' pixels of 'nc' interleaved channels of scalar
+// type. Operating on the raw channels rather than the pixel type lets the compiler vectorize:
+template<class S,class A>
 void
-fgSmoothUint1D(
-    const T             *srcPtr,
-    typename FgConvTraits<T>::Acc *dstPtr,
-    uint                num,
-    uchar               borderPolicy)               // See below
-{
-    typedef typename FgConvTraits<T>::Acc     Acc;
-    dstPtr[0] = Acc(srcPtr[0])*(2+borderPolicy) + Acc(srcPtr[1]);
-    for (uint ii=1; ii<num-1; ++ii)
-        dstPtr[ii] = Acc(srcPtr[ii-1]) + Acc(srcPtr[ii])*2 + Acc(srcPtr[ii+1]);
-    dstPtr[num-1] = Acc(srcPtr[num-2]) + Acc(srcPtr[num-1])*(2+borderPolicy);
-}
-template<class T>
+fgSmoothRowHoriz(
+    const S *           srcPtr,
+    A *                 dstPtr,         // Must not overlap with srcPtr
+    uint                wid,
+    uint                nc,
+    uchar               borderPolicy)   // See fgSmoothUint
+{
+    size_t          end = size_t(wid-1)*nc;
+    for (uint cc=0; cc<nc; ++cc)
+        dstPtr[cc] = A(A(srcPtr[cc])*(2+borderPolicy) + A(srcPtr[nc+cc]));
+    for (size_t ii=nc; ii<end; ++ii)
+        dstPtr[ii] = A(A(srcPtr[ii-nc]) + A(srcPtr[ii])*2 + A(srcPtr[ii+nc]));
+    for (uint cc=0; cc<nc; ++cc)
+        dstPtr[end+cc] = A(A(srcPtr[end-nc+cc]) + A(srcPtr[end+cc])*(2+borderPolicy));
+}
+
+// Vertical [1 2 1] kernel combining three horizontally smoothed rows:
+inline
 void
-fgSmoothUint(
+fgSmoothRowVert(
+    const ushort *      acc0,
+    const ushort *      acc1,
+    const ushort *      acc2,
+    uchar *             dstPtr,
+    size_t              num,
+    float)
+{
+    // Add 7 to minimize rounding bias. Adding 8 would bias the other way so we have to
+    // settle for a small amount of downward rounding bias unless we want to pseudo-randomize:
+    for (size_t ii=0; ii<num; ++ii)
+        dstPtr[ii] = uchar((acc0[ii] + acc1[ii]*2 + acc2[ii] + 7) / 16);
+}
+template<class F>
+void
+fgSmoothRowVert(
+    const F *           acc0,
+    const F *           acc1,
+    const F *           acc2,
+    F *                 dstPtr,
+    size_t              num,
+    float               factor)         // 2D kernel normalization factor
+{
+    for (size_t ii=0; ii<num; ++ii)
+        dstPtr[ii] = (acc0[ii] + acc1[ii]*2 + acc2[ii]) * factor;
+}
+
+// [1 2 1] outer product kernel over a band of rows [beg,end) of a channel image with scalar type 'S'
+// and accumulator type 'A'. Each band has a 4 row accumulator; a 3 row ring buffer plus a halo row.
+// 'prime' reads the only rows outside the band (beg-1 and end) so when all bands are primed before
+// any band is run, the source and destination can be the same:
+template<class S,class A>
+struct  FgSmooth121
+{
+    const S *           src;
+    S *                 dst;
+    uint                wid;
+    uint                hgt;
+    uint                nc;             // Channels per pixel
+    uchar               borderPolicy;
+    float               factor;
+
+    size_t
+    rowSz() const
+    {return size_t(wid)*nc; }
+
+    void
+    prime(uint beg,uint end,A * acc) const
+    {
+        size_t          rs = rowSz();
+        fgSmoothRowHoriz(src+beg*rs,acc+rs,wid,nc,borderPolicy);
+        if (beg > 0)
+            fgSmoothRowHoriz(src+(beg-1)*rs,acc,wid,nc,borderPolicy);
+        else
+            for (size_t ii=0; ii<rs; ++ii)
+                acc[ii] = A(acc[rs+ii]*borderPolicy);
+        if (end < hgt)
+            fgSmoothRowHoriz(src+end*rs,acc+3*rs,wid,nc,borderPolicy);
+    }
+
+    void
+    run(uint beg,uint end,A * acc) const
+    {
+        size_t          rs = rowSz();
+        for (uint yy=beg; yy<end; ++yy) {
+            uint        rr = yy - beg;
+            A           *acc0 = acc + (rr%3)*rs,
+                        *acc1 = acc + ((rr+1)%3)*rs,
+                        *acc2 = acc + ((rr+2)%3)*rs;
+            if (yy+1 < end)
+                fgSmoothRowHoriz(src+(yy+1)*rs,acc2,wid,nc,borderPolicy);
+            else if (yy+1 < hgt)
+                acc2 = acc + 3*rs;
+            else
+                for (size_t ii=0; ii<rs; ++ii)
+                    acc2[ii] = A(acc1[ii]*borderPolicy);
+            fgSmoothRowVert(acc0,acc1,acc2,dst+yy*rs,rs,factor);
+        }
+    }
+};
+
+template<class T,class A>
+void
+fgSmooth121(
     const FgImage<T> &  src,
-    FgImage<T> &        dst,
-    uchar               borderPolicy=1)     // 0 - zero border policy, 1 - replication border policy
+    FgImage<T> &        dst,                // Can be same as src
+    uchar               borderPolicy,
+    float               factor,
+    FgThreadPool *      pool)
 {
-    typedef typename FgConvTraits<T>::Acc     Acc;
+    typedef typename FgTraits<T>::Scalar    S;
     FGASSERT((src.width() > 1) && (src.height() > 1));  // Algorithm not designed for dim < 2
     FGASSERT((borderPolicy == 0) || (borderPolicy == 1));
-    dst.resize(src.width(),src.height());
-    FgImage<Acc> acc(src.width(),3);                  // Accumulator image
-    T           *dstPtr = dst.rowPtr(0);
-    Acc         *accPtr0,
-                *accPtr1 = acc.rowPtr(0),
-                *accPtr2 = acc.rowPtr(1);
-    fgSmoothUint1D(src.rowPtr(0),accPtr1,src.width(),borderPolicy);
-    fgSmoothUint1D(src.rowPtr(1),accPtr2,src.width(),borderPolicy);
-    for (uint xx=0; xx<src.width(); xx++) {
-        // Add 7 to minimize rounding bias. Adding 8 would bias the other way so we have to
-        // settle for a small amount of downward rounding bias unless we want to pseudo-randomize:
-        Acc        tmp = accPtr1[xx]*(2+borderPolicy) + accPtr2[xx] + Acc(7);
-        dstPtr[xx] = T(tmp / 16);
-    }
-    for (uint yy=1; yy<src.height()-1; ++yy) {
-        dstPtr = dst.rowPtr(yy),
-        accPtr0 = acc.rowPtr((yy-1)%3),
-        accPtr1 = acc.rowPtr(yy%3),
-        accPtr2 = acc.rowPtr((yy+1)%3);
-        fgSmoothUint1D(src.rowPtr(yy+1),accPtr2,src.width(),borderPolicy);
-        for (uint xx=0; xx<src.width(); ++xx)
-            dstPtr[xx] = T((accPtr0[xx] + accPtr1[xx]*2 + accPtr2[xx] + Acc(7)) / 16);
+    FG_STATIC_ASSERT(sizeof(T) % sizeof(S) == 0);
+    dst.resize(src.dims());
+    FgSmooth121<S,A>    sm;
+    sm.src = reinterpret_cast<const S*>(src.dataPtr());
+    sm.dst = reinterpret_cast<S*>(dst.dataPtr());
+    sm.wid = src.width();
+    sm.hgt = src.height();
+    sm.nc = uint(sizeof(T) / sizeof(S));
+    sm.borderPolicy = borderPolicy;
+    sm.factor = factor;
+    size_t              rs = sm.rowSz();
+    vector<uint>        bands = fgImgRowBands(sm.hgt,rs,pool);
+    size_t              numBands = bands.size()-1;
+    vector<A>           acc(numBands*4*rs);
+    if (numBands == 1) {
+        sm.prime(0,sm.hgt,acc.data());
+        sm.run(0,sm.hgt,acc.data());
+        return;
     }
-    dstPtr = dst.rowPtr(dst.height()-1);
-    for (uint xx=0; xx<dst.width(); ++xx)
-        dstPtr[xx] = T((accPtr1[xx] + accPtr2[xx]*(2+borderPolicy) + Acc(7)) / 16);
+    vector<FgJob>       jobs;
+    for (size_t bb=0; bb<numBands; ++bb)
+        jobs.push_back(boost::bind(&FgSmooth121<S,A>::prime,&sm,bands[bb],bands[bb+1],&acc[bb*4*rs]));
+    pool->run(jobs);
+    jobs.clear();
+    for (size_t bb=0; bb<numBands; ++bb)
+        jobs.push_back(boost::bind(&FgSmooth121<S,A>::run,&sm,bands[bb],bands[bb+1],&acc[bb*4*rs]));
+    pool->run(jobs);
 }
 
-// Use of the __restrict keyword for the pointer args below made no speed difference here (msvc2012).
-// Perhaps the compiler is smart enough to look at the calling context:
+// Applies a [1 2 1] outer product 2D kernel smoothing using border replication to an
+// UNISGNED INTEGER channel image in a preicsion-friendly, cache-friendly way.
+// The Source and desination images can be the same, for in-place convolution.
+// If 'pool' is given, large images are smoothed as row bands on it:
 template<class T>
 void
-fgSmoothFloat1D(
-    const T *   srcPtr,
-    T *         dstPtr,         // Must not overlap with srcPtr
-    uint        wid,
-    uchar       borderPolicy)   // See below
+fgSmoothUint(
+    const FgImage<T> &  src,
+    FgImage<T> &        dst,
+    uchar               borderPolicy=1,     // 0 - zero border policy, 1 - replication border policy
+    FgThreadPool *      pool=NULL)
 {
-    dstPtr[0] = srcPtr[0]*(2+borderPolicy) + srcPtr[1];
-    for (uint ii=1; ii<wid-1; ++ii)
-        dstPtr[ii] = srcPtr[ii-1] + srcPtr[ii]*2 + srcPtr[ii+1];
-    dstPtr[wid-1] = srcPtr[wid-2] + srcPtr[wid-1]*(2+borderPolicy);
-}
-template<class T>
-void
-fgSmoothFloat2D(
-    const T *   srcPtr,
-    T *         dstPtr,         // Must not overlap with srcPtr
-    uint        wid,
-    uint        hgt,
-    uchar       borderPolicy,   // See below
-    float       fac=1.0f/4.0f)  // Per-axis kernel normalization factor
-{
-    float       factor = fac*fac;
-    FgImage<T>  acc(wid,3);
-    T           *accPtr0,
-                *accPtr1 = acc.rowPtr(0),
-                *accPtr2 = acc.rowPtr(1);
-    fgSmoothFloat1D(srcPtr,accPtr1,wid,borderPolicy);
-    srcPtr += wid;
-    fgSmoothFloat1D(srcPtr,accPtr2,wid,borderPolicy);
-    for (uint xx=0; xx<wid; ++xx)
-        dstPtr[xx] = (accPtr1[xx]*(2+borderPolicy) + accPtr2[xx]) * factor;
-    for (uint yy=1; yy<hgt-1; ++yy) {
-        dstPtr += wid;
-        srcPtr += wid;
-        accPtr0 = acc.rowPtr((yy-1)%3);
-        accPtr1 = acc.rowPtr(yy%3);
-        accPtr2 = acc.rowPtr((yy+1)%3);
-        fgSmoothFloat1D(srcPtr,accPtr2,wid,borderPolicy);
-        for (uint xx=0; xx<wid; ++xx)
-            dstPtr[xx] = (accPtr0[xx] + accPtr1[xx] * 2 + accPtr2[xx]) * factor;
-    }
-    dstPtr += wid;
-    for (uint xx=0; xx<wid; ++xx)
-        dstPtr[xx] = (accPtr1[xx] + accPtr2[xx]*(2+borderPolicy)) * factor;
+    typedef typename FgConvTraits<typename FgTraits<T>::Scalar>::Acc    A;
+    fgSmooth121<T,A>(src,dst,borderPolicy,1.0f/16.0f,pool);
 }
+
 // Applies a [1 2 1] outer product 2D kernel smoothing to a floating point channel
 // image in a cache-friendly way.
 // The Source and destination images can be the same, for in-place convolution.
+// If 'pool' is given, large images are smoothed as row bands on it:
 template<class T>
 void
 fgSmoothFloat(
     const FgImage<T> &  src,
     FgImage<T> &        dst,                // Can be same as src
-    uchar               borderPolicy)       // 0 - zero border policy, 1 - replication border policy
+    uchar               borderPolicy,       // 0 - zero border policy, 1 - replication border policy
+    FgThreadPool *      pool=NULL)
 {
-    FGASSERT((src.width() > 1) && (src.height() > 1));  // Algorithm not designed for dim < 2
-    FGASSERT((borderPolicy == 0) || (borderPolicy == 1));
-    dst.resize(src.dims());
-    fgSmoothFloat2D(src.dataPtr(),dst.dataPtr(),src.width(),src.height(),borderPolicy);
+    fgSmooth121<T,typename FgTraits<T>::Scalar>(src,dst,borderPolicy,1.0f/16.0f,pool);
 }
 
 // Applies a 3x3 non-separable kernel to a floating-point channel image. (technically a correlation
@@ -435,39 +528,59 @@ fgConvolveFloatHoriz(
         dstPtr[sz-1] += srcPtrs[jj][sz-2] * krn.rc(jj,0) +
                         srcPtrs[jj][sz-1] * (krn.rc(jj,1)+krn.rc(jj,2)*borderPolicy);
 }
+// Destination rows [beg,end):
+template<class Pixel>
+void
+fgConvolveFloatRows(
+    const FgImage<Pixel> *  src,
+    const FgMat33F *        krn,
+    FgImage<Pixel> *        dst,
+    uchar                   borderPolicy,
+    uint                    beg,
+    uint                    end)
+{
+    uint                    wid = src->width(),
+                            hgt = src->height();
+    vector<Pixel>           boundaryRow;
+    if (borderPolicy == 0)
+        boundaryRow.resize(wid,Pixel(0));
+    const Pixel *           srcPtrs[3];
+    for (uint yy=beg; yy<end; ++yy) {
+        if (yy > 0)
+            srcPtrs[0] = src->rowPtr(yy-1);
+        else
+            srcPtrs[0] = (borderPolicy == 0) ? &boundaryRow[0] : src->rowPtr(0);
+        srcPtrs[1] = src->rowPtr(yy);
+        if (yy+1 < hgt)
+            srcPtrs[2] = src->rowPtr(yy+1);
+        else
+            srcPtrs[2] = (borderPolicy == 0) ? &boundaryRow[0] : src->rowPtr(yy);
+        fgConvolveFloatHoriz(srcPtrs,*krn,dst->rowPtr(yy),wid,borderPolicy);
+    }
+}
+// If 'pool' is given, large images are convolved as row bands on it:
 template<class Pixel>
 void
 fgConvolveFloat(
     const FgImage<Pixel> &  src,
     const FgMat33F &     krn,                // The kernel to be correlated
     FgImage<Pixel> &        dst,                // Must be different from src
-    uchar                   borderPolicy)       // 0 - zero border policy, 1 - replication border policy
+    uchar                   borderPolicy,       // 0 - zero border policy, 1 - replication border policy
+    FgThreadPool *          pool=NULL)
 {
     FGASSERT((src.width() > 1) && (src.height() > 1));  // Algorithm not designed for dim < 2
     FGASSERT((borderPolicy == 0) || (borderPolicy == 1));
     dst.resize(src.dims());
     FGASSERT(src.dataPtr() != dst.dataPtr());
-    uint                    wid = src.width();
-    vector<Pixel>           boundaryRow(wid,Pixel(0));
-    const Pixel *           srcPtrs[3];
-    if (borderPolicy == 0)
-        srcPtrs[0] = &boundaryRow[0];
-    else
-        srcPtrs[0] = src.rowPtr(0);
-    srcPtrs[1] = src.rowPtr(0);
-    srcPtrs[2] = src.rowPtr(1);
-    fgConvolveFloatHoriz(srcPtrs,krn,dst.rowPtr(0),wid,borderPolicy);
-    for (uint yy=1; yy<dst.height()-1; ++yy) {
-        srcPtrs[0] = srcPtrs[1];
-        srcPtrs[1] = srcPtrs[2];
-        srcPtrs[2] = src.rowPtr(yy+1);
-        fgConvolveFloatHoriz(srcPtrs,krn,dst.rowPtr(yy),wid,borderPolicy);
+    vector<uint>            bands = fgImgRowBands(src.height(),src.width()*sizeof(Pixel)/sizeof(float),pool);
+    if (bands.size() == 2) {
+        fgConvolveFloatRows(&src,&krn,&dst,borderPolicy,0,src.height());
+        return;
     }
-    srcPtrs[0] = srcPtrs[1];
-    srcPtrs[1] = srcPtrs[2];
-    if (borderPolicy == 0)
-        srcPtrs[2] = &boundaryRow[0];
-    fgConvolveFloatHoriz(srcPtrs,krn,dst.rowPtr(dst.height()-1),wid,borderPolicy);
+    vector<FgJob>           jobs;
+    for (size_t bb=0; bb+1<bands.size(); ++bb)
+        jobs.push_back(boost::bind(fgConvolveFloatRows<Pixel>,&src,&krn,&dst,borderPolicy,bands[bb],bands[bb+1]));
+    pool->run(jobs);
 }
 
 // Resample 'in' at the centre of each pixel in 'out' (assuming images are spatially 1-1):
@@ -13,6 +13,8 @@
 #include "FgScopeGuard.hpp"
 #include "FgSmartPtr.hpp"
 #include "FgCommand.hpp"
+#include "FgRandom.hpp"
+#include <boost/thread/reverse_lock.hpp>
 
 // Don't let ImageMagick redeclare malloc:
 #define HAVE_STDLIB_H
@@ -22,6 +24,10 @@ using namespace std;
 
 static FgOnce fg_magick_init = FG_ONCE_INIT;
 
+// The bundled ImageMagick is built without thread support on all platforms but Windows, so all
+// calls into it are serialized. The direct codecs are reentrant and don't take this lock:
+static boost::mutex s_magickMtx;
+
 static
 void
 fgEnsureMagick()
@@ -37,10 +43,10 @@ fgEnsureMagick()
     fgRunOnce(fg_magick_init,Helper::init);
 }
 
-void
-fgLoadImgAnyFormat(
-    const FgString &    fname,
-    FgImgRgbaUb &       img)
+// Returns the decoded image, which must be freed with DestroyImage:
+static
+Image *
+readMagick(const FgString & fname)
 {
     if (!fgFileReadable(fname))
         fgThrow("Unable to read file",fname);
@@ -53,21 +59,137 @@ fgLoadImgAnyFormat(
     if (imgPtr == 0)
         // exception.description is NULL. exception->reason includes the filename:
         fgThrow("Unable to read image file",exception->reason);
+    return imgPtr;
+}
+
+// Copy a block of rows out of the ImageMagick pixel cache in one call rather than per pixel.
+// 'map' gives the channel order (eg. "RGBA") of 'dst':
+static
+void
+exportRows(
+    const Image *       imgPtr,
+    uint                rowBeg,
+    uint                numRows,
+    const char *        map,
+    StorageType         type,
+    void *              dst)
+{
+    if (numRows == 0)
+        return;
+    FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
+    MagickBooleanType   res = ExportImagePixels(imgPtr,0,rowBeg,imgPtr->columns,numRows,map,type,dst,exception.get());
+    if (res != MagickTrue)
+        fgThrow("Unable to read image pixels",imgPtr->filename);
+}
+
+enum    FgImgCodec {fgImgCodecOther, fgImgCodecPng, fgImgCodecJpeg};
+
+// Identify by content rather than file extension:
+static
+FgImgCodec
+sniffCodec(const uchar * data,size_t size)
+{
+    static const uchar  pngSig[] = {0x89,'P','N','G','\r','\n',0x1A,'\n'};
+    if ((size >= 8) && (memcmp(data,pngSig,8) == 0))
+        return fgImgCodecPng;
+    if ((size >= 3) && (data[0] == 0xFF) && (data[1] == 0xD8) && (data[2] == 0xFF))
+        return fgImgCodecJpeg;
+    return fgImgCodecOther;
+}
+
+// Returns false if the data is not PNG or JPEG, or is a variant not handled directly
+// (eg. CMYK JPEG). The direct decoders can't distinguish such variants from corrupt data
+// so the reason is returned in 'reason' and only reported if ImageMagick also fails:
+static
+bool
+decodeDirect(const vector<uchar> & data,FgImgRgbaUb & img,FgString & reason)
+{
+    FgImgCodec          codec = sniffCodec(data.data(),data.size());
+    try {
+        if (codec == fgImgCodecPng) {
+            fgImgLoadPng(data,img);
+            return true;
+        }
+        if (codec == fgImgCodecJpeg) {
+            fgImgLoadJfif(data,img);
+            return true;
+        }
+    }
+    catch (FgException & e) {
+        reason = e.tr_message();
+    }
+    return false;
+}
+
+void
+fgLoadImgAnyFormat(
+    const FgString &    fname,
+    FgImgRgbaUb &       img)
+{
+    FgString            reason;
+    {
+        FgIfstream          ifs(fname,false);
+        if (!ifs.is_open())
+            fgThrow("Unable to read file",fname);
+        uchar               sig[8];
+        ifs.read(reinterpret_cast<char*>(sig),8);
+        if (sniffCodec(sig,size_t(ifs.gcount())) != fgImgCodecOther) {
+            ifs.clear();
+            ifs.seekg(0,std::ios::end);
+            vector<uchar>   data(size_t(ifs.tellg()));
+            ifs.seekg(0,std::ios::beg);
+            ifs.read(reinterpret_cast<char*>(data.data()),data.size());
+            if (decodeDirect(data,img,reason))
+                return;
+        }
+    }
+    boost::lock_guard<boost::mutex> lock(s_magickMtx);
+    Image *                     imgPtr;
+    try {
+        imgPtr = readMagick(fname);
+    }
+    catch (FgException & e) {
+        if (!reason.empty())
+            e.pushMsg("Direct decode failed",reason);
+        throw;
+    }
     FgScopeGuard                sg0(boost::bind(DestroyImage,imgPtr));
-    FgScopePtr<CacheView>       view(AcquireCacheView(imgPtr),DestroyCacheView);
     img.resize(uint(imgPtr->columns),uint(imgPtr->rows));
-    for(uint row = 0; row < imgPtr->rows; ++row) {
-        for(uint column = 0; column < imgPtr->columns; ++column) {
-            PixelPacket pixel;
-            FGASSERT(MagickTrue == 
-                    GetOneCacheViewAuthenticPixel(view.get(),column,row,&pixel,exception.get()));
-            img.xy(column,row).red() = uchar(pixel.red);
-            img.xy(column,row).green() = uchar(pixel.green);
-            img.xy(column,row).blue() = uchar(pixel.blue);
-            img.xy(column,row).alpha() =  255 - uchar(pixel.opacity);
-        }
+    exportRows(imgPtr,0,img.height(),"RGBA",CharPixel,img.dataPtr());
+}
+
+void
+fgDecodeImgAnyFormat(
+    const vector<uchar> &   data,
+    FgImgRgbaUb &           img,
+    const string &          ext)
+{
+    FgString            reason;
+    if (decodeDirect(data,img,reason))
+        return;
+    boost::lock_guard<boost::mutex> lock(s_magickMtx);
+    fgEnsureMagick();
+    FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
+    FgScopePtr<ImageInfo>       image_info(CloneImageInfo(0),DestroyImageInfo);
+    if (!ext.empty()) {
+        // As for encoding, ImageMagick takes the format from the filename extension:
+        string                  fname = "blob." + fgToLower(ext);
+        if (fname.size() >= MaxTextExtent)
+            fgThrow("Invalid image format extension",ext);
+        (void) strcpy(image_info->filename,fname.c_str());
     }
+    Image *imgPtr = BlobToImage(image_info.get(),data.data(),data.size(),exception.get());
+    if (imgPtr == 0) {
+        FgException         e("Unable to decode image data",exception->reason);
+        if (!reason.empty())
+            e.pushMsg("Direct decode failed",reason);
+        fgThrow(e);
+    }
+    FgScopeGuard                sg0(boost::bind(DestroyImage,imgPtr));
+    img.resize(uint(imgPtr->columns),uint(imgPtr->rows));
+    exportRows(imgPtr,0,img.height(),"RGBA",CharPixel,img.dataPtr());
 }
+
 void
 fgLoadImgAnyFormat(const FgString & fname,FgImgUC & ret)
 {
@@ -80,32 +202,10 @@ fgLoadImgAnyFormat(const FgString & fname,FgImgUC & ret)
 FgImg4UC
 fgLoadImg4UC(const FgString & fname)
 {
-    FgImg4UC        ret;
-    if (!fgFileReadable(fname))
-        fgThrow("Unable to read file",fname);
-    fgEnsureMagick();
-    FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
-    FgScopePtr<ImageInfo>       image_info(CloneImageInfo(0),DestroyImageInfo);
-    (void) strcpy(image_info->filename,fname.as_utf8_string().c_str());
-    // TODO: Do we need to convert into a specific colourspace?
-    Image *imgPtr = ReadImage(image_info.get(),exception.get());
-    if (imgPtr == 0)
-        // exception.description is NULL. exception->reason includes the filename:
-        fgThrow("Unable to read image file",exception->reason);
-    FgScopeGuard                sg0(boost::bind(DestroyImage,imgPtr));
-    FgScopePtr<CacheView>       view(AcquireCacheView(imgPtr),DestroyCacheView);
-    ret.resize(uint(imgPtr->columns),uint(imgPtr->rows));
-    for(uint row= 0; row < imgPtr->rows; ++row) {
-        for(uint column = 0; column < imgPtr->columns; ++column) {
-            PixelPacket pixel;
-            FGASSERT(MagickTrue == 
-                    GetOneCacheViewAuthenticPixel(view.get(),column,row,&pixel,exception.get()));
-            ret.xy(column,row)[0] = uchar(pixel.red);
-            ret.xy(column,row)[1] = uchar(pixel.green);
-            ret.xy(column,row)[2] = uchar(pixel.blue);
-            ret.xy(column,row)[3] =  255 - uchar(pixel.opacity);
-        }
-    }
+    FgImgRgbaUb                 img = fgLoadImgAnyFormat(fname);
+    FgImg4UC                    ret(img.dims());
+    if (img.numPixels() > 0)
+        memcpy(ret.dataPtr(),img.dataPtr(),img.numPixels()*4);     // Same channel order
     return ret;
 }
 
@@ -114,27 +214,36 @@ fgLoadImgAnyFormat(
     const FgString &    fname,
     FgImgF &            img)
 {
-    if (!fgFileReadable(fname))
-        fgThrow("Unable to read file",fname);
-    fgEnsureMagick();
-    FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
-    FgScopePtr<ImageInfo>       image_info(CloneImageInfo(0),DestroyImageInfo);
-    (void) strcpy(image_info->filename,fname.as_utf8_string().c_str());
-    // TODO: Do we need to convert into a specific colourspace?
-    Image *imgPtr = ReadImage(image_info.get(),exception.get());
-    if (imgPtr == 0)
-        // exception.description is NULL. exception->reason includes the filename:
-        fgThrow("Unable to read image file",exception->reason);
+    boost::lock_guard<boost::mutex> lock(s_magickMtx);
+    Image *                     imgPtr = readMagick(fname);
     FgScopeGuard                sg0(boost::bind(DestroyImage,imgPtr));
-    FgScopePtr<CacheView>       view(AcquireCacheView(imgPtr),DestroyCacheView);
     img.resize(uint(imgPtr->columns),uint(imgPtr->rows));
-    for(uint row = 0; row < imgPtr->rows; ++row) {
-        for(uint column = 0; column < imgPtr->columns; ++column) {
-            PixelPacket pixel;
-            FGASSERT(MagickTrue == 
-                    GetOneCacheViewAuthenticPixel(view.get(),column,row,&pixel,exception.get()));
-            img.xy(column,row) = pixel.red;   // All channels same value if single-channel read
-        }
+    // Raw quantum values (not normalized), as a row at a time to limit the extra memory.
+    // All channels have the same value if single-channel read:
+    vector<Quantum>             row(img.width());
+    for (uint yy=0; (yy<img.height()) && !row.empty(); ++yy) {
+        exportRows(imgPtr,yy,1,"R",QuantumPixel,row.data());
+        float *                 dst = &img.xy(0,yy);
+        for (uint xx=0; xx<img.width(); ++xx)
+            dst[xx] = row[xx];
+    }
+}
+
+void
+fgLoadImgRows(const FgString & fname,const FgImgRowFunc & fn)
+{
+    boost::unique_lock<boost::mutex> lock(s_magickMtx);
+    Image *                     imgPtr = readMagick(fname);
+    // Declared after 'lock' so the image is destroyed while it is held:
+    FgScopeGuard                sg0(boost::bind(DestroyImage,imgPtr));
+    FgVect2UI                   dims(uint(imgPtr->columns),uint(imgPtr->rows));
+    vector<FgRgbaUB>            row(dims[0]);
+    for (uint yy=0; yy<dims[1]; ++yy) {
+        exportRows(imgPtr,yy,1,"RGBA",CharPixel,row.data());
+        // The lock is not recursive so it's released during the callback, which may itself
+        // use ImageMagick (eg. load or save another image). It's re-acquired even if 'fn' throws:
+        boost::reverse_lock<boost::unique_lock<boost::mutex> >  unlock(lock);
+        fn(dims,yy,row.data());
     }
 }
 
@@ -144,6 +253,7 @@ fgSaveImgAnyFormat(
     const FgImgRgbaUb & img)
 {
     FGASSERT(fname.length() > 0);
+    boost::lock_guard<boost::mutex> lock(s_magickMtx);
     fgEnsureMagick();
     FgScopePtr<ImageInfo>       image_info(CloneImageInfo(0),DestroyImageInfo);
     FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
@@ -159,10 +269,50 @@ fgSaveImgAnyFormat(
         fgThrow("Unable to save image to file",exception->reason);
 }
 
+void
+fgEncodeImgAnyFormat(
+    const FgImgRgbaUb &     img,
+    const string &          ext,
+    vector<uchar> &         fileContents)
+{
+    string                      extl = fgToLower(ext);
+    if (extl == "png") {
+        fgImgSavePng(img,fileContents);
+        return;
+    }
+    if ((extl == "jpg") || (extl == "jpeg")) {
+        fgImgSaveJfif(img,fileContents);
+        return;
+    }
+    boost::lock_guard<boost::mutex> lock(s_magickMtx);
+    fgEnsureMagick();
+    FgScopePtr<ImageInfo>       image_info(CloneImageInfo(0),DestroyImageInfo);
+    FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
+    FgScopePtr<Image>           image(ConstituteImage(img.width(),img.height(),"RGBA",
+                                                   CharPixel,
+                                                   img.dataPtr(),
+                                                   exception.get()),
+                                   DestroyImage);
+    if (image.get() == 0)
+        fgThrow("Unable to encode image",exception->reason);
+    // ImageMagick selects the format from the filename extension:
+    string                      fname = "blob." + extl;
+    if (fname.size() >= MaxTextExtent)
+        fgThrow("Invalid image format extension",ext);
+    (void) strcpy(image_info->filename,fname.c_str());
+    size_t                      size = 0;
+    uchar *                     blob = ImageToBlob(image_info.get(),image.get(),&size,exception.get());
+    if (blob == 0)
+        fgThrow("Unable to encode image as",ext);
+    FgScopeGuard                sg(boost::bind(RelinquishMagickMemory,blob));
+    fileContents.assign(blob,blob+size);
+}
+
 vector<string>
 fgImgSupportedFormats()
 {
     vector<string>              ret;
+    boost::lock_guard<boost::mutex> lock(s_magickMtx);
     fgEnsureMagick();
     FgScopePtr<ExceptionInfo>   exception(AcquireExceptionInfo(),DestroyExceptionInfo);
     size_t                      number_formats = 0;
@@ -235,3 +385,88 @@ fgImgTestWrite(const FgArgs & args)
     fgSaveImgAnyFormat(chinese+"0.jpg",redImg);
     fgSaveImgAnyFormat(chinese+"0.png",redImg);
 }
+
+static
+void
+checkRow(const FgImgRgbaUb & img,FgVect2UI dims,uint row,const FgRgbaUB * pixels,uint * rowsRead)
+{
+    FGASSERT(dims == img.dims());
+    FGASSERT(row == (*rowsRead)++);
+    for (uint xx=0; xx<dims[0]; ++xx)
+        FGASSERT(pixels[xx] == img.xy(xx,row));
+}
+
+// Row callbacks may themselves go through ImageMagick:
+static
+void
+loadInRow(const FgString & fname,FgVect2UI dims,uint row,const FgRgbaUB *,uint * rowsRead)
+{
+    FgImgF          img;
+    fgLoadImgAnyFormat(fname,img);
+    FGASSERT(img.dims() == dims);
+    FGASSERT(row == (*rowsRead)++);
+}
+
+void
+fgImgTestRead(const FgArgs & args)
+{
+    FGTESTDIR
+    fgRandSeedRepeatable();
+    FgImgRgbaUb     img(37,23);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        img[ii] = FgRgbaUB(uchar(fgRandUint(256)),uchar(fgRandUint(256)),uchar(fgRandUint(256)),uchar(fgRandUint(256)));
+    fgSaveImgAnyFormat("read.png",img);
+    FgImgRgbaUb     rgba;
+    fgLoadImgAnyFormat("read.png",rgba);
+    FGASSERT((rgba.dims() == img.dims()) && (rgba.dataVec() == img.dataVec()));
+    FgImg4UC        img4 = fgLoadImg4UC("read.png");
+    FGASSERT(img4.dims() == img.dims());
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        FGASSERT(img4[ii] == img[ii].m_c);
+    FgImgF          imgF;
+    fgLoadImgAnyFormat("read.png",imgF);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        FGASSERT(imgF[ii] == float(img[ii].red()) * float(QuantumRange / 255));
+    uint            rowsRead = 0;
+    fgLoadImgRows("read.png",boost::bind(checkRow,boost::cref(img),_1,_2,_3,&rowsRead));
+    FGASSERT(rowsRead == img.height());
+    rowsRead = 0;
+    fgLoadImgRows("read.png",boost::bind(loadInRow,FgString("read.png"),_1,_2,_3,&rowsRead));
+    FGASSERT(rowsRead == img.height());
+    // Direct codecs from memory, and ImageMagick fallback for other formats:
+    vector<uchar>   buff;
+    FgImgRgbaUb     opaque(img.dims(),FgRgbaUB(10,20,30,255)),
+                    dec;
+    fgImgSavePng(opaque,buff);
+    fgDecodeImgAnyFormat(buff,dec);
+    FGASSERT(dec.dataVec() == opaque.dataVec());
+    fgSaveImgAnyFormat("read.bmp",opaque);
+    string          bmp = fgSlurp("read.bmp");
+    fgDecodeImgAnyFormat(vector<uchar>(bmp.begin(),bmp.end()),dec);
+    FGASSERT(dec.dataVec() == opaque.dataVec());
+    fgEncodeImgAnyFormat(opaque,"bmp",buff);
+    fgDecodeImgAnyFormat(buff,dec);
+    FGASSERT(dec.dataVec() == opaque.dataVec());
+    fgEncodeImgAnyFormat(opaque,"tga",buff);
+    fgDecodeImgAnyFormat(buff,dec,"tga");
+    FGASSERT(dec.dataVec() == opaque.dataVec());
+    fgImgSaveJfif(img,buff);
+    fgDecodeImgAnyFormat(buff,dec);
+    FGASSERT(dec.dims() == img.dims());
+    fgImgLoadJfif(buff,dec,2);
+    FGASSERT(dec.dims() == FgVect2UI(19,12));
+    fgImgLoadJfif(buff,dec,8);
+    FGASSERT(dec.dims() == FgVect2UI(5,3));
+    // Corrupt data fails both decoders, with the direct decode reason in the exception:
+    fgImgSavePng(opaque,buff);
+    buff.resize(buff.size()/2);
+    string          msg;
+    try {fgDecodeImgAnyFormat(buff,dec); }
+    catch (const FgException & e) {msg = e.tr_message().m_str; }
+    FGASSERT(msg.find("Direct decode failed") != string::npos);
+    fgWriteFile("corrupt.png",string(buff.begin(),buff.end()),false);
+    msg.clear();
+    try {fgLoadImgAnyFormat("corrupt.png",dec); }
+    catch (const FgException & e) {msg = e.tr_message().m_str; }
+    FGASSERT(msg.find("Direct decode failed") != string::npos);
+}
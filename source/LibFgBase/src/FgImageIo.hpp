@@ -18,6 +18,8 @@
 #include "FgImage.hpp"
 #include "FgMatrixV.hpp"
 
+// PNG and JPEG files are decoded directly (falling back to ImageMagick for variants not
+// handled directly), all other formats by ImageMagick:
 void
 fgLoadImgAnyFormat(const FgString & fname,FgImgRgbaUb & img);
 void
@@ -36,6 +38,14 @@ fgLoadImgAnyFormat(const FgString & fname)
 FgImg4UC
 fgLoadImg4UC(const FgString & fname);
 
+// Called for each row of an image in order from the top, with 'dims' the full image dimensions
+// and 'pixels' valid only for the duration of the call:
+typedef boost::function<void(FgVect2UI dims,uint row,const FgRgbaUB * pixels)>   FgImgRowFunc;
+
+// Process an image a row at a time without copying all of it into an FgImage:
+void
+fgLoadImgRows(const FgString & fname,const FgImgRowFunc & fn);
+
 void
 fgSaveImgAnyFormat(
     const FgString &    fname,
@@ -77,14 +87,57 @@ fgImgSaveJfif(
     std::vector<uchar> &    buffer,
     int                     quality=100);
 
+// 'scaleDenom' decodes at reduced size (rounded up to 1/2, 1/4 or 1/8) in the DCT domain,
+// which is much faster than decoding at full size then resizing:
 void
 fgImgLoadJfif(
     const FgString &        fname,
-    FgImgRgbaUb &           img);
+    FgImgRgbaUb &           img,
+    uint                    scaleDenom=1);
 
 void
 fgImgLoadJfif(
+    const std::vector<uchar> &  fileContents,
+    FgImgRgbaUb &           img,
+    uint                    scaleDenom=1);
+
+// Direct PNG codec. All PNG formats are read as 8-bit RGBA; fully opaque images are
+// saved without an alpha channel:
+void
+fgImgLoadPng(
+    const FgString &        fname,
+    FgImgRgbaUb &           img);
+
+void
+fgImgLoadPng(
     const std::vector<uchar> &  fileContents,
     FgImgRgbaUb &           img);
 
+void
+fgImgSavePng(
+    const FgImgRgbaUb &     img,
+    const FgString &        fname);
+
+void
+fgImgSavePng(
+    const FgImgRgbaUb &     img,
+    std::vector<uchar> &    buffer);
+
+// Decode an image file already in memory. PNG and JPEG are decoded directly, other
+// formats with ImageMagick. Formats which can't be identified from their contents (eg. TGA)
+// also need the file extension 'ext' (no '.'):
+void
+fgDecodeImgAnyFormat(
+    const std::vector<uchar> &  fileContents,
+    FgImgRgbaUb &           img,
+    const std::string &     ext=std::string());
+
+// Encode an image in the format given by the file extension 'ext' (no '.'). PNG and JPEG
+// are encoded directly, other formats with ImageMagick:
+void
+fgEncodeImgAnyFormat(
+    const FgImgRgbaUb &     img,
+    const std::string &     ext,
+    std::vector<uchar> &    fileContents);
+
 #endif
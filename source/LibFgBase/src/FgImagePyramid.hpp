@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2015 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Created:     Oct 16, 2026
+//
+// Image pyramid (mip chain) with lazily built levels for filtered multi-scale sampling.
+//
+
+#ifndef FGIMAGEPYRAMID_HPP
+#define FGIMAGEPYRAMID_HPP
+
+#include "FgImage.hpp"
+
+// Level 0 is the source image, which is referenced, not copied, so must outlive the pyramid.
+// Each subsequent level is a 2x2 block average of the previous one, rounding odd dimensions down
+// but never below 1. Levels are built on first access and are then shared, so a single pyramid
+// can be sampled concurrently from many threads:
+template<class T>
+class   FgImagePyramid
+{
+public:
+    typedef typename FgTraits<T>::Floating      Floating;
+
+    explicit
+    FgImagePyramid(const FgImage<T> & base)
+    : m_base(&base), m_numLevels(1)
+    {
+        FGASSERT(!base.empty());
+        FgVect2UI       dims = base.dims();
+        while (fgMaxElem(dims) > 1) {
+            dims = levelDims(dims);
+            ++m_numLevels;
+        }
+        m_levels.resize(m_numLevels-1);
+        m_built.reset(new std::atomic<bool>[m_numLevels]);
+        for (uint ll=0; ll<m_numLevels; ++ll)
+            m_built[ll] = false;
+    }
+
+    uint
+    numLevels() const
+    {return m_numLevels; }
+
+    // Thread-safe:
+    const FgImage<T> &
+    level(uint ll) const
+    {
+        FGASSERT(ll < m_numLevels);
+        if (ll == 0)
+            return *m_base;
+        if (!m_built[ll].load(std::memory_order_acquire)) {
+            boost::lock_guard<boost::mutex>     lock(m_mtx);
+            for (uint ii=1; ii<=ll; ++ii) {
+                if (!m_built[ii].load(std::memory_order_relaxed)) {
+                    const FgImage<T> &  src = (ii == 1) ? *m_base : m_levels[ii-2];
+                    shrink(src,m_levels[ii-1]);
+                    m_built[ii].store(true,std::memory_order_release);
+                }
+            }
+        }
+        return m_levels[ll-1];
+    }
+
+    // Trilinear sampling. 'lod' is the (fractional) level, clamped to the valid range:
+    Floating
+    sample(FgVect2F uvIucs,float lod) const
+    {
+        float           maxLod = float(m_numLevels-1);
+        lod = fgClip(lod,0.0f,maxLod);
+        uint            l0 = uint(lod);
+        float           w1 = lod - float(l0);
+        Floating        ret = fgBlerpClipIucs(level(l0),uvIucs);
+        if ((w1 > 0.0f) && (l0+1 < m_numLevels)) {
+            ret *= 1.0 - w1;
+            ret += fgBlerpClipIucs(level(l0+1),uvIucs) * double(w1);
+        }
+        return ret;
+    }
+
+    // Samples the footprint of an output pixel given by the columns of 'iucsPerPixel', the
+    // derivatives of the texture coordinate with respect to the output pixel X and Y. Up to
+    // 'maxAniso' trilinear probes are spread along the major axis of the footprint, and the level
+    // is chosen from the major axis length divided by the number of probes. This approximates the
+    // minor axis unless the anisotropy exceeds 'maxAniso', in which case a coarser level avoids
+    // aliasing. A footprint under one texel samples level 0 bilinearly:
+    Floating
+    sample(
+        FgVect2F            uvIucs,
+        FgMat22F            iucsPerPixel,
+        uint                maxAniso=4) const
+    {
+        FgVect2F        dims(m_base->dims());
+        FgVect2F        ax(iucsPerPixel.rc(0,0),iucsPerPixel.rc(1,0)),
+                        ay(iucsPerPixel.rc(0,1),iucsPerPixel.rc(1,1));
+        float           lx = fgMapMul(ax,dims).length(),          // Texels per pixel
+                        ly = fgMapMul(ay,dims).length();
+        FgVect2F        major = (lx > ly) ? ax : ay;
+        float           lMaj = std::max(lx,ly),
+                        lMin = std::min(lx,ly);
+        if (!(lMaj > 1.0f))                     // Magnification (or degenerate); also catches NaN
+            return fgBlerpClipIucs(*m_base,uvIucs);
+        uint            num = 1;
+        if (lMin * float(maxAniso) < lMaj)
+            num = maxAniso;
+        else if (lMin > 0.0f)
+            num = std::max(uint(std::ceil(lMaj / lMin)),1U);
+        float           lod = std::log(lMaj / float(num)) / std::log(2.0f);
+        if (num == 1)
+            return sample(uvIucs,lod);
+        Floating        ret = sample(uvIucs + major * (0.5f / float(num) - 0.5f),lod);
+        for (uint ii=1; ii<num; ++ii)
+            ret += sample(uvIucs + major * ((float(ii) + 0.5f) / float(num) - 0.5f),lod);
+        return ret * (1.0 / double(num));
+    }
+
+private:
+    const FgImage<T> *                  m_base;
+    uint                                m_numLevels;
+    mutable vector<FgImage<T> >         m_levels;       // Level 'll' is at index 'll-1'
+    std::unique_ptr<std::atomic<bool>[]> m_built;       // Indexed by level; level 0 unused
+    mutable boost::mutex                m_mtx;          // Serializes level construction
+
+    FgImagePyramid(const FgImagePyramid &);             // Not copyable
+    void operator=(const FgImagePyramid &);
+
+    static
+    FgVect2UI
+    levelDims(FgVect2UI dims)
+    {return FgVect2UI(std::max(dims[0]/2,1U),std::max(dims[1]/2,1U)); }
+
+    static
+    void
+    shrink(const FgImage<T> & src,FgImage<T> & dst)
+    {
+        // Integer channel types round to nearest:
+        Floating        bias(std::numeric_limits<typename FgTraits<T>::Scalar>::is_integer ? 0.5 : 0.0);
+        dst.resize(levelDims(src.dims()));
+        uint            xm = src.width()-1,
+                        ym = src.height()-1;
+        for (uint yy=0; yy<dst.height(); ++yy) {
+            const T     *s0 = src.rowPtr(std::min(2*yy,ym)),
+                        *s1 = src.rowPtr(std::min(2*yy+1,ym));
+            T *         dp = dst.rowPtr(yy);
+            for (uint xx=0; xx<dst.width(); ++xx) {
+                uint        x0 = std::min(2*xx,xm),
+                            x1 = std::min(2*xx+1,xm);
+                Floating    acc = Floating(s0[x0]) + Floating(s0[x1]) + Floating(s1[x0]) + Floating(s1[x1]);
+                dp[xx] = T(acc * 0.25 + bias);
+            }
+        }
+    }
+};
+
+typedef FgImagePyramid<FgRgbaUB>    FgImgPyramidRgbaUb;
+
+#endif
+
+// */
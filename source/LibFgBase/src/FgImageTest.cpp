@@ -16,6 +16,10 @@
 #include "FgTestUtils.hpp"
 #include "FgApproxEqual.hpp"
 #include "FgCommand.hpp"
+#include "FgRandom.hpp"
+#include "FgImagePyramid.hpp"
+#include "FgImageTiled.hpp"
+#include "FgThread.hpp"
 
 using namespace std;
 
@@ -63,6 +67,61 @@ sfs(const FgArgs &)
     fgImgDisplay(img);
 }
 
+// Random-UV bilinear fetch throughput for linear vs. tiled storage. Fetches are either fully
+// random or in short spans along random directions, as from rotated texture footprints:
+template<class Img>
+static
+double
+blerpFetchMs(const Img & img,const FgVect2Fs & uvs,const FgVect2Fs & steps,uint spanLen,double & sum)
+{
+    FgTimer             time;
+    for (size_t ii=0; ii<uvs.size(); ++ii) {
+        FgVect2F        uv = uvs[ii];
+        for (uint ss=0; ss<spanLen; ++ss) {
+            sum += fgBlerpClipIucs(img,uv).alpha();
+            uv += steps[ii];
+        }
+    }
+    return time.read() * 1000.0;
+}
+
+static
+void
+tiledBench(const FgArgs &)
+{
+    fgRandSeedRepeatable();
+    FgImgRgbaUb         img(4096,4096);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        img[ii] = FgRgbaUB(uchar(ii),uchar(ii>>8),uchar(ii>>16),uchar(fgRandUint(256)));
+    FgTimer             time;
+    FgImgTiledRgbaUb    tiled(img);
+    fgout << fgnl << "To tiled: " << time.read()*1000.0 << "ms";
+    time.start();
+    FgImgRgbaUb         back = tiled.toLinear();
+    fgout << fgnl << "To linear: " << time.read()*1000.0 << "ms";
+    FGASSERT(back.m_data == img.m_data);
+    uint                spanLens[] = {1,16};
+    for (uint sl=0; sl<2; ++sl) {
+        uint            spanLen = spanLens[sl];
+        size_t          num = (1 << 22) / spanLen;
+        FgVect2Fs       uvs(num),
+                        steps(num);
+        for (size_t ii=0; ii<num; ++ii) {
+            uvs[ii] = FgVect2F(float(fgRand()),float(fgRand()));
+            float       ang = float(fgRand() * 2.0 * fgPi());
+            steps[ii] = FgVect2F(std::cos(ang),std::sin(ang)) / 4096.0f;
+        }
+        double          s0 = 0.0,
+                        s1 = 0.0,
+                        ms0 = blerpFetchMs(img,uvs,steps,spanLen,s0),
+                        ms1 = blerpFetchMs(tiled,uvs,steps,spanLen,s1),
+                        mf = double(num*spanLen) / 1.0e6;
+        FGASSERT(s0 == s1);
+        fgout << fgnl << "Span length " << spanLen << ": linear " << mf / ms0 * 1000.0 << " Mfetch/s, tiled "
+            << mf / ms1 * 1000.0 << " Mfetch/s";
+    }
+}
+
 void
 fgImageTestm(const FgArgs & args)
 {
@@ -70,6 +129,7 @@ fgImageTestm(const FgArgs & args)
     cmds.push_back(FgCmd(resize,"resize"));
     cmds.push_back(FgCmd(display,"display"));
     cmds.push_back(FgCmd(sfs,"sfs","smoothFloat speed"));
+    cmds.push_back(FgCmd(tiledBench,"tiled","Bilinear fetch speed for linear vs. tiled image storage"));
     fgMenu(args,cmds);
 }
 
@@ -90,6 +150,215 @@ testConvolve(const FgArgs &)
     FGASSERT(fgApproxEqual(i0.m_data,i1.m_data));
 }
 
+// Row-banded parallel smoothing must give identical results to the serial path,
+// including in-place where bands overwrite each other's halo rows:
+static
+void
+testSmoothBands(const FgArgs &)
+{
+    fgRandSeedRepeatable();
+    FgImgRgbaUb         img(301,257);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        for (uint cc=0; cc<4; ++cc)
+            img[ii].m_c[cc] = uchar(fgRandUint(256));
+    for (uchar bp=0; bp<2; ++bp) {
+        FgImgRgbaUb     ser,par = img;
+        fgSmoothUint(img,ser,bp);
+        fgSmoothUint(par,par,bp,&fgThreadPool());
+        FGASSERT(ser.m_data == par.m_data);
+        // Spot check against the direct 3x3 sum with border replication:
+        if (bp == 1) {
+            for (uint yy=0; yy<img.height(); yy+=37) {
+                for (uint xx=0; xx<img.width(); xx+=29) {
+                    for (uint cc=0; cc<4; ++cc) {
+                        uint        acc = 7;
+                        for (int jj=-1; jj<2; ++jj) {
+                            for (int ii=-1; ii<2; ++ii) {
+                                uint    sx = uint(fgClip(int(xx)+ii,0,int(img.width())-1)),
+                                        sy = uint(fgClip(int(yy)+jj,0,int(img.height())-1));
+                                acc += img.xy(sx,sy).m_c[cc] * (2-std::abs(ii)) * (2-std::abs(jj));
+                            }
+                        }
+                        FGASSERT(ser.xy(xx,yy).m_c[cc] == acc/16);
+                    }
+                }
+            }
+        }
+    }
+    FgImg3F             imf(600,500);
+    for (size_t ii=0; ii<imf.numPixels(); ++ii)
+        imf[ii] = FgVect3F(float(fgRand()),float(fgRand()),float(fgRand()));
+    FgImg3F             ser,par = imf,conv;
+    fgSmoothFloat(imf,ser,1);
+    fgSmoothFloat(par,par,1,&fgThreadPool());
+    FGASSERT(ser.m_data == par.m_data);
+    fgConvolveFloat(imf,FgMat33F(1,2,1,2,4,2,1,2,1)/16.0f,conv,0,&fgThreadPool());
+    fgSmoothFloat(imf,ser,0);
+    for (size_t ii=0; ii<ser.numPixels(); ++ii)
+        FGASSERT((ser[ii]-conv[ii]).mag() < 1.0e-10f);
+}
+
+static
+void
+pyramidLevel(const FgImgPyramidRgbaUb * pyr,uint ll)
+{pyr->level(ll); }
+
+static
+void
+testPyramid(const FgArgs &)
+{
+    fgRandSeedRepeatable();
+    FgImgRgbaUb         img(37,10);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        for (uint cc=0; cc<4; ++cc)
+            img[ii].m_c[cc] = uchar(fgRandUint(256));
+    FgImgPyramidRgbaUb  pyr(img);
+    FGASSERT(pyr.numLevels() == 6);
+    // Concurrent first access to levels must build each one exactly once:
+    vector<FgJob>       jobs;
+    for (uint ii=0; ii<64; ++ii)
+        jobs.push_back(boost::bind(pyramidLevel,&pyr,5-ii%6));
+    fgThreadPool().run(jobs);
+    FGASSERT(pyr.level(1).dims() == FgVect2UI(18,5));
+    FGASSERT(pyr.level(5).dims() == FgVect2UI(1,1));
+    FgRgbaUS            sum = FgRgbaUS(img.xy(6,4)) + FgRgbaUS(img.xy(7,4)) +
+                              FgRgbaUS(img.xy(6,5)) + FgRgbaUS(img.xy(7,5)) + FgRgbaUS(2,2,2,2);
+    FGASSERT(pyr.level(1).xy(3,2) == FgRgbaUB(sum / ushort(4)));
+    // Level 0 and magnified footprints give plain bilinear samples:
+    FgVect2F            uv(0.3f,0.6f);
+    FgRgbaD             ref = fgBlerpClipIucs(img,uv);
+    FGASSERT(pyr.sample(uv,0.0f) == ref);
+    FGASSERT(pyr.sample(uv,FgMat22F(0.01f,0.0f,0.0f,0.05f)) == ref);
+    // A constant image is preserved at any footprint:
+    FgImgRgbaUb         cnst(64,32,FgRgbaUB(10,20,30,255));
+    FgImgPyramidRgbaUb  cpyr(cnst);
+    FgMat22F            fps[] = {FgMat22F(0.1f,0.0f,0.0f,0.1f),FgMat22F(0.3f,0.01f,0.0f,0.02f)};
+    for (uint ii=0; ii<2; ++ii) {
+        FgRgbaD         smp = cpyr.sample(uv,fps[ii]);
+        FGASSERT((smp.m_c - FgVect4D(10,20,30,255)).mag() < 1.0e-6);
+    }
+}
+
+static
+void
+testTiled(const FgArgs &)
+{
+    fgRandSeedRepeatable();
+    // Dimensions not a multiple of the tile size:
+    FgImgF              img(21,13);
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        img[ii] = float(fgRand());
+    FgImgTiledF         tiled(img);
+    FGASSERT(tiled.dims() == img.dims());
+    for (FgIter2UI it(img.dims()); it.valid(); it.next())
+        FGASSERT(tiled[it] == img[it]);
+    FGASSERT(tiled.toLinear().m_data == img.m_data);
+    for (uint ii=0; ii<100; ++ii) {
+        FgVect2F        uv(float(fgRand()*1.2-0.1),float(fgRand()*1.2-0.1));
+        FGASSERT(fgBlerpClipIucs(tiled,uv) == fgBlerpClipIucs(img,uv));
+    }
+}
+
+static
+void
+resizeJob(const FgImgRgbaUb * src,FgImgRgbaUb * dst)
+{fgImgResize(*src,*dst); }
+
+static
+void
+testResize(const FgArgs &)
+{
+    fgRandSeedRepeatable();
+    FgImgRgbaUb         src(37,23);
+    for (size_t ii=0; ii<src.numPixels(); ++ii)
+        for (uint cc=0; cc<4; ++cc)
+            src[ii].m_c[cc] = uchar(fgRandUint(256));
+    // Box filter exact halving is the average of each 2x2 block, to within rounding:
+    {
+        FgImgRgbaUb     even(36,22),
+                        dst(18,11);
+        for (uint yy=0; yy<even.height(); ++yy)
+            for (uint xx=0; xx<even.width(); ++xx)
+                even.xy(xx,yy) = src.xy(xx,yy);
+        fgImgResize(even,dst);
+        for (uint yy=0; yy<dst.height(); ++yy) {
+            for (uint xx=0; xx<dst.width(); ++xx) {
+                for (uint cc=0; cc<4; ++cc) {
+                    float   avg = 0.25f * (
+                        float(even.xy(2*xx,2*yy).m_c[cc]) + float(even.xy(2*xx+1,2*yy).m_c[cc]) +
+                        float(even.xy(2*xx,2*yy+1).m_c[cc]) + float(even.xy(2*xx+1,2*yy+1).m_c[cc]));
+                    FGASSERT(std::abs(float(dst.xy(xx,yy).m_c[cc]) - avg) <= 0.5f);
+                }
+            }
+        }
+        FgImgF          evenF(36,22),
+                        dstF(18,11);
+        for (size_t ii=0; ii<evenF.numPixels(); ++ii)
+            evenF[ii] = float(even[ii].red());
+        fgImgResize(evenF,dstF);
+        for (uint yy=0; yy<dstF.height(); ++yy) {
+            for (uint xx=0; xx<dstF.width(); ++xx) {
+                float   avg = 0.25f * (evenF.xy(2*xx,2*yy) + evenF.xy(2*xx+1,2*yy) +
+                                       evenF.xy(2*xx,2*yy+1) + evenF.xy(2*xx+1,2*yy+1));
+                FGASSERT(std::abs(dstF.xy(xx,yy) - avg) < 1.0e-4f);
+            }
+        }
+    }
+    // Box filter with a non-integer ratio lies within the range of the source pixels it covers:
+    {
+        FgImgRgbaUb     dst(18,11);
+        fgImgResize(src,dst);
+        for (uint yy=0; yy<dst.height(); ++yy) {
+            for (uint xx=0; xx<dst.width(); ++xx) {
+                for (uint cc=0; cc<4; ++cc) {
+                    // Source pixels per destination pixel is slightly over 2, so allow rounding slack:
+                    uint    sx = (xx*37)/18,
+                            sy = (yy*23)/11;
+                    int     lo = 255, hi = 0;
+                    for (uint ss=sy; ss<=std::min(sy+2,22U); ++ss)
+                        for (uint rr=sx; rr<=std::min(sx+2,36U); ++rr)
+                            lo = std::min(lo,int(src.xy(rr,ss).m_c[cc])),
+                            hi = std::max(hi,int(src.xy(rr,ss).m_c[cc]));
+                    int     val = dst.xy(xx,yy).m_c[cc];
+                    FGASSERT((val >= lo) && (val <= hi));
+                }
+            }
+        }
+    }
+    // Resizing large images within pool jobs, as the imgops batch command does, runs the nested
+    // resize bands serially and gives the same result:
+    {
+        FgImgRgbaUb     big(700,500),
+                        ref(333,222);
+        for (uint yy=0; yy<big.height(); ++yy)
+            for (uint xx=0; xx<big.width(); ++xx)
+                big.xy(xx,yy) = src.xy(xx%37,yy%23);
+        fgImgResize(big,ref);
+        vector<FgImgRgbaUb> dsts(4,FgImgRgbaUb(333,222));
+        vector<FgJob>   jobs;
+        for (size_t ii=0; ii<dsts.size(); ++ii)
+            jobs.push_back(boost::bind(resizeJob,&big,&dsts[ii]));
+        fgThreadPool().run(jobs);
+        for (size_t ii=0; ii<dsts.size(); ++ii)
+            FGASSERT(dsts[ii].dataVec() == ref.dataVec());
+    }
+    // All filters must preserve a constant image, when shrinking and expanding:
+    FgImgF              cnst(37,23,0.375f);
+    FgResizeFilter      filters[] = {FgResizeFilter::box,FgResizeFilter::bilinear,FgResizeFilter::lanczos3,FgResizeFilter::mitchell};
+    vector<FgVect2UI>   dimss;
+    dimss.push_back(FgVect2UI(9,5));
+    dimss.push_back(FgVect2UI(101,64));
+    for (size_t ff=0; ff<4; ++ff) {
+        for (size_t dd=0; dd<dimss.size(); ++dd) {
+            FgImgF      dst(dimss[dd]);
+            fgImgResize(cnst,dst,filters[ff]);
+            for (size_t ii=0; ii<dst.numPixels(); ++ii)
+                FGASSERT(std::abs(dst[ii]-0.375f) < 1.0e-5f);
+        }
+    }
+}
+
+void    fgImgTestRead(const FgArgs &);
 void    fgImgTestWrite(const FgArgs &);
 
 void
@@ -97,6 +366,11 @@ fgImageTest(const FgArgs & args)
 {
     vector<FgCmd>       cmds;
     cmds.push_back(FgCmd(testConvolve,"conv"));
+    cmds.push_back(FgCmd(fgImgTestRead,"read"));
+    cmds.push_back(FgCmd(testPyramid,"pyramid"));
+    cmds.push_back(FgCmd(testResize,"resize"));
+    cmds.push_back(FgCmd(testTiled,"tiled"));
+    cmds.push_back(FgCmd(testSmoothBands,"smoothBands"));
     cmds.push_back(FgCmd(fgImgTestWrite,"write"));
     fgMenu(args,cmds,true,false,true);
 }
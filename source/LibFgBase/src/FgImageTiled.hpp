@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2015 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Created:     Oct 16, 2026
+//
+// Image stored as square tiles, for access patterns that are local in 2D but not along rows
+// (eg. texture lookups from rotated or minified screen footprints).
+//
+// INVARIANTS:
+//
+// m_tiles = ceil(m_dims / tileSz)
+// m_data.size() = m_tiles[0] * m_tiles[1] * tileSz * tileSz;
+//
+// Tiles are stored left to right, top to bottom, and pixels within a tile likewise. Pixels in
+// the padding of the right and bottom tiles are unused.
+
+#ifndef FGIMAGETILED_HPP
+#define FGIMAGETILED_HPP
+
+#include "FgImage.hpp"
+
+template<typename T,uint tileLog2=3>        // Default 8x8 tiles
+struct  FgImageTiled
+{
+    static const uint   tileSz = 1U << tileLog2;
+    static const uint   tileMask = tileSz - 1;
+
+    FgVect2UI       m_dims;         // [width,height]
+    FgVect2UI       m_tiles;        // Number of tiles in each dimension
+    vector<T>       m_data;
+
+    typedef T PixelType;
+
+    FgImageTiled() : m_dims(0), m_tiles(0) {}
+
+    explicit
+    FgImageTiled(FgVect2UI dims)
+    {resize(dims); }
+
+    FgImageTiled(FgVect2UI dims,T fillVal)
+    {resize(dims,fillVal); }
+
+    explicit
+    FgImageTiled(const FgImage<T> & img)
+    {fromLinear(img); }
+
+    void
+    clear()
+    {m_data.clear(); m_dims = m_tiles = FgVect2UI(0); }
+
+    // WARNING: This does not adjust any existing image data, just allocated dimensions and memory:
+    void
+    resize(FgVect2UI dims)
+    {
+        m_dims = dims;
+        m_tiles = (dims + FgVect2UI(tileMask)) / uint(tileSz);
+        m_data.resize(size_t(m_tiles[0])*m_tiles[1]*tileSz*tileSz);
+    }
+
+    void
+    resize(FgVect2UI dims,T fillVal)
+    {
+        resize(dims);
+        std::fill(m_data.begin(),m_data.end(),fillVal);
+    }
+
+    uint
+    width() const
+    {return m_dims[0]; }
+
+    uint
+    height() const
+    {return m_dims[1]; }
+
+    FgVect2UI
+    dims() const
+    {return m_dims; }
+
+    size_t
+    numPixels() const
+    {return size_t(m_dims[0])*m_dims[1]; }
+
+    bool
+    empty() const
+    {return (m_data.empty()); }
+
+    size_t
+    index(size_t ircs_x,size_t ircs_y) const
+    {
+        FGASSERT_FAST((ircs_x < m_dims[0]) && (ircs_y < m_dims[1]));
+        size_t      tile = (ircs_y >> tileLog2) * m_tiles[0] + (ircs_x >> tileLog2);
+        return (tile << (2*tileLog2)) | ((ircs_y & tileMask) << tileLog2) | (ircs_x & tileMask);
+    }
+
+    // Element access by (X,Y) / (column,row):
+    T &
+    xy(size_t ircs_x,size_t ircs_y)
+    {return m_data[index(ircs_x,ircs_y)]; }
+
+    const T &
+    xy(size_t ircs_x,size_t ircs_y) const
+    {return m_data[index(ircs_x,ircs_y)]; }
+
+    T &
+    operator[](FgVect2UI ircsPos)
+    {return xy(ircsPos[0],ircsPos[1]); }
+
+    const T &
+    operator[](FgVect2UI ircsPos) const
+    {return xy(ircsPos[0],ircsPos[1]); }
+
+    template<typename U>
+    T &
+    operator[](const FgIter<U,2> & it)
+    {return xy(it()[0],it()[1]); }
+
+    template<typename U>
+    const T &
+    operator[](const FgIter<U,2> & it) const
+    {return xy(it()[0],it()[1]); }
+
+    // 'paint' access is bounds checked and out of bounds paints are ignored:
+    void
+    paint(uint ircs_x,uint ircs_y,T val)
+    {
+        if ((ircs_x < m_dims[0]) && (ircs_y < m_dims[1]))
+            xy(ircs_x,ircs_y) = val;
+    }
+
+    // Conversion copies whole tile rows at a time:
+    void
+    fromLinear(const FgImage<T> & img)
+    {
+        resize(img.dims());
+        for (uint yy=0; yy<m_dims[1]; ++yy) {
+            const T *   src = img.rowPtr(yy);
+            for (uint tx=0; tx<m_tiles[0]; ++tx) {
+                uint    x0 = tx * tileSz,
+                        num = std::min(uint(tileSz),m_dims[0]-x0);
+                std::copy(src+x0,src+x0+num,&m_data[index(x0,yy)]);
+            }
+        }
+    }
+
+    FgImage<T>
+    toLinear() const
+    {
+        FgImage<T>      ret(m_dims);
+        for (uint yy=0; yy<m_dims[1]; ++yy) {
+            T *         dst = ret.rowPtr(yy);
+            for (uint tx=0; tx<m_tiles[0]; ++tx) {
+                uint        x0 = tx * tileSz,
+                            num = std::min(uint(tileSz),m_dims[0]-x0);
+                const T *   src = &m_data[index(x0,yy)];
+                std::copy(src,src+num,dst+x0);
+            }
+        }
+        return ret;
+    }
+};
+
+typedef FgImageTiled<FgRgbaUB>  FgImgTiledRgbaUb;
+typedef FgImageTiled<float>     FgImgTiledF;
+
+template<class T,uint tileLog2>
+typename FgTraits<T>::Floating
+fgBlerpClipIpcs(const FgImageTiled<T,tileLog2> & img,FgVect2F coordIpcs)
+{return fgBlerpClipIpcsImg(img,coordIpcs); }
+
+template<class T,uint tileLog2>
+typename FgTraits<T>::Floating
+fgBlerpClipIucs(const FgImageTiled<T,tileLog2> & img,FgVect2F coordIucs)
+{return fgBlerpClipIpcsImg(img,fgMapMul(coordIucs,FgVect2F(img.dims()))); }
+
+#endif
+
+// */
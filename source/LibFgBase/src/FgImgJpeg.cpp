@@ -11,6 +11,7 @@
 #include "FgException.hpp"
 #include "FgImage.hpp"
 #include "FgStdString.hpp"
+#include "FgFileSystem.hpp"
 
 #ifdef _MSC_VER
 // _setjmp and C++ object destruction is non-portable.
@@ -53,9 +54,12 @@ using namespace std;
 static
 bool
 loadJpeg(
-    const vector<uchar> &   jpgBuffer,
+    const uchar *           jpgData,
+    size_t                  jpgSize,
+    uint                    scaleDenom,
     FgImgRgbaUb &           img)
 {
+    FGASSERT(scaleDenom > 0);
     jpeg_decompress_struct cinfo;
     IJGErrorManager jerr;
 
@@ -74,7 +78,7 @@ loadJpeg(
         {
             // DO NOT ALLOCATE ANY C++ OBJECTS HERE OR ELSE THERE COULD BE A MEMORY LEAK
             jpeg_create_decompress(&cinfo);
-            jpeg_mem_src(&cinfo,&jpgBuffer[0],jpgBuffer.size());
+            jpeg_mem_src(&cinfo,jpgData,jpgSize);
             jpeg_read_header(&cinfo,TRUE);
 
             // We need to do this because libjpeg does not do a very good job at guessing.
@@ -94,6 +98,9 @@ loadJpeg(
             }
             // We always want RGB out
             cinfo.out_color_space = JCS_RGB;
+            // Reduced size output is done in the IDCT so is much faster than a full decode:
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = scaleDenom;
             jpeg_start_decompress(&cinfo);
             // Must try-catch C++ allocations to avoid memory leaks here:
             try {
@@ -116,12 +123,15 @@ loadJpeg(
                 // Here the array is only one element long, but you could ask for
                 // more than one scanline at a time if that's more convenient:
                 jpeg_read_scanlines(&cinfo,&buffer,1);
-                uchar         *ptr = buffer;
+                const uchar *   src = buffer;
+                uchar *         dst = &img.xy(0,row).red();
                 for (uint col=0; col<img.width(); col++) {
-                    img.xy(col,row).red() = *ptr++;
-                    img.xy(col,row).green() = *ptr++;
-                    img.xy(col,row).blue() = *ptr++;
-                    img.xy(col,row).alpha() = 255;
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst[3] = 255;
+                    src += 3;
+                    dst += 4;
                 }
                 row++;
             }
@@ -169,7 +179,8 @@ saveJpeg(
 
     bool succeeded = false;
 
-    vector<uchar> img_buffer(img.height() * img.width() * 3);
+    // Only one row is converted at a time to avoid a full-size copy of the image:
+    vector<uchar> row_buffer(img.width() * 3);
 
     switch(setjmp(jerr.setjmp_buffer))
     {
@@ -192,21 +203,19 @@ saveJpeg(
 
             jpeg_start_compress(&cinfo, TRUE);
 
-            uchar * imgPtr = &img_buffer[0];
-            for(uint yy = 0; yy < img.height(); yy++)
+            row_pointer[0] = &row_buffer[0];
+            while(cinfo.next_scanline < cinfo.image_height)
             {
+                const uchar *   src = &img.xy(0,cinfo.next_scanline).red();
+                uchar *         dst = &row_buffer[0];
                 for(uint xx=0; xx<img.width(); xx++)
                 {
-                    *imgPtr++ = img.xy(xx,yy).red();
-                    *imgPtr++ = img.xy(xx,yy).green();
-                    *imgPtr++ = img.xy(xx,yy).blue();
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    src += 4;
+                    dst += 3;
                 }
-            }
-
-            uint row_stride = img.width() * 3;
-            while(cinfo.next_scanline < cinfo.image_height)
-            {
-                row_pointer[0] = &img_buffer[cinfo.next_scanline * row_stride];
                 jpeg_write_scanlines(&cinfo,row_pointer,1);
             }
             jpeg_finish_compress(&cinfo);
@@ -260,27 +269,20 @@ fgImgSaveJfif(
 void
 fgImgLoadJfif(
     const FgString &    fname,
-    FgImgRgbaUb &       img)
+    FgImgRgbaUb &       img,
+    uint                scaleDenom)
 {
-    FgIfstream  ifs(fname);
-
-    ifs.seekg(0,std::ios::end);
-    std::streamsize size = ifs.tellg();
-    ifs.seekg(0,std::ios::beg);
-    
-    vector<uchar>       source;
-    source.resize(static_cast<std::size_t>(size));
-    ifs.read(reinterpret_cast<char*>(&source[0]),size);
-    
-    if(!loadJpeg(source,img))
+    string              source = fgSlurp(fname);
+    if(!loadJpeg(reinterpret_cast<const uchar*>(source.data()),source.size(),scaleDenom,img))
         fgThrow("Error processing JFIF data",fname);
 }
 
 void 
 fgImgLoadJfif(
     const vector<uchar> &   data,
-    FgImgRgbaUb &           img)
+    FgImgRgbaUb &           img,
+    uint                    scaleDenom)
 {
-    if(!loadJpeg(data,img))
+    if(!loadJpeg(data.data(),data.size(),scaleDenom,img))
         fgThrow("Error processing JFIF data");
 }
@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2015 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Created:     Oct 16, 2026
+//
+// Direct use of the libpng bundled with ImageMagick, avoiding the overhead of ImageMagick's
+// generic pixel cache for the most common lossless format.
+//
+
+#include "stdafx.h"
+
+#include "FgImageIo.hpp"
+#include "FgStdStream.hpp"
+#include "FgException.hpp"
+#include "FgScopeGuard.hpp"
+#include "FgFileSystem.hpp"
+
+#ifdef _MSC_VER
+// As with the IJG code, the functions below which call setjmp CANNOT construct any C++ objects
+// with non-trivial destructors, since longjmp will not unwind them:
+#  pragma warning(disable:4611)
+#endif
+
+#include "png/png.h"
+
+using namespace std;
+
+struct  PngSrc
+{
+    const uchar *   data;
+    size_t          size;
+    size_t          pos;
+};
+
+struct  PngDst
+{
+    vector<uchar> * data;
+    bool            failed;
+};
+
+static
+void
+pngError(png_structp png,png_const_charp)
+{longjmp(png_jmpbuf(png),1); }
+
+static
+void
+pngWarning(png_structp,png_const_charp)
+{}
+
+static
+void
+pngRead(png_structp png,png_bytep dst,png_size_t len)
+{
+    PngSrc *        src = reinterpret_cast<PngSrc*>(png_get_io_ptr(png));
+    if (len > src->size - src->pos)
+        png_error(png,"Truncated PNG data");
+    memcpy(dst,src->data+src->pos,len);
+    src->pos += len;
+}
+
+static
+void
+pngWrite(png_structp png,png_bytep src,png_size_t len)
+{
+    PngDst *        dst = reinterpret_cast<PngDst*>(png_get_io_ptr(png));
+    if (dst->failed)
+        return;
+    // Can't longjmp out of a catch block so just flag the failure:
+    try {
+        dst->data->insert(dst->data->end(),src,src+len);
+    }
+    catch (...) {
+        dst->failed = true;
+    }
+}
+
+static
+void
+pngFlush(png_structp)
+{}
+
+// Read the header and set up transformations so that every format is read as 8-bit RGBA:
+static
+bool
+readHeader(png_structp png,png_infop info,png_uint_32 * width,png_uint_32 * height)
+{
+    if (setjmp(png_jmpbuf(png)))
+        return false;
+    png_read_info(png,info);
+    int             depth,
+                    colorType;
+    png_get_IHDR(png,info,width,height,&depth,&colorType,NULL,NULL,NULL);
+    bool            trns = (png_get_valid(png,info,PNG_INFO_tRNS) != 0);
+    if (depth == 16)
+        png_set_strip_16(png);
+    if (colorType == PNG_COLOR_TYPE_PALETTE)
+        png_set_palette_to_rgb(png);
+    if ((colorType == PNG_COLOR_TYPE_GRAY) && (depth < 8))
+        png_set_expand_gray_1_2_4_to_8(png);
+    if ((colorType == PNG_COLOR_TYPE_GRAY) || (colorType == PNG_COLOR_TYPE_GRAY_ALPHA))
+        png_set_gray_to_rgb(png);
+    if (trns)
+        png_set_tRNS_to_alpha(png);
+    else if ((colorType & PNG_COLOR_MASK_ALPHA) == 0)
+        png_set_filler(png,0xFF,PNG_FILLER_AFTER);
+    png_set_interlace_handling(png);
+    png_read_update_info(png,info);
+    return (png_get_rowbytes(png,info) == *width * 4);
+}
+
+static
+bool
+readPixels(png_structp png,png_bytepp rows)
+{
+    if (setjmp(png_jmpbuf(png)))
+        return false;
+    png_read_image(png,rows);
+    png_read_end(png,NULL);
+    return true;
+}
+
+static
+bool
+writeAll(png_structp png,png_infop info,png_uint_32 width,png_uint_32 height,bool opaque,png_bytepp rows)
+{
+    if (setjmp(png_jmpbuf(png)))
+        return false;
+    png_set_IHDR(png,info,width,height,8,
+        opaque ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA,
+        PNG_INTERLACE_NONE,PNG_COMPRESSION_TYPE_DEFAULT,PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png,info);
+    if (opaque)
+        png_set_filler(png,0,PNG_FILLER_AFTER);     // Strips the alpha byte on write
+    png_write_image(png,rows);
+    png_write_end(png,NULL);
+    return true;
+}
+
+static
+bool
+decodePng(const uchar * data,size_t size,FgImgRgbaUb & img)
+{
+    if ((size < 8) || (png_sig_cmp(const_cast<png_bytep>(data),0,8) != 0))
+        return false;
+    png_structp     png = png_create_read_struct(PNG_LIBPNG_VER_STRING,NULL,pngError,pngWarning);
+    if (png == NULL)
+        return false;
+    png_infop       info = png_create_info_struct(png);
+    FgScopeGuard    sg(boost::bind(png_destroy_read_struct,&png,&info,png_infopp(NULL)));
+    if (info == NULL)
+        return false;
+    PngSrc          src = {data,size,0};
+    png_set_read_fn(png,&src,pngRead);
+    png_uint_32     width,
+                    height;
+    if (!readHeader(png,info,&width,&height))
+        return false;
+    img.resize(width,height);
+    vector<png_bytep>   rows(height);
+    for (uint yy=0; yy<height; ++yy)
+        rows[yy] = reinterpret_cast<png_bytep>(&img.xy(0,yy));
+    return readPixels(png,rows.data());
+}
+
+void
+fgImgLoadPng(
+    const FgString &        fname,
+    FgImgRgbaUb &           img)
+{
+    string          data = fgSlurp(fname);
+    if (!decodePng(reinterpret_cast<const uchar*>(data.data()),data.size(),img))
+        fgThrow("Error processing PNG data",fname);
+}
+
+void
+fgImgLoadPng(
+    const vector<uchar> &   fileContents,
+    FgImgRgbaUb &           img)
+{
+    if (!decodePng(fileContents.data(),fileContents.size(),img))
+        fgThrow("Error processing PNG data");
+}
+
+void
+fgImgSavePng(
+    const FgImgRgbaUb &     img,
+    vector<uchar> &         buffer)
+{
+    buffer.clear();
+    if (img.numPixels() == 0)
+        fgThrow("Unable to save empty image as PNG");
+    bool            opaque = true;
+    for (size_t ii=0; ii<img.numPixels(); ++ii)
+        if (img[ii].alpha() != 255)
+            opaque = false;
+    png_structp     png = png_create_write_struct(PNG_LIBPNG_VER_STRING,NULL,pngError,pngWarning);
+    if (png == NULL)
+        fgThrow("Unable to initialize PNG encoder");
+    png_infop       info = png_create_info_struct(png);
+    FgScopeGuard    sg(boost::bind(png_destroy_write_struct,&png,&info));
+    if (info == NULL)
+        fgThrow("Unable to initialize PNG encoder");
+    buffer.reserve(img.numPixels()*2);
+    PngDst          dst = {&buffer,false};
+    png_set_write_fn(png,&dst,pngWrite,pngFlush);
+    vector<png_bytep>   rows(img.height());
+    for (uint yy=0; yy<img.height(); ++yy)
+        rows[yy] = reinterpret_cast<png_bytep>(const_cast<FgRgbaUB*>(&img.xy(0,yy)));
+    if (!writeAll(png,info,img.width(),img.height(),opaque,rows.data()) || dst.failed)
+        fgThrow("Could not encode as PNG");
+}
+
+void
+fgImgSavePng(
+    const FgImgRgbaUb &     img,
+    const FgString &        fname)
+{
+    vector<uchar>   buffer;
+    fgImgSavePng(img,buffer);
+    FgOfstream      ofs(fname);
+    ofs.write(reinterpret_cast<const char*>(buffer.data()),buffer.size());
+}
+
+// */
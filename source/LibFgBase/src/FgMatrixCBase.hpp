@@ -520,6 +520,14 @@ fgWritep(std::ostream & os,const FgMatrixC<T,nrows,ncols> & m)
         fgWritep(os,m[ii]);
 }
 
+// Serialized as consecutive elements so arrays can be serialized as a block if the elements can:
+template<class T,uint nrows,uint ncols>
+struct  FgSerialRaw<FgMatrixC<T,nrows,ncols> >
+{
+    static const bool value =
+        FgSerialRaw<T>::value && (sizeof(FgMatrixC<T,nrows,ncols>) == nrows*ncols*sizeof(T));
+};
+
 // function 'constructors':
 
 template<typename T,uint nrows,uint ncols>
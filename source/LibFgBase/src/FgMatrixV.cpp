@@ -15,6 +15,8 @@
 #include "FgOut.hpp"
 #include "FgApproxEqual.hpp"
 #include "FgSyntax.hpp"
+#include "FgThread.hpp"
+#include "FgTime.hpp"
 
 using namespace std;
 
@@ -43,3 +45,229 @@ fgRelDiff(const FgMatrixD & a,const FgMatrixD & b,double minAbs)
     ret.m_data = fgRelDiff(a.m_data,b.m_data,minAbs);
     return ret;
 }
+
+// Row-major view of a matrix or its transpose:
+template<class T>
+struct  MatView
+{
+    const T *       data;
+    uint            stride;
+    bool            trans;
+
+    MatView(const FgMatrixV<T> & m,bool t) : data(m.m_data.data()), stride(m.ncols), trans(t) {}
+
+    T
+    operator()(uint row,uint col) const
+    {return trans ? data[size_t(col)*stride+row] : data[size_t(row)*stride+col]; }
+};
+
+// Block sizes chosen so a packed panel of rhs (kBlock x nBlock) stays in L2 and the
+// result rows being updated stay in L1:
+static const uint   kBlock = 128,
+                    nBlock = 256,
+                    rowBand = 64;
+
+// Accumulate the product of rows [rowBeg,rowEnd) of 'lhs', columns [kBeg,kBeg+kc) with the
+// packed rhs panel into 'ret', columns [nBeg,nBeg+nc). Each 'rhs' row is shared across 4 result
+// rows, and the inner loops are over contiguous memory so the compiler can vectorize them.
+// Every result element is summed in increasing 'k' order so results don't depend on blocking:
+template<class T>
+static
+void
+mulBand(
+    MatView<T>          lhs,
+    const T *           rhsPack,    // kc x nc row-major
+    uint                kBeg,
+    uint                kc,
+    uint                nBeg,
+    uint                nc,
+    uint                rowBeg,
+    uint                rowEnd,
+    FgMatrixV<T> *      retPtr)
+{
+    FgMatrixV<T> &      ret = *retPtr;
+    vector<T>           lhsPack(kc*4);
+    uint                row = rowBeg;
+    for (; row+4<=rowEnd; row+=4) {
+        for (uint kk=0; kk<kc; ++kk)
+            for (uint rr=0; rr<4; ++rr)
+                lhsPack[kk*4+rr] = lhs(row+rr,kBeg+kk);
+        T *             r0 = ret.m_data.data() + size_t(row)*ret.ncols + nBeg;
+        T *             r1 = r0 + ret.ncols;
+        T *             r2 = r1 + ret.ncols;
+        T *             r3 = r2 + ret.ncols;
+        for (uint kk=0; kk<kc; ++kk) {
+            T           l0 = lhsPack[kk*4],
+                        l1 = lhsPack[kk*4+1],
+                        l2 = lhsPack[kk*4+2],
+                        l3 = lhsPack[kk*4+3];
+            const T *   rhsRow = rhsPack + size_t(kk)*nc;
+            for (uint jj=0; jj<nc; ++jj) {
+                T       rv = rhsRow[jj];
+                r0[jj] += l0 * rv;
+                r1[jj] += l1 * rv;
+                r2[jj] += l2 * rv;
+                r3[jj] += l3 * rv;
+            }
+        }
+    }
+    for (; row<rowEnd; ++row) {
+        T *             r0 = ret.m_data.data() + size_t(row)*ret.ncols + nBeg;
+        for (uint kk=0; kk<kc; ++kk) {
+            T           l0 = lhs(row,kBeg+kk);
+            const T *   rhsRow = rhsPack + size_t(kk)*nc;
+            for (uint jj=0; jj<nc; ++jj)
+                r0[jj] += l0 * rhsRow[jj];
+        }
+    }
+}
+
+template<class T>
+static
+FgMatrixV<T>
+mulBlocked(
+    const FgMatrixV<T> &    lhsMat,
+    bool                    lhsTrans,
+    const FgMatrixV<T> &    rhsMat,
+    bool                    rhsTrans)
+{
+    MatView<T>          lhs(lhsMat,lhsTrans),
+                        rhs(rhsMat,rhsTrans);
+    uint                numRows = lhsTrans ? lhsMat.ncols : lhsMat.nrows,
+                        numInner = lhsTrans ? lhsMat.nrows : lhsMat.ncols,
+                        numCols = rhsTrans ? rhsMat.nrows : rhsMat.ncols;
+    FGASSERT(numInner == (rhsTrans ? rhsMat.ncols : rhsMat.nrows));
+    FgMatrixV<T>        ret(numRows,numCols,T(0));
+    // Not worth the thread overhead for small products:
+    bool                parallel = (double(numRows)*numInner*numCols > 1.0e6) && (numRows > rowBand);
+    vector<T>           rhsPack(kBlock*nBlock);
+    vector<FgJob>       jobs;
+    for (uint nBeg=0; nBeg<numCols; nBeg+=nBlock) {
+        uint            nc = std::min(nBlock,numCols-nBeg);
+        for (uint kBeg=0; kBeg<numInner; kBeg+=kBlock) {
+            uint        kc = std::min(kBlock,numInner-kBeg);
+            for (uint kk=0; kk<kc; ++kk)
+                for (uint jj=0; jj<nc; ++jj)
+                    rhsPack[kk*nc+jj] = rhs(kBeg+kk,nBeg+jj);
+            if (parallel) {
+                jobs.clear();
+                for (uint row=0; row<numRows; row+=rowBand)
+                    jobs.push_back(boost::bind(mulBand<T>,lhs,rhsPack.data(),kBeg,kc,nBeg,nc,
+                        row,std::min(row+rowBand,numRows),&ret));
+                fgThreadPool().run(jobs);
+            }
+            else
+                mulBand(lhs,rhsPack.data(),kBeg,kc,nBeg,nc,0,numRows,&ret);
+        }
+    }
+    return ret;
+}
+
+FgMatrixF
+fgMatMul(const FgMatrixF & lhs,const FgMatrixF & rhs)
+{return mulBlocked(lhs,false,rhs,false); }
+
+FgMatrixD
+fgMatMul(const FgMatrixD & lhs,const FgMatrixD & rhs)
+{return mulBlocked(lhs,false,rhs,false); }
+
+FgMatrixF
+fgMatMulAtB(const FgMatrixF & lhs,const FgMatrixF & rhs)
+{return mulBlocked(lhs,true,rhs,false); }
+
+FgMatrixD
+fgMatMulAtB(const FgMatrixD & lhs,const FgMatrixD & rhs)
+{return mulBlocked(lhs,true,rhs,false); }
+
+FgMatrixF
+fgMatMulABt(const FgMatrixF & lhs,const FgMatrixF & rhs)
+{return mulBlocked(lhs,false,rhs,true); }
+
+FgMatrixD
+fgMatMulABt(const FgMatrixD & lhs,const FgMatrixD & rhs)
+{return mulBlocked(lhs,false,rhs,true); }
+
+// The original textbook implementation, as a reference:
+template<class T>
+static
+FgMatrixV<T>
+mulNaive(const FgMatrixV<T> & lhs,const FgMatrixV<T> & rhs)
+{
+    FgMatrixV<T>    ret(lhs.nrows,rhs.ncols);
+    FGASSERT(lhs.ncols == rhs.nrows);
+    for (uint ii=0; ii<lhs.nrows; ii++) {
+        for (uint jj=0; jj<rhs.ncols; jj++) {
+            ret.rc(ii,jj) = 0;
+            for (uint kk=0; kk<lhs.ncols; kk++)
+                ret.rc(ii,jj) += lhs.rc(ii,kk) * rhs.rc(kk,jj);
+        }
+    }
+    return ret;
+}
+
+template<class T>
+static
+void
+testMul(uint numRows,uint numInner,uint numCols)
+{
+    FgMatrixV<T>    lhs = fgMatRandNormal<T>(numRows,numInner),
+                    rhs = fgMatRandNormal<T>(numInner,numCols),
+                    ref = mulNaive(lhs,rhs);
+    // Reassociation and FMA contraction can change the rounding of each sum, so compare
+    // with a tolerance that grows with the inner dimension:
+    T               tol = std::numeric_limits<T>::epsilon() * T(numInner);
+    FGASSERT(fgApproxEqual(lhs * rhs,ref,tol));
+    FGASSERT(fgApproxEqual(fgMatMulAtB(lhs.transpose(),rhs),ref,tol));
+    FGASSERT(fgApproxEqual(fgMatMulABt(lhs,rhs.transpose()),ref,tol));
+}
+
+void
+fgMatrixVTest(const FgArgs &)
+{
+    fgRandSeedRepeatable();
+    testMul<double>(3,5,7);
+    testMul<double>(1,300,1);
+    testMul<double>(131,257,301);
+    testMul<float>(67,129,259);
+    testMul<float>(0,4,3);
+}
+
+void
+fgMatrixVBench(const FgArgs & args)
+{
+    uint            dim = 1000;
+    if (args.size() > 1) {
+        FgSyntax        syntax(args,
+            "[<size>]\n"
+            "    <size> - Dimension of the square matrices to multiply (default 1000)"
+            );
+        dim = syntax.nextAs<uint>();
+    }
+    fgRandSeedRepeatable();
+    FgMatrixD       lhs = fgMatRandNormal<double>(dim,dim),
+                    rhs = fgMatRandNormal<double>(dim,dim);
+    double          gflop = 2.0e-9 * double(dim) * dim * dim;
+    FgTimer         timer;
+    FgMatrixD       naive = mulNaive(lhs,rhs);
+    double          tNaive = timer.read();
+    timer.start();
+    FgMatrixD       blocked = lhs * rhs;
+    double          tBlocked = timer.read();
+    timer.start();
+    FgMatrixD       atb = fgMatMulAtB(lhs,rhs);
+    double          tAtb = timer.read();
+    timer.start();
+    FgMatrixD       transCopy = lhs.transpose() * rhs;
+    double          tTransCopy = timer.read();
+    double          tol = std::numeric_limits<double>::epsilon() * dim;
+    FGASSERT(fgApproxEqual(blocked,naive,tol));
+    FGASSERT(fgApproxEqual(atb,transCopy,tol));
+    fgout << fgnl << dim << "x" << dim << " double on " << fgThreadPool().numThreads() << " threads:" << fgpush
+        << fgnl << "naive:              " << tNaive << "s " << gflop/tNaive << " GFLOPS"
+        << fgnl << "blocked:            " << tBlocked << "s " << gflop/tBlocked << " GFLOPS"
+        << fgnl << "A^T*B:              " << tAtb << "s " << gflop/tAtb << " GFLOPS"
+        << fgnl << "transpose() then *: " << tTransCopy << "s " << gflop/tTransCopy << " GFLOPS"
+        << fgpop;
+}
+
+// */
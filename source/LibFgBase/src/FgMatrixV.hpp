@@ -28,6 +28,23 @@ fgMatIdentity(size_t dim)
 FgMatrixD &
 operator/=(FgMatrixD & mat,double div);
 
+// Large products are computed in cache-sized blocks on fgThreadPool(). When called from within
+// an FgThreadPool job the blocks are computed serially on the calling thread. The 'AtB' and 'ABt'
+// versions multiply by the transpose of the respective argument without forming it. Each result
+// element is summed by a single thread so the number of threads does not affect the result, but
+// rounding may differ slightly from a naive triple loop:
+FgMatrixF
+fgMatMulAtB(const FgMatrixF & lhs,const FgMatrixF & rhs);
+
+FgMatrixD
+fgMatMulAtB(const FgMatrixD & lhs,const FgMatrixD & rhs);
+
+FgMatrixF
+fgMatMulABt(const FgMatrixF & lhs,const FgMatrixF & rhs);
+
+FgMatrixD
+fgMatMulABt(const FgMatrixD & lhs,const FgMatrixD & rhs);
+
 // FgMatrixV<> * vector<> treats rhs side as a column vector and returns same:
 template<class T>
 vector<T>
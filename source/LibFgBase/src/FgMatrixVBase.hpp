@@ -18,6 +18,19 @@
 #include "FgDiagnostics.hpp"
 #include "FgMatrixCBase.hpp"    // Used to represent dimensions 
 
+template <class T> struct FgMatrixV;
+
+template<class T>
+FgMatrixV<T>
+fgMatMul(const FgMatrixV<T> & lhs,const FgMatrixV<T> & rhs);
+
+// Cache-blocked and multithreaded for large matrices (see FgMatrixV.hpp):
+FgMatrixV<float>
+fgMatMul(const FgMatrixV<float> & lhs,const FgMatrixV<float> & rhs);
+
+FgMatrixV<double>
+fgMatMul(const FgMatrixV<double> & lhs,const FgMatrixV<double> & rhs);
+
 template <class T>
 struct  FgMatrixV
 {
@@ -178,18 +191,7 @@ struct  FgMatrixV
 
     FgMatrixV
     operator*(const FgMatrixV & m) const
-    {
-        FgMatrixV<T> newMat(nrows,m.ncols);
-        FGASSERT(ncols == m.nrows);
-        for (uint ii=0; ii<nrows; ii++) {
-            for (uint jj=0; jj<m.ncols; jj++) {
-                newMat.rc(ii,jj) = 0.0;
-                for (uint kk=0; kk<ncols; kk++)
-                    newMat.rc(ii,jj) += this->rc(ii,kk) * m.rc(kk,jj);
-            }
-        }
-        return newMat;
-    }
+    {return fgMatMul(*this,m); }
 
     FgMatrixV
     operator*(T v) const
@@ -369,6 +371,25 @@ FgMatrixV<T>
 operator*(const T & lhs,const FgMatrixV<T> & rhs)
 {return (rhs*lhs); }
 
+// Rows of 'rhs' are accumulated into rows of the result so all accesses are sequential:
+template<class T>
+FgMatrixV<T>
+fgMatMul(const FgMatrixV<T> & lhs,const FgMatrixV<T> & rhs)
+{
+    FGASSERT(lhs.ncols == rhs.nrows);
+    FgMatrixV<T>    ret(lhs.nrows,rhs.ncols,T(0));
+    for (uint ii=0; ii<lhs.nrows; ++ii) {
+        T *         retRow = ret.m_data.data() + size_t(ii)*ret.ncols;
+        for (uint kk=0; kk<lhs.ncols; ++kk) {
+            const T &   lhsVal = lhs.rc(ii,kk);
+            const T *   rhsRow = rhs.m_data.data() + size_t(kk)*rhs.ncols;
+            for (uint jj=0; jj<rhs.ncols; ++jj)
+                retRow[jj] += lhsVal * rhsRow[jj];
+        }
+    }
+    return ret;
+}
+
 template<typename T>
 FgMatrixV<T>
 fgColVec(const vector<T> & v)
@@ -12,6 +12,8 @@
 #include "FgDiagnostics.hpp"
 #include "FgTestUtils.hpp"
 #include "FgCommand.hpp"
+#include "FgStdStream.hpp"
+#include "FgMatrixC.hpp"
 
 using namespace std;
 
@@ -105,6 +107,36 @@ fgSerializeTest(const FgArgs &)
     fgLoadText("t1",vc);
     for (size_t ii=0; ii<sz; ++ii)
         FGASSERT(va[ii].m0 == vc[ii].m0);
+    // Portable serialization of vectors is the same whether written as a block or per element.
+    // On little-endian platforms vertex and index arrays must take the block path:
+#if defined(BOOST_LITTLE_ENDIAN)
+    FG_STATIC_ASSERT(FgSerialRaw<FgVect3F>::value);
+    FG_STATIC_ASSERT(FgSerialRaw<FgVect3UI>::value);
+    FG_STATIC_ASSERT(FgSerialRaw<uint>::value);
+#endif
+    FgVerts                 verts;
+    vector<FgUints>         indss(2);
+    for (uint ii=0; ii<100; ++ii) {
+        verts.push_back(FgVect3F(ii,-0.5f*ii,1.0f/(ii+1)));
+        indss[ii%2].push_back(ii*ii);
+    }
+    ostringstream           block,elems;
+    fgWritep(block,verts);
+    fgWritep(block,indss);
+    fgWritep(elems,uint32(verts.size()));
+    for (size_t ii=0; ii<verts.size(); ++ii)
+        for (uint jj=0; jj<3; ++jj)
+            fgWritep(elems,verts[ii][jj]);
+    fgWritep(elems,uint32(indss.size()));
+    for (size_t ii=0; ii<indss.size(); ++ii) {
+        fgWritep(elems,uint32(indss[ii].size()));
+        for (size_t jj=0; jj<indss[ii].size(); ++jj)
+            fgWritep(elems,indss[ii][jj]);
+    }
+    FGASSERT(block.str() == elems.str());
+    istringstream           is(block.str());
+    FGASSERT(fgReadpT<FgVerts>(is) == verts);
+    FGASSERT(fgReadpT<vector<FgUints> >(is) == indss);
 }
 
 // */
@@ -173,6 +173,7 @@ typedef FgRgba<double>          FgRgbaD;
 template<typename T>
 struct  FgTraits<FgRgba<T> >
 {
+    typedef typename FgTraits<T>::Scalar                Scalar;
     typedef FgRgba<typename FgTraits<T>::Accumulator>  Accumulator;
     typedef FgRgba<typename FgTraits<T>::Floating>     Floating;
 };
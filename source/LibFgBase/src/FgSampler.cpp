@@ -16,6 +16,7 @@
 #include "FgSyntax.hpp"
 #include "FgImgDisplay.hpp"
 #include "FgTime.hpp"
+#include "FgThread.hpp"
 
 using namespace std;
 
@@ -33,12 +34,10 @@ valsDiffer(
         (fgMaxElem(fgAbs(corners[3].m_c - centre.m_c)) > maxDiff));
 }
 
-static uint64 rayCount;
-
 static
 FgRgbaF
 sampleRecurse(
-    FgFuncSample            sample,
+    const FgFuncSamples &   sample,
     FgMat22F                bounds,
     FgMatrixC<FgRgbaF,2,2>  cornerVals,
     float                   maxDiff)
@@ -49,19 +48,23 @@ sampleRecurse(
                     delx,dely;
     delx[0] = del[0];
     dely[1] = del[1];
+    FgVect2F        cpos = lc+delx+dely;
     FgRgbaF         ret,
-                    centre(sample(lc+delx+dely));
+                    centre;
+    sample(&cpos,1,&centre);
     if (valsDiffer(centre,cornerVals,maxDiff)) {
-        rayCount+=4;
+        FgVect2F        epos[4] = {lc+delx,lc+dely,uc-dely,uc-delx};
+        FgRgbaF         evals[4];
+        sample(epos,4,evals);
         FgMatrixC<FgRgbaF,3,3>  vals(
                 cornerVals[0],
-                sample(lc+delx),
+                evals[0],
                 cornerVals[1],
-                sample(lc+dely),
+                evals[1],
                 centre,
-                sample(uc-dely),
+                evals[2],
                 cornerVals[2],
-                sample(uc-delx),
+                evals[3],
                 cornerVals[3]);
         FgRgbaF     acc;
         for (FgIter2UI it(2); it.valid(); it.next()) {
@@ -81,29 +84,38 @@ sampleRecurse(
     return ret;
 }
 
-FgImgRgbaF
-fgSamplerF(
-    FgVect2UI           dims,
-    FgFuncSample        sample,
-    uint                antiAliasBitDepth)
+// Samples the pixels within 'tile' (exclusive upper bounds). Corner samples are shared along
+// rows within a tile and recomputed at tile boundaries, with identical sample positions,
+// so the result doesn't depend on the tiling:
+static
+void
+sampleTile(
+    const FgFuncSamples & sample,
+    FgMat22UI           tile,
+    float               maxDiff,
+    FgImgRgbaF *        imgPtr)
 {
-    FgImgRgbaF          img(dims);
-    FGASSERT(dims.volume() > 0);
-    FGASSERT((antiAliasBitDepth > 0) && (antiAliasBitDepth <= 16));
-    rayCount = (img.width()+1) * (img.height()+1);
+    FgImgRgbaF &        img = *imgPtr;
     float               widf = float(img.width()),
                         hgtf = float(img.height());
-    FgImgRgbaF          sampleLines(img.width()+1,2);
-    for (uint col=0; col<sampleLines.width(); ++col)
-        sampleLines.xy(col,0) = 
-            sample(FgVect2F(float(col)/widf,0.0f));
-    for (uint row=0; row<img.height(); ++row) {
-        uint            fbit = row%2,
+    uint                colBeg = tile[0],
+                        colEnd = tile[1],
+                        rowBeg = tile[2],
+                        rowEnd = tile[3];
+    uint                lineSz = colEnd-colBeg+1;
+    FgImgRgbaF          sampleLines(lineSz,2);
+    FgVect2Fs           linePos(lineSz);
+    for (uint col=colBeg; col<=colEnd; ++col)
+        linePos[col-colBeg] = FgVect2F(float(col)/widf,float(rowBeg)/hgtf);
+    sample(&linePos[0],lineSz,&sampleLines.xy(0,0));
+    for (uint row=rowBeg; row<rowEnd; ++row) {
+        uint            fbit = (row-rowBeg)%2,
                         sbit = 1-fbit;
-        for (uint col=0; col<sampleLines.width(); ++col)
-            sampleLines.xy(col,sbit) = 
-                sample(FgVect2F(float(col)/widf,float(row+1)/hgtf));
-        for (uint col=0; col<img.width(); ++col) {
+        for (uint col=colBeg; col<=colEnd; ++col)
+            linePos[col-colBeg] = FgVect2F(float(col)/widf,float(row+1)/hgtf);
+        sample(&linePos[0],lineSz,&sampleLines.xy(0,sbit));
+        for (uint col=colBeg; col<colEnd; ++col) {
+            uint        tc = col - colBeg;
             img.xy(col,row) =
                 sampleRecurse(
                     sample,
@@ -113,26 +125,76 @@ fgSamplerF(
                         float(row)/hgtf,
                         float(row+1)/hgtf),
                     FgMatrixC<FgRgbaF,2,2>(
-                        sampleLines.xy(col,fbit),
-                        sampleLines.xy(col+1,fbit),
-                        sampleLines.xy(col,sbit),
-                        sampleLines.xy(col+1,sbit)),
-                    float(1 << (9-antiAliasBitDepth)));
+                        sampleLines.xy(tc,fbit),
+                        sampleLines.xy(tc+1,fbit),
+                        sampleLines.xy(tc,sbit),
+                        sampleLines.xy(tc+1,sbit)),
+                    maxDiff);
+        }
+    }
+}
+
+FgImgRgbaF
+fgSamplerPacketF(
+    FgVect2UI           dims,
+    FgFuncSamples       sample,
+    uint                antiAliasBitDepth,
+    uint                numThreads)
+{
+    FgImgRgbaF          img(dims);
+    FGASSERT(dims.volume() > 0);
+    FGASSERT((antiAliasBitDepth > 0) && (antiAliasBitDepth <= 16));
+    float               maxDiff = float(1 << (9-antiAliasBitDepth));
+    if (numThreads == 1) {
+        sampleTile(sample,FgMat22UI(0,dims[0],0,dims[1]),maxDiff,&img);
+        return img;
+    }
+    // Tiles rather than row bands so that expensive regions of the image (eg. anti-aliased
+    // edges) are spread across threads:
+    const uint          tileSz = 64;
+    vector<FgJob>       jobs;
+    for (uint row=0; row<dims[1]; row+=tileSz) {
+        for (uint col=0; col<dims[0]; col+=tileSz) {
+            FgMat22UI   tile(col,std::min(col+tileSz,dims[0]),row,std::min(row+tileSz,dims[1]));
+            jobs.push_back(boost::bind(sampleTile,boost::cref(sample),tile,maxDiff,&img));
         }
     }
-    //fgout << "Raycast count: " << rayCount;
+    fgThreadPool().run(jobs,numThreads);
     return img;
 }
 
-FgImgRgbaUb
-fgSampler(
+static
+void
+sampleEach(
+    const FgFuncSample &    sample,
+    const FgVect2F *        pos,
+    uint                    num,
+    FgRgbaF *               ret)
+{
+    for (uint ii=0; ii<num; ++ii)
+        ret[ii] = sample(pos[ii]);
+}
+
+FgImgRgbaF
+fgSamplerF(
     FgVect2UI           dims,
     FgFuncSample        sample,
-    uint                antiAliasBitDepth)
+    uint                antiAliasBitDepth,
+    uint                numThreads)
+{
+    return fgSamplerPacketF(dims,boost::bind(sampleEach,sample,_1,_2,_3),antiAliasBitDepth,numThreads);
+}
+
+FgImgRgbaUb
+fgSamplerPacket(
+    FgVect2UI           dims,
+    FgFuncSamples       sample,
+    uint                antiAliasBitDepth,
+    uint                numThreads)
 {
     FgImgRgbaUb         img(dims);
     FGASSERT((antiAliasBitDepth > 0) && (antiAliasBitDepth <= 8));
-    FgImgRgbaF          fimg = fgSamplerF(img.dims(),sample,antiAliasBitDepth);
+    FgImgRgbaF          fimg = fgSamplerPacketF(img.dims(),sample,antiAliasBitDepth,numThreads);
     for (FgIter2UI it(img.dims()); it.valid(); it.next())
     {
         const FgRgbaF & fpix = fimg[it()];
@@ -146,6 +208,16 @@ fgSampler(
     return img;
 }
 
+FgImgRgbaUb
+fgSampler(
+    FgVect2UI           dims,
+    FgFuncSample        sample,
+    uint                antiAliasBitDepth,
+    uint                numThreads)
+{
+    return fgSamplerPacket(dims,boost::bind(sampleEach,sample,_1,_2,_3),antiAliasBitDepth,numThreads);
+}
+
 static
 FgRgbaF
 halfMoon(FgVect2F ics)
@@ -6,7 +6,11 @@
 // Authors:     Andrew Beatty
 // Created:     April 6, 2010
 //
-// Adaptive image sampler
+// Adaptive image sampler. The packet versions take a sample function which evaluates many
+// positions per call.
+//
+// 'numThreads' > 1 (0 for all hardware threads) samples image tiles concurrently on the shared
+// thread pool, in which case 'sample' must be thread-safe. The result is identical regardless.
 
 #ifndef FG_SAMPLER_HPP
 #define FG_SAMPLER_HPP
@@ -15,17 +19,37 @@
 
 typedef boost::function<FgRgbaF(FgVect2F)>  FgFuncSample;
 
+// Sample 'num' positions at once, writing 'num' results. Positions are neighbours (along an
+// image row or around a sub-pixel) so implementations can take advantage of coherence:
+typedef boost::function<void(const FgVect2F *,uint,FgRgbaF *)>  FgFuncSamples;
+
+FgImgRgbaF
+fgSamplerPacketF(
+    FgVect2UI           dims,               // Must be non-zero
+    FgFuncSamples       sample,
+    uint                antiAliasBitDepth,  // Must be in [1,16]
+    uint                numThreads=1);
+
 FgImgRgbaF
 fgSamplerF(
     FgVect2UI           dims,               // Must be non-zero
     FgFuncSample        sample,
-    uint                antiAliasBitDepth); // Must be in [1,16]
+    uint                antiAliasBitDepth,  // Must be in [1,16]
+    uint                numThreads=1);
+
+FgImgRgbaUb
+fgSamplerPacket(
+    FgVect2UI           dims,               // Must be non-zero
+    FgFuncSamples       sample,
+    uint                antiAliasBitDepth,  // Must be in [1,8]
+    uint                numThreads=1);
 
 FgImgRgbaUb
 fgSampler(
     FgVect2UI           dims,               // Must be non-zero
     FgFuncSample        sample,
-    uint                antiAliasBitDepth); // Must be in [1,8]
+    uint                antiAliasBitDepth,  // Must be in [1,8]
+    uint                numThreads=1);
 
 #endif
 
@@ -20,6 +20,7 @@
 #include "Fg3dMeshIo.hpp"
 #include "Fg3dCamera.hpp"
 #include "FgTime.hpp"
+#include "FgThread.hpp"
 
 using namespace std;
 
@@ -29,12 +30,14 @@ shader(
     const FgLighting &  lighting,
     FgVect3F            normOecs,
     FgVect2F            uvIucs,
+    FgMat22F            iucsPerPixel,
     FgMaterial          material,
-    const FgImgRgbaUb * img = NULL)
+    const FgImgPyramidRgbaUb * img = NULL)
 {
     FgVect3F        acc(0.0f);
-    FgRgbaF         texSample = (img && (!img->empty())) ?
-        FgRgbaF(fgBlerpClipIucs(*img,uvIucs)) :
+    // The pyramid filters minified texture lookups according to the pixel footprint:
+    FgRgbaF         texSample = img ?
+        FgRgbaF(img->sample(uvIucs,iucsPerPixel)) :
         FgRgbaF(230.0f,230.0f,230.0f,255.0f);
 	float	        aw = texSample.alpha() / 255.0f;
     FgVect3F        surfColour = texSample.m_c.subMatrix<3,1>(0,0) * aw;
@@ -57,6 +60,317 @@ shader(
     return FgRgbaF(acc[0],acc[1],acc[2],texSample.alpha());
 }
 
+// Surface data for the rasterizer, with verts projected to supersample raster coordinates:
+struct  RastSurf
+{
+    FgSurfPtr           surf;
+    FgVect2Fs           vertsRcs;   // (0,0) is the top left corner of the supersample raster
+    vector<float>       invDepth;   // Linear in screen space, used for z-buffer & perspective correction
+    vector<FgVect3F>    norms;      // OECS
+    float               pixelsPerRcs;
+
+    RastSurf(FgSurfPtr rs,FgAffine3F modelview,FgAffineCw2F itcsToRcs,float pxPerRcs)
+    : surf(rs), pixelsPerRcs(pxPerRcs)
+    {
+        const FgVerts &     verts = *(surf.verts);
+        vertsRcs.resize(verts.size());
+        invDepth.resize(verts.size());
+        for (size_t ii=0; ii<verts.size(); ++ii) {
+            FgVect3F    vertOecs = modelview * verts[ii];
+            FGASSERT(vertOecs[2] < 0.0f);
+            invDepth[ii] = -1.0f / vertOecs[2];
+            FgVect2F    vertItcs(-vertOecs[0]/vertOecs[2],vertOecs[1]/vertOecs[2]);
+            vertsRcs[ii] = itcsToRcs * vertItcs;
+        }
+        fgTransform_(rs.norms->vert,norms,modelview.linear);
+    }
+
+    FgRgbaF
+    shade(const FgFuncShader & shader,uint triIdx,FgVect3F bary) const
+    {
+        FgVect3UI       tri = (*surf.vertInds)[triIdx];
+        FgVect3F        norm = bary[0] * norms[tri[0]] +
+                               bary[1] * norms[tri[1]] +
+                               bary[2] * norms[tri[2]];
+        norm /= norm.length();
+        FgVect2F        uv(0.0f);
+        FgMat22F        uvPerPixel(0.0f);
+        if ((surf.uvInds != NULL) && (!surf.uvInds->empty())) {
+            FgVect3UI   uvInds = (*surf.uvInds)[triIdx];
+            FgVect2F    uvs[3],
+                        pos[3];
+            for (uint ii=0; ii<3; ++ii) {
+                uvs[ii] = (*surf.uvs)[uvInds[ii]];
+                uvs[ii][1] = 1.0f - uvs[ii][1];     // OTCS to IUCS
+                pos[ii] = vertsRcs[tri[ii]] * pixelsPerRcs;
+            }
+            uv = bary[0] * uvs[0] + bary[1] * uvs[1] + bary[2] * uvs[2];
+            uvPerPixel = fgTriUvPerPos(pos,uvs);
+        }
+        return shader(norm,uv,uvPerPixel,surf.material,surf.texImg);
+    }
+};
+
+struct  RastSample
+{
+    float       invDepth;   // 0 when nothing has been rasterized to this sample
+    uint        surfIdx;
+    uint        triIdx;
+    FgVect3F    bary;       // Perspective-correct
+};
+
+struct  RastTri
+{
+    uint        surfIdx;
+    uint        triIdx;
+
+    RastTri(uint s,uint t) : surfIdx(s), triIdx(t) {}
+};
+
+// Returns the triangles overlapping each band of 'bandRows' supersample rows, in surface then
+// triangle order so that z-buffer ties resolve as for a single pass over all triangles:
+static
+vector<vector<RastTri> >
+binTris(
+    const vector<RastSurf> &    surfs,
+    uint                        width,      // In supersamples
+    uint                        height,     // "
+    uint                        bandRows)
+{
+    vector<vector<RastTri> >    ret((height+bandRows-1)/bandRows);
+    for (uint ss=0; ss<surfs.size(); ++ss) {
+        const RastSurf &            rs = surfs[ss];
+        const vector<FgVect3UI> &   tris = *(rs.surf.vertInds);
+        for (uint tt=0; tt<tris.size(); ++tt) {
+            FgVect3UI   tri = tris[tt];
+            FgVect2F    v[3] = {rs.vertsRcs[tri[0]],rs.vertsRcs[tri[1]],rs.vertsRcs[tri[2]]};
+            // Samples are at the centres of the raster cells:
+            float       yMin = std::min(v[0][1],std::min(v[1][1],v[2][1])) - 0.5f,
+                        yMax = std::max(v[0][1],std::max(v[1][1],v[2][1])) - 0.5f,
+                        xMin = std::min(v[0][0],std::min(v[1][0],v[2][0])) - 0.5f,
+                        xMax = std::max(v[0][0],std::max(v[1][0],v[2][0])) - 0.5f;
+            if ((yMax < 0.0f) || (yMin >= float(height)) || (xMax < 0.0f) || (xMin >= float(width)))
+                continue;
+            int         r0 = int(std::ceil(std::max(yMin,0.0f))),
+                        r1 = int(std::floor(std::min(yMax,float(height-1))));
+            for (int bb=r0/int(bandRows); bb<=r1/int(bandRows); ++bb)
+                ret[bb].push_back(RastTri(ss,tt));
+        }
+    }
+    return ret;
+}
+
+// Scan converts 'rastTris' over the supersample rows [rowBeg,rowEnd) into 'zbuf':
+static
+void
+rasterBand(
+    const vector<RastSurf> &    surfs,
+    const vector<RastTri> &     rastTris,
+    uint                        width,      // In supersamples
+    uint                        rowBeg,
+    uint                        rowEnd,
+    vector<RastSample> &        zbuf)
+{
+    RastSample          empty;
+    empty.invDepth = 0.0f;
+    zbuf.assign(size_t(width)*(rowEnd-rowBeg),empty);
+    for (size_t ii=0; ii<rastTris.size(); ++ii) {
+        uint        ss = rastTris[ii].surfIdx,
+                    tt = rastTris[ii].triIdx;
+        const RastSurf & rs = surfs[ss];
+        FgVect3UI   tri = (*rs.surf.vertInds)[tt];
+        FgVect2F    v[3] = {rs.vertsRcs[tri[0]],rs.vertsRcs[tri[1]],rs.vertsRcs[tri[2]]};
+        // Samples are at the centres of the raster cells:
+        float       yMin = std::min(v[0][1],std::min(v[1][1],v[2][1])) - 0.5f,
+                    yMax = std::max(v[0][1],std::max(v[1][1],v[2][1])) - 0.5f,
+                    xMin = std::min(v[0][0],std::min(v[1][0],v[2][0])) - 0.5f,
+                    xMax = std::max(v[0][0],std::max(v[1][0],v[2][0])) - 0.5f;
+        if ((yMax < float(rowBeg)) || (yMin >= float(rowEnd)) || (xMax < 0.0f) || (xMin >= float(width)))
+            continue;
+        int         r0 = int(std::ceil(std::max(yMin,float(rowBeg)))),
+                    r1 = int(std::floor(std::min(yMax,float(rowEnd-1)))),
+                    c0 = int(std::ceil(std::max(xMin,0.0f))),
+                    c1 = int(std::floor(std::min(xMax,float(width-1))));
+        // Edge function 'ee' is opposite vertex 'ee' and is proportional to its barycentric coord:
+        float       dx[3],dy[3],e0[3];
+        for (uint ee=0; ee<3; ++ee) {
+            FgVect2F    va = v[(ee+1)%3],
+                        vb = v[(ee+2)%3];
+            dx[ee] = va[1] - vb[1];
+            dy[ee] = vb[0] - va[0];
+            e0[ee] = va[0]*vb[1] - va[1]*vb[0];
+        }
+        float       area = e0[0] + e0[1] + e0[2];
+        if (area == 0.0f)
+            continue;
+        // Normalize so edge functions give barycentric coordinates directly, handling
+        // either winding since the ray caster doesn't cull back faces:
+        float       invArea = 1.0f / area;
+        for (uint ee=0; ee<3; ++ee) {
+            dx[ee] *= invArea;
+            dy[ee] *= invArea;
+            e0[ee] *= invArea;
+        }
+        float       w0 = rs.invDepth[tri[0]],
+                    w1 = rs.invDepth[tri[1]],
+                    w2 = rs.invDepth[tri[2]];
+        for (int row=r0; row<=r1; ++row) {
+            float       py = float(row) + 0.5f,
+                        px = float(c0) + 0.5f,
+                        b0 = e0[0] + dx[0]*px + dy[0]*py,
+                        b1 = e0[1] + dx[1]*px + dy[1]*py,
+                        b2 = e0[2] + dx[2]*px + dy[2]*py;
+            RastSample *    line = &zbuf[size_t(row-rowBeg)*width];
+            for (int col=c0; col<=c1; ++col) {
+                if ((b0 >= 0.0f) && (b1 >= 0.0f) && (b2 >= 0.0f)) {
+                    float       w = b0*w0 + b1*w1 + b2*w2;
+                    RastSample &    smp = line[col];
+                    if (w > smp.invDepth) {
+                        float   iw = 1.0f / w;
+                        smp.invDepth = w;
+                        smp.surfIdx = ss;
+                        smp.triIdx = tt;
+                        smp.bary = FgVect3F(b0*w0*iw,b1*w1*iw,b2*w2*iw);
+                    }
+                }
+                b0 += dx[0];
+                b1 += dx[1];
+                b2 += dx[2];
+            }
+        }
+    }
+}
+
+// Renders the image rows [rowBeg,rowEnd) by rasterizing then resolving the 'ss' x 'ss'
+// supersamples of each pixel. As with multisample anti-aliasing, samples are shaded once per
+// distinct triangle in the pixel (at their mean position) and weighted by coverage, since
+// shading is far more expensive than coverage:
+static
+void
+rasterRows(
+    const vector<RastSurf> &    surfs,
+    const vector<RastTri> &     rastTris,   // Triangles overlapping these rows
+    const FgFuncShader &        shader,
+    FgRgbaF                     background,
+    uint                        ss,
+    uint                        rowBeg,
+    uint                        rowEnd,
+    FgImgRgbaUb *               imgPtr)
+{
+    FgImgRgbaUb &       img = *imgPtr;
+    uint                width = img.width() * ss;
+    vector<RastSample>  zbuf;
+    rasterBand(surfs,rastTris,width,rowBeg*ss,rowEnd*ss,zbuf);
+    float               norm = 1.0f / float(ss*ss);
+    struct  Frag
+    {
+        uint        surfIdx;
+        uint        triIdx;
+        FgVect3F    baryAcc;
+        uint        count;
+    };
+    Frag                frags[16];
+    FGASSERT(ss*ss <= 16);
+    for (uint row=rowBeg; row<rowEnd; ++row) {
+        for (uint col=0; col<img.width(); ++col) {
+            uint            numFrags = 0,
+                            numEmpty = 0;
+            for (uint yy=0; yy<ss; ++yy) {
+                const RastSample *  line = &zbuf[size_t((row-rowBeg)*ss+yy)*width + col*ss];
+                for (uint xx=0; xx<ss; ++xx) {
+                    const RastSample &  smp = line[xx];
+                    if (smp.invDepth > 0.0f) {
+                        uint        ff = 0;
+                        while ((ff < numFrags) &&
+                               ((frags[ff].triIdx != smp.triIdx) || (frags[ff].surfIdx != smp.surfIdx)))
+                            ++ff;
+                        if (ff == numFrags) {
+                            Frag &  frag = frags[numFrags++];
+                            frag.surfIdx = smp.surfIdx;
+                            frag.triIdx = smp.triIdx;
+                            frag.baryAcc = smp.bary;
+                            frag.count = 1;
+                        }
+                        else {
+                            frags[ff].baryAcc += smp.bary;
+                            ++frags[ff].count;
+                        }
+                    }
+                    else
+                        ++numEmpty;
+                }
+            }
+            FgRgbaF         acc = background * float(numEmpty);
+            for (uint ff=0; ff<numFrags; ++ff) {
+                const Frag &    frag = frags[ff];
+                FgRgbaF         clr = surfs[frag.surfIdx].shade(shader,frag.triIdx,frag.baryAcc/float(frag.count));
+                acc += fgCompositeFragment(clr,background) * float(frag.count);
+            }
+            acc *= norm;
+            img.xy(col,row) =
+                FgRgbaUB(
+                    uchar(fgClip(acc.red(),0.0f,255.0f)),
+                    uchar(fgClip(acc.green(),0.0f,255.0f)),
+                    uchar(fgClip(acc.blue(),0.0f,255.0f)),
+                    uchar(fgClip(acc.alpha(),0.0f,255.0f)));
+        }
+    }
+}
+
+static
+FgImgRgbaUb
+rasterize(
+    FgVect2UI                   pxSz,
+    const vector<FgSurfPtr> &   rendSurfs,
+    const FgFuncShader &        shader,
+    FgAffine3F                  modelview,
+    FgAffineCw2F                itcsToIucs,
+    FgRgbaF                     background,
+    uint                        antiAliasBitDepth,
+    uint                        numThreads)
+{
+    FgImgRgbaUb         img(pxSz);
+    FGASSERT(pxSz.volume() > 0);
+    FGASSERT((antiAliasBitDepth > 0) && (antiAliasBitDepth <= 8));
+    // Roughly matches the ray caster's quality for the same bit depth without its adaptivity;
+    // the upper limit keeps the z-buffer small:
+    uint                ss = std::min(1U << ((antiAliasBitDepth+1)/2),4U);
+    FgAffineCw2F        iucsToRcs(FgVect2F(pxSz*ss),FgVect2F(0.0f));
+    vector<RastSurf>    surfs;
+    surfs.reserve(rendSurfs.size());
+    for (size_t ii=0; ii<rendSurfs.size(); ++ii)
+        surfs.push_back(RastSurf(rendSurfs[ii],modelview,iucsToRcs*itcsToIucs,1.0f/float(ss)));
+    // Bands keep the z-buffer small and are independent so can be run in parallel. Triangles
+    // are binned once into the bands they overlap so each band only traverses its own:
+    const uint          bandSz = 16;
+    vector<vector<RastTri> >    bins = binTris(surfs,pxSz[0]*ss,pxSz[1]*ss,bandSz*ss);
+    if (numThreads == 1) {
+        for (uint row=0; row<pxSz[1]; row+=bandSz)
+            rasterRows(surfs,bins[row/bandSz],shader,background,ss,row,std::min(row+bandSz,pxSz[1]),&img);
+        return img;
+    }
+    vector<FgJob>       jobs;
+    for (uint row=0; row<pxSz[1]; row+=bandSz)
+        jobs.push_back(boost::bind(rasterRows,boost::cref(surfs),boost::cref(bins[row/bandSz]),
+            boost::cref(shader),background,ss,row,std::min(row+bandSz,pxSz[1]),&img));
+    fgThreadPool().run(jobs,numThreads);
+    return img;
+}
+
+static
+bool
+hasTransparency(const Fg3dMesh & mesh)
+{
+    for (size_t ss=0; ss<mesh.surfaces.size(); ++ss) {
+        const boost::shared_ptr<FgImgRgbaUb> &  map = mesh.surfaces[ss].albedoMap;
+        if (map)
+            for (size_t ii=0; ii<map->numPixels(); ++ii)
+                if ((*map)[ii].alpha() < 255)
+                    return true;
+    }
+    return false;
+}
+
 FgImgRgbaUb
 fgSoftRender(
     FgVect2UI                   pxSz,
@@ -65,7 +379,9 @@ fgSoftRender(
     FgAffine3D                  modelview,
     FgAffineCw2D                itcsToIucs,
     FgRgbaF                     backgroundColor,
-    uint                        antiAliasBitDepth)
+    uint                        antiAliasBitDepth,
+    uint                        numThreads,
+    FgSoftRenderBackend         backend)
 {
     FgImgRgbaUb             img;
     FgVectF2                colorBounds = fgBounds(backgroundColor.m_c);
@@ -73,6 +389,8 @@ fgSoftRender(
     vector<Fg3dSurface>     surfs(meshes.size());
     vector<FgSurfPtr>       rendSurfs(meshes.size());
     vector<Fg3dNormals>     norms(meshes.size());
+    // Built per call since Fg3dSurface has nowhere to cache them; levels are built on first use:
+    vector<std::unique_ptr<FgImgPyramidRgbaUb> >    texPyrs(meshes.size());
     for (size_t ii=0; ii<meshes.size(); ++ii) {
         const Fg3dMesh &    mesh = meshes[ii];
         FGASSERT(mesh.surfaces.size() == 1);
@@ -85,15 +403,32 @@ fgSoftRender(
         rs.norms = &norms[ii];
         rs.uvs = &mesh.uvs;
         rs.uvInds = &surfs[ii].tris.uvInds;
-        rs.texImg = (mesh.surfaces[0].albedoMap ? mesh.surfaces[0].albedoMap.get() : NULL);
+        const boost::shared_ptr<FgImgRgbaUb> &  map = mesh.surfaces[0].albedoMap;
+        if (map && !map->empty())
+            texPyrs[ii].reset(new FgImgPyramidRgbaUb(*map));
+        rs.texImg = texPyrs[ii].get();
+    }
+    FgFuncShader    shade = boost::bind(shader,boost::cref(light),_1,_2,_3,_4,_5);
+    if (backend == FgSoftRenderBackend::automatic) {
+        backend = FgSoftRenderBackend::raster;
+        for (size_t ii=0; ii<meshes.size(); ++ii)
+            if (hasTransparency(meshes[ii]))
+                backend = FgSoftRenderBackend::rayCast;
     }
+    if (backend == FgSoftRenderBackend::raster)
+        return rasterize(pxSz,rendSurfs,shade,modelview,fgD2F(itcsToIucs),
+            backgroundColor,antiAliasBitDepth,numThreads);
     Fg3dRayCaster   rc(rendSurfs,
-            boost::bind(shader,boost::cref(light),_1,_2,_3,_4),
+            shade,
             modelview,
             fgD2F(itcsToIucs),
-            backgroundColor);
-    // The 'boost::cref' for the 'rc' arg is critical; otherwise 'rc' gets copied on every call:
-    img = fgSampler(pxSz,boost::bind(&Fg3dRayCaster::cast,boost::cref(rc),_1),antiAliasBitDepth);
+            backgroundColor,
+            pxSz);
+    // The 'boost::cref' for the 'rc' arg is critical; otherwise 'rc' gets copied on every call.
+    // 'rc' is read-only during sampling so can be shared by the sampler threads:
+    img = fgSamplerPacket(pxSz,
+        boost::bind(&Fg3dRayCaster::castPacket,boost::cref(rc),_1,_2,_3),
+        antiAliasBitDepth,numThreads);
     return img;
 }
 
@@ -6,7 +6,7 @@
 // Authors:     Andrew Beatty
 // Created:     April 7, 2010
 //
-// Anti-aliased ray-casting software renderer
+// Anti-aliased software renderer with ray-casting and z-buffer rasterizing backends
 //
 
 #ifndef FG_SOFTRENDER_HPP
@@ -17,6 +17,14 @@
 #include "FgLighting.hpp"
 #include "FgImage.hpp"
 
+// The ray caster composites up to 8 transparent layers per sample and adaptively anti-aliases.
+// The rasterizer keeps only the nearest surface per sample and uses fixed supersampling so it's
+// much faster but is only correct for opaque meshes. 'automatic' selects the rasterizer unless
+// any albedo map has transparent pixels:
+enum class FgSoftRenderBackend { rayCast, raster, automatic };
+
+// Albedo maps are sampled through an FgImagePyramid built for the duration of each call. Only the
+// levels actually sampled are computed, but those are recomputed on every call:
 FgImgRgbaUb
 fgSoftRender(
     FgVect2UI                   pixelSize,
@@ -27,7 +35,9 @@ fgSoftRender(
     // no clip planes (except for the implicit clipping at Z=0):
     FgAffineCw2D                itcsToIucs,
     FgRgbaF                     backgroundColor,        // PRE-WEIGHTED values in range [0,255]
-    uint                        antiAliasBitDepth=3);   // in [1,8], higher is slower
+    uint                        antiAliasBitDepth=3,    // in [1,8], higher is slower
+    uint                        numThreads=0,           // 0: all hardware threads
+    FgSoftRenderBackend         backend=FgSoftRenderBackend::rayCast);
 
 #endif
 
@@ -36,6 +36,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <exception>
 #include <fstream>
 #include <functional>
@@ -51,6 +54,7 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 #endif
 
@@ -83,12 +83,42 @@ inline void
 fgWritep(std::ostream & os,const FgString & s)
 {fgWritep(os,s.m_str); }
 
+// Vectors of elements whose serialized form is identical to their in-memory form (see FgSerialRaw)
+// are written and read as a single block, giving the same bytes as one element at a time.
+// Returns false if the element type requires per-element serialization:
+template<class T,bool raw=FgSerialRaw<T>::value>
+struct  FgSerialBlock
+{
+    static bool write(ostream &,const vector<T> &) {return false; }
+    static bool read(istream &,vector<T> &) {return false; }
+};
+
+template<class T>
+struct  FgSerialBlock<T,true>
+{
+    static
+    bool
+    write(ostream & os,const vector<T> & vec)
+    {
+        os.write(reinterpret_cast<const char*>(&vec[0]),std::streamsize(vec.size()*sizeof(T)));
+        return true;
+    }
+
+    static
+    bool
+    read(istream & is,vector<T> & vec)
+    {
+        is.read(reinterpret_cast<char*>(&vec[0]),std::streamsize(vec.size()*sizeof(T)));
+        return true;
+    }
+};
+
 template<class T>
 void
 fgWritep(ostream & os,const vector<T> & vec)
 {
     fgWritep(os,uint32(vec.size()));        // Always store size_t as 32 bit for 32/64 portability
-    if (!vec.empty())
+    if (!vec.empty() && !FgSerialBlock<T>::write(os,vec))
         for (size_t ii=0; ii<vec.size(); ++ii)
             fgWritep(os,vec[ii]);
 }
@@ -166,8 +196,9 @@ void
 fgReadp(istream & is,vector<T> & vec)
 {
     vec.resize(fgReadt<uint32>(is));
-    for (size_t ii=0; ii<vec.size(); ++ii)
-        fgReadp(is,vec[ii]);
+    if (!vec.empty() && !FgSerialBlock<T>::read(is,vec))
+        for (size_t ii=0; ii<vec.size(); ++ii)
+            fgReadp(is,vec[ii]);
 }
 
 template<class T>
@@ -0,0 +1,394 @@
+//
+// Copyright (c) 2015 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Created:     Oct 16, 2026
+//
+// Fast text output for large ASCII file formats. Numbers are formatted directly into a large
+// buffer without iostreams or the locale, and large arrays can be formatted in parallel chunks.
+//
+
+#ifndef FGTEXTWRITER_HPP
+#define FGTEXTWRITER_HPP
+
+#include "FgStdLibs.hpp"
+#include "FgTypes.hpp"
+#include "FgStdStream.hpp"
+#include "FgException.hpp"
+#include "FgDiagnostics.hpp"
+#include "FgThread.hpp"
+
+// Returns 10^exp for exp in [-53,53]:
+inline
+double
+fgPow10(int exp)
+{
+    static const double tab[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+        1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+        1e18, 1e19, 1e20, 1e21, 1e22, 1e23, 1e24, 1e25, 1e26,
+        1e27, 1e28, 1e29, 1e30, 1e31, 1e32, 1e33, 1e34, 1e35,
+        1e36, 1e37, 1e38, 1e39, 1e40, 1e41, 1e42, 1e43, 1e44,
+        1e45, 1e46, 1e47, 1e48, 1e49, 1e50, 1e51, 1e52, 1e53,
+    };
+    FGASSERT_FAST((exp > -54) && (exp < 54));
+    return (exp < 0) ? 1.0 / tab[-exp] : tab[exp];
+}
+
+// The functions below write to 'buf' without a null terminator and return the number of chars
+// written. 'buf' must have space for at least 24 chars (64 for fgFormatFixed):
+
+inline
+uint
+fgFormatUint(uint64 val,char * buf)
+{
+    char        tmp[24];
+    uint        num = 0;
+    do {
+        tmp[num++] = char('0' + val % 10);
+        val /= 10;
+    } while (val > 0);
+    for (uint ii=0; ii<num; ++ii)
+        buf[ii] = tmp[num-1-ii];
+    return num;
+}
+
+inline
+uint
+fgFormatInt(int64 val,char * buf)
+{
+    if (val >= 0)
+        return fgFormatUint(uint64(val),buf);
+    buf[0] = '-';
+    return fgFormatUint(uint64(0)-uint64(val),buf+1) + 1;
+}
+
+// Exact value of the positive finite float with the given bits. Unlike a cast, this is not
+// affected by the denormals-are-zero mode set by fast-math:
+inline
+double
+fgFloatBitsToDouble(uint32 bits)
+{
+    uint32          expBits = bits >> 23,
+                    mant = bits & 0x7FFFFF;
+    int             exp2 = -149;
+    if (expBits > 0) {
+        mant |= 0x800000;
+        exp2 += int(expBits) - 1;
+    }
+    uint64          scaleBits = uint64(exp2 + 1023) << 52;
+    double          scale;
+    memcpy(&scale,&scaleBits,8);
+    return double(mant) * scale;
+}
+
+// Uses the fewest significant digits which read back (eg. with strtof) to exactly 'val', except
+// that a decimal exactly halfway to an adjacent float is never used (one more digit is output).
+// Exponential notation is used for exponents below -4 or above 8, as for printf "%g":
+inline
+uint
+fgFormatFloat(float val,char * buf)
+{
+    // Classify using the bits since isnan etc. are not reliable with fast-math:
+    uint32          bits;
+    memcpy(&bits,&val,4);
+    char *          ptr = buf;
+    if (bits >> 31)
+        *ptr++ = '-';
+    bits &= 0x7FFFFFFF;
+    if (bits >= 0x7F800000) {
+        memcpy(ptr,(bits == 0x7F800000) ? "inf" : "nan",3);
+        return uint(ptr-buf) + 3;
+    }
+    if (bits == 0) {
+        *ptr++ = '0';
+        return uint(ptr-buf);
+    }
+    // Any decimal strictly within half the distance to the adjacent floats reads back as 'val':
+    double          dd = fgFloatBitsToDouble(bits),
+                    loWid = (dd - fgFloatBitsToDouble(bits-1)) * 0.5,
+                    hiWid = (bits == 0x7F7FFFFF) ? loWid : (fgFloatBitsToDouble(bits+1) - dd) * 0.5;
+    // Decimal exponent of the leading digit, estimated from the binary exponent then corrected
+    // so that the value rounded to 9 significant digits (always sufficient for a float) has
+    // exactly 9 digits:
+    uint64          ddBits;
+    memcpy(&ddBits,&dd,8);
+    int             exp10 = int(std::floor((int(ddBits >> 52) - 1023) * 0.30102999566398));
+    double          scale9,scaled;
+    uint64          digits;
+    for (;;) {
+        scale9 = fgPow10(8-exp10);
+        scaled = dd * scale9;
+        digits = uint64(scaled + 0.5);
+        if (digits >= 1000000000ULL)
+            ++exp10;
+        else if (digits < 100000000ULL)
+            --exp10;
+        else
+            break;
+    }
+    // Interval widths in units of the 9th digit, less a margin covering the rounding error
+    // in 'scaled' so that the result always reads back exactly:
+    double          hiTol = hiWid * scale9 * 0.999999,
+                    loTol = loWid * scale9 * 0.999999;
+    // Binary search for the fewest digits, since if N digits read back exactly then so do N+1:
+    uint            numDigits = 9,
+                    lo = 1;
+    uint64          shortest = digits;
+    while (lo < numDigits) {
+        uint        mid = (lo + numDigits) / 2;
+        double      unit = fgPow10(9-int(mid)),
+                    cand = std::floor(scaled / unit + 0.5),
+                    err = cand * unit - scaled;
+        if ((err >= 0.0) ? (err < hiTol) : (-err < loTol)) {
+            numDigits = mid;
+            shortest = uint64(cand);
+        }
+        else
+            lo = mid + 1;
+    }
+    digits = shortest;
+    if (digits == uint64(fgPow10(int(numDigits)))) {    // Rounded up to the next power of 10
+        digits /= 10;
+        ++exp10;
+    }
+    while ((numDigits > 1) && (digits % 10 == 0)) {
+        digits /= 10;
+        --numDigits;
+    }
+    char            dig[24];
+    fgFormatUint(digits,dig);
+    if ((exp10 < -4) || (exp10 > 8)) {
+        *ptr++ = dig[0];
+        if (numDigits > 1) {
+            *ptr++ = '.';
+            for (uint ii=1; ii<numDigits; ++ii)
+                *ptr++ = dig[ii];
+        }
+        *ptr++ = 'e';
+        *ptr++ = (exp10 < 0) ? '-' : '+';
+        uint        absExp = uint(std::abs(exp10));
+        if (absExp < 10)
+            *ptr++ = '0';
+        ptr += fgFormatUint(absExp,ptr);
+    }
+    else if (exp10 >= 0) {
+        uint        numInt = uint(exp10) + 1;
+        for (uint ii=0; ii<numInt; ++ii)
+            *ptr++ = (ii < numDigits) ? dig[ii] : '0';
+        if (numDigits > numInt) {
+            *ptr++ = '.';
+            for (uint ii=numInt; ii<numDigits; ++ii)
+                *ptr++ = dig[ii];
+        }
+    }
+    else {
+        *ptr++ = '0';
+        *ptr++ = '.';
+        for (int ii=-1; ii>exp10; --ii)
+            *ptr++ = '0';
+        for (uint ii=0; ii<numDigits; ++ii)
+            *ptr++ = dig[ii];
+    }
+    return uint(ptr-buf);
+}
+
+// As above. Values exactly representable as float (the usual case for mesh data) are formatted
+// as such, otherwise the C library is used to find the shortest of 15 to 17 digits:
+inline
+uint
+fgFormatDouble(double val,char * buf)
+{
+    float           fv = float(val);
+    if (double(fv) == val)
+        return fgFormatFloat(fv,buf);
+    for (int prec=15; prec<17; ++prec) {
+        int         num = sprintf(buf,"%.*g",prec,val);
+        if (strtod(buf,NULL) == val)
+            return uint(num);
+    }
+    return uint(sprintf(buf,"%.17g",val));
+}
+
+// Fixed point with the given number of decimals (max 9), as printf "%.*f":
+inline
+uint
+fgFormatFixed(float val,uint decimals,char * buf)
+{
+    FGASSERT_FAST(decimals < 10);
+    uint32          bits;
+    memcpy(&bits,&val,4);
+    uint32          absBits = bits & 0x7FFFFFFF;
+    float           absVal;
+    memcpy(&absVal,&absBits,4);
+    // Exact since the float mantissa times 10^9 fits within the double mantissa:
+    double          scaled = double(absVal) * fgPow10(int(decimals));
+    if ((absBits >= 0x7F800000) || (scaled >= 9.0e18))
+        return uint(sprintf(buf,"%.*f",int(decimals),double(val)));
+    uint64          num = uint64(scaled);
+    double          frac = scaled - double(num);
+    if ((frac > 0.5) || ((frac == 0.5) && (num & 1)))  // Round half to even, as printf
+        ++num;
+    char *          ptr = buf;
+    if (bits >> 31)
+        *ptr++ = '-';
+    uint64          div = uint64(fgPow10(int(decimals)));
+    ptr += fgFormatUint(num/div,ptr);
+    if (decimals > 0) {
+        *ptr++ = '.';
+        char        dig[24];
+        uint        nd = fgFormatUint(num%div,dig);
+        for (uint ii=nd; ii<decimals; ++ii)
+            *ptr++ = '0';
+        for (uint ii=0; ii<nd; ++ii)
+            *ptr++ = dig[ii];
+    }
+    return uint(ptr-buf);
+}
+
+// Stream this to an FgTextWriter to output a float as fixed point:
+struct  FgFixed
+{
+    float       val;
+    uint        decimals;
+
+    FgFixed(float v,uint d) : val(v), decimals(d) {}
+};
+
+// Drop-in replacement for an output file stream for text formats. Output is accumulated in a
+// large buffer and written to the file in blocks:
+class   FgTextWriter
+{
+public:
+    // Accumulates the text in memory only, eg. for text to be appended to other writers:
+    FgTextWriter() {}
+
+    // Throws if 'fname' cannot be opened for writing:
+    explicit
+    FgTextWriter(const FgString & fname)
+    : m_ofs(new FgOfstream(fname)), m_fname(fname)
+    {m_buf.reserve(bufSize + bufSize/4); }
+
+    // Errors writing the remaining text are only reported by 'close':
+    ~FgTextWriter()
+    {
+        try {close(); }
+        catch (...) {}
+    }
+
+    // Writes any remaining text to the file and closes it. Throws on failure:
+    void
+    close()
+    {
+        if (!m_ofs)
+            return;
+        flush();
+        m_ofs->close();
+        bool        fail = m_ofs->fail();
+        m_ofs.reset();
+        if (fail)
+            fgThrow("Error writing to file",m_fname);
+    }
+
+    // Text accumulated and not yet written to file:
+    const string &
+    str() const
+    {return m_buf; }
+
+    FgTextWriter &
+    write(const char * ptr,size_t num)
+    {
+        m_buf.append(ptr,num);
+        if (m_ofs && (m_buf.size() >= bufSize))
+            flush();
+        return *this;
+    }
+
+    FgTextWriter &
+    append(const FgTextWriter & text)
+    {return write(text.m_buf.data(),text.m_buf.size()); }
+
+    FgTextWriter & operator<<(const char * str) {return write(str,strlen(str)); }
+    FgTextWriter & operator<<(const string & str) {return write(str.data(),str.size()); }
+    FgTextWriter & operator<<(const FgString & str) {return write(str.m_str.data(),str.m_str.size()); }
+    FgTextWriter & operator<<(char ch) {return write(&ch,1); }
+    FgTextWriter & operator<<(int val) {return formatted(fgFormatInt(val,m_tmp)); }
+    FgTextWriter & operator<<(long val) {return formatted(fgFormatInt(val,m_tmp)); }
+    FgTextWriter & operator<<(long long val) {return formatted(fgFormatInt(val,m_tmp)); }
+    FgTextWriter & operator<<(unsigned int val) {return formatted(fgFormatUint(val,m_tmp)); }
+    FgTextWriter & operator<<(unsigned long val) {return formatted(fgFormatUint(val,m_tmp)); }
+    FgTextWriter & operator<<(unsigned long long val) {return formatted(fgFormatUint(val,m_tmp)); }
+    FgTextWriter & operator<<(float val) {return formatted(fgFormatFloat(val,m_tmp)); }
+    FgTextWriter & operator<<(double val) {return formatted(fgFormatDouble(val,m_tmp)); }
+    FgTextWriter & operator<<(FgFixed val) {return formatted(fgFormatFixed(val.val,val.decimals,m_tmp)); }
+
+    // Only 'endl' (newline) and 'flush' (ignored) are supported:
+    FgTextWriter &
+    operator<<(std::ostream & (*manip)(std::ostream &))
+    {
+        typedef std::ostream & (*Manip)(std::ostream &);
+        if (manip == static_cast<Manip>(std::endl))
+            return write("\n",1);
+        FGASSERT(manip == static_cast<Manip>(std::flush));
+        return *this;
+    }
+
+private:
+    static const size_t             bufSize = size_t(1) << 22;
+    std::unique_ptr<FgOfstream>     m_ofs;
+    FgString                        m_fname;
+    string                          m_buf;
+    char                            m_tmp[64];
+
+    FgTextWriter(const FgTextWriter &);     // Not copyable
+    void operator=(const FgTextWriter &);
+
+    FgTextWriter &
+    formatted(uint num)
+    {return write(m_tmp,num); }
+
+    void
+    flush()
+    {
+        if (!m_buf.empty())
+            m_ofs->write(m_buf.data(),m_buf.size());
+        m_buf.clear();
+    }
+};
+
+// Writes the text of a single item (eg. a vertex) given its index:
+typedef boost::function<void(FgTextWriter &,size_t)>    FgTextItemFunc;
+
+inline
+void
+fgWriteItemRange(const FgTextItemFunc * func,size_t begin,size_t end,FgTextWriter * out)
+{
+    for (size_t ii=begin; ii<end; ++ii)
+        (*func)(*out,ii);
+}
+
+// Writes the text of items [0,num) to 'out' in order. Large item counts are formatted in
+// separate chunks in parallel then appended, so 'func' must be safe to call concurrently:
+inline
+void
+fgWriteItems(FgTextWriter & out,size_t num,const FgTextItemFunc & func)
+{
+    const size_t            minItemsPerChunk = 4096;
+    size_t                  numChunks = std::min(num/minItemsPerChunk,size_t(fgThreadPool().numThreads())*4);
+    if (numChunks < 2) {
+        fgWriteItemRange(&func,0,num,&out);
+        return;
+    }
+    vector<FgTextWriter>    chunks(numChunks);
+    vector<FgJob>           jobs(numChunks);
+    for (size_t ii=0; ii<numChunks; ++ii)
+        jobs[ii] = boost::bind(fgWriteItemRange,&func,(num*ii)/numChunks,(num*(ii+1))/numChunks,&chunks[ii]);
+    fgThreadPool().run(jobs);
+    for (size_t ii=0; ii<numChunks; ++ii)
+        out.append(chunks[ii]);
+}
+
+#endif
+
+// */
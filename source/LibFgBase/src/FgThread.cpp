@@ -22,3 +22,133 @@ bool    fg_debug_thread = false;
 */
 #define LOG_DEBUG_THREAD(x)
 
+
+FgThreadPool::FgThreadPool(uint numThreads) :
+    m_jobs(NULL),
+    m_next(0),
+    m_remaining(0),
+    m_active(0),
+    m_maxActive(0),
+    m_failed(false),
+    m_exception(""),
+    m_quit(false)
+{
+    if (numThreads == 0)
+        numThreads = uint(boost::thread::hardware_concurrency());
+    for (uint ii=1; ii<numThreads; ++ii)
+        m_threads.push_back(std::unique_ptr<boost::thread>(
+            new boost::thread(&FgThreadPool::worker,this)));
+}
+
+FgThreadPool::~FgThreadPool()
+{
+    {
+        boost::lock_guard<boost::mutex>     lock(m_mtx);
+        m_quit = true;
+    }
+    m_cvWork.notify_all();
+    for (size_t ii=0; ii<m_threads.size(); ++ii)
+        m_threads[ii]->join();
+}
+
+void
+FgThreadPool::run(const vector<FgJob> & jobs,uint maxThreads)
+{
+    if (jobs.empty())
+        return;
+    // Waiting for the pool from within one of its own jobs would deadlock:
+    bool                                nested;
+    {
+        boost::lock_guard<boost::mutex>     lock(m_mtx);
+        nested = fgContains(m_inJob,boost::this_thread::get_id());
+    }
+    if (nested) {
+        for (size_t ii=0; ii<jobs.size(); ++ii)
+            jobs[ii]();
+        return;
+    }
+    boost::lock_guard<boost::mutex>     runLock(m_runMtx);
+    boost::unique_lock<boost::mutex>    lock(m_mtx);
+    m_jobs = &jobs;
+    m_next = 0;
+    m_remaining = jobs.size();
+    m_maxActive = (maxThreads == 0) ? numThreads() : maxThreads;
+    m_failed = false;
+    lock.unlock();
+    m_cvWork.notify_all();
+    lock.lock();
+    while (runOne(lock))
+        {}
+    while (m_remaining > 0)
+        m_cvDone.wait(lock);
+    m_jobs = NULL;
+    if (m_failed)
+        fgThrow(m_exception);
+}
+
+void
+FgThreadPool::worker()
+{
+    boost::unique_lock<boost::mutex>    lock(m_mtx);
+    while (!m_quit) {
+        if (!runOne(lock))
+            m_cvWork.wait(lock);
+    }
+}
+
+bool
+FgThreadPool::runOne(boost::unique_lock<boost::mutex> & lock)
+{
+    if ((m_jobs == NULL) || (m_next == m_jobs->size()) || (m_active >= m_maxActive))
+        return false;
+    const FgJob &   job = (*m_jobs)[m_next++];
+    boost::thread::id   id = boost::this_thread::get_id();
+    ++m_active;
+    m_inJob.push_back(id);
+    lock.unlock();
+    bool            failed = true;
+    FgException     err("");
+    try {
+        job();
+        failed = false;
+    }
+    catch(FgException const & e) {
+        err = e;
+    }
+    catch(std::exception const & e) {
+        err = FgException("Standard library exception",e.what());
+    }
+    catch(...) {
+        err = FgException("Unknown exception type");
+    }
+    lock.lock();
+    m_inJob.erase(find(m_inJob.begin(),m_inJob.end(),id));
+    --m_active;
+    --m_remaining;
+    if (failed && !m_failed) {
+        m_failed = true;
+        m_exception = err;
+        // Abandon unclaimed jobs:
+        m_remaining -= m_jobs->size() - m_next;
+        m_next = m_jobs->size();
+    }
+    if (m_remaining == 0)
+        m_cvDone.notify_all();
+    return true;
+}
+
+static FgThreadPool *   s_threadPool;
+static FgOnce           s_threadPoolOnce = FG_ONCE_INIT;
+
+static
+void
+threadPoolInit()
+// Never destroyed since worker threads cannot be reliably joined during static destruction:
+{s_threadPool = new FgThreadPool; }
+
+FgThreadPool &
+fgThreadPool()
+{
+    fgRunOnce(s_threadPoolOnce,threadPoolInit);
+    return *s_threadPool;
+}
@@ -10,6 +10,8 @@
 #define INCLUDED_FGTHREAD_HPP
 
 #include "FgTypes.hpp"
+#include "FgStdVector.hpp"
+#include "FgException.hpp"
 
 extern bool     fg_debug_thread;        // Set to true for copious debug messages
 
@@ -64,4 +66,65 @@ struct FgOnce
 void fgRunOnce(FgOnce & once,
                void(*init_routine)());
 
+typedef boost::function<void()>     FgJob;
+
+// Persistent pool of worker threads for data-parallel jobs. Threads are created once and
+// sleep on a condition variable between calls, so repeated small batches don't pay for
+// thread creation. Jobs must be independent of each other.
+class   FgThreadPool
+{
+public:
+    explicit
+    FgThreadPool(uint numThreads=0);    // Total including calling thread. 0: hardware concurrency
+
+    ~FgThreadPool();
+
+    uint
+    numThreads() const
+    {return uint(m_threads.size()) + 1; }
+
+    // Blocks until all jobs are done. The calling thread also runs jobs. No more than
+    // 'maxThreads' (0: all) threads will work on the jobs concurrently. If any job throws, the
+    // remaining jobs are abandoned and the first exception is re-thrown here.
+    // Concurrent calls from different threads are serialized. A call from within a job (eg. a
+    // parallel image resize inside a batch of image conversions) runs its jobs serially on the
+    // calling thread, since the pool's threads may all be busy with the outer jobs. Any
+    // exception from a nested job propagates directly:
+    void
+    run(
+        const vector<FgJob> &   jobs,
+        uint                    maxThreads=0);
+
+private:
+    vector<std::unique_ptr<boost::thread> > m_threads;
+    boost::mutex                m_runMtx;       // Serializes calls to 'run'
+    boost::mutex                m_mtx;          // Guards all members below:
+    boost::condition_variable   m_cvWork;
+    boost::condition_variable   m_cvDone;
+    const vector<FgJob> *       m_jobs;
+    size_t                      m_next;         // Next job to be claimed
+    size_t                      m_remaining;    // Claimed or unclaimed jobs not yet finished
+    uint                        m_active;       // Threads currently running a job
+    uint                        m_maxActive;
+    vector<boost::thread::id>   m_inJob;        // Threads currently running a job
+    bool                        m_failed;
+    FgException                 m_exception;
+    bool                        m_quit;
+
+    FgThreadPool(const FgThreadPool &);         // Not copyable
+    void operator=(const FgThreadPool &);
+
+    void
+    worker();
+
+    // Returns false if there was no job available to this thread. 'lock' must be held on
+    // entry and is held on return:
+    bool
+    runOne(boost::unique_lock<boost::mutex> & lock);
+};
+
+// Process-wide pool using all hardware threads, constructed on first use:
+FgThreadPool &
+fgThreadPool();
+
 #endif
@@ -74,6 +74,19 @@ template<> struct FgTypeAttributeFixedS<ulong> {};
 template<> struct FgTypeAttributeFixedS<int64> {};
 template<> struct FgTypeAttributeFixedS<uint64> {};
 
+// Types whose portable binary serialization (see FgStdStream.hpp) is identical to their in-memory
+// representation, so that contiguous arrays of them can be written and read as a single block.
+// The portable format is little-endian so this can only hold on little-endian platforms:
+template<class T> struct FgSerialRaw {static const bool value = false; };
+#if defined(BOOST_LITTLE_ENDIAN)
+template<> struct FgSerialRaw<int32> {static const bool value = true; };
+template<> struct FgSerialRaw<uint32> {static const bool value = true; };
+template<> struct FgSerialRaw<int64> {static const bool value = true; };
+template<> struct FgSerialRaw<uint64> {static const bool value = true; };
+template<> struct FgSerialRaw<float> {static const bool value = true; };
+template<> struct FgSerialRaw<double> {static const bool value = true; };
+#endif
+
 template<class T> struct FgTraits;
 
 template<> struct FgTraits<uchar>
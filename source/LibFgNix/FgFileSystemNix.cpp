@@ -12,6 +12,8 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include "FgFileSystem.hpp"
 #include "FgException.hpp"
 #include "FgDiagnostics.hpp"
@@ -133,6 +135,34 @@ void
 fgMakeWritableByAll(const FgString &)
 {fgThrowNotImplemented(); }
 
+FgFileMap::FgFileMap(const FgString & fname) : m_data(NULL), m_size(0), m_handle(NULL)
+{
+    int         fd = open(fname.as_utf8_string().c_str(),O_RDONLY);
+    if (fd < 0)
+        fgThrow("Unable to open file for reading",fname);
+    struct stat st;
+    if (fstat(fd,&st) != 0) {
+        close(fd);
+        fgThrow("Unable to get size of file",fname);
+    }
+    m_size = size_t(st.st_size);
+    if (m_size > 0) {
+        void *      ptr = mmap(NULL,m_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if (ptr == MAP_FAILED) {
+            close(fd);
+            fgThrow("Unable to memory map file",fname);
+        }
+        m_data = static_cast<const char*>(ptr);
+    }
+    close(fd);              // The mapping remains valid
+}
+
+FgFileMap::~FgFileMap()
+{
+    if (m_data != NULL)
+        munmap(const_cast<char*>(m_data),m_size);
+}
+
 #if defined(__APPLE__)
 
 #include <CoreFoundation/CFBundle.h>
@@ -198,6 +198,44 @@ fgPublicDocumentsDirectory()
     return FgString(path) + "\\";
 }
 
+FgFileMap::FgFileMap(const FgString & fname) : m_data(NULL), m_size(0), m_handle(NULL)
+{
+    HANDLE          hFile =
+        CreateFile(fname.as_wstring().c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        fgThrowWindows("Unable to open file for reading",fname);
+    LARGE_INTEGER   sz;
+    if (!GetFileSizeEx(hFile,&sz)) {
+        CloseHandle(hFile);
+        fgThrowWindows("Unable to get size of file",fname);
+    }
+    m_size = size_t(sz.QuadPart);
+    if (m_size > 0) {
+        HANDLE          hMap = CreateFileMapping(hFile,NULL,PAGE_READONLY,0,0,NULL);
+        if (hMap == NULL) {
+            CloseHandle(hFile);
+            fgThrowWindows("Unable to memory map file",fname);
+        }
+        m_data = static_cast<const char*>(MapViewOfFile(hMap,FILE_MAP_READ,0,0,0));
+        if (m_data == NULL) {
+            CloseHandle(hMap);
+            CloseHandle(hFile);
+            fgThrowWindows("Unable to memory map file",fname);
+        }
+        m_handle = hMap;
+    }
+    CloseHandle(hFile);     // The mapping keeps the file open
+}
+
+FgFileMap::~FgFileMap()
+{
+    if (m_data != NULL) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_handle);
+    }
+}
+
 bool
 fgCreationTime(const FgString & path,uint64 & time)
 {